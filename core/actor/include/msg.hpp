@@ -126,6 +126,7 @@ namespace bb
 
       virtual msg::result_t Execute() const = 0;
 
+      basicExecTask_t() = default;
       basicExecTask_t(const basicExecTask_t&) = default;
       basicExecTask_t& operator= (const basicExecTask_t&) = default;
 
@@ -0,0 +1,34 @@
+/**
+ * @file parallel.hpp
+ *
+ * Fork-join helpers on top of actor system
+ *
+ */
+
+#pragma once
+#ifndef __BB_CORE_ACTOR_PARALLEL_HEADER__
+#define __BB_CORE_ACTOR_PARALLEL_HEADER__
+
+#include <cstddef>
+#include <functional>
+
+namespace bb
+{
+
+  /**
+   * Call func(0) ... func(count - 1) on temporary execTask_t actors and
+   * wait until all calls are finished.
+   *
+   * Calls are distributed round-robin, so func must be safe to run
+   * concurrently for different indecies.
+   *
+   * @warning must not be called from actor: caller blocks until workers
+   * finish the job.
+   *
+   * @throw first exception thrown by func, after all calls are finished
+   */
+  void ParallelFor(size_t count, const std::function<void(size_t)>& func);
+
+} // namespace bb
+
+#endif /* __BB_CORE_ACTOR_PARALLEL_HEADER__ */
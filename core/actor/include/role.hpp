@@ -63,7 +63,8 @@ namespace bb
 
   inline msg::result_t execTask_t::OnProcessMessage(const actor_t&, const msg::basic_t& msg)
   {
-    if (auto execTask = bb::msg::As<msg::basicExecTask_t>(msg))
+    // As() matches exact type only, tasks are execTask_t<func_t> subclasses
+    if (auto execTask = dynamic_cast<const msg::basicExecTask_t*>(&msg))
     {
       return execTask->Execute();
     }
@@ -0,0 +1,95 @@
+#include <parallel.hpp>
+#include <worker.hpp>
+#include <role.hpp>
+#include <mailbox.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace bb
+{
+
+  void ParallelFor(size_t count, const std::function<void(size_t)>& func)
+  {
+    if (count == 0)
+    {
+      return;
+    }
+
+    if (count == 1)
+    { // not worth of messaging
+      func(0);
+      return;
+    }
+
+    // carries exception thrown by func, if any
+    using jobDone_t = bb::msg::dataMsg_t<std::exception_ptr>;
+
+    auto& pool = bb::workerPool_t::Instance();
+    auto box = bb::postOffice_t::Instance().New(bb::GenerateUniqueName());
+    auto address = box->Address();
+
+    auto actorCount = std::max<size_t>(std::min<size_t>(std::thread::hardware_concurrency(), count), 1);
+
+    std::vector<bb::actorPID_t> actors;
+    actors.reserve(actorCount);
+    for (size_t i = 0; i < actorCount; ++i)
+    {
+      actors.emplace_back(pool.Register<bb::execTask_t>());
+    }
+
+    const std::function<void(size_t)>* pFunc = &func;
+    for (size_t i = 0; i < count; ++i)
+    {
+      auto task = [pFunc, i, address]()
+      {
+        std::exception_ptr error;
+        try
+        {
+          (*pFunc)(i);
+        }
+        catch (...)
+        { // done must be posted anyway, or caller waits forever
+          error = std::current_exception();
+        }
+        bb::postOffice_t::Instance().Post(address, bb::Issue<jobDone_t>(error, -1));
+        return bb::msg::result_t::complete;
+      };
+
+      pool.PostMessage(
+        actors[i % actorCount],
+        bb::msg_t(new bb::msg::execTask_t<decltype(task)>(task))
+      );
+    }
+
+    std::exception_ptr error;
+    for (size_t i = 0; i < count; ++i)
+    {
+      auto msg = box->Wait();
+      auto done = bb::As<jobDone_t>(msg);
+      if (done == nullptr)
+      { // nobody else knows this mailbox
+        assert(0);
+        continue;
+      }
+      if ((!error) && (done->Data()))
+      {
+        error = done->Data();
+      }
+    }
+
+    for (auto actor: actors)
+    {
+      pool.Unregister(actor);
+    }
+
+    if (error)
+    {
+      std::rethrow_exception(error);
+    }
+  }
+
+} // namespace bb
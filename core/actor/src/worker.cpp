@@ -111,6 +111,9 @@ namespace bb
       std::unique_lock<std::mutex> lock(info.guard);
       if (info.stop)
       { // when stop requested, and all messages processed
+        // One more pass, so unregistered actors swallow queued poison.
+        // Messages posted during this pass are not waited for.
+        this->DoProcessActors();
         Info("%s", "Stop Requested");
         break;
       }
@@ -0,0 +1,43 @@
+/**
+ * @file blockCompress.hpp
+ *
+ * BC1 (DXT1) and BC3 (DXT5) texture compression
+ *
+ * Encoder fits endpoints to inset bounding box of block colors. It is
+ * fast and good enough for offline asset baking of UI and tile textures.
+ *
+ */
+
+#pragma once
+#ifndef __BB_CORE_COMMON_BLOCK_COMPRESS_HEADER__
+#define __BB_CORE_COMMON_BLOCK_COMPRESS_HEADER__
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bb
+{
+
+  /**
+   * Compress RGBA image to BC1, alpha is dropped.
+   *
+   * @param rgba source pixels
+   * @param width image width
+   * @param height image height
+   * @param output ((width + 3)/4)*((height + 3)/4)*8 bytes
+   */
+  void CompressBC1(const uint8_t* rgba, int width, int height, uint8_t* output);
+
+  /**
+   * Compress RGBA image to BC3.
+   *
+   * @param rgba source pixels
+   * @param width image width
+   * @param height image height
+   * @param output ((width + 3)/4)*((height + 3)/4)*16 bytes
+   */
+  void CompressBC3(const uint8_t* rgba, int width, int height, uint8_t* output);
+
+} // namespace bb
+
+#endif /* __BB_CORE_COMMON_BLOCK_COMPRESS_HEADER__ */
@@ -0,0 +1,109 @@
+/**
+ * @file glyphTable.hpp
+ *
+ * Codepoint to dense glyph ID mapping.
+ *
+ */
+
+#pragma once
+#ifndef __BB_CORE_COMMON_GLYPH_TABLE_HEADER__
+#define __BB_CORE_COMMON_GLYPH_TABLE_HEADER__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bb
+{
+
+  /**
+   * Two-level page table from codepoints to glyph IDs.
+   *
+   * Codepoints are split on pages of 128 symbols, only pages with glyphs
+   * are stored, all other pages share one empty page. Lookup is two array
+   * reads without branches on page content.
+   *
+   * Glyph ID 0 means "no glyph", so glyph metrics can be kept in flat
+   * array, where element 0 is default glyph.
+   */
+  class glyphTable_t final
+  {
+    enum : uint32_t
+    {
+      pageBits = 7,
+      pageSize = 1u << pageBits,
+      pageMask = pageSize - 1
+    };
+
+    std::vector<uint16_t> directory; // page index for each page of codepoints
+    std::vector<uint16_t> ids;       // glyph IDs, page 0 is always empty
+
+  public:
+
+    /**
+     * @return glyph ID or 0, if codepoint has no glyph
+     */
+    uint16_t Find(uint32_t codepoint) const;
+
+    /**
+     * Map codepoint to glyph ID, previous mapping is replaced.
+     *
+     * @return -1 if codepoint is out of unicode range, 0 otherwise
+     */
+    int Insert(uint32_t codepoint, uint16_t id);
+
+    /**
+     * Table memory footprint in bytes.
+     */
+    size_t ByteSize() const;
+
+    glyphTable_t();
+  };
+
+  inline uint16_t glyphTable_t::Find(uint32_t codepoint) const
+  {
+    uint32_t page = codepoint >> pageBits;
+    if (page >= this->directory.size())
+    {
+      return 0;
+    }
+    return this->ids[(static_cast<uint32_t>(this->directory[page]) << pageBits) | (codepoint & pageMask)];
+  }
+
+  inline int glyphTable_t::Insert(uint32_t codepoint, uint16_t id)
+  {
+    if (codepoint > 0x10FFFF)
+    {
+      return -1;
+    }
+
+    uint32_t page = codepoint >> pageBits;
+    if (page >= this->directory.size())
+    {
+      this->directory.resize(page + 1, 0);
+    }
+
+    if (this->directory[page] == 0)
+    {
+      this->directory[page] = static_cast<uint16_t>(this->ids.size() >> pageBits);
+      this->ids.resize(this->ids.size() + pageSize, 0);
+    }
+
+    this->ids[(static_cast<uint32_t>(this->directory[page]) << pageBits) | (codepoint & pageMask)] = id;
+    return 0;
+  }
+
+  inline size_t glyphTable_t::ByteSize() const
+  {
+    return (this->directory.size() + this->ids.size())*sizeof(uint16_t);
+  }
+
+  inline glyphTable_t::glyphTable_t()
+  : ids(pageSize, 0)
+  {
+    ;
+  }
+
+} // namespace bb
+
+#endif /* __BB_CORE_COMMON_GLYPH_TABLE_HEADER__ */
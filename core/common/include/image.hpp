@@ -58,6 +58,16 @@ namespace bb
 
   image_t LoadTGA(const std::string& filename);
 
+  /**
+   * Decode TGA image from memory, as read from file.
+   *
+   * Only 32-bit RGBA and 16-bit grey with alpha images are supported.
+   * Result is always RGBA with origin in upper left corner.
+   *
+   * @throw std::runtime_error on invalid data
+   */
+  image_t LoadTGA(const uint8_t* data, size_t size);
+
 }
 
 #endif /* __BB_CORE_COMMON_TARGA_HEADER__ */
\ No newline at end of file
@@ -0,0 +1,81 @@
+/**
+ * @file mappedFile.hpp
+ *
+ * Read-only memory mapped file
+ *
+ */
+
+#pragma once
+#ifndef __BB_CORE_COMMON_MAPPED_FILE_HEADER__
+#define __BB_CORE_COMMON_MAPPED_FILE_HEADER__
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bb
+{
+
+  class mappedFile_t final
+  {
+    const uint8_t* data;
+    size_t size;
+    intptr_t handle; // platform specific mapping handle
+
+    mappedFile_t(const mappedFile_t&) = delete;
+    mappedFile_t& operator=(const mappedFile_t&) = delete;
+
+    mappedFile_t(const uint8_t* data, size_t size, intptr_t handle);
+
+  public:
+
+    bool IsGood() const;
+
+    const uint8_t* Data() const;
+
+    size_t Size() const;
+
+    /**
+     * Hint OS, that file will be read from start to end.
+     */
+    void Sequential() const;
+
+    /**
+     * Hint OS, that whole file will be needed soon, so it can be read
+     * in background.
+     */
+    void WillNeed() const;
+
+    mappedFile_t();
+    mappedFile_t(mappedFile_t&&);
+    mappedFile_t& operator=(mappedFile_t&&);
+    ~mappedFile_t();
+
+    /**
+     * Map whole file to memory.
+     *
+     * Empty files can't be mapped, result is not IsGood() for them.
+     *
+     * @param filename path to file
+     */
+    static mappedFile_t Open(const char* filename);
+
+  };
+
+  inline bool mappedFile_t::IsGood() const
+  {
+    return this->data != nullptr;
+  }
+
+  inline const uint8_t* mappedFile_t::Data() const
+  {
+    return this->data;
+  }
+
+  inline size_t mappedFile_t::Size() const
+  {
+    return this->size;
+  }
+
+} // namespace bb
+
+#endif /* __BB_CORE_COMMON_MAPPED_FILE_HEADER__ */
@@ -9,7 +9,14 @@
 #ifndef __BB_CORE_COMMON_MONITOR_FS_HEADER__
 #define __BB_CORE_COMMON_MONITOR_FS_HEADER__
 
+#include <chrono>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace bb
 {
@@ -98,7 +105,64 @@ namespace bb
 
     };
 
+    /**
+     * Background file watcher.
+     *
+     * Directories of watched files are monitored on own thread, bursts of
+     * editor writes are coalesced: callback is called once per file, when it
+     * was not changed for debounce period. Editors, which save by rename, are
+     * supported too.
+     *
+     * Callback runs on watcher thread.
+     */
+    class watcher_t final
+    {
+    public:
+
+      using callback_t = std::function<void(const std::string& filename)>;
+
+    private:
+
+      using watchClock_t = std::chrono::steady_clock;
+      using pending_t = std::unordered_map<std::string, watchClock_t::time_point>;
+
+      int notify;
+      int poll;
+      int wakeup;
+
+      callback_t callback;
+      std::chrono::milliseconds debounce;
+
+      std::mutex guard;
+      std::unordered_map<int, std::string> dirs;
+      std::unordered_map<std::string, std::vector<std::string>> files;
+
+      std::thread thread;
+
+      watcher_t(const watcher_t&) = delete;
+      watcher_t& operator=(const watcher_t&) = delete;
+      watcher_t(watcher_t&&) = delete;
+      watcher_t& operator=(watcher_t&&) = delete;
 
+      void Run();
+      int ReadEvents(pending_t* pending);
+
+    public:
+
+      bool IsGood() const;
+
+      /**
+       * Add file to watch list.
+       *
+       * File may not exist yet. Callback gets filename exactly as given here.
+       *
+       * @return 0 on success, -1 on errors
+       */
+      int Watch(const std::string& filename);
+
+      watcher_t(callback_t&& callback, std::chrono::milliseconds debounce);
+      ~watcher_t();
+    };
 
   } // namespace fs
 
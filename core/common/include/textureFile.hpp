@@ -0,0 +1,117 @@
+/**
+ * @file textureFile.hpp
+ *
+ * GPU-ready texture container with prebuilt mip levels
+ *
+ * File layout (.tex):
+ *   textureFileHeader_t
+ *   textureFileLevel_t * levelCount
+ *   level data, each level starts at 16 byte boundary
+ *
+ * Level data is stored as glTexImage2D or glCompressedTexImage2D
+ * expect it, so it is uploaded directly from mapped file.
+ *
+ */
+
+#pragma once
+#ifndef __BB_CORE_COMMON_TEXTURE_FILE_HEADER__
+#define __BB_CORE_COMMON_TEXTURE_FILE_HEADER__
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include <image.hpp>
+#include <mappedFile.hpp>
+
+namespace bb
+{
+
+  enum class textureFormat_t: uint32_t
+  {
+    rgba8 = 0, /**< uncompressed RGBA, 4 bytes per texel */
+    bc1 = 1,   /**< DXT1, opaque RGB, 8 bytes per 4x4 block */
+    bc3 = 2    /**< DXT5, RGBA, 16 bytes per 4x4 block */
+  };
+
+  struct textureLevel_t
+  {
+    int width;
+    int height;
+    const uint8_t* data;
+    size_t size;
+  };
+
+  /**
+   * Read-only texture container, which points into memory mapped file.
+   */
+  class textureFile_t final
+  {
+    std::shared_ptr<const mappedFile_t> file;
+    std::vector<textureLevel_t> levels;
+    textureFormat_t format;
+
+  public:
+
+    bool IsGood() const;
+
+    textureFormat_t Format() const;
+
+    const std::vector<textureLevel_t>& Levels() const;
+
+    textureFile_t();
+
+    /**
+     * Map texture container.
+     *
+     * @return empty texture file on errors
+     */
+    static textureFile_t Map(const char* filename);
+
+  };
+
+  /**
+   * Byte size of texture level in given format.
+   */
+  size_t TextureLevelSize(textureFormat_t format, int width, int height);
+
+  /**
+   * Make next mip level with 2x2 box filter, as glGenerateMipmap does.
+   *
+   * Size is halved and rounded down, dimension of 1 pixel is kept.
+   *
+   * @param image RGBA image
+   */
+  image_t Downsample(const image_t& image);
+
+  /**
+   * Save texture container.
+   *
+   * @param output file to write
+   * @param image RGBA image
+   * @param format level data format
+   * @param mipmaps build full mip chain down to 1x1
+   *
+   * @return zero on success
+   */
+  int SaveTexture(FILE* output, const image_t& image, textureFormat_t format, bool mipmaps);
+
+  inline bool textureFile_t::IsGood() const
+  {
+    return !this->levels.empty();
+  }
+
+  inline textureFormat_t textureFile_t::Format() const
+  {
+    return this->format;
+  }
+
+  inline const std::vector<textureLevel_t>& textureFile_t::Levels() const
+  {
+    return this->levels;
+  }
+
+} // namespace bb
+
+#endif /* __BB_CORE_COMMON_TEXTURE_FILE_HEADER__ */
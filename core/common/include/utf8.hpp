@@ -11,6 +11,8 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <cwchar>
 
 #include <vector>
 #include <string>
@@ -31,6 +33,65 @@ namespace bb
 
   using utf8Symbols = std::u32string;
 
+  /**
+   * Length of ASCII prefix of string.
+   *
+   * Checks 16 or 32 bytes per step, when SIMD is available.
+   */
+  size_t utf8AsciiPrefix(const char* str, size_t size);
+
+  /**
+   * Decodes UTF-8 text in place, one symbol at a time.
+   *
+   * ASCII runs are found with utf8AsciiPrefix and then returned without
+   * any checks, other sequences are validated: overlong forms, surrogates
+   * and symbols after U+10FFFF are errors.
+   *
+   * @code
+   * bb::utf8Decoder_t decoder(text);
+   * uint32_t smb;
+   * while (decoder.Next(&smb))
+   * {
+   *   ...
+   * }
+   * if (!decoder.IsGood())
+   * {
+   *   // invalid UTF-8
+   * }
+   * @endcode
+   */
+  class utf8Decoder_t final
+  {
+    const uint8_t* cursor;
+    const uint8_t* end;
+    const uint8_t* asciiEnd; // symbols before it are known to be ASCII
+    bool good;
+
+    bool NextSlow(uint32_t* smb);
+
+  public:
+
+    /**
+     * Decode next symbol.
+     *
+     * @return false at the end of text or on invalid sequence
+     */
+    bool Next(uint32_t* smb);
+
+    /**
+     * No invalid sequence found yet.
+     */
+    bool IsGood() const;
+
+    /**
+     * Position of next symbol in text.
+     */
+    const char* Position() const;
+
+    explicit utf8Decoder_t(const char* str);
+    utf8Decoder_t(const char* str, size_t size);
+  };
+
   utf8Symbols utf8extract(const char* str); 
 
   utf8Length_t utf8SymbolLength(int smb);
@@ -45,6 +106,41 @@ namespace bb
 
   bool IsUpper(wint_t symbol);
 
+  inline bool utf8Decoder_t::Next(uint32_t* smb)
+  {
+    if (this->cursor < this->asciiEnd)
+    {
+      *smb = *this->cursor++;
+      return true;
+    }
+    return this->NextSlow(smb);
+  }
+
+  inline bool utf8Decoder_t::IsGood() const
+  {
+    return this->good;
+  }
+
+  inline const char* utf8Decoder_t::Position() const
+  {
+    return reinterpret_cast<const char*>(this->cursor);
+  }
+
+  inline utf8Decoder_t::utf8Decoder_t(const char* str, size_t size)
+  : cursor(reinterpret_cast<const uint8_t*>(str)),
+    end(reinterpret_cast<const uint8_t*>(str) + size),
+    asciiEnd(reinterpret_cast<const uint8_t*>(str)),
+    good(true)
+  {
+    ;
+  }
+
+  inline utf8Decoder_t::utf8Decoder_t(const char* str)
+  : utf8Decoder_t(str, strlen(str))
+  {
+    ;
+  }
+
 } // namespace bb
 
 #endif /* __BB_CORE_COMMON_UTF8_HEADER__ */
\ No newline at end of file
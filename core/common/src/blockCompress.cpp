@@ -0,0 +1,219 @@
+#include <blockCompress.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace bb
+{
+
+  namespace
+  {
+
+    // 4x4 RGBA texels, blocks on image border repeat last row and column
+    void FetchBlock(const uint8_t* rgba, int width, int height, int bx, int by, uint8_t* block)
+    {
+      for (int y = 0; y < 4; ++y)
+      {
+        int sy = std::min(by*4 + y, height - 1);
+        for (int x = 0; x < 4; ++x)
+        {
+          int sx = std::min(bx*4 + x, width - 1);
+          memcpy(
+            block + (y*4 + x)*4,
+            rgba + (static_cast<size_t>(sy)*static_cast<size_t>(width) + static_cast<size_t>(sx))*4,
+            4
+          );
+        }
+      }
+    }
+
+    uint16_t To565(const uint8_t* color)
+    {
+      return static_cast<uint16_t>(
+          ((color[0] >> 3) << 11)
+        | ((color[1] >> 2) << 5)
+        | (color[2] >> 3)
+      );
+    }
+
+    void From565(uint16_t packed, int* color)
+    {
+      int r = (packed >> 11) & 0x1F;
+      int g = (packed >> 5) & 0x3F;
+      int b = packed & 0x1F;
+      color[0] = (r << 3) | (r >> 2);
+      color[1] = (g << 2) | (g >> 4);
+      color[2] = (b << 3) | (b >> 2);
+    }
+
+    void Write16(uint8_t* output, uint16_t value)
+    {
+      output[0] = static_cast<uint8_t>(value & 0xFF);
+      output[1] = static_cast<uint8_t>(value >> 8);
+    }
+
+    // 8 byte BC1 color block in four color mode
+    //
+    // With withAlpha set, color of transparent texels is ignored, when
+    // block has visible ones: it is hidden by alpha block anyway.
+    void CompressColorBlock(const uint8_t* block, bool withAlpha, uint8_t* output)
+    {
+      bool hasVisible = false;
+      for (int i = 0; i < 16; ++i)
+      {
+        hasVisible = hasVisible || (block[i*4 + 3] != 0);
+      }
+      bool skipHidden = withAlpha && hasVisible;
+
+      uint8_t minColor[3] = { 255, 255, 255 };
+      uint8_t maxColor[3] = { 0, 0, 0 };
+      for (int i = 0; i < 16; ++i)
+      {
+        if (skipHidden && (block[i*4 + 3] == 0))
+        {
+          continue;
+        }
+        for (int c = 0; c < 3; ++c)
+        {
+          minColor[c] = std::min(minColor[c], block[i*4 + c]);
+          maxColor[c] = std::max(maxColor[c], block[i*4 + c]);
+        }
+      }
+
+      // inset box by 1/16 of its size, so endpoints are not wasted on outliers
+      for (int c = 0; c < 3; ++c)
+      {
+        int inset = (maxColor[c] - minColor[c]) >> 4;
+        minColor[c] = static_cast<uint8_t>(minColor[c] + inset);
+        maxColor[c] = static_cast<uint8_t>(maxColor[c] - inset);
+      }
+
+      uint16_t color0 = To565(maxColor);
+      uint16_t color1 = To565(minColor);
+      if (color0 < color1)
+      {
+        std::swap(color0, color1);
+      }
+
+      uint32_t indecies = 0;
+      if (color0 != color1)
+      {
+        int palette[4][3];
+        From565(color0, palette[0]);
+        From565(color1, palette[1]);
+        for (int c = 0; c < 3; ++c)
+        {
+          palette[2][c] = (2*palette[0][c] + palette[1][c])/3;
+          palette[3][c] = (palette[0][c] + 2*palette[1][c])/3;
+        }
+
+        for (int i = 0; i < 16; ++i)
+        {
+          uint32_t best = 0;
+          int bestDist = 0x7FFFFFFF;
+          for (uint32_t p = 0; p < 4; ++p)
+          {
+            int dist = 0;
+            for (int c = 0; c < 3; ++c)
+            {
+              int delta = block[i*4 + c] - palette[p][c];
+              dist += delta*delta;
+            }
+            if (dist < bestDist)
+            {
+              bestDist = dist;
+              best = p;
+            }
+          }
+          indecies |= best << (i*2);
+        }
+      }
+
+      Write16(output, color0);
+      Write16(output + 2, color1);
+      for (int i = 0; i < 4; ++i)
+      {
+        output[4 + i] = static_cast<uint8_t>((indecies >> (i*8)) & 0xFF);
+      }
+    }
+
+    // 8 byte BC3 alpha block in eight alpha mode
+    void CompressAlphaBlock(const uint8_t* block, uint8_t* output)
+    {
+      uint8_t minAlpha = 255;
+      uint8_t maxAlpha = 0;
+      for (int i = 0; i < 16; ++i)
+      {
+        minAlpha = std::min(minAlpha, block[i*4 + 3]);
+        maxAlpha = std::max(maxAlpha, block[i*4 + 3]);
+      }
+
+      uint64_t indecies = 0;
+      if (maxAlpha != minAlpha)
+      {
+        int palette[8];
+        palette[0] = maxAlpha;
+        palette[1] = minAlpha;
+        for (int p = 1; p < 7; ++p)
+        {
+          palette[p + 1] = ((7 - p)*maxAlpha + p*minAlpha)/7;
+        }
+
+        for (int i = 0; i < 16; ++i)
+        {
+          uint64_t best = 0;
+          int bestDist = 0x7FFFFFFF;
+          for (uint64_t p = 0; p < 8; ++p)
+          {
+            int dist = std::abs(block[i*4 + 3] - palette[p]);
+            if (dist < bestDist)
+            {
+              bestDist = dist;
+              best = p;
+            }
+          }
+          indecies |= best << (i*3);
+        }
+      }
+
+      output[0] = maxAlpha;
+      output[1] = minAlpha;
+      for (int i = 0; i < 6; ++i)
+      {
+        output[2 + i] = static_cast<uint8_t>((indecies >> (i*8)) & 0xFF);
+      }
+    }
+
+  } // namespace
+
+  void CompressBC1(const uint8_t* rgba, int width, int height, uint8_t* output)
+  {
+    uint8_t block[64];
+    for (int by = 0; by < (height + 3)/4; ++by)
+    {
+      for (int bx = 0; bx < (width + 3)/4; ++bx)
+      {
+        FetchBlock(rgba, width, height, bx, by, block);
+        CompressColorBlock(block, false, output);
+        output += 8;
+      }
+    }
+  }
+
+  void CompressBC3(const uint8_t* rgba, int width, int height, uint8_t* output)
+  {
+    uint8_t block[64];
+    for (int by = 0; by < (height + 3)/4; ++by)
+    {
+      for (int bx = 0; bx < (width + 3)/4; ++bx)
+      {
+        FetchBlock(rgba, width, height, bx, by, block);
+        CompressAlphaBlock(block, output);
+        CompressColorBlock(block, true, output + 8);
+        output += 16;
+      }
+    }
+  }
+
+} // namespace bb
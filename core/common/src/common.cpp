@@ -187,13 +187,25 @@ namespace bb
     "[ERR]"
   };
 
+  namespace
+  {
+    // trivially destructible, so it is still valid after logger_t died
+    thread_local bool loggerDied = false;
+
+    void WriteLine(FILE* output, logLevel_t level, const char* format, va_list vl)
+    {
+      fprintf(output, "%s %s\t", CurrentTime().c_str(), logText[level]);
+      vfprintf(output, format, vl);
+      fputc('\n', output);
+    }
+  }
+
   class logger_t
   {
 
-    friend void Debug(const char* format, ...);
-    friend void Info(const char* format, ...);
-    friend void Warning(const char* format, ...);
-    friend void Error(const char* format, ...);
+    // log file stays open, so log line costs no open/close
+    FILE* output;
+    std::string outputName;
 
     logger_t();
     logger_t(const logger_t&) = delete;
@@ -206,26 +218,35 @@ namespace bb
 
   public:
     static logger_t& Instance();
+
+    /**
+     * Static objects log from destructors after thread's logger died,
+     * such lines are written by reopening log file.
+     */
+    static void Write(logLevel_t level, const char* format, va_list vl);
   };
 
   logger_t::logger_t()
+  : output(nullptr),
+    outputName(GetThisThreadName())
   {
-    FILE* output = fopen((GetThisThreadName() + ".log").c_str(), "wt");
-    if (output != nullptr)
+    this->output = fopen((this->outputName + ".log").c_str(), "wt");
+    if (this->output != nullptr)
     {
-      BB_DEFER(fclose(output));
-      fprintf(output, "%s", "Log Started\n");
+      fprintf(this->output, "%s", "Log Started\n");
+      fflush(this->output);
     }
   }
 
   logger_t::~logger_t()
   {
-    FILE* output = fopen((GetThisThreadName() + ".log").c_str(), "at");
-    if (output != nullptr)
+    if (this->output != nullptr)
     {
-      BB_DEFER(fclose(output));
-      fprintf(output, "%s", "Log Ended\n");
+      fprintf(this->output, "%s", "Log Ended\n");
+      fclose(this->output);
+      this->output = nullptr;
     }
+    loggerDied = true;
   }
 
   logger_t& logger_t::Instance()
@@ -236,14 +257,41 @@ namespace bb
 
   void logger_t::Log(logLevel_t level, const char* format, va_list vl)
   {
+    const std::string& name = GetThisThreadName();
+    if (name != this->outputName)
+    { // thread renamed, after log started
+      if (this->output != nullptr)
+      {
+        fclose(this->output);
+      }
+      this->outputName = name;
+      this->output = fopen((this->outputName + ".log").c_str(), "at");
+    }
+
+    if (this->output != nullptr)
+    {
+      WriteLine(this->output, level, format, vl);
+      if (level >= LL_WARNING)
+      { // problems must not be lost, when process crashes, other
+        // lines are flushed by buffer overflow or on close
+        fflush(this->output);
+      }
+    }
+  }
+
+  void logger_t::Write(logLevel_t level, const char* format, va_list vl)
+  {
+    if (!loggerDied)
+    {
+      logger_t::Instance().Log(level, format, vl);
+      return;
+    }
+
     FILE* output = fopen((GetThisThreadName() + ".log").c_str(), "at");
     if (output != nullptr)
     {
       BB_DEFER(fclose(output));
-
-      fprintf(output, "%s %s\t", CurrentTime().c_str(), logText[level]);
-      vfprintf(output, format, vl);
-      fputc('\n', output);
+      WriteLine(output, level, format, vl);
     }
   }
 
@@ -251,7 +299,7 @@ namespace bb
   {
     va_list vl;
     va_start(vl, format);
-    logger_t::Instance().Log(LL_DEBUG, format, vl);
+    logger_t::Write(LL_DEBUG, format, vl);
     va_end(vl);
   }
 
@@ -259,7 +307,7 @@ namespace bb
   {
     va_list vl;
     va_start(vl, format);
-    logger_t::Instance().Log(LL_INFO, format, vl);
+    logger_t::Write(LL_INFO, format, vl);
     va_end(vl);
   }
 
@@ -267,7 +315,7 @@ namespace bb
   {
     va_list vl;
     va_start(vl, format);
-    logger_t::Instance().Log(LL_WARNING, format, vl);
+    logger_t::Write(LL_WARNING, format, vl);
     va_end(vl);
   }
 
@@ -275,7 +323,7 @@ namespace bb
   {
     va_list vl;
     va_start(vl, format);
-    logger_t::Instance().Log(LL_ERROR, format, vl);
+    logger_t::Write(LL_ERROR, format, vl);
     va_end(vl);
   }
 
@@ -104,6 +104,41 @@ namespace bb
       return monitor_t(-1, std::move(processor));
     }
 
+    bool watcher_t::IsGood() const
+    { // not implemented on this platform
+      return false;
+    }
+
+    int watcher_t::Watch(const std::string&)
+    {
+      return -1;
+    }
+
+    void watcher_t::Run()
+    {
+      ;
+    }
+
+    int watcher_t::ReadEvents(pending_t*)
+    {
+      return 0;
+    }
+
+    watcher_t::watcher_t(callback_t&& callback, std::chrono::milliseconds debounce)
+    : notify(-1),
+      poll(-1),
+      wakeup(-1),
+      callback(std::move(callback)),
+      debounce(debounce)
+    {
+      ;
+    }
+
+    watcher_t::~watcher_t()
+    {
+      ;
+    }
+
   } // namespace fs
 
 } // namespace bb
@@ -0,0 +1,117 @@
+#include <mappedFile.hpp>
+#include <common.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace bb
+{
+
+  mappedFile_t::mappedFile_t(const uint8_t* data, size_t size, intptr_t handle)
+  : data(data),
+    size(size),
+    handle(handle)
+  {
+    ;
+  }
+
+  mappedFile_t::mappedFile_t()
+  : data(nullptr),
+    size(0),
+    handle(-1)
+  {
+    ;
+  }
+
+  mappedFile_t::mappedFile_t(mappedFile_t&& move)
+  : data(move.data),
+    size(move.size),
+    handle(move.handle)
+  {
+    move.data = nullptr;
+    move.size = 0;
+    move.handle = -1;
+  }
+
+  mappedFile_t& mappedFile_t::operator=(mappedFile_t&& move)
+  {
+    if (this == &move)
+    {
+      return *this;
+    }
+
+    // old mapping is released with moved object
+    std::swap(this->data, move.data);
+    std::swap(this->size, move.size);
+    std::swap(this->handle, move.handle);
+    return *this;
+  }
+
+  mappedFile_t::~mappedFile_t()
+  {
+    if (this->data != nullptr)
+    {
+      munmap(const_cast<uint8_t*>(this->data), this->size);
+      this->data = nullptr;
+    }
+  }
+
+  void mappedFile_t::Sequential() const
+  {
+    if (this->data != nullptr)
+    {
+      madvise(const_cast<uint8_t*>(this->data), this->size, MADV_SEQUENTIAL);
+    }
+  }
+
+  void mappedFile_t::WillNeed() const
+  {
+    if (this->data != nullptr)
+    {
+      madvise(const_cast<uint8_t*>(this->data), this->size, MADV_WILLNEED);
+    }
+  }
+
+  mappedFile_t mappedFile_t::Open(const char* filename)
+  {
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1)
+    {
+      bb::Error("Can't open \"%s\": %s", filename, strerror(errno));
+      return mappedFile_t();
+    }
+    BB_DEFER(close(fd));
+
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+      bb::Error("Can't stat \"%s\": %s", filename, strerror(errno));
+      return mappedFile_t();
+    }
+
+    if (info.st_size <= 0)
+    {
+      bb::Error("Can't map empty file \"%s\"", filename);
+      return mappedFile_t();
+    }
+
+    auto size = static_cast<size_t>(info.st_size);
+
+    // mapping stays valid after descriptor is closed
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+    {
+      bb::Error("Can't map \"%s\": %s", filename, strerror(errno));
+      return mappedFile_t();
+    }
+
+    return mappedFile_t(reinterpret_cast<const uint8_t*>(data), size, -1);
+  }
+
+} // namespace bb
@@ -8,9 +8,13 @@
 #include <cstring>
 #include <climits>
 
+#include <algorithm>
+
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/inotify.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 
 namespace bb
 {
@@ -207,6 +211,276 @@ namespace bb
       return monitor_t(notifyHandle, std::move(processor));
     }
 
+    namespace
+    {
+
+      // editors write in place, or write new file and rename it over old one
+      const uint32_t watchMask = IN_MODIFY|IN_CLOSE_WRITE|IN_MOVED_TO;
+
+      void SplitPath(const std::string& filename, std::string* dir, std::string* name)
+      {
+        auto slash = filename.find_last_of('/');
+        if (slash == std::string::npos)
+        {
+          *dir = ".";
+          *name = filename;
+          return;
+        }
+        *dir = (slash == 0)?(std::string("/")):(filename.substr(0, slash));
+        *name = filename.substr(slash + 1);
+      }
+
+      void LogErrno(const char* what)
+      {
+        char buffer[1024];
+        char* text = strerror_r(errno, buffer, sizeof(buffer));
+        bb::Error("Error: %s failed \"%s\" (%d)", what, text, errno);
+      }
+
+    } // namespace
+
+    bool watcher_t::IsGood() const
+    {
+      return this->thread.joinable();
+    }
+
+    int watcher_t::Watch(const std::string& filename)
+    {
+      if (!this->IsGood())
+      { // Programmer's error!
+        assert(0);
+        return -1;
+      }
+
+      std::string dir;
+      std::string name;
+      SplitPath(filename, &dir, &name);
+      if (name.empty())
+      {
+        bb::Error("Can't watch \"%s\": not a file", filename.c_str());
+        return -1;
+      }
+
+      std::unique_lock<std::mutex> lock(this->guard);
+
+      // same directory gives same watch descriptor
+      int wd = inotify_add_watch(this->notify, dir.c_str(), watchMask);
+      if (wd == -1)
+      {
+        LogErrno("inotify_add_watch");
+        return -1;
+      }
+      this->dirs[wd] = dir;
+
+      auto& names = this->files[dir + "/" + name];
+      if (std::find(names.begin(), names.end(), filename) == names.end())
+      {
+        names.push_back(filename);
+      }
+      return 0;
+    }
+
+    int watcher_t::ReadEvents(pending_t* pending)
+    {
+      alignas(inotify_event) char notifyBuffer[4096];
+      static_assert(
+        sizeof(notifyBuffer) >= (sizeof(inotify_event) + NAME_MAX + 1),
+        "Documentation says - notify events buffer must be at least this size"
+      );
+
+      for (;;)
+      {
+        auto notifyLen = read(this->notify, notifyBuffer, sizeof(notifyBuffer));
+        if (notifyLen == -1)
+        {
+          if (errno == EAGAIN)
+          { // all events are read
+            return 0;
+          }
+          if (errno == EINTR)
+          {
+            continue;
+          }
+          LogErrno("inotify read");
+          return -1;
+        }
+
+        // timer restarts on each write, so burst gives one callback
+        auto deadline = watchClock_t::now() + this->debounce;
+
+        std::unique_lock<std::mutex> lock(this->guard);
+        for (char* cursor = notifyBuffer; cursor < notifyBuffer + notifyLen;)
+        {
+          auto event = reinterpret_cast<inotify_event*>(cursor);
+          cursor += sizeof(inotify_event) + event->len;
+
+          if ((event->mask & IN_Q_OVERFLOW) != 0)
+          {
+            bb::Warning("%s", "inotify queue overflow, some changes are lost");
+            continue;
+          }
+
+          if (((event->mask & watchMask) == 0) || (event->len == 0))
+          {
+            continue;
+          }
+
+          auto dir = this->dirs.find(event->wd);
+          if (dir == this->dirs.end())
+          {
+            continue;
+          }
+
+          auto names = this->files.find(dir->second + "/" + event->name);
+          if (names == this->files.end())
+          { // other file in same directory
+            continue;
+          }
+
+          for (auto& name: names->second)
+          {
+            (*pending)[name] = deadline;
+          }
+        }
+      }
+    }
+
+    void watcher_t::Run()
+    {
+      SetThisThreadName("fswatch");
+
+      pending_t pending;
+      std::vector<std::string> ready;
+      for (;;)
+      {
+        int timeout = -1;
+        if (!pending.empty())
+        {
+          auto now = watchClock_t::now();
+          auto first = pending.begin()->second;
+          for (auto& item: pending)
+          {
+            first = std::min(first, item.second);
+          }
+          timeout = (first <= now)?(0):(static_cast<int>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(first - now).count() + 1
+          ));
+        }
+
+        epoll_event events[2];
+        int count = epoll_wait(this->poll, events, 2, timeout);
+        if (count == -1)
+        {
+          if (errno == EINTR)
+          {
+            continue;
+          }
+          LogErrno("epoll_wait");
+          return;
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+          if (events[i].data.fd == this->wakeup)
+          { // watcher is destroyed
+            return;
+          }
+          if (this->ReadEvents(&pending) != 0)
+          {
+            return;
+          }
+        }
+
+        auto now = watchClock_t::now();
+        for (auto it = pending.begin(); it != pending.end();)
+        {
+          if (it->second <= now)
+          {
+            ready.push_back(it->first);
+            it = pending.erase(it);
+            continue;
+          }
+          ++it;
+        }
+
+        for (auto& filename: ready)
+        {
+          this->callback(filename);
+        }
+        ready.clear();
+      }
+    }
+
+    watcher_t::watcher_t(callback_t&& callback, std::chrono::milliseconds debounce)
+    : notify(-1),
+      poll(-1),
+      wakeup(-1),
+      callback(std::move(callback)),
+      debounce(debounce)
+    {
+      if (!this->callback)
+      { // Programmer's error!
+        assert(0);
+        return;
+      }
+
+      this->notify = inotify_init1(IN_NONBLOCK|IN_CLOEXEC);
+      if (this->notify == -1)
+      {
+        LogErrno("inotify_init1");
+        return;
+      }
+
+      this->wakeup = eventfd(0, EFD_NONBLOCK|EFD_CLOEXEC);
+      if (this->wakeup == -1)
+      {
+        LogErrno("eventfd");
+        return;
+      }
+
+      this->poll = epoll_create1(EPOLL_CLOEXEC);
+      if (this->poll == -1)
+      {
+        LogErrno("epoll_create1");
+        return;
+      }
+
+      for (auto fd: { this->notify, this->wakeup })
+      {
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(this->poll, EPOLL_CTL_ADD, fd, &event) == -1)
+        {
+          LogErrno("epoll_ctl");
+          return;
+        }
+      }
+
+      this->thread = std::thread(&watcher_t::Run, this);
+    }
+
+    watcher_t::~watcher_t()
+    {
+      if (this->thread.joinable())
+      {
+        uint64_t stop = 1;
+        if (write(this->wakeup, &stop, sizeof(stop)) != sizeof(stop))
+        {
+          LogErrno("eventfd write");
+        }
+        this->thread.join();
+      }
+
+      for (auto fd: { this->poll, this->wakeup, this->notify })
+      {
+        if (fd != -1)
+        {
+          close(fd);
+        }
+      }
+    }
+
   } // namespace fs
 
 } // namespace bb
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
 #include <cstdlib>
@@ -6,6 +7,7 @@
 
 #include <common.hpp>
 #include <image.hpp>
+#include <mappedFile.hpp>
 
 namespace
 {
@@ -84,90 +86,112 @@ namespace
     return (imtype & 0x8) == 0x8;
   }
 
-  void tgaRLEReadRGBA(uint8_t *data, const tgaHeader head, FILE *input)
+  // Pixel converters write RGBA, loops have no branches, so compiler vectorizes them
+
+  struct tgaRGBA_t
   {
-    uint8_t *cursor = data;
+    static const size_t size = 4;
 
-    while (cursor - data < static_cast<off_t>(head.is.width) * head.is.height * 4)
+    static void Convert(uint8_t *dst, const uint8_t *src, size_t count)
     {
-      int rc = fgetc(input);
-      if (rc == EOF)
+      for (size_t i = 0; i < count; ++i, dst += 4, src += 4)
       {
-        throw std::runtime_error("TGA: unexpected EOF (RGBA)");
+        dst[0] = src[2];
+        dst[1] = src[1];
+        dst[2] = src[0];
+        dst[3] = src[3];
       }
+    }
+  };
 
-      size_t pixCount = (rc & 0x7F) + 1;
+  struct tgaBW_t
+  {
+    static const size_t size = 2;
 
-      if ((rc & 0x80) != 0) // RLE-packet
+    static void Convert(uint8_t *dst, const uint8_t *src, size_t count)
+    {
+      for (size_t i = 0; i < count; ++i, dst += 4, src += 2)
       {
-        uint32_t copyPixel;
-        if (fread(&copyPixel, 4, 1, input) != 1)
-        {
-          throw std::runtime_error("TGA: fread RLE failed (RGBA)");
-        }
-        while (pixCount-- > 0)
-        {
-          memcpy(cursor, &copyPixel, sizeof(uint32_t));
-          cursor += 4;
-        }
+        dst[0] = src[0];
+        dst[1] = src[0];
+        dst[2] = src[0];
+        dst[3] = src[1];
       }
-      else // RAW-packet
+    }
+  };
+
+  // Short runs are stored texel by texel, long ones double already written
+  // part, so they take few memcpy calls
+  void tgaFill(uint8_t *dst, const uint8_t *pixel, size_t count)
+  {
+    const size_t shortRun = 16;
+    if (count < shortRun)
+    {
+      for (size_t i = 0; i < count; ++i)
       {
-        if (fread(cursor, 4, pixCount, input) != pixCount)
-        {
-          throw std::runtime_error("TGA: fread raw failed (RGBA)");
-        }
-        cursor += 4 * pixCount;
+        memcpy(dst + i * 4, pixel, 4);
       }
+      return;
+    }
+
+    size_t total = count * 4;
+    memcpy(dst, pixel, 4);
+    for (size_t done = 4; done < total; done *= 2)
+    {
+      memcpy(dst + done, dst, std::min(done, total - done));
     }
   }
 
-  void tgaRLEReadBW(uint8_t *data, const tgaHeader head, FILE *input)
+  template <typename format_t>
+  void tgaReadRaw(uint8_t *data, size_t pixels, const uint8_t *src, const uint8_t *end)
+  {
+    if (static_cast<size_t>(end - src) / format_t::size < pixels)
+    {
+      throw std::runtime_error("TGA: not enough pixel data");
+    }
+    format_t::Convert(data, src, pixels);
+  }
+
+  template <typename format_t>
+  void tgaReadRLE(uint8_t *data, size_t pixels, const uint8_t *src, const uint8_t *end)
   {
     uint8_t *cursor = data;
+    uint8_t *last = data + pixels * 4;
 
-    while (cursor - data < head.is.width * head.is.height * 4)
+    while (cursor != last)
     {
-      int rc = fgetc(input);
-      if (rc == EOF)
+      if (src == end)
       {
-        throw std::runtime_error("TGA: unexpected EOF (BW)");
+        throw std::runtime_error("TGA: unexpected end of RLE data");
       }
 
-      size_t pixCount = (rc & 0x7F) + 1;
+      size_t pixCount = static_cast<size_t>(*src & 0x7F) + 1;
+      bool isRLE = (*src & 0x80) != 0;
+      ++src;
 
-      if ((rc & 0x80) != 0) // RLE-packet
+      if (pixCount > static_cast<size_t>(last - cursor) / 4)
       {
-        uint8_t copyPixel[2];
-        if (fread(copyPixel, 2, 1, input) != 1)
-        {
-          throw std::runtime_error("TGA: fread RLE failed (BW)");
-        }
-        while (pixCount-- > 0)
-        {
-          cursor[0] = copyPixel[0];
-          cursor[1] = copyPixel[0];
-          cursor[2] = copyPixel[0];
-          cursor[3] = copyPixel[1];
-          cursor += 4;
-        }
+        throw std::runtime_error("TGA: RLE packet is out of image");
       }
-      else // RAW-packet
+
+      size_t packetSize = (isRLE) ? (format_t::size) : (format_t::size * pixCount);
+      if (static_cast<size_t>(end - src) < packetSize)
       {
-        while (pixCount-- > 0)
-        {
-          uint8_t copyPixel[2];
-          if (fread(copyPixel, 2, 1, input) != 1)
-          {
-            throw std::runtime_error("TGA: fread RAW failed (BW)");
-          }
-          cursor[0] = copyPixel[0];
-          cursor[1] = copyPixel[0];
-          cursor[2] = copyPixel[0];
-          cursor[3] = copyPixel[1];
-          cursor += 4;
-        }
+        throw std::runtime_error("TGA: unexpected end of RLE packet");
+      }
+
+      if (isRLE)
+      {
+        uint8_t pixel[4];
+        format_t::Convert(pixel, src, 1);
+        tgaFill(cursor, pixel, pixCount);
       }
+      else
+      {
+        format_t::Convert(cursor, src, pixCount);
+      }
+      src += packetSize;
+      cursor += pixCount * 4;
     }
   }
 
@@ -176,44 +200,23 @@ namespace
 namespace bb
 {
 
-  image_t LoadTGA(const std::string &filename)
+  image_t LoadTGA(const uint8_t *data, size_t size)
   {
-    FILE *input = fopen(filename.c_str(), "rb");
-    if (input == nullptr)
+    if (size < sizeof(tgaHeader) + sizeof(tgaFooter))
     {
-      throw std::runtime_error(std::string("TGA: image not found") + filename);
-    }
-    BB_DEFER(fclose(input));
-
-    if (fseek(input, -static_cast<long>(sizeof(tgaFooter)), SEEK_END) != 0)
-    {
-      throw std::runtime_error("TGA: fseek failed");
+      throw std::runtime_error("TGA: file is too small");
     }
 
     tgaFooter foot;
+    memcpy(&foot, data + size - sizeof(tgaFooter), sizeof(tgaFooter));
 
-    if (fread(&foot, sizeof(tgaFooter), 1, input) != 1)
-    {
-      throw std::runtime_error("TGA: fread failed");
-    }
-
-    if (strcmp(foot.sig, TGA_SIGNATURE) != 0)
+    if (memcmp(foot.sig, TGA_SIGNATURE, sizeof(TGA_SIGNATURE)) != 0)
     {
       throw std::runtime_error("TGA: invalid signature");
     }
 
-    clearerr(input);
-    if (fseek(input, 0, SEEK_SET) != 0)
-    {
-      throw std::runtime_error("TGA: fseek failed");
-    }
-
     tgaHeader head;
-
-    if (fread(&head, sizeof(tgaHeader), 1, input) != 1)
-    {
-      throw std::runtime_error("TGA: fread failed");
-    }
+    memcpy(&head, data, sizeof(tgaHeader));
 
     if (head.idlen != 0)
     {
@@ -255,45 +258,27 @@ namespace bb
         assert(0);
     }
 
+    size_t width = head.is.width;
+    size_t height = head.is.height;
+    size_t pixelCount = width * height;
+
     std::unique_ptr<uint8_t[]> pixels;
 
-    pixels.reset(new uint8_t[head.is.width * head.is.height * 4]); // always allocate full 32-bit image
+    pixels.reset(new uint8_t[pixelCount * 4]); // always allocate full 32-bit image
+
+    const uint8_t *src = data + sizeof(tgaHeader);
+    const uint8_t *end = data + size - sizeof(tgaFooter);
 
     if (!tgaIsRLE(head.imtype))
     {
       switch (colorMode)
       {
         case tgaColorMode_t::rgba:
-        {
-          size_t expectRead = head.is.width * head.is.height;
-          size_t totalRead = fread(
-            pixels.get(), 4, expectRead, input);
-          if (totalRead != expectRead)
-          {
-            throw std::runtime_error("TGA: not enough RGB data");
-          }
-        }
-        break;
+          tgaReadRaw<tgaRGBA_t>(pixels.get(), pixelCount, src, end);
+          break;
         case tgaColorMode_t::bw:
-        {
-          size_t expectRead = head.is.width * head.is.height;
-          uint8_t *cursor = pixels.get();
-          uint8_t tmpPixel[2];
-          while (expectRead-- > 0)
-          {
-            size_t totalRead = fread(tmpPixel, 2, 1, input);
-            if (totalRead != 1)
-            {
-              throw std::runtime_error("TGA: fread failed BW");
-            }
-            cursor[0] = tmpPixel[0];
-            cursor[1] = tmpPixel[0];
-            cursor[2] = tmpPixel[0];
-            cursor[3] = tmpPixel[1];
-            cursor += 4;
-          }
-        }
-        break;
+          tgaReadRaw<tgaBW_t>(pixels.get(), pixelCount, src, end);
+          break;
         default:
           // can't reach here.
           assert(0);
@@ -304,10 +289,10 @@ namespace bb
       switch (colorMode)
       {
         case tgaColorMode_t::rgba:
-          tgaRLEReadRGBA(pixels.get(), head, input);
+          tgaReadRLE<tgaRGBA_t>(pixels.get(), pixelCount, src, end);
           break;
         case tgaColorMode_t::bw:
-          tgaRLEReadBW(pixels.get(), head, input);
+          tgaReadRLE<tgaBW_t>(pixels.get(), pixelCount, src, end);
           break;
         default:
           // can't reach here.
@@ -315,33 +300,35 @@ namespace bb
       }
     }
 
-    auto bgra = pixels.get();
-
-    for (int index = 0; index < head.is.width * head.is.height; ++index)
-    {
-      uint8_t temp = bgra[index * 4];
-      bgra[index * 4] = bgra[index * 4 + 2];
-      bgra[index * 4 + 2] = temp;
-    }
-
     if (head.is.orig == 0)
     {
       // image origin in lower left corner
       // so loader must invert line order
       std::unique_ptr<uint8_t[]> tempLine;
-      tempLine.reset(new uint8_t[head.is.width * 4]);
+      tempLine.reset(new uint8_t[width * 4]);
 
-      size_t byteWidth = head.is.width * 4;
+      size_t byteWidth = width * 4;
 
-      for (uint32_t line = 0; line < static_cast<uint32_t>(head.is.height) / 2; ++line)
+      for (size_t line = 0; line < height / 2; ++line)
       {
         memcpy(tempLine.get(), pixels.get() + line * byteWidth, byteWidth);
-        memcpy(pixels.get() + line * byteWidth, pixels.get() + (head.is.height - line - 1) * byteWidth, byteWidth);
-        memcpy(pixels.get() + (head.is.height - line - 1) * byteWidth, tempLine.get(), byteWidth);
+        memcpy(pixels.get() + line * byteWidth, pixels.get() + (height - line - 1) * byteWidth, byteWidth);
+        memcpy(pixels.get() + (height - line - 1) * byteWidth, tempLine.get(), byteWidth);
       }
     }
 
     return bb::image_t(std::move(pixels), head.is.width, head.is.height, 4);
   }
 
+  image_t LoadTGA(const std::string &filename)
+  {
+    auto file = mappedFile_t::Open(filename.c_str());
+    if (!file.IsGood())
+    {
+      throw std::runtime_error(std::string("TGA: image not found ") + filename);
+    }
+    file.Sequential();
+    return LoadTGA(file.Data(), file.Size());
+  }
+
 } // namespace bb
@@ -0,0 +1,276 @@
+#include <textureFile.hpp>
+#include <blockCompress.hpp>
+#include <common.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+
+namespace bb
+{
+
+  namespace
+  {
+
+    const uint32_t TEXTURE_FILE_MAGIC = 0x78746262; // "bbtx"
+    const uint32_t TEXTURE_FILE_VERSION = 1;
+    const uint32_t TEXTURE_FILE_MAX_LEVELS = 32;
+    const size_t TEXTURE_LEVEL_ALIGN = 16;
+
+    struct textureFileHeader_t
+    {
+      uint32_t magic;
+      uint32_t version;
+      uint32_t format;
+      uint32_t width;
+      uint32_t height;
+      uint32_t levelCount;
+    };
+
+    struct textureFileLevel_t
+    {
+      uint32_t width;
+      uint32_t height;
+      uint64_t offset;
+      uint64_t size;
+    };
+
+    bool CheckFormat(uint32_t format)
+    {
+      switch (static_cast<textureFormat_t>(format))
+      {
+        case textureFormat_t::rgba8:
+        case textureFormat_t::bc1:
+        case textureFormat_t::bc3:
+          return true;
+        default:
+          return false;
+      }
+    }
+
+    size_t AlignLevel(size_t offset)
+    {
+      return (offset + TEXTURE_LEVEL_ALIGN - 1) & ~(TEXTURE_LEVEL_ALIGN - 1);
+    }
+
+    std::vector<uint8_t> EncodeLevel(const image_t& image, textureFormat_t format)
+    {
+      std::vector<uint8_t> result(TextureLevelSize(format, image.Width(), image.Height()));
+      switch (format)
+      {
+        case textureFormat_t::rgba8:
+          memcpy(result.data(), image.Data(), result.size());
+          break;
+        case textureFormat_t::bc1:
+          CompressBC1(image.Data(), image.Width(), image.Height(), result.data());
+          break;
+        case textureFormat_t::bc3:
+          CompressBC3(image.Data(), image.Width(), image.Height(), result.data());
+          break;
+      }
+      return result;
+    }
+
+  } // namespace
+
+  textureFile_t::textureFile_t()
+  : format(textureFormat_t::rgba8)
+  {
+    ;
+  }
+
+  size_t TextureLevelSize(textureFormat_t format, int width, int height)
+  {
+    auto w = static_cast<size_t>(width);
+    auto h = static_cast<size_t>(height);
+    switch (format)
+    {
+      case textureFormat_t::rgba8:
+        return w*h*4;
+      case textureFormat_t::bc1:
+        return ((w + 3)/4)*((h + 3)/4)*8;
+      case textureFormat_t::bc3:
+        return ((w + 3)/4)*((h + 3)/4)*16;
+      default:
+        // Programmer's error!
+        assert(0);
+        return 0;
+    }
+  }
+
+  image_t Downsample(const image_t& image)
+  {
+    assert(image.Depth() == 4);
+
+    int width = std::max(image.Width()/2, 1);
+    int height = std::max(image.Height()/2, 1);
+    auto srcWidth = static_cast<size_t>(image.Width());
+    auto src = image.Data();
+
+    std::unique_ptr<uint8_t[]> data(new uint8_t[static_cast<size_t>(width*height)*4]);
+    uint8_t* dst = data.get();
+    for (int y = 0; y < height; ++y)
+    {
+      auto y0 = static_cast<size_t>(std::min(y*2, image.Height() - 1));
+      auto y1 = static_cast<size_t>(std::min(y*2 + 1, image.Height() - 1));
+      for (int x = 0; x < width; ++x)
+      {
+        auto x0 = static_cast<size_t>(std::min(x*2, image.Width() - 1));
+        auto x1 = static_cast<size_t>(std::min(x*2 + 1, image.Width() - 1));
+        for (size_t c = 0; c < 4; ++c)
+        {
+          unsigned sum = 2u
+            + src[(y0*srcWidth + x0)*4 + c]
+            + src[(y0*srcWidth + x1)*4 + c]
+            + src[(y1*srcWidth + x0)*4 + c]
+            + src[(y1*srcWidth + x1)*4 + c];
+          *dst++ = static_cast<uint8_t>(sum/4);
+        }
+      }
+    }
+    return image_t(std::move(data), width, height, 4);
+  }
+
+  int SaveTexture(FILE* output, const image_t& image, textureFormat_t format, bool mipmaps)
+  {
+    if ((output == nullptr) || (image.Data() == nullptr) || (image.Depth() != 4))
+    {
+      // Programmer's error!
+      bb::Error("%s", "Can't save texture: RGBA image expected");
+      assert(0);
+      return -1;
+    }
+
+    std::vector<std::vector<uint8_t>> levelData;
+    std::vector<textureFileLevel_t> levels;
+
+    image_t level(image);
+    for (;;)
+    {
+      levelData.emplace_back(EncodeLevel(level, format));
+      levels.push_back(textureFileLevel_t{
+        static_cast<uint32_t>(level.Width()),
+        static_cast<uint32_t>(level.Height()),
+        0,
+        levelData.back().size()
+      });
+
+      if (!mipmaps || ((level.Width() == 1) && (level.Height() == 1)))
+      {
+        break;
+      }
+      level = Downsample(level);
+    }
+
+    size_t offset = sizeof(textureFileHeader_t) + sizeof(textureFileLevel_t)*levels.size();
+    for (auto& item: levels)
+    {
+      offset = AlignLevel(offset);
+      item.offset = offset;
+      offset += static_cast<size_t>(item.size);
+    }
+
+    textureFileHeader_t header;
+    header.magic = TEXTURE_FILE_MAGIC;
+    header.version = TEXTURE_FILE_VERSION;
+    header.format = static_cast<uint32_t>(format);
+    header.width = static_cast<uint32_t>(image.Width());
+    header.height = static_cast<uint32_t>(image.Height());
+    header.levelCount = static_cast<uint32_t>(levels.size());
+
+    if (
+         (fwrite(&header, sizeof(header), 1, output) != 1)
+      || (fwrite(levels.data(), sizeof(textureFileLevel_t), levels.size(), output) != levels.size())
+    )
+    {
+      bb::Error("%s", "Can't write texture header");
+      return -1;
+    }
+
+    const uint8_t padding[TEXTURE_LEVEL_ALIGN] = { 0 };
+    size_t written = sizeof(textureFileHeader_t) + sizeof(textureFileLevel_t)*levels.size();
+    for (size_t i = 0; i < levels.size(); ++i)
+    {
+      size_t padSize = static_cast<size_t>(levels[i].offset) - written;
+      if (
+           (fwrite(padding, 1, padSize, output) != padSize)
+        || (fwrite(levelData[i].data(), 1, levelData[i].size(), output) != levelData[i].size())
+      )
+      {
+        bb::Error("%s", "Can't write texture level");
+        return -1;
+      }
+      written += padSize + levelData[i].size();
+    }
+    return 0;
+  }
+
+  textureFile_t textureFile_t::Map(const char* filename)
+  {
+    auto file = std::make_shared<mappedFile_t>(mappedFile_t::Open(filename));
+    if (!file->IsGood())
+    {
+      bb::Error("Can't map texture \"%s\"", filename);
+      return textureFile_t();
+    }
+
+    textureFileHeader_t header;
+    if (file->Size() < sizeof(header))
+    {
+      bb::Error("Texture \"%s\" is too small", filename);
+      return textureFile_t();
+    }
+    memcpy(&header, file->Data(), sizeof(header));
+
+    if ((header.magic != TEXTURE_FILE_MAGIC) || (header.version != TEXTURE_FILE_VERSION))
+    {
+      bb::Error("Texture \"%s\" has invalid magic or version", filename);
+      return textureFile_t();
+    }
+
+    if (!CheckFormat(header.format) || (header.levelCount == 0) || (header.levelCount > TEXTURE_FILE_MAX_LEVELS))
+    {
+      bb::Error("Texture \"%s\" has invalid format (%u) or level count (%u)", filename, header.format, header.levelCount);
+      return textureFile_t();
+    }
+
+    if ((file->Size() - sizeof(header))/sizeof(textureFileLevel_t) < header.levelCount)
+    {
+      bb::Error("Texture \"%s\" level table is truncated", filename);
+      return textureFile_t();
+    }
+
+    textureFile_t result;
+    result.format = static_cast<textureFormat_t>(header.format);
+    result.levels.reserve(header.levelCount);
+    for (uint32_t i = 0; i < header.levelCount; ++i)
+    {
+      textureFileLevel_t level;
+      memcpy(&level, file->Data() + sizeof(header) + sizeof(level)*i, sizeof(level));
+
+      if (
+           (level.width == 0) || (level.height == 0)
+        || (level.width > static_cast<uint32_t>(std::numeric_limits<int>::max()))
+        || (level.height > static_cast<uint32_t>(std::numeric_limits<int>::max()))
+        || (level.size != TextureLevelSize(result.format, static_cast<int>(level.width), static_cast<int>(level.height)))
+        || (level.offset > file->Size())
+        || (level.size > file->Size() - level.offset)
+      )
+      {
+        bb::Error("Texture \"%s\" level %u is invalid", filename, i);
+        return textureFile_t();
+      }
+
+      result.levels.push_back(textureLevel_t{
+        static_cast<int>(level.width),
+        static_cast<int>(level.height),
+        file->Data() + level.offset,
+        static_cast<size_t>(level.size)
+      });
+    }
+    result.file = std::move(file);
+    return result;
+  }
+
+} // namespace bb
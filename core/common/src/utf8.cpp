@@ -4,6 +4,21 @@
 
 #include <utf8.hpp>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define BB_UTF8_SSE2
+#include <emmintrin.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define BB_UTF8_NEON
+#include <arm_neon.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 namespace
 {
 
@@ -40,6 +55,23 @@ namespace
     return result;
   }
 
+#ifdef BB_UTF8_SSE2
+  size_t FirstSetBit(uint32_t mask)
+  {
+#ifdef _MSC_VER
+    unsigned long result;
+    _BitScanForward(&result, mask);
+    return static_cast<size_t>(result);
+#else
+    return static_cast<size_t>(__builtin_ctz(mask));
+#endif
+  }
+#endif
+
+  bool IsTail(uint8_t octet)
+  {
+    return (octet & 0xC0) == 0x80;
+  }
 
 } // namespace
 
@@ -79,6 +111,138 @@ namespace bb
     return UTF8_ERROR;
   }
 
+  size_t utf8AsciiPrefix(const char* str, size_t size)
+  {
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(str);
+    size_t result = 0;
+
+#if defined(BB_UTF8_SSE2)
+#ifdef __AVX2__
+    while (result + 32 <= size)
+    {
+      auto chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + result));
+      auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(chunk));
+      if (mask != 0)
+      {
+        return result + FirstSetBit(mask);
+      }
+      result += 32;
+    }
+#endif
+    while (result + 16 <= size)
+    {
+      auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + result));
+      auto mask = static_cast<uint32_t>(_mm_movemask_epi8(chunk));
+      if (mask != 0)
+      {
+        return result + FirstSetBit(mask);
+      }
+      result += 16;
+    }
+#elif defined(BB_UTF8_NEON)
+    while (result + 16 <= size)
+    {
+      if (vmaxvq_u8(vld1q_u8(data + result)) >= 0x80)
+      { // exact position found below
+        break;
+      }
+      result += 16;
+    }
+#else
+    while (result + 8 <= size)
+    {
+      uint64_t word;
+      memcpy(&word, data + result, sizeof(word));
+      if ((word & 0x8080808080808080ull) != 0)
+      {
+        break;
+      }
+      result += 8;
+    }
+#endif
+
+    while ((result < size) && (data[result] < 0x80))
+    {
+      ++result;
+    }
+    return result;
+  }
+
+  bool utf8Decoder_t::NextSlow(uint32_t* smb)
+  {
+    if (this->cursor >= this->end)
+    {
+      return false;
+    }
+
+    uint32_t lead = *this->cursor;
+    if (lead < 0x80)
+    {
+      this->asciiEnd = this->cursor + utf8AsciiPrefix(
+        reinterpret_cast<const char*>(this->cursor),
+        static_cast<size_t>(this->end - this->cursor)
+      );
+      *smb = lead;
+      ++this->cursor;
+      return true;
+    }
+
+    size_t octets;
+    uint32_t result;
+    uint8_t minSecond = 0x80; // second octet range rejects overlong forms,
+    uint8_t maxSecond = 0xBF; // surrogates and symbols after U+10FFFF
+
+    if ((lead >= 0xC2) && (lead <= 0xDF))
+    {
+      octets = 2;
+      result = lead & 0x1F;
+    }
+    else if ((lead >= 0xE0) && (lead <= 0xEF))
+    {
+      octets = 3;
+      result = lead & 0x0F;
+      minSecond = (lead == 0xE0)?(0xA0):(0x80);
+      maxSecond = (lead == 0xED)?(0x9F):(0xBF);
+    }
+    else if ((lead >= 0xF0) && (lead <= 0xF4))
+    {
+      octets = 4;
+      result = lead & 0x07;
+      minSecond = (lead == 0xF0)?(0x90):(0x80);
+      maxSecond = (lead == 0xF4)?(0x8F):(0xBF);
+    }
+    else
+    {
+      this->good = false;
+      this->cursor = this->end;
+      return false;
+    }
+
+    if ((static_cast<size_t>(this->end - this->cursor) < octets)
+      || (this->cursor[1] < minSecond)
+      || (this->cursor[1] > maxSecond))
+    {
+      this->good = false;
+      this->cursor = this->end;
+      return false;
+    }
+
+    for (size_t i = 1; i < octets; ++i)
+    {
+      if (!IsTail(this->cursor[i]))
+      {
+        this->good = false;
+        this->cursor = this->end;
+        return false;
+      }
+      result = (result << 6) | (this->cursor[i] & 0x3F);
+    }
+
+    this->cursor += octets;
+    *smb = result;
+    return true;
+  }
+
   uint32_t utf8GetOctet(const char* str)
   {
     return utf8Octet(str, utf8SymbolLength(str[0]));
@@ -86,38 +250,34 @@ namespace bb
 
   size_t utf8len(const char* str)
   {
-    const char* cursor = str;
+    utf8Decoder_t decoder(str);
     size_t result = 0;
-    while(*cursor != 0)
+    uint32_t smb;
+    while (decoder.Next(&smb))
     {
-      int len = utf8SymbolLength(*cursor);
-      if (len <= 0)
-      { // hit non utf8 character
-        assert(0);
-        return result;
-      }
-      cursor += len;
       ++result;
     }
+    // hit non utf8 character
+    assert(decoder.IsGood());
     return result;
   }
 
   utf8Symbols utf8extract(const char* str)
   {
     utf8Symbols result;
-    const char* cursor = str;
-    result.reserve(utf8len(str));
+    size_t size = strlen(str);
+    result.reserve(size);
 
-    while(*cursor != 0)
+    utf8Decoder_t decoder(str, size);
+    uint32_t smb;
+    while (decoder.Next(&smb))
     {
-      int octets = utf8SymbolLength(*cursor);
-      if (octets <= 0)
-      {
-        throw std::runtime_error("Non-UTF8 string");
-      }
+      result.push_back(smb);
+    }
 
-      result.push_back(utf8Octet(cursor, octets));
-      cursor += octets;
+    if (!decoder.IsGood())
+    {
+      throw std::runtime_error("Non-UTF8 string");
     }
     return result;
   }
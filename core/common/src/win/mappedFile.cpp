@@ -0,0 +1,123 @@
+#include <mappedFile.hpp>
+#include <common.hpp>
+
+#include <utility>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+namespace bb
+{
+
+  mappedFile_t::mappedFile_t(const uint8_t* data, size_t size, intptr_t handle)
+  : data(data),
+    size(size),
+    handle(handle)
+  {
+    ;
+  }
+
+  mappedFile_t::mappedFile_t()
+  : data(nullptr),
+    size(0),
+    handle(0)
+  {
+    ;
+  }
+
+  mappedFile_t::mappedFile_t(mappedFile_t&& move)
+  : data(move.data),
+    size(move.size),
+    handle(move.handle)
+  {
+    move.data = nullptr;
+    move.size = 0;
+    move.handle = 0;
+  }
+
+  mappedFile_t& mappedFile_t::operator=(mappedFile_t&& move)
+  {
+    if (this == &move)
+    {
+      return *this;
+    }
+
+    // old mapping is released with moved object
+    std::swap(this->data, move.data);
+    std::swap(this->size, move.size);
+    std::swap(this->handle, move.handle);
+    return *this;
+  }
+
+  mappedFile_t::~mappedFile_t()
+  {
+    if (this->data != nullptr)
+    {
+      UnmapViewOfFile(this->data);
+      this->data = nullptr;
+    }
+    if (this->handle != 0)
+    {
+      CloseHandle(reinterpret_cast<HANDLE>(this->handle));
+      this->handle = 0;
+    }
+  }
+
+  void mappedFile_t::Sequential() const
+  {
+    ;
+  }
+
+  void mappedFile_t::WillNeed() const
+  {
+    ;
+  }
+
+  mappedFile_t mappedFile_t::Open(const char* filename)
+  {
+    HANDLE file = CreateFileA(
+      filename,
+      GENERIC_READ,
+      FILE_SHARE_READ,
+      nullptr,
+      OPEN_EXISTING,
+      FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+      nullptr
+    );
+    if (file == INVALID_HANDLE_VALUE)
+    {
+      bb::Error("Can't open \"%s\" (%lu)", filename, GetLastError());
+      return mappedFile_t();
+    }
+    BB_DEFER(CloseHandle(file));
+
+    LARGE_INTEGER fileSize;
+    if ((GetFileSizeEx(file, &fileSize) == FALSE) || (fileSize.QuadPart <= 0))
+    {
+      bb::Error("Can't map empty file \"%s\"", filename);
+      return mappedFile_t();
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+    {
+      bb::Error("Can't map \"%s\" (%lu)", filename, GetLastError());
+      return mappedFile_t();
+    }
+
+    auto data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == nullptr)
+    {
+      bb::Error("Can't map \"%s\" (%lu)", filename, GetLastError());
+      CloseHandle(mapping);
+      return mappedFile_t();
+    }
+
+    return mappedFile_t(
+      reinterpret_cast<const uint8_t*>(data),
+      static_cast<size_t>(fileSize.QuadPart),
+      reinterpret_cast<intptr_t>(mapping)
+    );
+  }
+
+} // namespace bb
@@ -1,8 +1,8 @@
 /**
  * @file config.hpp
- * 
+ *
  * Simple text config file routines
- * 
+ *
  */
 
 #pragma once
@@ -12,73 +12,199 @@
 #include <value.hpp>
 #include <common.hpp>
 
-#include <unordered_map>
+#include <cstdint>
+#include <vector>
 
 namespace bb
 {
 
+  /**
+   * Interned config key.
+   *
+   * Key names are interned process wide, so handle resolved once can be used
+   * with any config and lookups with it do not hash strings.
+   *
+   * @code
+   * static const bb::configKey_t fullAhead("engine.full_ahead");
+   * auto output = config.Value(fullAhead, 0.5);
+   * @endcode
+   */
+  class configKey_t final
+  {
+    uint32_t id;
+
+  public:
+
+    uint32_t Id() const;
+
+    /**
+     * Full dotted key name.
+     */
+    const std::string& Name() const;
+
+    bool operator == (const configKey_t& rhs) const;
+    bool operator != (const configKey_t& rhs) const;
+
+    explicit configKey_t(const std::string& name);
+    explicit configKey_t(const char* name);
+
+    /**
+     * Find already interned key.
+     *
+     * @return false, when no config ever had this key
+     */
+    static bool Find(const std::string& name, configKey_t* key);
+  };
+
+  inline uint32_t configKey_t::Id() const
+  {
+    return this->id;
+  }
+
+  inline bool configKey_t::operator == (const configKey_t& rhs) const
+  {
+    return this->id == rhs.id;
+  }
+
+  inline bool configKey_t::operator != (const configKey_t& rhs) const
+  {
+    return this->id != rhs.id;
+  }
+
   class config_t final
   {
-    using dict_t = std::unordered_map<std::string, ref_t>;
+    /**
+     * Open addressed table slot, values are stored in place.
+     */
+    struct slot_t
+    {
+      uint32_t key;
+      ref_t value;
+    };
 
-    dict_t dict;
+    std::vector<slot_t> slots;
+    size_t used;
 
     config_t(const config_t&) = delete;
     config_t& operator=(const config_t&) = delete;
 
-    std::string ParseString(const std::string& line, const std::string& context);
+    const ref_t* Find(uint32_t key) const;
+    ref_t& Insert(uint32_t key);
+    void Grow();
+
+    const ref_t* Find(const std::string& key) const;
+
+    /**
+     * Parse config text in one pass.
+     *
+     * @param text config text, need not be zero terminated
+     * @param size text size in bytes
+     */
+    void Parse(const char* text, size_t size);
 
   public:
 
     void Load(const std::string& filename);
 
+    /**
+     * Save all values, sorted by key.
+     */
     void Save(const std::string& filename) const;
 
+    /**
+     * Number of stored keys.
+     */
+    size_t Size() const;
+
+    /**
+     * Deep copy. Config is move only, so copies are never made by accident.
+     */
+    config_t Copy() const;
+
+    /**
+     * Get value to assign, it is created, when not found.
+     *
+     * Reference is valid until next key is added.
+     */
+    ref_t& operator [] (const configKey_t& key);
+
     ref_t& operator [] (const std::string& key)
     {
-      return this->dict[key];
+      return this->operator[](configKey_t(key));
+    }
+
+    const ref_t& operator [] (const configKey_t& key) const
+    {
+      auto result = this->Find(key.Id());
+      if (result == nullptr)
+      {
+        throw std::runtime_error(std::string("Key '") + key.Name() + std::string("' not found"));
+      }
+      return *result;
     }
 
     const ref_t& operator [] (const std::string& key) const
     {
-      auto it = this->dict.find(key);
-      if (it == this->dict.end())
+      auto result = this->Find(key);
+      if (result == nullptr)
       {
         throw std::runtime_error(std::string("Key '") + key + std::string("' not found"));
       }
-      return it->second;
+      return *result;
+    }
+
+    double Value(const configKey_t& key, double defaultVal) const
+    {
+      auto result = this->Find(key.Id());
+      if ((result == nullptr) || (result->Type() != type_t::number))
+      {
+        bb::Debug("\"%s\" is not found in config or has invalid type (defaults to %f)", key.Name().c_str(), defaultVal);
+        return defaultVal;
+      }
+      return result->Number();
+    }
+
+    const std::string& Value(const configKey_t& key, const std::string& defaultVal) const
+    {
+      auto result = this->Find(key.Id());
+      if ((result == nullptr) || (result->Type() != type_t::string))
+      {
+        bb::Debug("\"%s\" is not found in config or has invalid type (defaults to %s)", key.Name().c_str(), defaultVal.c_str());
+        return defaultVal;
+      }
+      return result->String();
     }
 
     double Value(const std::string& key, double defaultVal) const
     {
-      auto it = this->dict.find(key);
-      if (it == this->dict.end())
+      auto result = this->Find(key);
+      if (result == nullptr)
       {
         bb::Debug("\"%s\" is not found in config (defaults to %f)", key.c_str(), defaultVal);
         return defaultVal;
       }
-      if (it->second.Type() != type_t::number)
+      if (result->Type() != type_t::number)
       {
         bb::Debug("\"%s\" has invalid type (defaults to %f)", key.c_str(), defaultVal);
         return defaultVal;
       }
-      return it->second.Number();
+      return result->Number();
     }
 
     const std::string& Value(const std::string& key, const std::string& defaultVal) const
     {
-      auto it = this->dict.find(key);
-      if (it == this->dict.end())
+      auto result = this->Find(key);
+      if (result == nullptr)
       {
         bb::Debug("\"%s\" is not found in config (defaults to %s)", key.c_str(), defaultVal.c_str());
         return defaultVal;
       }
-      if (it->second.Type() != type_t::string)
+      if (result->Type() != type_t::string)
       {
         bb::Debug("\"%s\" has invalid type (defaults to %s)", key.c_str(), defaultVal.c_str());
         return defaultVal;
       }
-      return it->second.String();
+      return result->String();
     }
 
     config_t(config_t&&);
@@ -89,6 +215,11 @@ namespace bb
     ~config_t();
   };
 
+  inline size_t config_t::Size() const
+  {
+    return this->used;
+  }
+
 } // namespace bb
 
-#endif /* __BB_COMMON_CONFIG_HEADER__ */
\ No newline at end of file
+#endif /* __BB_COMMON_CONFIG_HEADER__ */
@@ -1,7 +1,7 @@
 /**
  * @file value.hpp
  * 
- * Simple abstract value wrapper.
+ * Simple tagged value wrapper.
  * 
  */
 
@@ -12,6 +12,7 @@
 #include <unordered_map>
 #include <memory>
 #include <string>
+#include <typeinfo>
 
 namespace bb
 {
@@ -23,87 +24,60 @@ namespace bb
     string
   };
 
-  class value_t
-  {
-
-    value_t(const value_t&) = delete;
-    value_t& operator =(const value_t&) = delete;
-    value_t(value_t&&) = delete;
-    value_t& operator =(value_t&&) = delete;
-
-  public:
-
-    /**
-     * Converts embeded value to string in format, which can be easily parsed
-     * back with config parser - e.g strings puts " symbols around text, and
-     * numbers do not.
-     */
-    virtual std::string ToString() const = 0;
-
-    /**
-     * Convert embeded value to simple raw strings.
-     */
-    virtual std::string AsString() const = 0;
-
-    virtual bool operator == (const value_t& rhs) = 0;
-    virtual type_t Type() const = 0;
-    virtual double Number() const = 0;
-    virtual const std::string& String() const = 0;
-
-    value_t();
-    virtual ~value_t() = 0;
-
-  };
-
+  /**
+   * Number or string value.
+   *
+   * Value is stored inline with type tag, so numbers never allocate.
+   */
   class ref_t
   {
-    std::unique_ptr<value_t> val;
+    type_t type;
+    double number;
+    std::string string;
 
     ref_t(const ref_t&) = delete;
     ref_t& operator=(const ref_t&) = delete;
 
-    ref_t(std::unique_ptr<value_t>&& val);
-
   public:
 
     type_t Type() const
     {
-      if (this->val)
-      {
-        return this->val->Type();
-      }
-      return type_t::none;
+      return this->type;
     }
 
-    std::string AsString() const
-    {
-      if (this->val)
-      {
-        return this->val->AsString();
-      }
-      return std::string("none");
-    }
+    /**
+     * Convert embeded value to simple raw strings.
+     */
+    std::string AsString() const;
 
-    std::string ToString() const
-    {
-      if (this->val)
-      {
-        return this->val->ToString();
-      }
-      return std::string("none");
-    }
+    /**
+     * Converts embeded value to string in format, which can be easily parsed
+     * back with config parser - e.g strings puts " symbols around text, and
+     * numbers do not.
+     */
+    std::string ToString() const;
 
     double Number() const
     {
-      return this->val->Number();
+      if (this->type != type_t::number)
+      {
+        throw std::bad_cast();
+      }
+      return this->number;
     }
 
     const std::string& String() const
     {
-      return this->val->String();
+      if (this->type != type_t::string)
+      {
+        throw std::bad_cast();
+      }
+      return this->string;
     }
 
     ref_t()
+    : type(type_t::none),
+      number(0.0)
     {
       ;
     }
@@ -114,21 +88,27 @@ namespace bb
     }
 
     ref_t(ref_t&& move) noexcept
-    :val(std::move(move.val))
+    : type(move.type),
+      number(move.number),
+      string(std::move(move.string))
     {
       ;
     }
 
-    bool operator == (const ref_t& ref)
+    bool operator == (const ref_t& ref) const
     {
-      if ((this->Type() == type_t::none) || (ref.Type() == type_t::none))
+      if ((this->type == type_t::none) || (this->type != ref.type))
       {
         return false;
       }
-      return this->val->operator==(*ref.val);
+      if (this->type == type_t::number)
+      {
+        return this->number == ref.number;
+      }
+      return this->string == ref.string;
     }
 
-    bool operator != (const ref_t& ref)
+    bool operator != (const ref_t& ref) const
     {
       return !this->operator==(ref);
     }
@@ -139,12 +119,15 @@ namespace bb
       {
         return *this;
       }
-      this->val = std::move(move.val);
+      this->type = move.type;
+      this->number = move.number;
+      this->string = std::move(move.string);
       return *this;
     }
 
     static ref_t Number(double value);
     static ref_t String(const std::string& value);
+    static ref_t String(std::string&& value);
 
   };
 
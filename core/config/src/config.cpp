@@ -1,222 +1,641 @@
 #include <fstream>
-#include <type_traits>
 #include <clocale>
+#include <cctype>
+#include <cstdlib>
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __APPLE__
+#include <xlocale.h>
+#endif /* __APPLE__ */
 
 #include <common.hpp>
 #include <config.hpp>
 
-extern "C"
+namespace bb
 {
-#include <token.h>
-#include <config.lex.h>
 
-#if _WIN32
+  namespace
+  {
+
+#ifdef _WIN32
+    using cLocale_t = _locale_t;
+#else
+    using cLocale_t = locale_t;
+#endif
+
+    /**
+     * Standard C locale, so numbers are parsed same way with any user locale.
+     *
+     * Created once on first use.
+     */
+    class cLocaleHolder_t final
+    {
+      cLocale_t locale;
+
+      cLocaleHolder_t(const cLocaleHolder_t&) = delete;
+      cLocaleHolder_t& operator=(const cLocaleHolder_t&) = delete;
+
+      cLocaleHolder_t()
+      {
+#ifdef _WIN32
+        this->locale = _create_locale(LC_ALL, "C");
+#else
+        this->locale = newlocale(LC_ALL_MASK, "C", nullptr);
+#endif
+        if (this->locale == ((cLocale_t)0))
+        {
+          throw std::runtime_error("Can't initialize locale");
+        }
+      }
+
+      ~cLocaleHolder_t()
+      {
+#ifdef _WIN32
+        _free_locale(this->locale);
+#else
+        freelocale(this->locale);
+#endif
+      }
+
+    public:
+
+      static double StrToD(const char* text)
+      {
+        static cLocaleHolder_t self;
+#ifdef _WIN32
+        return _strtod_l(text, nullptr, self.locale);
+#else
+        return strtod_l(text, nullptr, self.locale);
+#endif
+      }
+
+    };
+
+    enum class token_t
+    {
+      string,
+      number,
+      set,
+      start,
+      finish,
+      end
+    };
+
+    /**
+     * Config tokenizer over whole file text.
+     *
+     * String tokens point into scanned text, nothing is copied until key or
+     * value is stored.
+     */
+    class scanner_t final
+    {
+      const char* cursor;
+      const char* finish;
+      size_t line;
+
+      const char* text;
+      size_t textSize;
+      double number;
+
+      std::string numberText;
+
+      static bool IsDigit(char ch)
+      {
+        return (ch >= '0') && (ch <= '9');
+      }
+
+      const char* SkipDigits(const char* pos) const
+      {
+        while ((pos != this->finish) && IsDigit(*pos))
+        {
+          ++pos;
+        }
+        return pos;
+      }
+
+      /**
+       * Matches [-]*{D}+{E}?, [-]*{D}*"."{D}+{E}? and [-]*{D}+"."{D}*{E}?
+       *
+       * @return token end, or nullptr if no number starts at cursor
+       */
+      const char* MatchNumber() const
+      {
+        auto pos = this->cursor;
+        while ((pos != this->finish) && (*pos == '-'))
+        {
+          ++pos;
+        }
+
+        auto intEnd = this->SkipDigits(pos);
+        bool hasDigits = (intEnd != pos);
+        pos = intEnd;
+
+        if ((pos != this->finish) && (*pos == '.'))
+        {
+          auto fracEnd = this->SkipDigits(pos + 1);
+          if (hasDigits || (fracEnd != pos + 1))
+          {
+            hasDigits = true;
+            pos = fracEnd;
+          }
+        }
+
+        if (!hasDigits)
+        {
+          return nullptr;
+        }
+
+        if ((pos != this->finish) && ((*pos == 'e') || (*pos == 'E')))
+        { // exponent is a part of number only with digits
+          auto expPos = pos + 1;
+          if ((expPos != this->finish) && ((*expPos == '+') || (*expPos == '-')))
+          {
+            ++expPos;
+          }
+          auto expEnd = this->SkipDigits(expPos);
+          if (expEnd != expPos)
+          {
+            pos = expEnd;
+          }
+        }
+        return pos;
+      }
+
+    public:
+
+      token_t Next()
+      {
+        while ((this->cursor != this->finish) && isspace(static_cast<unsigned char>(*this->cursor)))
+        {
+          this->line += (*this->cursor == '\n')?(1):(0);
+          ++this->cursor;
+        }
+
+        if (this->cursor == this->finish)
+        {
+          return token_t::end;
+        }
+
+        switch (*this->cursor)
+        {
+        case ':':
+          ++this->cursor;
+          return token_t::set;
+        case '{':
+          ++this->cursor;
+          return token_t::start;
+        case '}':
+          ++this->cursor;
+          return token_t::finish;
+        case '\"':
+          {
+            auto start = this->cursor + 1;
+            auto pos = start;
+            while ((pos != this->finish) && (*pos != '\"'))
+            {
+              this->line += (*pos == '\n')?(1):(0);
+              ++pos;
+            }
+            if (pos == this->finish)
+            {
+              bb::Error("Line " BBsize_t ": string is not terminated", this->line);
+              throw std::runtime_error("Invalid configuration line");
+            }
+            this->text = start;
+            this->textSize = static_cast<size_t>(pos - start);
+            this->cursor = pos + 1;
+          }
+          return token_t::string;
+        default:
+          break;
+        }
+
+        auto numberEnd = this->MatchNumber();
+        if (numberEnd == nullptr)
+        {
+          auto ch = static_cast<unsigned char>(*this->cursor);
+          if (isprint(ch) != 0)
+          {
+            bb::Error("Line " BBsize_t ": invalid character '%c'", this->line, ch);
+          }
+          else
+          {
+            bb::Error("Line " BBsize_t ": invalid character <%02X>", this->line, ch);
+          }
+          throw std::runtime_error("Invalid configuration line");
+        }
+
+        // text is not zero terminated, strtod needs a copy
+        this->numberText.assign(this->cursor, numberEnd);
+        this->number = cLocaleHolder_t::StrToD(this->numberText.c_str());
+        this->cursor = numberEnd;
+        return token_t::number;
+      }
+
+      const char* Text() const
+      {
+        return this->text;
+      }
+
+      size_t TextSize() const
+      {
+        return this->textSize;
+      }
+
+      double Number() const
+      {
+        return this->number;
+      }
+
+      size_t Line() const
+      {
+        return this->line;
+      }
+
+      scanner_t(const char* text, size_t size)
+      : cursor(text),
+        finish(text + size),
+        line(1),
+        text(nullptr),
+        textSize(0),
+        number(0.0)
+      {
+        ;
+      }
+
+    };
+
+    void ThrowTokenError(const scanner_t& scanner, const char* expected)
+    {
+      bb::Error("Line " BBsize_t ": %s expected", scanner.Line(), expected);
+      throw std::runtime_error("Invalid configuration line");
+    }
+
+    /**
+     * Process wide key names, ids are never reused.
+     */
+    class keyTable_t final
+    {
+      std::mutex lock;
+      std::unordered_map<std::string, uint32_t> ids;
+      std::vector<const std::string*> names;
+
+      keyTable_t() = default;
+      keyTable_t(const keyTable_t&) = delete;
+      keyTable_t& operator=(const keyTable_t&) = delete;
+
+    public:
+
+      uint32_t Intern(const std::string& name)
+      {
+        std::lock_guard<std::mutex> guard(this->lock);
+        auto inserted = this->ids.emplace(name, static_cast<uint32_t>(this->names.size()));
+        if (inserted.second)
+        { // map nodes never move, so name pointer stays valid
+          this->names.push_back(&inserted.first->first);
+        }
+        return inserted.first->second;
+      }
+
+      bool Find(const std::string& name, uint32_t* id)
+      {
+        std::lock_guard<std::mutex> guard(this->lock);
+        auto it = this->ids.find(name);
+        if (it == this->ids.end())
+        {
+          return false;
+        }
+        *id = it->second;
+        return true;
+      }
+
+      const std::string& Name(uint32_t id)
+      {
+        std::lock_guard<std::mutex> guard(this->lock);
+        return *this->names.at(id);
+      }
+
+      static keyTable_t& Instance()
+      {
+        static keyTable_t self;
+        return self;
+      }
+
+    };
+
+    const uint32_t emptySlot = 0xFFFFFFFF;
+    const size_t minSlots = 16;
 
-  locale_t clocale()
+    size_t SlotHash(uint32_t key)
+    {
+      uint32_t result = key*0x9E3779B1u;
+      return static_cast<size_t>(result ^ (result >> 16));
+    }
+
+  } // namespace
+
+  configKey_t::configKey_t(const std::string& name)
+  : id(keyTable_t::Instance().Intern(name))
   {
-    return _create_locale(LC_ALL, "C");
+    ;
   }
 
-  void freelocale(locale_t locale)
+  configKey_t::configKey_t(const char* name)
+  : id(keyTable_t::Instance().Intern(std::string(name)))
   {
-    _free_locale(locale);
+    ;
   }
 
-  double strtod_l(const char* strSource, char** endptr, locale_t locale)
+  const std::string& configKey_t::Name() const
   {
-    return _strtod_l(strSource, endptr, locale);
+    return keyTable_t::Instance().Name(this->id);
   }
-  
-#else
-  
-  locale_t clocale()
+
+  bool configKey_t::Find(const std::string& name, configKey_t* key)
   {
-    return newlocale(LC_ALL_MASK, "C", nullptr);
+    uint32_t id;
+    if (!keyTable_t::Instance().Find(name, &id))
+    {
+      return false;
+    }
+    key->id = id;
+    return true;
   }
- 
-#endif
-  
 
-}
+  const ref_t* config_t::Find(uint32_t key) const
+  {
+    if (this->slots.empty())
+    {
+      return nullptr;
+    }
 
-namespace bb
-{
+    const size_t mask = this->slots.size() - 1;
+    for (size_t index = SlotHash(key) & mask; ; index = (index + 1) & mask)
+    {
+      auto& slot = this->slots[index];
+      if (slot.key == key)
+      {
+        return &slot.value;
+      }
+      if (slot.key == emptySlot)
+      {
+        return nullptr;
+      }
+    }
+  }
 
-  config_t::config_t(config_t&& move)
-  :dict(std::move(move.dict))
+  const ref_t* config_t::Find(const std::string& key) const
   {
-    ;
+    uint32_t id;
+    if (!keyTable_t::Instance().Find(key, &id))
+    {
+      return nullptr;
+    }
+    return this->Find(id);
   }
 
-  config_t& config_t::operator=(config_t&& move)
+  void config_t::Grow()
   {
-    if (this == &move)
+    std::vector<slot_t> old(std::max(this->slots.size()*2, minSlots));
+    for (auto& slot: old)
     {
-      return *this;
+      slot.key = emptySlot;
     }
+    old.swap(this->slots);
 
-    this->dict = std::move(move.dict);
-    return *this;
+    const size_t mask = this->slots.size() - 1;
+    for (auto& item: old)
+    {
+      if (item.key == emptySlot)
+      {
+        continue;
+      }
+      size_t index = SlotHash(item.key) & mask;
+      while (this->slots[index].key != emptySlot)
+      {
+        index = (index + 1) & mask;
+      }
+      this->slots[index].key = item.key;
+      this->slots[index].value = std::move(item.value);
+    }
   }
 
-  config_t::config_t()
+  ref_t& config_t::Insert(uint32_t key)
   {
-    ;
-  }
+    // table is kept at most half full, so probes are short
+    if ((this->used + 1)*2 > this->slots.size())
+    {
+      this->Grow();
+    }
 
-  config_t::config_t(const std::string& filename)
-  {
-    this->Load(filename);
+    const size_t mask = this->slots.size() - 1;
+    size_t index = SlotHash(key) & mask;
+    for (; this->slots[index].key != emptySlot; index = (index + 1) & mask)
+    {
+      if (this->slots[index].key == key)
+      {
+        return this->slots[index].value;
+      }
+    }
+
+    ++this->used;
+    this->slots[index].key = key;
+    return this->slots[index].value;
   }
 
-  config_t::~config_t()
+  ref_t& config_t::operator [] (const configKey_t& key)
   {
-    ;
+    return this->Insert(key.Id());
   }
 
-  static void ThrowTokenError(int token, const bbCoreConfigTokenData_t& tokenData)
+  config_t::config_t(config_t&& move)
+  : slots(std::move(move.slots)),
+    used(move.used)
   {
-    switch (tokenData.type)
-    {
-    case BB_STRING:
-      bb::Error("Unexpected token: %d (\"%s\")", token, tokenData.str);
-      break;
-    case BB_NUMBER:
-      bb::Error("Unexpected token: %d (\"%e\")", token, tokenData.num);
-      break;
-    default:
-      break;
-    }
-    throw std::runtime_error("Invalid configuration line");
+    move.slots.clear();
+    move.used = 0;
   }
 
-  std::string config_t::ParseString(const std::string& line, const std::string& context)
+  config_t& config_t::operator=(config_t&& move)
   {
-    if (line.empty())
+    if (this == &move)
     {
-      return context;
+      return *this;
     }
 
-    locale_t cLocale = clocale();
-    if (cLocale == ((locale_t)0))
-    {
-      throw std::runtime_error("Can't initialize locale");
-    }
-    BB_DEFER(freelocale(cLocale));
+    this->slots = std::move(move.slots);
+    this->used = move.used;
+    move.slots.clear();
+    move.used = 0;
+    return *this;
+  }
 
-    yyscan_t scanner;
-    if (yylex_init(&scanner) != 0)
+  config_t config_t::Copy() const
+  {
+    config_t result;
+    result.slots.reserve(this->slots.size());
+    for (auto& slot: this->slots)
     {
-      throw std::runtime_error("Can't initialize scanner");
+      ref_t value;
+      switch (slot.value.Type())
+      {
+      case type_t::none:
+        break;
+      case type_t::number:
+        value = ref_t::Number(slot.value.Number());
+        break;
+      case type_t::string:
+        value = ref_t::String(slot.value.String());
+        break;
+      }
+      result.slots.emplace_back(slot_t{ slot.key, std::move(value) });
     }
-    BB_DEFER(yylex_destroy(scanner));
+    result.used = this->used;
+    return result;
+  }
 
-    bbCoreConfigTokenData_t tokenData;
-    tokenData.type = BB_ERROR;
-    tokenData.str = nullptr;
-    BB_DEFER(bbCoreConfigTokenReset(&tokenData));
+  config_t::config_t()
+  : used(0)
+  {
+    ;
+  }
 
-    yyset_extra(&tokenData, scanner);
+  config_t::config_t(const std::string& filename)
+  : used(0)
+  {
+    this->Load(filename);
+  }
 
-    // this can lead to YY_FATAL_ERROR, and exit
-    auto tmpBuf = yy_scan_string(line.c_str(), scanner);
-    BB_DEFER(yy_delete_buffer(tmpBuf, scanner));
+  config_t::~config_t()
+  {
+    ;
+  }
 
-    // Only this variants expected
+  void config_t::Parse(const char* text, size_t size)
+  {
+    // Only this statements expected
     // }
     // "key" {
     // "key": value
     // "key": "value"
 
-    // Expect "key" or }
-    int token = yylex(scanner, cLocale);
+    scanner_t scanner(text, size);
 
+    // full dotted key of current statement, section prefixes are kept in it
     std::string key;
-    switch (token)
+    std::vector<size_t> sections;
+
+    for (;;)
     {
-      case BB_STRING:
-        key = tokenData.str;
-        break;
-      case BB_FINISH:
+      switch (scanner.Next())
+      {
+      case token_t::end:
+        return;
+      case token_t::finish:
+        if (sections.empty())
         {
-          if (context.empty())
-          {
-            bb::Error("Unexpected context close");
-            throw std::runtime_error("Unexpected context close");
-          }
-
-          auto dotPos = context.rfind('.');
-          if (dotPos == std::string::npos)
-          {
-            dotPos = 0;
-          }
-          return context.substr(0, dotPos);
+          bb::Error("Line " BBsize_t ": unexpected context close", scanner.Line());
+          throw std::runtime_error("Unexpected context close");
         }
+        key.resize(sections.back());
+        sections.pop_back();
+        continue;
+      case token_t::string:
+        break;
       default:
-        ThrowTokenError(token, tokenData);
-    }
-    bbCoreConfigTokenReset(&tokenData);
+        ThrowTokenError(scanner, "key or }");
+      }
 
-    // expect : or {
-    token = yylex(scanner, cLocale);
+      const size_t prefixSize = key.size();
+      if (!key.empty())
+      {
+        key.push_back('.');
+      }
+      key.append(scanner.Text(), scanner.TextSize());
 
-    switch(token)
-    {
-      case BB_SET:
-        // just go to next token
+      switch (scanner.Next())
+      {
+      case token_t::start:
+        // new context started, key stays as prefix
+        sections.push_back(prefixSize);
+        continue;
+      case token_t::set:
         break;
-      case BB_START:
-        // new context started, just return
-        return  (context.empty())?(key):(context + "." + key);
       default:
-        ThrowTokenError(token, tokenData);
-    }
-    bbCoreConfigTokenReset(&tokenData);
-
-    std::string fullKey = (context.empty())?(key):(context + "." + key);
+        ThrowTokenError(scanner, ": or {");
+      }
 
-    switch (yylex(scanner, cLocale))
-    {
-    case BB_STRING:
-      this->dict[fullKey] = ref_t::String(tokenData.str);
-      break;
-    case BB_NUMBER:
-      this->dict[fullKey] = ref_t::Number(tokenData.num);
-      break;
-    default:
-      throw std::runtime_error("Invalid configuration line");
+      switch (scanner.Next())
+      {
+      case token_t::string:
+        this->Insert(configKey_t(key).Id()) = ref_t::String(std::string(scanner.Text(), scanner.TextSize()));
+        break;
+      case token_t::number:
+        this->Insert(configKey_t(key).Id()) = ref_t::Number(scanner.Number());
+        break;
+      default:
+        ThrowTokenError(scanner, "value");
+      }
+      key.resize(prefixSize);
     }
-
-    return context;
   }
 
   void config_t::Load(const std::string& filename)
   {
-    std::ifstream input(filename, std::ios::in);
-    std::string context;
+    std::ifstream input(filename, std::ios::in | std::ios::binary);
+    if (!input)
+    {
+      throw std::runtime_error(std::string("Can't open file '") + filename + std::string("'"));
+    }
 
-    if (input)
+    // whole file is scanned at once
+    input.seekg(0, std::ios::end);
+    std::string text(static_cast<size_t>(input.tellg()), '\0');
+    input.seekg(0, std::ios::beg);
+    if (!input.read(&text[0], static_cast<std::streamsize>(text.size())))
     {
-      std::string line;
-      while(std::getline(input, line))
-      {
-        context = this->ParseString(line, context);
-      }
+      throw std::runtime_error(std::string("Can't read file '") + filename + std::string("'"));
     }
-    else
+
+    try
     {
-      throw std::runtime_error(std::string("Can't open file '") + filename + std::string("'"));
+      this->Parse(text.data(), text.size());
+    }
+    catch (const std::runtime_error&)
+    {
+      bb::Error("Can't parse config '%s'", filename.c_str());
+      throw;
     }
   }
 
   void config_t::Save(const std::string& filename) const
   {
+    // sorted, so saved file does not change without reason
+    std::vector<std::pair<const std::string*, const ref_t*>> sorted;
+    sorted.reserve(this->used);
+    for (auto& slot: this->slots)
+    {
+      if ((slot.key != emptySlot) && (slot.value.Type() != type_t::none))
+      { // unassigned values can't be parsed back
+        sorted.emplace_back(&keyTable_t::Instance().Name(slot.key), &slot.value);
+      }
+    }
+    std::sort(sorted.begin(), sorted.end(),
+      [](const std::pair<const std::string*, const ref_t*>& a, const std::pair<const std::string*, const ref_t*>& b)
+      {
+        return *a.first < *b.first;
+      }
+    );
+
     std::ofstream output(filename, std::ios::out);
     if (output)
     {
-      for (auto it = this->dict.begin(), e = this->dict.end(); it != e; ++it)
+      for (auto& item: sorted)
       {
-        output << '\"' << it->first << "\": " << it->second.ToString() << std::endl;
+        output << '\"' << *item.first << "\": " << item.second->ToString() << '\n';
       }
     }
     else
@@ -15,6 +15,7 @@
 
 #include <list>
 #include <utility>
+#include <vector>
 
 #include <framebuffer.hpp>
 #include <shader.hpp>
@@ -39,6 +40,27 @@ namespace bb
       mouse = 0x0002
     };
 
+    /**
+     * Frame pacing mode, selected by "opengl.pacing" in default.config.
+     */
+    enum class pacing_t
+    {
+      vsync,      // "vsync": swap waits for vertical retrace
+      uncapped,   // "uncapped": no swap interval, no waits
+      fences,     // "fences": no swap interval, at most "opengl.frames" frames queued on GPU
+      lowLatency  // "low-latency": vsync, wait for GPU to finish frame right before input poll
+    };
+
+    /**
+     * Measured frame timings in seconds.
+     */
+    struct frameStats_t
+    {
+      double frame; // time between two consecutive frame starts
+      double cpu;   // time spent by CPU to prepare frame
+      double gpu;   // time spent by GPU to render frame (from GL_TIME_ELAPSED query)
+    };
+
   private:
 
     static bool isAlreadyExists;
@@ -71,6 +93,18 @@ namespace bb
 
     double              clickTimeout[GLFW_MOUSE_BUTTON_LAST+1];
 
+    pacing_t            pacing;
+    std::vector<GLsync> frameFences;
+    std::vector<GLuint> gpuQueries;
+    size_t              frameIndex;
+    double              frameStart;
+    frameStats_t        stats;
+    frameStats_t        totalStats;
+    size_t              gpuFrames;
+    std::string         profilerCSV;
+
+    void BeginFrame();
+
     context_t();
     ~context_t();
 
@@ -107,6 +141,15 @@ namespace bb
 
     bool Update();
 
+    pacing_t Pacing() const;
+
+    /**
+     * Timings of last measured frame.
+     *
+     * GPU time lags behind CPU time by frames in flight count.
+     */
+    const frameStats_t& FrameStats() const;
+
     bool IsKeyDown(uint16_t key) const;
 
     void SetStickyMouse(bool enable) const;
@@ -172,6 +215,16 @@ namespace bb
     return this->height;
   }
 
+  inline context_t::pacing_t context_t::Pacing() const
+  {
+    return this->pacing;
+  }
+
+  inline const context_t::frameStats_t& context_t::FrameStats() const
+  {
+    return this->stats;
+  }
+
   inline bool context_t::IsKeyDown(uint16_t key) const
   {
     return glfwGetKey(this->wnd, key) != GLFW_RELEASE;
@@ -11,8 +11,8 @@
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 #include <vector>
-#include <map>
 
+#include <glyphTable.hpp>
 #include <texture.hpp>
 #include <vao.hpp>
 
@@ -22,6 +22,15 @@ namespace bb
   using vec2_t = glm::vec2;
   using vec3_t = glm::vec3;
 
+  /**
+   * Symbol position and size in font texture.
+   */
+  struct glyph_t
+  {
+    vec2_t offset;
+    vec2_t size;
+  };
+
   class font_t final
   {
     sharedTexture_t texture;
@@ -29,9 +38,8 @@ namespace bb
     int width;
     int height;
 
-    using smbToVec_t = std::map<uint32_t, vec2_t>;
-    smbToVec_t offsets;
-    smbToVec_t sizes;
+    glyphTable_t table;
+    std::vector<glyph_t> glyphs; // glyph 0 is used for unknown symbols
 
     font_t(const font_t&) = delete;
     font_t& operator=(const font_t&) = delete;
@@ -43,7 +51,7 @@ namespace bb
       this->Load(filename);
     }
 
-    font_t() = default;
+    font_t();
     font_t(font_t&&) = default;
     font_t& operator=(font_t&&) = default;
 
@@ -66,24 +74,24 @@ namespace bb
       return this->height;
     }
 
+    /**
+     * Symbol offset and size with one lookup.
+     *
+     * Unknown symbols have zero offset and unit size.
+     */
+    const glyph_t& Glyph(uint32_t smb) const
+    {
+      return this->glyphs[this->table.Find(smb)];
+    }
+
     vec2_t SymbolOffset(uint32_t smb) const
     {
-      auto it = this->offsets.find(smb);
-      if (it == this->offsets.end())
-      {
-        return vec2_t(0.0f, 0.0f);
-      }
-      return it->second;
+      return this->Glyph(smb).offset;
     }
 
     vec2_t SymbolSize(uint32_t smb) const
     {
-      auto it = this->sizes.find(smb);
-      if (it == this->sizes.end())
-      {
-        return vec2_t(1.0f, 1.0f);
-      }
-      return it->second;
+      return this->Glyph(smb).size;
     }
 
   };
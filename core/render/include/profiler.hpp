@@ -0,0 +1,177 @@
+/**
+ * @file profiler.hpp
+ *
+ * GPU time profiler based on timer queries.
+ *
+ * Named scopes put GL_TIMESTAMP queries around GPU commands. Results are read
+ * several frames later, only when available, so profiler never stalls
+ * pipeline. Timestamps used instead of GL_TIME_ELAPSED queries, because only
+ * one GL_TIME_ELAPSED query can be active at once (context_t already measures
+ * whole frame with it), and scopes must nest.
+ *
+ * Profiler must be used only from render thread.
+ *
+ */
+
+#pragma once
+#ifndef __BB_CORE_RENDER_PROFILER_HEADER__
+#define __BB_CORE_RENDER_PROFILER_HEADER__
+
+#include <glad/glad.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <common.hpp>
+
+namespace bb
+{
+
+  struct gpuScopeStats_t
+  {
+    std::string name;
+    double average; // rolling average in seconds
+    double last;    // last resolved frame in seconds
+    size_t samples; // samples in rolling window
+  };
+
+  class gpuProfiler_t final
+  {
+    static const size_t latency = 4; // frames between issue and read
+    static const size_t window = 64; // rolling average window size
+
+    struct record_t
+    {
+      size_t scope;
+      GLuint begin;
+      GLuint end;
+    };
+
+    struct scope_t
+    {
+      std::string name;
+      double frameTotal;
+      bool touched;
+      double history[window];
+      double sum;
+      double last;
+      size_t cursor;
+      size_t samples;
+    };
+
+    using frame_t = std::vector<record_t>;
+
+    bool enabled;
+    size_t frameIndex;
+    size_t dropped;
+    std::vector<scope_t> scopes;
+    std::unordered_map<std::string, size_t> scopeIDs;
+    std::vector<GLuint> pool;
+    std::vector<size_t> openRecords;
+    frame_t frames[latency];
+
+    GLuint Acquire();
+    void Release(frame_t& frame);
+    void Resolve(frame_t& frame);
+
+    gpuProfiler_t();
+    ~gpuProfiler_t();
+
+    gpuProfiler_t(const gpuProfiler_t&) = delete;
+    gpuProfiler_t(gpuProfiler_t&&) = delete;
+    gpuProfiler_t& operator=(const gpuProfiler_t&) = delete;
+    gpuProfiler_t& operator=(gpuProfiler_t&&) = delete;
+
+  public:
+
+    static gpuProfiler_t& Instance();
+
+    bool Enabled() const;
+    void Enable(bool enable);
+
+    /**
+     * Get scope identifier by name, new scope is registered on first call.
+     */
+    size_t ScopeID(const char* name);
+
+    void Begin(size_t scope);
+    void End();
+
+    /**
+     * Mark frame end. Called by context_t::Update.
+     */
+    void FrameEnd();
+
+    /**
+     * Release all query objects. Called before OpenGL context destruction.
+     */
+    void Clear();
+
+    /**
+     * Frames, which results were not ready in time and were dropped.
+     */
+    size_t Dropped() const;
+
+    std::vector<gpuScopeStats_t> Stats() const;
+
+    int DumpCSV(FILE* output) const;
+    int DumpCSV(const std::string& filename) const;
+
+  };
+
+  class gpuScope_t final
+  {
+    bool active;
+
+    gpuScope_t(const gpuScope_t&) = delete;
+    gpuScope_t(gpuScope_t&&) = delete;
+    gpuScope_t& operator=(const gpuScope_t&) = delete;
+    gpuScope_t& operator=(gpuScope_t&&) = delete;
+
+  public:
+
+    explicit gpuScope_t(size_t scope);
+    ~gpuScope_t();
+  };
+
+  inline bool gpuProfiler_t::Enabled() const
+  {
+    return this->enabled;
+  }
+
+  inline size_t gpuProfiler_t::Dropped() const
+  {
+    return this->dropped;
+  }
+
+  inline gpuScope_t::gpuScope_t(size_t scope)
+  : active(gpuProfiler_t::Instance().Enabled())
+  {
+    if (this->active)
+    {
+      gpuProfiler_t::Instance().Begin(scope);
+    }
+  }
+
+  inline gpuScope_t::~gpuScope_t()
+  {
+    if (this->active)
+    {
+      gpuProfiler_t::Instance().End();
+    }
+  }
+
+} // namespace bb
+
+#ifdef BB_GPU_PROFILER_DISABLE
+#define BB_GPU_SCOPE(NAME)
+#else
+#define BB_GPU_SCOPE_1(NAME, INDEX) \
+  static const size_t BB_CALL_SCOPE_NAME_2(_bb_gpu_scope_id_, INDEX) = bb::gpuProfiler_t::Instance().ScopeID(NAME); \
+  bb::gpuScope_t BB_CALL_SCOPE_NAME_2(_bb_gpu_scope_, INDEX)(BB_CALL_SCOPE_NAME_2(_bb_gpu_scope_id_, INDEX))
+#define BB_GPU_SCOPE(NAME) BB_GPU_SCOPE_1(NAME, __COUNTER__)
+#endif /* BB_GPU_PROFILER_DISABLE */
+
+#endif /* __BB_CORE_RENDER_PROFILER_HEADER__ */
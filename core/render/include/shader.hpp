@@ -33,6 +33,8 @@ namespace bb
     GLint UniformLocation(const char* name) const;
 
     void SetFloat(GLint loc, float value) const;
+    void SetFloat(GLint loc, GLsizei count, const float* values) const;
+    void SetInteger(GLint loc, int value) const;
     void SetVector2f(GLint loc, GLsizei count, const float* values) const;
     void SetVector3f(GLint loc, GLsizei count, const float* values) const;
     void SetVector4f(GLint loc, GLsizei count, const float* values) const;
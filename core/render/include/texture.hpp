@@ -16,6 +16,8 @@
 
 namespace bb
 {
+
+  class textureFile_t;
   
   class texture_t final
   {
@@ -31,6 +33,14 @@ namespace bb
     void SetFilter(GLint minFiler, GLint magFilter);
     void GenerateMipmaps();
 
+    /**
+     * Set filters and generate mipmaps as texture.* values of config say.
+     *
+     * @param hasMipmaps texture has baked levels, so they are not generated
+     */
+    void ApplyConfig(const config_t& config, bool hasMipmaps);
+    void Update(int x, int y, int width, int height, GLenum format, GLenum type, const void* data);
+
     texture_t(texture_t&&);
     texture_t& operator=(texture_t&&);
 
@@ -39,13 +49,39 @@ namespace bb
     texture_t(int width, int height, bool fp);
     texture_t(int width, int height, int depth, const uint8_t* data);
     texture_t(int width, int height, const float* data);
+    texture_t(int width, int height, const uint8_t* data);
+
+    /**
+     * Upload all levels of texture container as is.
+     *
+     * Compressed levels need EXT_texture_compression_s3tc.
+     *
+     * @throw std::runtime_error when format is not supported
+     */
+    explicit texture_t(const textureFile_t& file);
 
     ~texture_t();
 
+    /**
+     * Load texture described by config.
+     *
+     * "texture.image" is TGA or .tex container. When container is
+     * compressed and driver has no S3TC, "texture.fallback" TGA is loaded.
+     *
+     * @throw std::runtime_error when texture can't be loaded
+     */
     static texture_t LoadConfig(const config_t& config);
     static texture_t LoadConfig(const std::string& filename);
     static texture_t LoadTGA(const std::string& filename);
+
+    /**
+     * Load texture container (.tex) made by tga2tex.
+     *
+     * @throw std::runtime_error on errors
+     */
+    static texture_t LoadTexture(const std::string& filename);
     static void Bind(const texture_t& tex);
+    static void Bind(const texture_t& tex, GLuint unit);
 
   };
 
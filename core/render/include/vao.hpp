@@ -24,11 +24,12 @@ namespace bb
 
     GLuint self;
     GLenum type;
+    size_t capacity;
 
     vbo_t(const vbo_t&) = delete;
     vbo_t& operator =(const vbo_t&) = delete;
 
-    vbo_t(GLuint self, GLenum type);
+    vbo_t(GLuint self, GLenum type, size_t capacity);
 
   public:
 
@@ -40,6 +41,18 @@ namespace bb
 
     void Update(int offset, size_t size, const void* data);
 
+    /**
+     * Replace whole buffer content.
+     *
+     * Old storage is orphaned, so driver does not wait for draws, which
+     * still use it. Storage grows only when data does not fit.
+     */
+    void Upload(const void* data, size_t size);
+
+    size_t Capacity() const;
+
+    bool Good() const;
+
     static vbo_t CreateArrayBuffer(const void* data, size_t dataSize, bool dynamic);
 
     static vbo_t CreateElementArrayBuffer(const void* data, size_t dataSize, bool dynamic);
@@ -88,6 +101,16 @@ namespace bb
 
   };
 
+  inline size_t vbo_t::Capacity() const
+  {
+    return this->capacity;
+  }
+
+  inline bool vbo_t::Good() const
+  {
+    return this->self != 0;
+  }
+
   inline bool vao_t::Good() const
   {
     return this->self != 0;
@@ -6,6 +6,7 @@
 #include <common.hpp>
 #include <config.hpp>
 #include <context.hpp>
+#include <profiler.hpp>
 #include <worker.hpp>
 
 #ifdef _WIN32
@@ -155,6 +156,46 @@ namespace
     }
   }
 
+  bb::context_t::pacing_t PacingString(const std::string& pacingName)
+  {
+    if (pacingName.compare("vsync") == 0)
+    {
+      return bb::context_t::pacing_t::vsync;
+    }
+    if (pacingName.compare("uncapped") == 0)
+    {
+      return bb::context_t::pacing_t::uncapped;
+    }
+    if (pacingName.compare("fences") == 0)
+    {
+      return bb::context_t::pacing_t::fences;
+    }
+    if (pacingName.compare("low-latency") == 0)
+    {
+      return bb::context_t::pacing_t::lowLatency;
+    }
+
+    bb::Debug("Unknown frame pacing: \"%s\" defaults to vsync", pacingName.c_str());
+    return bb::context_t::pacing_t::vsync;
+  }
+
+  void WaitFence(GLsync& fence)
+  {
+    if (fence == nullptr)
+    {
+      return;
+    }
+
+    // flush only on first try, otherwise we can wait forever
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (glClientWaitSync(fence, flags, 1000000000) == GL_TIMEOUT_EXPIRED)
+    {
+      flags = 0;
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+  }
+
   void APIENTRY OnGLError(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei /*length*/, const GLchar *message, const void * /*userPtr*/)
   {
     bb::Debug(
@@ -173,7 +214,8 @@ namespace bb
 {
 
   context_t::context_t()
-      : wnd(nullptr), width(800), height(600), insideWnd(false), relativeCursor(false), hasNewTitle(false)
+      : wnd(nullptr), width(800), height(600), insideWnd(false), relativeCursor(false), hasNewTitle(false),
+        pacing(pacing_t::vsync), frameIndex(0), frameStart(0.0), stats{0.0, 0.0, 0.0}, totalStats{0.0, 0.0, 0.0}, gpuFrames(0)
   {
     if (glfwInit() == GLFW_FALSE)
     {
@@ -195,6 +237,9 @@ namespace bb
       config["window.title"] = ref_t::String("BadBaby");
       config["window.fullscreen"] = ref_t::Number(0.0);
       config["opengl.debug"] = ref_t::Number(0.0);
+      config["opengl.pacing"] = ref_t::String("vsync");
+      config["opengl.frames"] = ref_t::Number(2.0);
+      config["opengl.profiler"] = ref_t::Number(0.0);
       config.Save("default.config");
     }
 
@@ -218,6 +263,11 @@ namespace bb
     this->height = static_cast<int>(config.Value("window.height", 600.0));
     std::string winTitle = config.Value("window.title", "BadBaby");
     bool winFullscreen = (config.Value("window.fullscreen", 0.0) != 0.0);
+    std::string pacingName = config.Value("opengl.pacing", "vsync");
+    this->pacing = PacingString(pacingName);
+    auto framesInFlight = static_cast<size_t>(
+      bb::CheckValueBounds(config.Value("opengl.frames", 2.0), 1.0, 8.0)
+    );
 
     if (winFullscreen)
     {
@@ -253,7 +303,17 @@ namespace bb
 
     glfwMakeContextCurrent(this->wnd);
     glfwSetWindowUserPointer(this->wnd, this);
-    glfwSwapInterval(1);
+    switch (this->pacing)
+    {
+      case pacing_t::vsync:
+      case pacing_t::lowLatency:
+        glfwSwapInterval(1);
+        break;
+      case pacing_t::uncapped:
+      case pacing_t::fences:
+        glfwSwapInterval(0);
+        break;
+    }
 
     gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress));
 
@@ -288,11 +348,59 @@ namespace bb
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+    // one more query than frames in flight, so reading result never stalls
+    this->frameFences.assign(framesInFlight, nullptr);
+    this->gpuQueries.resize(framesInFlight + 1);
+    glGenQueries(static_cast<GLsizei>(this->gpuQueries.size()), this->gpuQueries.data());
+
+    Info("Frame pacing: %s (%u frames)", pacingName.c_str(), static_cast<unsigned int>(framesInFlight));
+
+    gpuProfiler_t::Instance().Enable(config.Value("opengl.profiler", 0.0) != 0.0);
+    if (gpuProfiler_t::Instance().Enabled())
+    {
+      this->profilerCSV = config.Value("opengl.profiler.csv", "gpuProfile.csv");
+      Info("GPU profiler enabled: \"%s\"", this->profilerCSV.c_str());
+    }
+
+    this->BeginFrame();
+
     context_t::isAlreadyExists = true;
   }
 
   context_t::~context_t()
   {
+    glEndQuery(GL_TIME_ELAPSED);
+
+    if (this->frameIndex != 0)
+    {
+      auto frames = static_cast<double>(this->frameIndex);
+      Info("Frame stats (" BBsize_t " frames):\n\tFrame: %.3f ms\n\tCPU: %.3f ms\n\tGPU: %.3f ms",
+        this->frameIndex,
+        this->totalStats.frame * 1000.0 / frames,
+        this->totalStats.cpu * 1000.0 / frames,
+        (this->gpuFrames != 0)?(this->totalStats.gpu * 1000.0 / static_cast<double>(this->gpuFrames)):(0.0)
+      );
+    }
+
+    for (auto& fence: this->frameFences)
+    {
+      if (fence != nullptr)
+      {
+        glDeleteSync(fence);
+      }
+    }
+    this->frameFences.clear();
+
+    glDeleteQueries(static_cast<GLsizei>(this->gpuQueries.size()), this->gpuQueries.data());
+    this->gpuQueries.clear();
+
+    if (gpuProfiler_t::Instance().Enabled())
+    {
+      gpuProfiler_t::Instance().DumpCSV(this->profilerCSV);
+      Info("GPU profiler: " BBsize_t " frames dropped", gpuProfiler_t::Instance().Dropped());
+    }
+    gpuProfiler_t::Instance().Clear();
+
 #ifdef BB_FB_BLIT_DISABLE
     this->shader = shader_t();
     this->vao = vao_t();
@@ -325,34 +433,96 @@ namespace bb
   {
     std::unique_lock<std::mutex> lock(this->mutex);
 
+    this->stats.cpu = glfwGetTime() - this->frameStart;
+    this->totalStats.cpu += this->stats.cpu;
+
     if (this->hasNewTitle)
     {
       glfwSetWindowTitle(this->wnd, this->title.c_str());
       this->hasNewTitle = false;
     }
 
+    {
+      BB_GPU_SCOPE("blit");
 #ifndef BB_FB_BLIT_DISABLE
-    this->canvas.BlitToScreen();
+      this->canvas.BlitToScreen();
 #else
-    framebuffer_t::RenderToScreen();
-    shader_t::Bind(this->shader);
-    vao_t::Bind(this->vao);
-    texture_t::Bind(this->canvas.Texture());
-
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    glDisableVertexAttribArray(0);
-    glDisableVertexAttribArray(1);
+      framebuffer_t::RenderToScreen();
+      shader_t::Bind(this->shader);
+      vao_t::Bind(this->vao);
+      texture_t::Bind(this->canvas.Texture());
+
+      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+      glEnableVertexAttribArray(0);
+      glEnableVertexAttribArray(1);
+      glDrawArrays(GL_TRIANGLES, 0, 6);
+      glDisableVertexAttribArray(0);
+      glDisableVertexAttribArray(1);
 #endif
+    }
 
-    glFinish();
+    gpuProfiler_t::Instance().FrameEnd();
+    glEndQuery(GL_TIME_ELAPSED);
     glfwSwapBuffers(this->wnd);
+
+    switch (this->pacing)
+    {
+      case pacing_t::fences:
+        {
+          // wait for frame issued frameFences.size() frames ago
+          auto& fence = this->frameFences[this->frameIndex % this->frameFences.size()];
+          WaitFence(fence);
+          fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+        break;
+      case pacing_t::lowLatency:
+        {
+          // wait for this frame, so input is polled as late as possible
+          auto& fence = this->frameFences[0];
+          fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+          WaitFence(fence);
+        }
+        break;
+      case pacing_t::vsync:
+      case pacing_t::uncapped:
+        break;
+    }
+
     glfwPollEvents();
+
+    ++this->frameIndex;
+    this->BeginFrame();
     return (glfwWindowShouldClose(this->wnd) == 0);
   }
 
+  void context_t::BeginFrame()
+  {
+    auto slot = this->frameIndex % this->gpuQueries.size();
+    if (this->frameIndex >= this->gpuQueries.size())
+    { // query in this slot was issued gpuQueries.size() frames ago, never stall on it
+      GLint available = GL_FALSE;
+      glGetQueryObjectiv(this->gpuQueries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+      if (available != GL_FALSE)
+      {
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(this->gpuQueries[slot], GL_QUERY_RESULT, &elapsed);
+        this->stats.gpu = static_cast<double>(elapsed) * 1.0e-9;
+        this->totalStats.gpu += this->stats.gpu;
+        ++this->gpuFrames;
+      }
+    }
+
+    auto now = glfwGetTime();
+    if (this->frameIndex != 0)
+    {
+      this->stats.frame = now - this->frameStart;
+      this->totalStats.frame += this->stats.frame;
+    }
+    this->frameStart = now;
+
+    glBeginQuery(GL_TIME_ELAPSED, this->gpuQueries[slot]);
+  }
+
   void context_t::Title(const std::string &newTitle)
   {
     std::unique_lock<std::mutex> lock(this->mutex);
@@ -9,6 +9,8 @@ namespace
 
   using namespace bb;
 
+  const glyph_t unknownGlyph = { vec2_t(0.0f, 0.0f), vec2_t(1.0f, 1.0f) };
+
   std::shared_ptr<texture_t> LoadTexture(const config_t& config)
   {
     // First option - just font texture filename given
@@ -34,6 +36,14 @@ namespace
 namespace bb
 {
 
+  font_t::font_t()
+  : width(0),
+    height(0),
+    glyphs(1, unknownGlyph)
+  {
+    ;
+  }
+
   void font_t::Load(const std::string& filename)
   {
     config_t fontConfig;
@@ -74,6 +84,9 @@ namespace bb
     }
     BB_DEFER(iconv_close(code));
 
+    glyphTable_t table;
+    std::vector<glyph_t> glyphs(1, unknownGlyph);
+
     for (uint8_t smb = 0; smb < std::numeric_limits<uint8_t>::max(); ++smb)
     {
       char input[1] = { static_cast<char>(smb) };
@@ -92,9 +105,24 @@ namespace bb
 
       auto smbPos = bb::vec2_t(smb%this->width, smb/this->width);
 
-      this->offsets[static_cast<uint32_t>(output[0])] = vec2_t { smbPos.x * (size.x + xstride), smbPos.y * (size.y + ystride) };
-      this->sizes[static_cast<uint32_t>(output[0])] = size;
+      auto codepoint = static_cast<uint32_t>(output[0]);
+      auto id = table.Find(codepoint);
+      if (id == 0)
+      {
+        id = static_cast<uint16_t>(glyphs.size());
+        if (table.Insert(codepoint, id) != 0)
+        {
+          continue;
+        }
+        glyphs.emplace_back();
+      }
+
+      glyphs[id].offset = vec2_t { smbPos.x * (size.x + xstride), smbPos.y * (size.y + ystride) };
+      glyphs[id].size = size;
     }
+
+    this->table = std::move(table);
+    this->glyphs = std::move(glyphs);
   }
 
 }
\ No newline at end of file
@@ -0,0 +1,255 @@
+#include <cassert>
+
+#include <profiler.hpp>
+
+namespace bb
+{
+
+  gpuProfiler_t::gpuProfiler_t()
+  : enabled(false),
+    frameIndex(0),
+    dropped(0)
+  {
+    ;
+  }
+
+  gpuProfiler_t::~gpuProfiler_t()
+  {
+    // Queries must be released by Clear() while context is still alive
+    assert(this->pool.empty());
+  }
+
+  gpuProfiler_t& gpuProfiler_t::Instance()
+  {
+    static gpuProfiler_t self;
+    return self;
+  }
+
+  void gpuProfiler_t::Enable(bool enable)
+  {
+    this->enabled = enable;
+  }
+
+  size_t gpuProfiler_t::ScopeID(const char* name)
+  {
+    auto it = this->scopeIDs.find(name);
+    if (it != this->scopeIDs.end())
+    {
+      return it->second;
+    }
+
+    scope_t scope;
+    scope.name = name;
+    scope.frameTotal = 0.0;
+    scope.touched = false;
+    for (auto& item: scope.history)
+    {
+      item = 0.0;
+    }
+    scope.sum = 0.0;
+    scope.last = 0.0;
+    scope.cursor = 0;
+    scope.samples = 0;
+
+    this->scopes.emplace_back(std::move(scope));
+    this->scopeIDs.emplace(name, this->scopes.size() - 1);
+    return this->scopes.size() - 1;
+  }
+
+  GLuint gpuProfiler_t::Acquire()
+  {
+    if (this->pool.empty())
+    { // allocate queries in batches
+      GLuint batch[16];
+      glGenQueries(static_cast<GLsizei>(countof(batch)), batch);
+      this->pool.insert(this->pool.end(), batch, batch + countof(batch));
+    }
+    auto result = this->pool.back();
+    this->pool.pop_back();
+    return result;
+  }
+
+  void gpuProfiler_t::Release(frame_t& frame)
+  {
+    for (auto& record: frame)
+    {
+      this->pool.push_back(record.begin);
+      if (record.end != 0)
+      {
+        this->pool.push_back(record.end);
+      }
+    }
+    frame.clear();
+  }
+
+  void gpuProfiler_t::Begin(size_t scope)
+  {
+    assert(scope < this->scopes.size());
+
+    auto& frame = this->frames[this->frameIndex % latency];
+
+    record_t record;
+    record.scope = scope;
+    record.begin = this->Acquire();
+    record.end = 0;
+    glQueryCounter(record.begin, GL_TIMESTAMP);
+
+    this->openRecords.push_back(frame.size());
+    frame.push_back(record);
+  }
+
+  void gpuProfiler_t::End()
+  {
+    if (this->openRecords.empty())
+    { // programmer's error
+      assert(0);
+      return;
+    }
+
+    auto& frame = this->frames[this->frameIndex % latency];
+    auto& record = frame[this->openRecords.back()];
+    this->openRecords.pop_back();
+
+    record.end = this->Acquire();
+    glQueryCounter(record.end, GL_TIMESTAMP);
+  }
+
+  void gpuProfiler_t::Resolve(frame_t& frame)
+  {
+    if (frame.empty())
+    {
+      return;
+    }
+
+    // queries complete in order, so when last is ready - all are ready
+    auto& last = frame.back();
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv((last.end != 0)?(last.end):(last.begin), GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available == GL_FALSE)
+    {
+      ++this->dropped;
+      this->Release(frame);
+      return;
+    }
+
+    for (auto& record: frame)
+    {
+      if (record.end == 0)
+      { // unbalanced scope, skip it
+        continue;
+      }
+
+      GLuint64 begin = 0;
+      GLuint64 end = 0;
+      glGetQueryObjectui64v(record.begin, GL_QUERY_RESULT, &begin);
+      glGetQueryObjectui64v(record.end, GL_QUERY_RESULT, &end);
+
+      auto& scope = this->scopes[record.scope];
+      scope.frameTotal += static_cast<double>(end - begin) * 1.0e-9;
+      scope.touched = true;
+    }
+
+    for (auto& scope: this->scopes)
+    {
+      if (!scope.touched)
+      {
+        continue;
+      }
+
+      scope.sum -= scope.history[scope.cursor];
+      scope.history[scope.cursor] = scope.frameTotal;
+      scope.sum += scope.frameTotal;
+      scope.cursor = (scope.cursor + 1) % window;
+      if (scope.samples < window)
+      {
+        ++scope.samples;
+      }
+      scope.last = scope.frameTotal;
+      scope.frameTotal = 0.0;
+      scope.touched = false;
+    }
+
+    this->Release(frame);
+  }
+
+  void gpuProfiler_t::FrameEnd()
+  {
+    // scopes must not cross frame boundary
+    assert(this->openRecords.empty());
+    this->openRecords.clear();
+
+    ++this->frameIndex;
+    // this slot was filled (latency - 1) frames ago
+    this->Resolve(this->frames[this->frameIndex % latency]);
+  }
+
+  void gpuProfiler_t::Clear()
+  {
+    for (auto& frame: this->frames)
+    {
+      this->Release(frame);
+    }
+    this->openRecords.clear();
+
+    if (!this->pool.empty())
+    {
+      glDeleteQueries(static_cast<GLsizei>(this->pool.size()), this->pool.data());
+      this->pool.clear();
+    }
+  }
+
+  std::vector<gpuScopeStats_t> gpuProfiler_t::Stats() const
+  {
+    std::vector<gpuScopeStats_t> result;
+    result.reserve(this->scopes.size());
+    for (auto& scope: this->scopes)
+    {
+      gpuScopeStats_t stats;
+      stats.name = scope.name;
+      stats.average = (scope.samples != 0)?(scope.sum / static_cast<double>(scope.samples)):(0.0);
+      stats.last = scope.last;
+      stats.samples = scope.samples;
+      result.emplace_back(std::move(stats));
+    }
+    return result;
+  }
+
+  int gpuProfiler_t::DumpCSV(FILE* output) const
+  {
+    if (output == nullptr)
+    {
+      return -1;
+    }
+
+    if (fprintf(output, "scope,average_ms,last_ms,samples\n") < 0)
+    {
+      return -1;
+    }
+
+    for (auto& stats: this->Stats())
+    {
+      if (fprintf(output, "\"%s\",%.4f,%.4f," BBsize_t "\n",
+        stats.name.c_str(),
+        stats.average * 1000.0,
+        stats.last * 1000.0,
+        stats.samples) < 0)
+      {
+        return -1;
+      }
+    }
+    return 0;
+  }
+
+  int gpuProfiler_t::DumpCSV(const std::string& filename) const
+  {
+    FILE* output = fopen(filename.c_str(), "wt");
+    if (output == nullptr)
+    {
+      bb::Error("Can't open \"%s\" for GPU profile", filename.c_str());
+      return -1;
+    }
+    BB_DEFER(fclose(output));
+    return this->DumpCSV(output);
+  }
+
+} // namespace bb
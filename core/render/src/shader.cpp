@@ -121,6 +121,16 @@ namespace bb
     glUniform1f(loc, value);
   }
 
+  void shader_t::SetFloat(GLint loc, GLsizei count, const float* values) const
+  {
+    glUniform1fv(loc, count, values);
+  }
+
+  void shader_t::SetInteger(GLint loc, int value) const
+  {
+    glUniform1i(loc, value);
+  }
+
   void shader_t::SetVector2f(GLint loc, GLsizei count, const float* values) const
   {
     glUniform2fv(loc, count, values);
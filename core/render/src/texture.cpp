@@ -1,13 +1,51 @@
 #include <cassert>
+#include <cstring>
+#include <stdexcept>
 
 #include <texture.hpp>
 #include <image.hpp>
+#include <textureFile.hpp>
 #include <config.hpp>
 #include <common.hpp>
 
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
 namespace 
 {
 
+  bool HasS3TC()
+  {
+    // S3TC is not core, but supported by all desktop drivers
+    static const bool result = []() -> bool
+    {
+      GLint total = 0;
+      glGetIntegerv(GL_NUM_EXTENSIONS, &total);
+      for (GLint index = 0; index < total; ++index)
+      {
+        auto name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(index)));
+        if ((name != nullptr) && (strcmp(name, "GL_EXT_texture_compression_s3tc") == 0))
+        {
+          return true;
+        }
+      }
+      return false;
+    }();
+    return result;
+  }
+
+  bool IsTextureFile(const std::string& filename)
+  {
+    const char ext[] = ".tex";
+    return (filename.size() >= sizeof(ext) - 1)
+      && (filename.compare(filename.size() - (sizeof(ext) - 1), sizeof(ext) - 1, ext) == 0);
+  }
+
   GLint FilterString(const std::string& filterName)
   {
     if (filterName.compare("nearest") == 0)
@@ -138,6 +176,77 @@ namespace bb
     glBindTexture(GL_TEXTURE_2D, 0);
   }
 
+  texture_t::texture_t(int width, int height, const uint8_t* data)
+  {
+    assert((width != 0) && (height != 0));
+
+    glGenTextures(1, &this->self);
+    glBindTexture(GL_TEXTURE_2D, this->self);
+    // single channel rows are not 4-byte aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+  }
+
+  texture_t::texture_t(const textureFile_t& file)
+  :self(0)
+  {
+    assert(file.IsGood());
+
+    GLenum compressed = GL_NONE;
+    switch (file.Format())
+    {
+    case textureFormat_t::rgba8:
+      break;
+    case textureFormat_t::bc1:
+      compressed = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+      break;
+    case textureFormat_t::bc3:
+      compressed = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+      break;
+    }
+
+    if ((compressed != GL_NONE) && !HasS3TC())
+    {
+      throw std::runtime_error("Texture: S3TC compression is not supported");
+    }
+
+    const auto& levels = file.Levels();
+
+    glGenTextures(1, &this->self);
+    glBindTexture(GL_TEXTURE_2D, this->self);
+    for (size_t index = 0; index < levels.size(); ++index)
+    {
+      const auto& level = levels[index];
+      if (compressed == GL_NONE)
+      {
+        glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(index), GL_RGBA, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, level.data);
+      }
+      else
+      {
+        glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(index), compressed, level.width, level.height, 0, static_cast<GLsizei>(level.size), level.data);
+      }
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(levels.size() - 1));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+  }
+
+  void texture_t::Update(int x, int y, int width, int height, GLenum format, GLenum type, const void* data)
+  {
+    assert(this->self != 0);
+    assert(data != nullptr);
+    glBindTexture(GL_TEXTURE_2D, this->self);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, format, type, data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+  }
+
   void texture_t::SetFilter(GLint minFiler, GLint magFilter)
   {
     assert(this->self != 0);
@@ -155,17 +264,47 @@ namespace bb
     glBindTexture(GL_TEXTURE_2D, 0);
   }
 
+  void texture_t::ApplyConfig(const config_t& config, bool hasMipmaps)
+  {
+    std::string minFilter = config.Value("texture.min", "nearest");
+    std::string magFilter = config.Value("texture.mag", "nearest");
+
+    this->SetFilter(FilterString(minFilter), FilterString(magFilter));
+
+    if ((config.Value("texture.mipmaps", 0.0) != 0.0) && !hasMipmaps)
+    {
+      this->GenerateMipmaps();
+    }
+  }
+
   void texture_t::Bind(const texture_t& tex)
   {
     glBindTexture(GL_TEXTURE_2D, tex.self);
   }
 
+  void texture_t::Bind(const texture_t& tex, GLuint unit)
+  {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, tex.self);
+    glActiveTexture(GL_TEXTURE0);
+  }
+
   texture_t texture_t::LoadTGA(const std::string& filename)
   {
     image_t img = bb::LoadTGA(filename);
     return texture_t(img.Width(), img.Height(), img.Depth(), img.Data());
   }
 
+  texture_t texture_t::LoadTexture(const std::string& filename)
+  {
+    auto file = textureFile_t::Map(filename.c_str());
+    if (!file.IsGood())
+    {
+      throw std::runtime_error(std::string("Texture: can't load ") + filename);
+    }
+    return texture_t(file);
+  }
+
   texture_t texture_t::LoadConfig(const config_t& config)
   {
     std::string imgFile = config.Value("texture.image", "");
@@ -174,17 +313,37 @@ namespace bb
       throw std::runtime_error("Texture image filename not found");
     }
 
-    texture_t result = texture_t::LoadTGA(imgFile);
-
-    std::string minFilter = config.Value("texture.min", "nearest");
-    std::string magFilter = config.Value("texture.mag", "nearest");
+    texture_t result;
+    bool hasMipmaps = false;
+    if (IsTextureFile(imgFile))
+    { // levels are baked offline
+      auto file = textureFile_t::Map(imgFile.c_str());
+      if (!file.IsGood())
+      {
+        throw std::runtime_error(std::string("Texture: can't load ") + imgFile);
+      }
 
-    result.SetFilter(FilterString(minFilter), FilterString(magFilter));
+      if ((file.Format() != textureFormat_t::rgba8) && (!HasS3TC()))
+      { // compressed levels can't be uploaded, use source image
+        imgFile = config.Value("texture.fallback", "");
+        if (imgFile.empty())
+        {
+          throw std::runtime_error("Texture: S3TC compression is not supported");
+        }
+      }
+      else
+      {
+        hasMipmaps = (file.Levels().size() > 1);
+        result = texture_t(file);
+      }
+    }
 
-    if (config.Value("texture.mipmaps", 0.0) != 0.0)
+    if (result.self == 0)
     {
-      result.GenerateMipmaps();
+      result = texture_t::LoadTGA(imgFile);
     }
+
+    result.ApplyConfig(config, hasMipmaps);
     return result;
   }
 
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cassert>
 
 #include <vao.hpp>
@@ -6,10 +7,11 @@ namespace bb
 {
 
   vbo_t::vbo_t(vbo_t &&move) noexcept
-  :self(move.self),type(move.type)
+  :self(move.self),type(move.type),capacity(move.capacity)
   {
     move.self = 0;
     move.type = 0;
+    move.capacity = 0;
   }
 
   vbo_t &vbo_t::operator=(vbo_t &&move) noexcept
@@ -26,13 +28,15 @@ namespace bb
 
     this->self = move.self;
     this->type = move.type;
+    this->capacity = move.capacity;
     move.self = 0;
     move.type = 0;
+    move.capacity = 0;
     return *this;
   }
 
   vbo_t::vbo_t()
-  :self(0),type(0)
+  :self(0),type(0),capacity(0)
   {
     ;
   }
@@ -45,8 +49,8 @@ namespace bb
     }
   }
 
-  vbo_t::vbo_t(GLuint self, GLenum type)
-  :self(self),type(type)
+  vbo_t::vbo_t(GLuint self, GLenum type, size_t capacity)
+  :self(self),type(type),capacity(capacity)
   {
     ;
   }
@@ -58,6 +62,22 @@ namespace bb
     glBindBuffer(this->type, 0);
   }
 
+  void vbo_t::Upload(const void* data, size_t size)
+  {
+    assert(this->self != 0);
+
+    // element array binding is part of VAO state
+    glBindVertexArray(0);
+    glBindBuffer(this->type, this->self);
+    if (size > this->capacity)
+    {
+      this->capacity = std::max(size, this->capacity + this->capacity/2);
+    }
+    glBufferData(this->type, static_cast<GLsizeiptr>(this->capacity), nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(this->type, 0, static_cast<GLsizeiptr>(size), data);
+    glBindBuffer(this->type, 0);
+  }
+
   vbo_t vbo_t::CreateArrayBuffer(const void* data, size_t dataSize, bool dynamic)
   {
     GLuint vbo;
@@ -67,7 +87,7 @@ namespace bb
     glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(dataSize), data, (dynamic)?GL_DYNAMIC_DRAW:GL_STATIC_DRAW);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-    return vbo_t(vbo, GL_ARRAY_BUFFER);
+    return vbo_t(vbo, GL_ARRAY_BUFFER, dataSize);
   }
 
   vbo_t vbo_t::CreateElementArrayBuffer(const void* data, size_t dataSize, bool dynamic)
@@ -79,7 +99,7 @@ namespace bb
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(dataSize), data, (dynamic)?GL_DYNAMIC_DRAW:GL_STATIC_DRAW);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
-    return vbo_t(vbo, GL_ELEMENT_ARRAY_BUFFER);
+    return vbo_t(vbo, GL_ELEMENT_ARRAY_BUFFER, dataSize);
   }
 
   vao_t::vao_t(vao_t&& move)
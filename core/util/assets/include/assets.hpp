@@ -0,0 +1,419 @@
+/**
+ * @file assets.hpp
+ *
+ * Asynchronous asset loading service.
+ *
+ * Files are read and decoded by loader actors on worker threads. Decoded
+ * data is mailed back and uploaded by Update on render thread, no more
+ * than budget bytes per call. Requests are deduplicated by asset type and
+ * path: they give the same handle, until Purge drops unused ones.
+ *
+ * Handles are pending, until Update uploads them, scenes poll IsReady().
+ * Service and handles must be used only from render thread.
+ *
+ * With hot reload enabled, changed files are loaded again on workers and
+ * uploaded in place of old data by Update, then subscribers are notified
+ * with msg::assetChanged_t. When reload fails, previous version is kept.
+ *
+ */
+
+#pragma once
+#ifndef __BB_CORE_UTIL_ASSETS_HEADER__
+#define __BB_CORE_UTIL_ASSETS_HEADER__
+
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <config.hpp>
+#include <mailbox.hpp>
+#include <monfs.hpp>
+#include <shader.hpp>
+#include <shapes.hpp>
+#include <texture.hpp>
+
+namespace bb
+{
+
+  using assetClock_t = std::chrono::steady_clock;
+
+  enum class assetState_t
+  {
+    pending = 0,
+    ready,
+    failed
+  };
+
+  class basicAsset_t
+  {
+    friend class assets_t;
+
+    std::string key;
+    assetState_t state;
+    assetClock_t::time_point requested;
+    double loadTime;
+    double latency;
+    uint32_t generation;
+    std::string changed;
+
+    basicAsset_t(const basicAsset_t&) = delete;
+    basicAsset_t& operator=(const basicAsset_t&) = delete;
+
+  public:
+
+    /**
+     * Cache key, asset type and file path.
+     */
+    const std::string& Key() const;
+
+    assetState_t State() const;
+
+    bool IsReady() const;
+
+    bool IsFailed() const;
+
+    /**
+     * Seconds spent reading and decoding on worker.
+     */
+    double LoadTime() const;
+
+    /**
+     * Seconds from request until asset was uploaded or failed.
+     */
+    double Latency() const;
+
+    explicit basicAsset_t(const std::string& key);
+    virtual ~basicAsset_t();
+  };
+
+  template<typename data_t>
+  class asset_t final: public basicAsset_t
+  {
+    data_t data;
+
+  public:
+
+    const data_t& Get() const;
+    data_t& Get();
+
+    explicit asset_t(const std::string& key);
+    ~asset_t() override = default;
+  };
+
+  using textureAsset_t = std::shared_ptr<asset_t<texture_t>>;
+  using shaderAsset_t = std::shared_ptr<asset_t<shader_t>>;
+  using meshAsset_t = std::shared_ptr<asset_t<mesh_t>>;
+  using configAsset_t = std::shared_ptr<asset_t<config_t>>;
+
+  /**
+   * Decoded asset, which is uploaded on render thread.
+   */
+  class assetBlob_t
+  {
+  public:
+
+    /**
+     * Bytes to upload, counted against Update budget.
+     */
+    virtual size_t ByteSize() const = 0;
+
+    /**
+     * Make asset data from blob.
+     *
+     * @throw std::runtime_error on errors
+     */
+    virtual void Upload(basicAsset_t& target) = 0;
+
+    /**
+     * Files found while decoding, which must be watched too, like image of
+     * texture config.
+     */
+    virtual std::vector<std::string> Sources() const;
+
+    virtual ~assetBlob_t();
+  };
+
+  namespace msg
+  {
+
+    /**
+     * Asset was reloaded, because one of its files changed.
+     */
+    class assetChanged_t final: public basic_t
+    {
+      std::string key;
+      std::string filename;
+      std::shared_ptr<const config_t> config;
+
+    public:
+
+      /**
+       * Cache key of reloaded asset.
+       */
+      const std::string& Key() const
+      {
+        return this->key;
+      }
+
+      /**
+       * Changed file.
+       */
+      const std::string& Filename() const
+      {
+        return this->filename;
+      }
+
+      /**
+       * Copy of reloaded config, nullptr for other assets.
+       *
+       * Subscribers may run on workers, so they get own copy, which is
+       * never changed, instead of reading file again.
+       */
+      const config_t* Config() const
+      {
+        return this->config.get();
+      }
+
+      assetChanged_t(const std::string& key, const std::string& filename, const std::shared_ptr<const config_t>& config)
+      : key(key),
+        filename(filename),
+        config(config)
+      {
+        ;
+      }
+
+      ~assetChanged_t() override = default;
+    };
+
+  } // namespace msg
+
+  using uniqueBlob_t = std::unique_ptr<assetBlob_t>;
+
+  class assets_t final
+  {
+  public:
+
+    /**
+     * Runs on worker, reads and decodes asset.
+     *
+     * @throw std::runtime_error on errors
+     */
+    using load_t = std::function<uniqueBlob_t()>;
+
+  private:
+
+    struct upload_t
+    {
+      std::shared_ptr<basicAsset_t> asset;
+      uint32_t generation;
+      uniqueBlob_t blob;
+    };
+
+    using cache_t = std::unordered_map<std::string, std::shared_ptr<basicAsset_t>>;
+
+    mailbox_t::shared_t box;
+    std::vector<actorPID_t> loaders;
+    size_t nextLoader;
+    cache_t cache;
+    std::unordered_map<std::string, load_t> loads;
+    std::deque<upload_t> uploads;
+    size_t inFlight;
+    size_t budget;
+
+    // file to keys of assets, made from it
+    std::unordered_map<std::string, std::vector<std::string>> dependents;
+    std::unique_ptr<fs::watcher_t> watcher;
+    std::vector<postAddress_t> boxSubscribers;
+    std::vector<actorPID_t> actorSubscribers;
+
+    assets_t(const assets_t&) = delete;
+    assets_t& operator=(const assets_t&) = delete;
+    assets_t(assets_t&&) = delete;
+    assets_t& operator=(assets_t&&) = delete;
+
+    void Post(basicAsset_t& asset);
+    void Finish(basicAsset_t& asset, assetState_t state);
+    void Depend(const std::string& key, const std::string& filename);
+    void Reload(const std::string& filename);
+    void Notify(const basicAsset_t& asset);
+
+  public:
+
+    /**
+     * Request asset of any type.
+     *
+     * @param key unique cache key, requests with same key share handle
+     * @param load function, which makes blob on worker
+     */
+    template<typename data_t>
+    std::shared_ptr<asset_t<data_t>> Request(const std::string& key, load_t&& load);
+
+    /**
+     * Texture from .tga, .tex or texture .config file.
+     */
+    textureAsset_t Texture(const std::string& filename);
+
+    shaderAsset_t Shader(const std::string& vpFilename, const std::string& fpFilename);
+
+    /**
+     * Mesh from .msh file.
+     */
+    meshAsset_t Mesh(const std::string& filename);
+
+    configAsset_t Config(const std::string& filename);
+
+    /**
+     * Receive decoded assets and upload them within budget. At least one
+     * asset is uploaded each call, so big ones are never stuck.
+     *
+     * @return bytes uploaded
+     */
+    size_t Update();
+
+    /**
+     * Requested assets, which are not ready or failed yet.
+     */
+    size_t Pending() const;
+
+    /**
+     * Drop loaded assets, which are referenced only by cache.
+     *
+     * @return number of dropped assets
+     */
+    size_t Purge();
+
+    size_t Budget() const;
+    void SetBudget(size_t budget);
+
+    /**
+     * Watch files of requested assets and reload them, when they change.
+     *
+     * @param debounce quiet period after last write, before file is read
+     *
+     * @return 0 on success, -1 if files can't be watched on this platform
+     */
+    int EnableHotReload(std::chrono::milliseconds debounce);
+
+    bool HotReload() const;
+
+    /**
+     * Send msg::assetChanged_t to mailbox after reloads.
+     */
+    void Subscribe(const mailbox_t::shared_t& box);
+
+    /**
+     * Send msg::assetChanged_t to actor after reloads. Actor must
+     * unsubscribe before it is unregistered.
+     */
+    void Subscribe(actorPID_t actor);
+
+    void Unsubscribe(const mailbox_t::shared_t& box);
+    void Unsubscribe(actorPID_t actor);
+
+    explicit assets_t(size_t budget);
+    ~assets_t();
+
+  };
+
+  inline const std::string& basicAsset_t::Key() const
+  {
+    return this->key;
+  }
+
+  inline assetState_t basicAsset_t::State() const
+  {
+    return this->state;
+  }
+
+  inline bool basicAsset_t::IsReady() const
+  {
+    return this->state == assetState_t::ready;
+  }
+
+  inline bool basicAsset_t::IsFailed() const
+  {
+    return this->state == assetState_t::failed;
+  }
+
+  inline double basicAsset_t::LoadTime() const
+  {
+    return this->loadTime;
+  }
+
+  inline double basicAsset_t::Latency() const
+  {
+    return this->latency;
+  }
+
+  template<typename data_t>
+  inline const data_t& asset_t<data_t>::Get() const
+  {
+    assert(this->IsReady());
+    return this->data;
+  }
+
+  template<typename data_t>
+  inline data_t& asset_t<data_t>::Get()
+  {
+    return this->data;
+  }
+
+  template<typename data_t>
+  asset_t<data_t>::asset_t(const std::string& key)
+  : basicAsset_t(key)
+  {
+    ;
+  }
+
+  template<typename data_t>
+  std::shared_ptr<asset_t<data_t>> assets_t::Request(const std::string& key, load_t&& load)
+  {
+    auto cached = this->cache.find(key);
+    if (cached != this->cache.end())
+    {
+      auto result = std::dynamic_pointer_cast<asset_t<data_t>>(cached->second);
+      if (!result)
+      {
+        // Programmer's error!
+        bb::Error("Asset \"%s\" requested with different type", key.c_str());
+        assert(0);
+      }
+      return result;
+    }
+
+    std::shared_ptr<asset_t<data_t>> result(new asset_t<data_t>(key));
+    this->cache.emplace(key, result);
+    this->loads[key] = std::move(load);
+    this->Post(*result);
+    return result;
+  }
+
+  inline size_t assets_t::Pending() const
+  {
+    return this->inFlight + this->uploads.size();
+  }
+
+  inline size_t assets_t::Budget() const
+  {
+    return this->budget;
+  }
+
+  inline void assets_t::SetBudget(size_t budget)
+  {
+    this->budget = budget;
+  }
+
+  inline bool assets_t::HotReload() const
+  {
+    return static_cast<bool>(this->watcher);
+  }
+
+} // namespace bb
+
+#endif /* __BB_CORE_UTIL_ASSETS_HEADER__ */
@@ -0,0 +1,684 @@
+#include <assets.hpp>
+#include <image.hpp>
+#include <textureFile.hpp>
+#include <uploadQueue.hpp>
+#include <worker.hpp>
+#include <role.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace bb
+{
+
+  namespace
+  {
+
+    class assetLoaded_t final: public msg::basic_t
+    {
+      std::string key;
+      uint32_t generation;
+      uniqueBlob_t blob;
+      double loadTime;
+
+    public:
+
+      const std::string& Key() const
+      {
+        return this->key;
+      }
+
+      uint32_t Generation() const
+      {
+        return this->generation;
+      }
+
+      uniqueBlob_t& Blob()
+      {
+        return this->blob;
+      }
+
+      double LoadTime() const
+      {
+        return this->loadTime;
+      }
+
+      assetLoaded_t(const std::string& key, uint32_t generation, uniqueBlob_t&& blob, double loadTime)
+      : key(key),
+        generation(generation),
+        blob(std::move(blob)),
+        loadTime(loadTime)
+      {
+        ;
+      }
+
+      ~assetLoaded_t() override = default;
+    };
+
+    class fileChanged_t final: public msg::basic_t
+    {
+      std::string filename;
+
+    public:
+
+      const std::string& Filename() const
+      {
+        return this->filename;
+      }
+
+      fileChanged_t(const std::string& filename)
+      : filename(filename)
+      {
+        ;
+      }
+
+      ~fileChanged_t() override = default;
+    };
+
+    std::string ReadText(const std::string& filename)
+    {
+      std::ifstream input(filename, std::ios::in);
+      if (!input)
+      {
+        throw std::runtime_error(std::string("Can't open ") + filename);
+      }
+      std::stringstream text;
+      text << input.rdbuf();
+      return text.str();
+    }
+
+    bool HasExtension(const std::string& filename, const char* ext)
+    {
+      size_t extLen = strlen(ext);
+      return (filename.size() >= extLen)
+        && (filename.compare(filename.size() - extLen, extLen, ext) == 0);
+    }
+
+    class textureBlob_t final: public assetBlob_t
+    {
+      image_t image;
+      textureFile_t file;
+      std::unique_ptr<config_t> config;
+      std::string imageFile;
+
+    public:
+
+      size_t ByteSize() const override
+      {
+        if (this->file.IsGood())
+        {
+          size_t result = 0;
+          for (auto& level: this->file.Levels())
+          {
+            result += level.size;
+          }
+          return result;
+        }
+        return static_cast<size_t>(this->image.Width()*this->image.Height()*this->image.Depth());
+      }
+
+      void Upload(basicAsset_t& target) override
+      {
+        auto& texture = static_cast<asset_t<texture_t>&>(target).Get();
+        if (this->file.IsGood())
+        {
+          texture = texture_t(this->file);
+        }
+        else
+        {
+          texture = texture_t(this->image.Width(), this->image.Height(), this->image.Depth(), this->image.Data());
+        }
+
+        if (this->config)
+        {
+          texture.ApplyConfig(*this->config, this->file.IsGood() && (this->file.Levels().size() > 1));
+        }
+      }
+
+      std::vector<std::string> Sources() const override
+      {
+        if (this->config)
+        {
+          return std::vector<std::string>(1, this->imageFile);
+        }
+        return std::vector<std::string>();
+      }
+
+      textureBlob_t(const std::string& filename)
+      : imageFile(filename)
+      {
+        if (HasExtension(filename, ".config"))
+        {
+          this->config.reset(new config_t(filename));
+          this->imageFile = this->config->Value("texture.image", "");
+          if (this->imageFile.empty())
+          {
+            throw std::runtime_error("Texture image filename not found");
+          }
+        }
+
+        if (HasExtension(this->imageFile, ".tex"))
+        {
+          this->file = textureFile_t::Map(this->imageFile.c_str());
+          if (!this->file.IsGood())
+          {
+            throw std::runtime_error(std::string("Texture: can't load ") + this->imageFile);
+          }
+        }
+        else
+        {
+          this->image = LoadTGA(this->imageFile);
+        }
+      }
+
+      ~textureBlob_t() override = default;
+    };
+
+    class shaderBlob_t final: public assetBlob_t
+    {
+      std::string vpSource;
+      std::string fpSource;
+
+    public:
+
+      size_t ByteSize() const override
+      {
+        return this->vpSource.size() + this->fpSource.size();
+      }
+
+      void Upload(basicAsset_t& target) override
+      {
+        static_cast<asset_t<shader_t>&>(target).Get() = shader_t(this->vpSource.c_str(), this->fpSource.c_str());
+      }
+
+      shaderBlob_t(const std::string& vpFilename, const std::string& fpFilename)
+      : vpSource(ReadText(vpFilename)),
+        fpSource(ReadText(fpFilename))
+      {
+        ;
+      }
+
+      ~shaderBlob_t() override = default;
+    };
+
+    class meshBlob_t final: public assetBlob_t
+    {
+      meshDesc_t desc;
+
+    public:
+
+      size_t ByteSize() const override
+      {
+        return uploadQueue_t::ByteSize(this->desc);
+      }
+
+      void Upload(basicAsset_t& target) override
+      {
+        static_cast<asset_t<mesh_t>&>(target).Get() = GenerateMesh(this->desc);
+      }
+
+      meshBlob_t(const std::string& filename)
+      : desc(meshDesc_t::Map(filename.c_str()))
+      {
+        if (!this->desc.IsGood())
+        {
+          throw std::runtime_error(std::string("Mesh: can't load ") + filename);
+        }
+      }
+
+      ~meshBlob_t() override = default;
+    };
+
+    class configBlob_t final: public assetBlob_t
+    {
+      config_t config;
+
+    public:
+
+      size_t ByteSize() const override
+      { // nothing goes to GPU
+        return 0;
+      }
+
+      void Upload(basicAsset_t& target) override
+      {
+        static_cast<asset_t<config_t>&>(target).Get() = std::move(this->config);
+      }
+
+      configBlob_t(const std::string& filename)
+      : config(filename)
+      {
+        ;
+      }
+
+      ~configBlob_t() override = default;
+    };
+
+  } // namespace
+
+  basicAsset_t::basicAsset_t(const std::string& key)
+  : key(key),
+    state(assetState_t::pending),
+    requested(assetClock_t::now()),
+    loadTime(0.0),
+    latency(0.0),
+    generation(0)
+  {
+    ;
+  }
+
+  basicAsset_t::~basicAsset_t()
+  {
+    ;
+  }
+
+  std::vector<std::string> assetBlob_t::Sources() const
+  {
+    return std::vector<std::string>();
+  }
+
+  assetBlob_t::~assetBlob_t()
+  {
+    ;
+  }
+
+  assets_t::assets_t(size_t budget)
+  : box(postOffice_t::Instance().New(GenerateUniqueName())),
+    nextLoader(0),
+    inFlight(0),
+    budget(budget)
+  {
+    // render thread keeps one core busy
+    auto loaderCount = std::max<size_t>(std::thread::hardware_concurrency(), 2) - 1;
+
+    auto& pool = workerPool_t::Instance();
+    this->loaders.reserve(loaderCount);
+    for (size_t i = 0; i < loaderCount; ++i)
+    {
+      this->loaders.emplace_back(pool.Register<execTask_t>());
+    }
+  }
+
+  assets_t::~assets_t()
+  {
+    // no more changes are posted
+    this->watcher.reset();
+
+    // decoded blobs of running requests are dropped with mailbox
+    auto& pool = workerPool_t::Instance();
+    for (auto loader: this->loaders)
+    {
+      pool.Unregister(loader);
+    }
+  }
+
+  void assets_t::Post(basicAsset_t& asset)
+  {
+    auto key = asset.key;
+    auto generation = asset.generation;
+    auto load = this->loads.at(key);
+    auto address = this->box->Address();
+    auto task = [key, generation, load, address]() -> msg::result_t
+    {
+      auto start = assetClock_t::now();
+      uniqueBlob_t blob;
+      try
+      {
+        blob = load();
+      }
+      catch (const std::exception& error)
+      {
+        bb::Error("Asset \"%s\" load failed: %s", key.c_str(), error.what());
+      }
+      double loadTime = std::chrono::duration<double>(assetClock_t::now() - start).count();
+
+      postOffice_t::Instance().Post(address, Issue<assetLoaded_t>(key, generation, std::move(blob), loadTime));
+      return msg::result_t::complete;
+    };
+
+    workerPool_t::Instance().PostMessage(
+      this->loaders[this->nextLoader],
+      msg_t(new msg::execTask_t<decltype(task)>(task))
+    );
+    this->nextLoader = (this->nextLoader + 1) % this->loaders.size();
+    ++this->inFlight;
+  }
+
+  void assets_t::Finish(basicAsset_t& asset, assetState_t state)
+  {
+    asset.state = state;
+    asset.latency = std::chrono::duration<double>(assetClock_t::now() - asset.requested).count();
+    bb::Debug("Asset \"%s\" %s: load %.3f ms, latency %.3f ms",
+      asset.key.c_str(),
+      (state == assetState_t::ready)?("ready"):("failed"),
+      asset.loadTime*1000.0,
+      asset.latency*1000.0
+    );
+  }
+
+  void assets_t::Depend(const std::string& key, const std::string& filename)
+  {
+    auto& keys = this->dependents[filename];
+    if (std::find(keys.begin(), keys.end(), key) != keys.end())
+    {
+      return;
+    }
+
+    if (keys.empty() && this->watcher)
+    {
+      this->watcher->Watch(filename);
+    }
+    keys.push_back(key);
+  }
+
+  void assets_t::Reload(const std::string& filename)
+  {
+    auto keys = this->dependents.find(filename);
+    if (keys == this->dependents.end())
+    {
+      return;
+    }
+
+    for (auto& key: keys->second)
+    {
+      auto cached = this->cache.find(key);
+      if (cached == this->cache.end())
+      { // purged
+        continue;
+      }
+
+      auto& asset = *cached->second;
+      bb::Debug("Asset \"%s\" changed by \"%s\", reloading", key.c_str(), filename.c_str());
+
+      // results of older loads are dropped
+      ++asset.generation;
+      asset.requested = assetClock_t::now();
+      asset.changed = filename;
+      this->Post(asset);
+    }
+  }
+
+  void assets_t::Notify(const basicAsset_t& asset)
+  {
+    std::shared_ptr<const config_t> config;
+    if (auto configAsset = dynamic_cast<const asset_t<config_t>*>(&asset))
+    {
+      config.reset(new config_t(configAsset->Get().Copy()));
+    }
+
+    for (auto it = this->boxSubscribers.begin(); it != this->boxSubscribers.end();)
+    {
+      if (postOffice_t::Instance().Post(*it, Issue<msg::assetChanged_t>(asset.key, asset.changed, config)) != 0)
+      { // mailbox is destroyed
+        it = this->boxSubscribers.erase(it);
+        continue;
+      }
+      ++it;
+    }
+
+    for (auto actor: this->actorSubscribers)
+    {
+      workerPool_t::Instance().PostMessage(actor, Issue<msg::assetChanged_t>(asset.key, asset.changed, config));
+    }
+  }
+
+  size_t assets_t::Update()
+  {
+    msg_t msg;
+    while (this->box->Poll(&msg))
+    {
+      if (auto changed = As<fileChanged_t>(msg))
+      {
+        this->Reload(changed->Filename());
+        continue;
+      }
+
+      auto loaded = As<assetLoaded_t>(msg);
+      if (loaded == nullptr)
+      { // nobody else knows this mailbox
+        assert(0);
+        continue;
+      }
+      --this->inFlight;
+
+      auto cached = this->cache.find(loaded->Key());
+      if (cached == this->cache.end())
+      { // pending assets are never purged, so it was reload
+        continue;
+      }
+
+      auto& asset = *cached->second;
+      if (loaded->Generation() != asset.generation)
+      { // file changed again, while it was loaded
+        continue;
+      }
+      asset.loadTime = loaded->LoadTime();
+
+      if (!loaded->Blob())
+      {
+        if (asset.state == assetState_t::ready)
+        {
+          bb::Error("Asset \"%s\" reload failed, previous version kept", asset.key.c_str());
+          continue;
+        }
+        this->Finish(asset, assetState_t::failed);
+        continue;
+      }
+      this->uploads.push_back(upload_t{ cached->second, asset.generation, std::move(loaded->Blob()) });
+    }
+
+    size_t frameBytes = 0;
+    while (!this->uploads.empty())
+    {
+      auto& upload = this->uploads.front();
+      auto& asset = *upload.asset;
+      if (upload.generation != asset.generation)
+      { // newer version is loading
+        this->uploads.pop_front();
+        continue;
+      }
+
+      size_t bytes = upload.blob->ByteSize();
+      if ((frameBytes != 0) && (frameBytes + bytes > this->budget))
+      {
+        break;
+      }
+
+      const bool reload = (asset.state != assetState_t::pending);
+      try
+      {
+        upload.blob->Upload(asset);
+        this->Finish(asset, assetState_t::ready);
+        for (auto& source: upload.blob->Sources())
+        {
+          this->Depend(asset.key, source);
+        }
+        if (reload)
+        {
+          this->Notify(asset);
+        }
+      }
+      catch (const std::exception& error)
+      {
+        bb::Error("Asset \"%s\" upload failed: %s", asset.key.c_str(), error.what());
+        if (asset.state != assetState_t::ready)
+        {
+          this->Finish(asset, assetState_t::failed);
+        }
+      }
+
+      frameBytes += bytes;
+      this->uploads.pop_front();
+    }
+    return frameBytes;
+  }
+
+  size_t assets_t::Purge()
+  {
+    size_t result = 0;
+    for (auto it = this->cache.begin(); it != this->cache.end();)
+    {
+      if ((it->second->State() != assetState_t::pending) && (it->second.use_count() == 1))
+      {
+        this->loads.erase(it->first);
+        it = this->cache.erase(it);
+        ++result;
+        continue;
+      }
+      ++it;
+    }
+
+    if (result == 0)
+    {
+      return 0;
+    }
+
+    // files stay watched, their changes are ignored, when nothing depends on them
+    for (auto it = this->dependents.begin(); it != this->dependents.end();)
+    {
+      auto& keys = it->second;
+      keys.erase(
+        std::remove_if(keys.begin(), keys.end(),
+          [this](const std::string& key)
+          {
+            return this->cache.find(key) == this->cache.end();
+          }
+        ),
+        keys.end()
+      );
+      if (keys.empty())
+      {
+        it = this->dependents.erase(it);
+        continue;
+      }
+      ++it;
+    }
+    return result;
+  }
+
+  textureAsset_t assets_t::Texture(const std::string& filename)
+  {
+    auto key = "texture:" + filename;
+    auto result = this->Request<texture_t>(
+      key,
+      [filename]() -> uniqueBlob_t
+      {
+        return uniqueBlob_t(new textureBlob_t(filename));
+      }
+    );
+    this->Depend(key, filename);
+    return result;
+  }
+
+  shaderAsset_t assets_t::Shader(const std::string& vpFilename, const std::string& fpFilename)
+  {
+    auto key = "shader:" + vpFilename + "|" + fpFilename;
+    auto result = this->Request<shader_t>(
+      key,
+      [vpFilename, fpFilename]() -> uniqueBlob_t
+      {
+        return uniqueBlob_t(new shaderBlob_t(vpFilename, fpFilename));
+      }
+    );
+    this->Depend(key, vpFilename);
+    this->Depend(key, fpFilename);
+    return result;
+  }
+
+  meshAsset_t assets_t::Mesh(const std::string& filename)
+  {
+    auto key = "mesh:" + filename;
+    auto result = this->Request<mesh_t>(
+      key,
+      [filename]() -> uniqueBlob_t
+      {
+        return uniqueBlob_t(new meshBlob_t(filename));
+      }
+    );
+    this->Depend(key, filename);
+    return result;
+  }
+
+  configAsset_t assets_t::Config(const std::string& filename)
+  {
+    auto key = "config:" + filename;
+    auto result = this->Request<config_t>(
+      key,
+      [filename]() -> uniqueBlob_t
+      {
+        return uniqueBlob_t(new configBlob_t(filename));
+      }
+    );
+    this->Depend(key, filename);
+    return result;
+  }
+
+  int assets_t::EnableHotReload(std::chrono::milliseconds debounce)
+  {
+    if (this->watcher)
+    {
+      return 0;
+    }
+
+    auto address = this->box->Address();
+    this->watcher.reset(
+      new fs::watcher_t(
+        [address](const std::string& filename)
+        {
+          postOffice_t::Instance().Post(address, Issue<fileChanged_t>(filename));
+        },
+        debounce
+      )
+    );
+
+    if (!this->watcher->IsGood())
+    {
+      bb::Warning("%s", "Asset hot reload is not supported");
+      this->watcher.reset();
+      return -1;
+    }
+
+    for (auto& item: this->dependents)
+    {
+      this->watcher->Watch(item.first);
+    }
+    return 0;
+  }
+
+  void assets_t::Subscribe(const mailbox_t::shared_t& box)
+  {
+    if (std::find(this->boxSubscribers.begin(), this->boxSubscribers.end(), box->Address()) == this->boxSubscribers.end())
+    {
+      this->boxSubscribers.push_back(box->Address());
+    }
+  }
+
+  void assets_t::Subscribe(actorPID_t actor)
+  {
+    if (std::find(this->actorSubscribers.begin(), this->actorSubscribers.end(), actor) == this->actorSubscribers.end())
+    {
+      this->actorSubscribers.push_back(actor);
+    }
+  }
+
+  void assets_t::Unsubscribe(const mailbox_t::shared_t& box)
+  {
+    this->boxSubscribers.erase(
+      std::remove(this->boxSubscribers.begin(), this->boxSubscribers.end(), box->Address()),
+      this->boxSubscribers.end()
+    );
+  }
+
+  void assets_t::Unsubscribe(actorPID_t actor)
+  {
+    this->actorSubscribers.erase(
+      std::remove(this->actorSubscribers.begin(), this->actorSubscribers.end(), actor),
+      this->actorSubscribers.end()
+    );
+  }
+
+} // namespace bb
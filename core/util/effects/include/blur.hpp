@@ -1,7 +1,16 @@
 /**
  * @file blur.hpp
  *
- * Simple gaussian blur effect
+ * Blur/bloom effect with downsample chain.
+ *
+ * Source is downsampled by half for every level, so most work is done on
+ * small images and total cost stays near O(pixels/4) for large radius.
+ *
+ * Two kernels available:
+ *  - gaussian: separable gaussian on smallest level, weights generated from
+ *    radius and packed into linear-sampled taps;
+ *  - dual: dual filter (Kawase like) down/up sampling, radius is mostly
+ *    given by number of levels.
  *
  */
 
@@ -15,27 +24,68 @@
 #include <shader.hpp>
 #include <framebuffer.hpp>
 
+#include <vector>
+
 namespace bb
 {
 
+  enum class blurKernel_t
+  {
+    gaussian,
+    dual
+  };
+
   class blur_t
   {
+  public:
+
+    static const int maxTaps = 16;
+
+  private:
+
+    struct program_t
+    {
+      bb::shader_t shader;
+      GLint tex;
+      GLint halfpixel;
+      GLint offset;
+      GLint dir;
+    };
+
     bb::mesh_t plane;
-    bb::shader_t shader;
+    program_t down;
+    program_t up;
+    program_t kernel;
+    std::vector<bb::framebuffer_t> chain;
     bb::framebuffer_t temp;
     bb::framebuffer_t* src;
     bb::framebuffer_t* dst;
-    int fboSize;
+    blurKernel_t mode;
+    float offset;
 
     blur_t(const blur_t&) = delete;
     blur_t& operator=(const blur_t&) = delete;
 
+    void Pass(const program_t& prog, bb::framebuffer_t& from, bb::framebuffer_t& to);
+
   public:
 
     void Render();
 
+    size_t Levels() const;
+
     blur_t();
-    blur_t(bb::framebuffer_t* src, bb::framebuffer_t* dst, int fboSize);
+
+    /**
+     * Create blur effect.
+     *
+     * @param src source framebuffer
+     * @param dst destination framebuffer, must have same size as src
+     * @param radius blur radius in source pixels
+     * @param levels number of downsample levels, negative - choose by radius
+     * @param mode blur kernel
+     */
+    blur_t(bb::framebuffer_t* src, bb::framebuffer_t* dst, float radius, int levels, blurKernel_t mode);
     ~blur_t();
 
     blur_t(blur_t&&) = default;
@@ -43,6 +93,11 @@ namespace bb
 
   };
 
+  inline size_t blur_t::Levels() const
+  {
+    return this->chain.size();
+  }
+
 } // namespace bb
 
 #endif /* __BB_UTIL_BLUR_HEADER__ */
@@ -0,0 +1,57 @@
+/**
+ * @file profilerOverlay.hpp
+ *
+ * On-screen GPU profiler results, drawn with vector font
+ *
+ */
+
+#pragma once
+#ifndef __BB_UTIL_PROFILER_OVERLAY_HEADER__
+#define __BB_UTIL_PROFILER_OVERLAY_HEADER__
+
+#include <common.hpp>
+#include <camera.hpp>
+#include <shapes.hpp>
+#include <shader.hpp>
+#include <profiler.hpp>
+
+namespace bb
+{
+
+  class profilerOverlay_t
+  {
+    bb::shader_t shader;
+    bb::camera_t camera;
+    bb::mesh_t text;
+    double time;
+
+    profilerOverlay_t(const profilerOverlay_t&) = delete;
+    profilerOverlay_t& operator=(const profilerOverlay_t&) = delete;
+
+    void Rebuild();
+
+  public:
+
+    /**
+     * Rebuild text from profiler stats, not more often than twice per second.
+     */
+    void Update(double dt);
+
+    /**
+     * Draw overlay into currently bound framebuffer.
+     * Does nothing, when profiler is disabled.
+     */
+    void Render();
+
+    profilerOverlay_t();
+    explicit profilerOverlay_t(float aspect);
+    ~profilerOverlay_t();
+
+    profilerOverlay_t(profilerOverlay_t&&) = default;
+    profilerOverlay_t& operator=(profilerOverlay_t&&) = default;
+
+  };
+
+} // namespace bb
+
+#endif /* __BB_UTIL_PROFILER_OVERLAY_HEADER__ */
@@ -1,4 +1,8 @@
 #include <blur.hpp>
+#include <profiler.hpp>
+
+#include <algorithm>
+#include <cmath>
 
 namespace
 {
@@ -18,7 +22,7 @@ namespace
     }
   )raw";
 
-  const char* blurFShader =
+  const char* copyFShader =
   R"raw(
     #version 330 core
 
@@ -27,79 +31,334 @@ namespace
     in vec2 fragUV;
 
     uniform sampler2D tex;
-    uniform float resolution;
-    uniform float radius;
-    uniform vec2 dir;
 
     void main()
     {
-      vec4 sum = vec4(0.0);
+      pixColor = texture(tex, fragUV);
+    }
+  )raw";
+
+  const char* dualDownFShader =
+  R"raw(
+    #version 330 core
+
+    layout(location = 0) out vec4 pixColor;
+
+    in vec2 fragUV;
+
+    uniform sampler2D tex;
+    uniform vec2 halfpixel;
+    uniform float offset;
+
+    void main()
+    {
+      vec2 hp = halfpixel*offset;
 
-      vec2 tc = fragUV;
+      vec4 sum = texture(tex, fragUV) * 4.0;
+      sum += texture(tex, fragUV - hp);
+      sum += texture(tex, fragUV + hp);
+      sum += texture(tex, fragUV + vec2(hp.x, -hp.y));
+      sum += texture(tex, fragUV - vec2(hp.x, -hp.y));
+
+      pixColor = sum / 8.0;
+    }
+  )raw";
+
+  const char* dualUpFShader =
+  R"raw(
+    #version 330 core
 
-      float blur = radius/resolution;
+    layout(location = 0) out vec4 pixColor;
 
-      float hstep = dir.x;
-      float vstep = dir.y;
+    in vec2 fragUV;
 
-      sum += texture(tex, vec2(tc.x - 4.0*blur*hstep, tc.y - 4.0*blur*vstep)) * 0.0162162162;
-      sum += texture(tex, vec2(tc.x - 3.0*blur*hstep, tc.y - 3.0*blur*vstep)) * 0.0540540541;
-      sum += texture(tex, vec2(tc.x - 2.0*blur*hstep, tc.y - 2.0*blur*vstep)) * 0.1216216216;
-      sum += texture(tex, vec2(tc.x - 1.0*blur*hstep, tc.y - 1.0*blur*vstep)) * 0.1945945946;
+    uniform sampler2D tex;
+    uniform vec2 halfpixel;
+    uniform float offset;
 
-      sum += texture(tex, vec2(tc.x, tc.y)) * 0.2270270270;
+    void main()
+    {
+      vec2 hp = halfpixel*offset;
 
-      sum += texture(tex, vec2(tc.x + 1.0*blur*hstep, tc.y + 4.0*blur*vstep)) * 0.1945945946;
-      sum += texture(tex, vec2(tc.x + 2.0*blur*hstep, tc.y + 3.0*blur*vstep)) * 0.1216216216;
-      sum += texture(tex, vec2(tc.x + 3.0*blur*hstep, tc.y + 2.0*blur*vstep)) * 0.0540540541;
-      sum += texture(tex, vec2(tc.x + 4.0*blur*hstep, tc.y + 1.0*blur*vstep)) * 0.0162162162;
+      vec4 sum = texture(tex, fragUV + vec2(-hp.x * 2.0, 0.0));
+      sum += texture(tex, fragUV + vec2(-hp.x, hp.y)) * 2.0;
+      sum += texture(tex, fragUV + vec2(0.0, hp.y * 2.0));
+      sum += texture(tex, fragUV + vec2(hp.x, hp.y)) * 2.0;
+      sum += texture(tex, fragUV + vec2(hp.x * 2.0, 0.0));
+      sum += texture(tex, fragUV + vec2(hp.x, -hp.y)) * 2.0;
+      sum += texture(tex, fragUV + vec2(0.0, -hp.y * 2.0));
+      sum += texture(tex, fragUV + vec2(-hp.x, -hp.y)) * 2.0;
 
+      pixColor = sum / 12.0;
+    }
+  )raw";
+
+  // MAX_TAPS must be equal to blur_t::maxTaps
+  const char* gaussianFShader =
+  R"raw(
+    #version 330 core
+
+    #define MAX_TAPS 16
+
+    layout(location = 0) out vec4 pixColor;
+
+    in vec2 fragUV;
+
+    uniform sampler2D tex;
+    uniform vec2 dir;
+    uniform float offsets[MAX_TAPS];
+    uniform float weights[MAX_TAPS];
+    uniform int taps;
+
+    void main()
+    {
+      vec4 sum = texture(tex, fragUV) * weights[0];
+      for (int i = 1; i < taps; ++i)
+      {
+        vec2 step = dir*offsets[i];
+        sum += (texture(tex, fragUV + step) + texture(tex, fragUV - step)) * weights[i];
+      }
       pixColor = sum;
     }
   )raw";
 
+  // gaussian is evaluated on smallest level, keep it short
+  const float maxKernelRadius = 8.0f;
+
+  /**
+   * Generate half of symmetric gaussian kernel, which covers radius pixels.
+   * Neighbour discrete taps are merged to one linear-sampled tap.
+   *
+   * @return number of taps
+   */
+  int GaussianKernel(float radius, float* offsets, float* weights)
+  {
+    auto pixels = static_cast<int>(std::ceil(radius));
+    if (pixels > (bb::blur_t::maxTaps - 1) * 2)
+    {
+      bb::Debug("Blur radius %f clamped to %d", static_cast<double>(radius), (bb::blur_t::maxTaps - 1) * 2);
+      pixels = (bb::blur_t::maxTaps - 1) * 2;
+    }
+
+    if (pixels < 1)
+    {
+      offsets[0] = 0.0f;
+      weights[0] = 1.0f;
+      return 1;
+    }
+
+    // kernel covers 3 sigma
+    auto sigma = static_cast<float>(pixels) / 3.0f;
+
+    std::vector<float> discrete(static_cast<size_t>(pixels + 2), 0.0f);
+    float total = 0.0f;
+    for (int i = 0; i <= pixels; ++i)
+    {
+      auto x = static_cast<float>(i);
+      discrete[static_cast<size_t>(i)] = std::exp(-(x*x)/(2.0f*sigma*sigma));
+      total += (i == 0)?(discrete[0]):(2.0f*discrete[static_cast<size_t>(i)]);
+    }
+
+    offsets[0] = 0.0f;
+    weights[0] = discrete[0] / total;
+
+    int taps = 1;
+    for (int i = 1; i <= pixels; i += 2)
+    {
+      auto wa = discrete[static_cast<size_t>(i)];
+      auto wb = discrete[static_cast<size_t>(i + 1)];
+      auto weight = wa + wb;
+
+      offsets[taps] = (static_cast<float>(i)*wa + static_cast<float>(i + 1)*wb) / weight;
+      weights[taps] = weight / total;
+      ++taps;
+    }
+    return taps;
+  }
+
+  void ClampToEdge(const bb::texture_t& tex)
+  {
+    bb::texture_t::Bind(tex);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  }
+
 } // namespace
 
 namespace bb
 {
 
-  void blur_t::Render()
+  void blur_t::Pass(const program_t& prog, bb::framebuffer_t& from, bb::framebuffer_t& to)
   {
-    bb::shader_t::Bind(this->shader);
-    this->shader.SetVector2f("dir", bb::vec2_t(1.0f, 0.0f));
-    this->shader.SetFloat("radius", 1.0f);
-    this->shader.SetFloat("resolution", static_cast<float>(fboSize));
-
-    bb::framebuffer_t::Bind(this->temp);
-    glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
-    bb::texture_t::Bind(this->src->Texture());
+    bb::shader_t::Bind(prog.shader);
+    if (prog.halfpixel != -1)
+    {
+      prog.shader.SetVector2f(
+        prog.halfpixel,
+        glm::vec2(0.5f/static_cast<float>(from.Width()), 0.5f/static_cast<float>(from.Height()))
+      );
+    }
+    bb::framebuffer_t::Bind(to);
+    bb::texture_t::Bind(from.Texture());
     this->plane.Render();
-    glFlush();
+  }
 
-    bb::framebuffer_t::Bind(*this->dst);
-    glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
+  void blur_t::Render()
+  {
+    BB_GPU_SCOPE("blur");
 
-    this->shader.SetVector2f("dir", bb::vec2_t(0.0f, 1.0f));
-    bb::texture_t::Bind(this->temp.Texture());
-    this->plane.Render();
+    // every pass overwrites whole target
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    GLboolean blend = glIsEnabled(GL_BLEND);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+
+    bb::framebuffer_t* cur = this->src;
+    for (auto& level: this->chain)
+    {
+      this->Pass(this->down, *cur, level);
+      cur = &level;
+    }
+
+    if (this->mode == blurKernel_t::gaussian)
+    {
+      auto& target = (this->chain.empty())?(*this->dst):(*cur);
+
+      bb::shader_t::Bind(this->kernel.shader);
+      this->kernel.shader.SetVector2f(this->kernel.dir, glm::vec2(1.0f/static_cast<float>(cur->Width()), 0.0f));
+      this->Pass(this->kernel, *cur, this->temp);
+
+      this->kernel.shader.SetVector2f(this->kernel.dir, glm::vec2(0.0f, 1.0f/static_cast<float>(cur->Height())));
+      this->Pass(this->kernel, this->temp, target);
+    }
+
+    for (size_t i = this->chain.size(); i > 0; --i)
+    {
+      auto& to = (i == 1)?(*this->dst):(this->chain[i - 2]);
+      this->Pass(this->up, this->chain[i - 1], to);
+    }
+
+    if (blend == GL_TRUE)
+    {
+      glEnable(GL_BLEND);
+    }
+    if (depthTest == GL_TRUE)
+    {
+      glEnable(GL_DEPTH_TEST);
+    }
   }
 
   blur_t::blur_t()
   : src(nullptr),
-    dst(nullptr)
+    dst(nullptr),
+    mode(blurKernel_t::gaussian),
+    offset(0.0f)
   {
     ;
   }
 
-  blur_t::blur_t(bb::framebuffer_t* src, bb::framebuffer_t* dst, int fboSize)
+  blur_t::blur_t(bb::framebuffer_t* src, bb::framebuffer_t* dst, float radius, int levels, blurKernel_t mode)
   : plane(bb::GeneratePlane(bb::vec2_t(2.0f, 2.0f), bb::vec3_t(0.0f), bb::vec2_t(0.5f), false)),
-    shader(blurVShader, blurFShader),
-    temp(fboSize, fboSize),
     src(src),
     dst(dst),
-    fboSize(fboSize)
+    mode(mode),
+    offset(1.0f)
   {
     assert((src != nullptr) && (dst != nullptr));
+    assert((src->Width() == dst->Width()) && (src->Height() == dst->Height()));
+
+    if (levels < 0)
+    {
+      levels = 0;
+      switch (mode)
+      {
+        case blurKernel_t::gaussian:
+          // downsample until kernel is short enough
+          while ((radius / static_cast<float>(1 << levels)) > maxKernelRadius)
+          {
+            ++levels;
+          }
+          break;
+        case blurKernel_t::dual:
+          // every level doubles covered radius
+          levels = std::max(static_cast<int>(std::round(std::log2(std::max(radius, 2.0f)))), 1);
+          break;
+      }
+    }
+
+    if (mode == blurKernel_t::dual)
+    {
+      levels = std::max(levels, 1);
+      // fine tune radius between power of two steps
+      this->offset = bb::CheckValueBounds(radius / static_cast<float>(1 << levels), 0.5f, 4.0f);
+    }
+
+    auto width = src->Width();
+    auto height = src->Height();
+    for (int i = 0; i < levels; ++i)
+    {
+      width = std::max(width / 2, 1);
+      height = std::max(height / 2, 1);
+      this->chain.emplace_back(width, height);
+    }
+
+    ClampToEdge(src->Texture());
+    ClampToEdge(dst->Texture());
+    for (auto& level: this->chain)
+    {
+      ClampToEdge(level.Texture());
+    }
+
+    switch (mode)
+    {
+      case blurKernel_t::gaussian:
+        {
+          // plain bilinear copy in both directions
+          this->down.shader = bb::shader_t(blurVShader, copyFShader);
+          this->up.shader = bb::shader_t(blurVShader, copyFShader);
+          this->kernel.shader = bb::shader_t(blurVShader, gaussianFShader);
+          this->temp = bb::framebuffer_t(width, height);
+          ClampToEdge(this->temp.Texture());
+
+          float offsets[maxTaps];
+          float weights[maxTaps];
+          auto taps = GaussianKernel(radius / static_cast<float>(1 << levels), offsets, weights);
+
+          // kernel is constant, program keeps it between frames
+          auto& shader = this->kernel.shader;
+          bb::shader_t::Bind(shader);
+          shader.SetFloat(shader.UniformLocation("offsets"), taps, offsets);
+          shader.SetFloat(shader.UniformLocation("weights"), taps, weights);
+          shader.SetInteger(shader.UniformLocation("taps"), taps);
+          this->kernel.tex = shader.UniformLocation("tex");
+          this->kernel.halfpixel = -1;
+          this->kernel.offset = -1;
+          this->kernel.dir = shader.UniformLocation("dir");
+          shader.SetTexture(this->kernel.tex, 0);
+        }
+        break;
+      case blurKernel_t::dual:
+        this->down.shader = bb::shader_t(blurVShader, dualDownFShader);
+        this->up.shader = bb::shader_t(blurVShader, dualUpFShader);
+        break;
+    }
+
+    for (auto* prog: {&this->down, &this->up})
+    {
+      prog->tex = prog->shader.UniformLocation("tex");
+      prog->halfpixel = prog->shader.UniformLocation("halfpixel");
+      prog->offset = prog->shader.UniformLocation("offset");
+      prog->dir = -1;
+
+      bb::shader_t::Bind(prog->shader);
+      prog->shader.SetTexture(prog->tex, 0);
+      if (prog->offset != -1)
+      {
+        prog->shader.SetFloat(prog->offset, this->offset);
+      }
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
   }
 
   blur_t::~blur_t()
@@ -0,0 +1,137 @@
+#include <profilerOverlay.hpp>
+
+#include <cstdio>
+
+namespace
+{
+  const char* overlayVShader =
+  R"raw(
+    #version 330 core
+
+    layout(location = 0) in vec2 pos;
+    layout(location = 1) in vec2 dist;
+
+    uniform camera
+    {
+      mat4 proj;
+      mat4 view;
+    };
+
+    out vec2 fragPos;
+
+    void main()
+    {
+      fragPos = dist;
+      gl_Position = proj * view * vec4(pos, 0.0f, 1.0f);
+    }
+  )raw";
+
+  const char* overlayFShader =
+  R"raw(
+    #version 330 core
+
+    layout(location = 0) out vec4 pixColor;
+
+    in vec2 fragPos;
+
+    uniform vec4 lineColor;
+
+    void main()
+    {
+      float pct = 1.0f - 2.0f*distance(fragPos,vec2(0.5));
+      pixColor = mix(vec4(0.0f), lineColor, pct);
+    }
+  )raw";
+
+  const float overlayRows = 60.0f;
+  const float lineHeight = 1.5f;
+  const double rebuildPeriod = 0.5;
+
+} // namespace
+
+namespace bb
+{
+
+  void profilerOverlay_t::Rebuild()
+  {
+    auto& profiler = bb::gpuProfiler_t::Instance();
+
+    meshDesc_t desc;
+    char line[64];
+    float row = 0.5f;
+
+    snprintf(line, bb::countof(line), "GPU dropped " BBsize_t, profiler.Dropped());
+    desc.Append(bb::DefineNumber(glm::vec3(0.5f, row, 0.0f), 0.1f, glm::vec2(1.0f), line));
+    row += lineHeight;
+
+    for (auto& stats: profiler.Stats())
+    {
+      snprintf(line, bb::countof(line), "%-12.12s %6.2f ms", stats.name.c_str(), stats.average * 1000.0);
+      desc.Append(bb::DefineNumber(glm::vec3(0.5f, row, 0.0f), 0.1f, glm::vec2(1.0f), line));
+      row += lineHeight;
+    }
+
+    this->text = bb::GenerateMesh(desc);
+  }
+
+  void profilerOverlay_t::Update(double dt)
+  {
+    if (!bb::gpuProfiler_t::Instance().Enabled())
+    {
+      return;
+    }
+
+    this->time += dt;
+    if (this->time < rebuildPeriod)
+    {
+      return;
+    }
+    this->time = 0.0;
+    this->Rebuild();
+  }
+
+  void profilerOverlay_t::Render()
+  {
+    if ((!bb::gpuProfiler_t::Instance().Enabled()) || (!this->text.Good()))
+    {
+      return;
+    }
+
+    BB_GPU_SCOPE("overlay");
+
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    glDisable(GL_DEPTH_TEST);
+
+    this->camera.Update();
+
+    bb::shader_t::Bind(this->shader);
+    this->shader.SetBlock("camera", this->camera.UniformBlock());
+    this->shader.SetVector4f("lineColor", glm::vec4(1.0f, 1.0f, 0.2f, 1.0f));
+    this->text.Render();
+
+    if (depthTest == GL_TRUE)
+    {
+      glEnable(GL_DEPTH_TEST);
+    }
+  }
+
+  profilerOverlay_t::profilerOverlay_t()
+  : time(0.0)
+  {
+    ;
+  }
+
+  profilerOverlay_t::profilerOverlay_t(float aspect)
+  : shader(overlayVShader, overlayFShader),
+    camera(bb::camera_t::Orthogonal(0.0f, overlayRows*aspect, overlayRows, 0.0f)),
+    time(rebuildPeriod)
+  {
+    ;
+  }
+
+  profilerOverlay_t::~profilerOverlay_t()
+  {
+
+  }
+
+} // namespace bb
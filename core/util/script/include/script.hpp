@@ -2,6 +2,20 @@
  * @file script.hpp
  *
  * Simple scripting.
+ *
+ * Script is a list of commands, each command is a letter with optional
+ * arguments separated by ':' and terminated by ';', arguments are numbers
+ * or quoted strings:
+ *
+ * @code
+ * m:-0.98:-0.86;
+ * d:"sphinx of quartz";
+ * @endcode
+ *
+ * Script text is compiled once to script_t bytecode, with arguments stored
+ * inline and strings kept in constant pool. Executing compiled script does
+ * not allocate, so same script can be run many times. Compiled scripts can
+ * be saved and loaded back in later runs.
  */
 
 #pragma once
@@ -10,30 +24,95 @@
 
 #include <value.hpp>
 
-#include <list>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
 
 namespace bb
 {
 
-  using listOfRefs_t = std::list<ref_t>;
+  /**
+   * Compiled command argument, number or string.
+   */
+  class scriptArg_t final
+  {
+    friend class script_t;
+
+    type_t type;
+    uint32_t size;
+    uint32_t offset;
+    double number;
+    const char* string;
 
-  double Argument(const listOfRefs_t& refs, uint32_t id);
+  public:
 
-  std::string StringArg(const listOfRefs_t& refs, uint32_t id);
+    type_t Type() const;
 
-  class vm_t
+    /**
+     * @throw std::bad_cast if argument is not a number
+     */
+    double Number() const;
+
+    /**
+     * Zero terminated string, stored in script constant pool.
+     *
+     * @throw std::bad_cast if argument is not a string
+     */
+    const char* String() const;
+
+    /**
+     * String length in bytes.
+     */
+    uint32_t Size() const;
+  };
+
+  /**
+   * Arguments of one command, view into compiled script.
+   */
+  class scriptArgs_t final
   {
-    listOfRefs_t listOfRefs;
+    const scriptArg_t* first;
+    uint32_t count;
 
-    virtual int OnCommand(int cmd, const listOfRefs_t& refs) = 0;
+  public:
+
+    uint32_t Size() const;
+
+    const scriptArg_t& operator[](uint32_t id) const;
+
+    const scriptArg_t* begin() const;
+    const scriptArg_t* end() const;
+
+    scriptArgs_t(const scriptArg_t* first, uint32_t count);
+  };
+
+  /**
+   * @return number argument or 0.0, when argument is missing
+   */
+  double Argument(const scriptArgs_t& args, uint32_t id);
+
+  /**
+   * @return argument converted to string or empty string, when argument is missing
+   */
+  std::string StringArg(const scriptArgs_t& args, uint32_t id);
+
+  /**
+   * Same as StringArg, but without allocation.
+   *
+   * @return zero terminated string argument or "", when argument is missing or is not a string
+   */
+  const char* TextArg(const scriptArgs_t& args, uint32_t id);
+
+  class vm_t
+  {
+    virtual int OnCommand(int cmd, const scriptArgs_t& args) = 0;
 
     vm_t(const vm_t& vm) = delete;
     vm_t& operator = (const vm_t& vm) = delete;
 
   public:
 
-    int Push(ref_t&& ref);
-    int Command(int cmd);
+    int Command(int cmd, const scriptArgs_t& args);
 
     vm_t();
     virtual ~vm_t();
@@ -42,8 +121,69 @@ namespace bb
     vm_t& operator = (vm_t&& vm);
   };
 
+  class script_t final
+  {
+    // each word is command in low byte and argument count in upper bytes,
+    // arguments of all commands follow each other in args
+    std::vector<uint32_t> code;
+    std::vector<scriptArg_t> args;
+    std::vector<char> pool;
+    bool good;
+
+    script_t(const script_t&) = delete;
+    script_t& operator=(const script_t&) = delete;
+
+    void Link();
+
+  public:
+
+    bool IsGood() const;
+
+    /**
+     * Number of commands.
+     */
+    size_t Size() const;
+
+    /**
+     * Run all commands.
+     *
+     * @return 0 on success, -1 when script is not good or command fails
+     */
+    int Execute(vm_t& vm) const;
+
+    /**
+     * Save compiled script.
+     *
+     * @return 0 on success, -1 on errors
+     */
+    int Save(FILE* output) const;
+
+    /**
+     * Compile script text.
+     *
+     * Commands are not executed, when script has syntax errors.
+     */
+    static script_t Compile(const char* text);
+
+    /**
+     * Load script saved by script_t::Save.
+     */
+    static script_t Load(FILE* input);
+
+    script_t();
+    ~script_t() = default;
+
+    script_t(script_t&&) = default;
+    script_t& operator=(script_t&&) = default;
+  };
+
+  /**
+   * Compile and execute script text.
+   */
   int ExecuteScript(vm_t& vm, const char* script);
 
+  int ExecuteScript(vm_t& vm, const script_t& script);
+
   /**
    * Read whole content of file to memory.
    *
@@ -56,6 +196,81 @@ namespace bb
 
   char* ReadWholeFile(FILE* input, size_t* pSize);
 
+  inline type_t scriptArg_t::Type() const
+  {
+    return this->type;
+  }
+
+  inline double scriptArg_t::Number() const
+  {
+    if (this->type != type_t::number)
+    {
+      throw std::bad_cast();
+    }
+    return this->number;
+  }
+
+  inline const char* scriptArg_t::String() const
+  {
+    if (this->type != type_t::string)
+    {
+      throw std::bad_cast();
+    }
+    return this->string;
+  }
+
+  inline uint32_t scriptArg_t::Size() const
+  {
+    return this->size;
+  }
+
+  inline uint32_t scriptArgs_t::Size() const
+  {
+    return this->count;
+  }
+
+  inline const scriptArg_t& scriptArgs_t::operator[](uint32_t id) const
+  {
+    return this->first[id];
+  }
+
+  inline const scriptArg_t* scriptArgs_t::begin() const
+  {
+    return this->first;
+  }
+
+  inline const scriptArg_t* scriptArgs_t::end() const
+  {
+    return this->first + this->count;
+  }
+
+  inline scriptArgs_t::scriptArgs_t(const scriptArg_t* first, uint32_t count)
+  : first(first),
+    count(count)
+  {
+    ;
+  }
+
+  inline int vm_t::Command(int cmd, const scriptArgs_t& args)
+  {
+    return this->OnCommand(cmd, args);
+  }
+
+  inline bool script_t::IsGood() const
+  {
+    return this->good;
+  }
+
+  inline size_t script_t::Size() const
+  {
+    return this->code.size();
+  }
+
+  inline int ExecuteScript(vm_t& vm, const script_t& script)
+  {
+    return script.Execute(vm);
+  }
+
 } // namespace bb
 
 #endif /* __BB_UTILS_SCRIPT_HEADER__  */
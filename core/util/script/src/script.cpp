@@ -3,64 +3,153 @@
 
 #include <cctype>
 #include <cassert>
+#include <cerrno>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <limits>
 #include <memory>
+#include <unordered_map>
 
 namespace bb
 {
 
-  int vm_t::Push(ref_t&& ref)
+  vm_t::vm_t()
   {
-    this->listOfRefs.emplace_back(std::move(ref));
-    return 0;
+    ;
   }
 
-  int vm_t::Command(int cmd)
+  vm_t::~vm_t()
   {
-    int result = this->OnCommand(cmd, this->listOfRefs);
-    this->listOfRefs.clear();
-    return result;
+    ;
   }
 
-  vm_t::vm_t()
+  vm_t::vm_t(vm_t&&)
   {
     ;
   }
 
-  vm_t::~vm_t()
+  vm_t& vm_t::operator = (vm_t&&)
   {
-    ;
+    return *this;
   }
 
-  vm_t::vm_t(vm_t&& vm)
-  : listOfRefs(std::move(vm.listOfRefs))
+  double Argument(const scriptArgs_t& args, uint32_t id)
   {
-    ;
+    if (id < args.Size())
+    {
+      return args[id].Number();
+    }
+    return 0.0;
+  }
+
+  std::string StringArg(const scriptArgs_t& args, uint32_t id)
+  {
+    if (id < args.Size())
+    {
+      auto& arg = args[id];
+      switch (arg.Type())
+      {
+      case type_t::number:
+        return std::to_string(arg.Number());
+      case type_t::string:
+        return std::string(arg.String(), arg.Size());
+      default:
+        return std::string("none");
+      }
+    }
+    return std::string("");
   }
 
-  vm_t& vm_t::operator = (vm_t&& vm)
+  const char* TextArg(const scriptArgs_t& args, uint32_t id)
   {
-    if (this != &vm)
+    if ((id < args.Size()) && (args[id].Type() == type_t::string))
     {
-      this->listOfRefs = std::move(vm.listOfRefs);
+      return args[id].String();
     }
-    return *this;
+    return "";
   }
 
-  enum scriptMode_t
+#pragma pack(push, 1)
+
+  const uint32_t SCRIPT_MAGIC   = 0x63736262;
+  const uint32_t SCRIPT_VERSION = 0x01;
+
+  struct scriptHeader_t
   {
-    SM_COMMAND = 0,
-    SM_ARG,
-    SM_NEXT_OR_END
+    uint32_t magic;     // 0x63736262 // "bbsc"
+    uint32_t version;   // always 1
+    uint32_t codeSize;  // command words
+    uint32_t argCount;  // argument records after code
+    uint32_t poolSize;  // string pool bytes after arguments
   };
 
-  int ExecuteScript(vm_t& vm, const char* script)
+  struct scriptArgRecord_t
+  {
+    uint32_t type;      // bb::type_t
+    uint32_t size;      // string length
+    uint32_t offset;    // string offset in pool
+    double number;
+  };
+
+#pragma pack(pop)
+
+  namespace
+  {
+
+    enum scriptMode_t
+    {
+      SM_COMMAND = 0,
+      SM_ARG,
+      SM_NEXT_OR_END
+    };
+
+    const uint32_t SCRIPT_CMD_BITS = 8;
+    const uint32_t SCRIPT_CMD_MASK = (1u << SCRIPT_CMD_BITS) - 1;
+    const uint32_t SCRIPT_MAX_ARGS = 0xFFFFFFFFu >> SCRIPT_CMD_BITS;
+
+  } // namespace
+
+  void script_t::Link()
+  {
+    for (auto& arg: this->args)
+    {
+      arg.string = (arg.type == type_t::string)?(this->pool.data() + arg.offset):(nullptr);
+    }
+  }
+
+  int script_t::Execute(vm_t& vm) const
+  {
+    if (!this->good)
+    {
+      return -1;
+    }
+
+    const scriptArg_t* arg = this->args.data();
+    for (auto word: this->code)
+    {
+      uint32_t count = word >> SCRIPT_CMD_BITS;
+      if (vm.Command(static_cast<char>(word & SCRIPT_CMD_MASK), scriptArgs_t(arg, count)) != 0)
+      {
+        return -1;
+      }
+      arg += count;
+    }
+    return 0;
+  }
+
+  script_t script_t::Compile(const char* text)
   {
-    const char* cursor = script;
+    script_t result;
+
+    // same strings share pool entry
+    std::unordered_map<std::string, uint32_t> strings;
+
+    const char* cursor = text;
     scriptMode_t scriptMode = SM_COMMAND;
 
     int cmd = 0;
+    uint32_t count = 0;
     while(*cursor != 0)
     {
       switch(scriptMode)
@@ -69,12 +158,14 @@ namespace bb
         if (std::isalpha(*cursor) != 0)
         {
           cmd = *cursor;
+          count = 0;
           ++cursor;
           scriptMode = SM_NEXT_OR_END;
         }
         else
         {
-          return -1;
+          bb::Error("Script command expected at " BBsize_t, static_cast<size_t>(cursor - text));
+          return script_t();
         }
         break;
       case SM_ARG:
@@ -84,47 +175,73 @@ namespace bb
             ++cursor;
           }
 
+          if (count == SCRIPT_MAX_ARGS)
+          {
+            bb::Error("Too many script arguments at " BBsize_t, static_cast<size_t>(cursor - text));
+            return script_t();
+          }
+
+          scriptArg_t arg;
+          arg.size = 0;
+          arg.offset = 0;
+          arg.number = 0.0;
+          arg.string = nullptr;
+
           if ((*cursor == '\'') || (*cursor == '\"'))
           {
             int strToken = *cursor;
             auto strEnd = strchr(cursor+1, strToken);
             if (strEnd == nullptr)
             {
-              return -1;
+              bb::Error("Unterminated script string at " BBsize_t, static_cast<size_t>(cursor - text));
+              return script_t();
             }
 
             auto strLen = static_cast<size_t>(strEnd - (cursor + 1));
+            if (result.pool.size() + strLen + 1 > std::numeric_limits<uint32_t>::max())
+            {
+              bb::Error("%s", "Script string pool is too big");
+              return script_t();
+            }
 
-            std::string arg;
-            arg.resize(strLen);
-            memcpy(&arg[0], cursor + 1, strLen);
-
-            if (vm.Push(ref_t::String(arg)) != 0)
+            auto inserted = strings.emplace(
+              std::string(cursor + 1, strLen),
+              static_cast<uint32_t>(result.pool.size())
+            );
+            if (inserted.second)
             {
-              return -1;
+              result.pool.insert(result.pool.end(), cursor + 1, strEnd);
+              result.pool.push_back(0);
             }
+
+            arg.type = type_t::string;
+            arg.size = static_cast<uint32_t>(strLen);
+            arg.offset = inserted.first->second;
             cursor = strEnd+1;
           }
           else
           {
             char* afterArg;
             errno = 0;
-            double arg = std::strtod(cursor, &afterArg);
+            double number = std::strtod(cursor, &afterArg);
             if (errno == ERANGE)
             {
               errno = 0;
-              return -1;
+              bb::Error("Script number out of range at " BBsize_t, static_cast<size_t>(cursor - text));
+              return script_t();
             }
             if (afterArg == cursor)
             {
-              return -1;
-            }
-            if (vm.Push(ref_t::Number(arg)) != 0)
-            {
-              return -1;
+              bb::Error("Script argument expected at " BBsize_t, static_cast<size_t>(cursor - text));
+              return script_t();
             }
+
+            arg.type = type_t::number;
+            arg.number = number;
             cursor = afterArg;
           }
+          result.args.push_back(arg);
+          ++count;
           scriptMode = SM_NEXT_OR_END;
         }
         break;
@@ -136,14 +253,9 @@ namespace bb
             scriptMode = SM_ARG;
             break;
           case ';':
-            if (cmd != 0)
-            {
-              if (vm.Command(cmd) != 0)
-              {
-                return -1;
-              }
-            }
+            result.code.push_back((count << SCRIPT_CMD_BITS) | (static_cast<uint32_t>(cmd) & SCRIPT_CMD_MASK));
             cmd = 0;
+            count = 0;
             ++cursor;
             while(std::isspace(*cursor) != 0)
             {
@@ -152,37 +264,166 @@ namespace bb
             scriptMode = SM_COMMAND;
             break;
           default:
-            return -1;
+            bb::Error("Script ':' or ';' expected at " BBsize_t, static_cast<size_t>(cursor - text));
+            return script_t();
         }
         break;
       default:
         assert(0);
+        return script_t();
+      }
+    }
+
+    // command without ';' at the end is never executed
+    result.args.resize(result.args.size() - count);
+
+    result.Link();
+    result.good = true;
+    return result;
+  }
+
+  int script_t::Save(FILE* output) const
+  {
+    if (!this->good)
+    {
+      return -1;
+    }
+
+    scriptHeader_t header;
+    header.magic = SCRIPT_MAGIC;
+    header.version = SCRIPT_VERSION;
+    header.codeSize = static_cast<uint32_t>(this->code.size());
+    header.argCount = static_cast<uint32_t>(this->args.size());
+    header.poolSize = static_cast<uint32_t>(this->pool.size());
+
+    if (fwrite(&header, sizeof(scriptHeader_t), 1, output) != 1)
+    {
+      return -1;
+    }
+
+    if (fwrite(this->code.data(), sizeof(uint32_t), this->code.size(), output) != this->code.size())
+    {
+      return -1;
+    }
+
+    for (auto& arg: this->args)
+    {
+      scriptArgRecord_t record;
+      record.type = static_cast<uint32_t>(arg.type);
+      record.size = arg.size;
+      record.offset = arg.offset;
+      record.number = arg.number;
+
+      if (fwrite(&record, sizeof(scriptArgRecord_t), 1, output) != 1)
+      {
         return -1;
       }
     }
+
+    if (fwrite(this->pool.data(), 1, this->pool.size(), output) != this->pool.size())
+    {
+      return -1;
+    }
     return 0;
   }
 
-  double Argument(const listOfRefs_t& refs, uint32_t id)
+  script_t script_t::Load(FILE* input)
   {
-    if (id < refs.size())
+    scriptHeader_t header;
+    if (fread(&header, sizeof(scriptHeader_t), 1, input) != 1)
     {
-      auto item = refs.begin();
-      std::advance(item, id);
-      return item->Number();
+      return script_t();
     }
-    return 0.0;
+
+    if ((header.magic != SCRIPT_MAGIC) || (header.version != SCRIPT_VERSION))
+    {
+      bb::Error("%s", "Not a compiled script");
+      return script_t();
+    }
+
+    script_t result;
+    result.code.resize(header.codeSize);
+    if (fread(result.code.data(), sizeof(uint32_t), result.code.size(), input) != result.code.size())
+    {
+      return script_t();
+    }
+
+    uint64_t totalArgs = 0;
+    for (auto word: result.code)
+    {
+      totalArgs += word >> SCRIPT_CMD_BITS;
+    }
+    if (totalArgs != header.argCount)
+    {
+      bb::Error("%s", "Compiled script arguments do not match commands");
+      return script_t();
+    }
+
+    result.args.resize(header.argCount);
+    for (auto& arg: result.args)
+    {
+      scriptArgRecord_t record;
+      if (fread(&record, sizeof(scriptArgRecord_t), 1, input) != 1)
+      {
+        return script_t();
+      }
+
+      switch (static_cast<type_t>(record.type))
+      {
+      case type_t::number:
+        break;
+      case type_t::string:
+        if (static_cast<uint64_t>(record.offset) + record.size >= header.poolSize)
+        {
+          bb::Error("%s", "Compiled script string is out of pool");
+          return script_t();
+        }
+        break;
+      default:
+        bb::Error("Unknown compiled script argument type: %u", record.type);
+        return script_t();
+      }
+
+      arg.type = static_cast<type_t>(record.type);
+      arg.size = record.size;
+      arg.offset = record.offset;
+      arg.number = record.number;
+    }
+
+    result.pool.resize(header.poolSize);
+    if (fread(result.pool.data(), 1, result.pool.size(), input) != result.pool.size())
+    {
+      return script_t();
+    }
+
+    for (auto& arg: result.args)
+    {
+      if ((arg.type == type_t::string) && (result.pool[arg.offset + arg.size] != 0))
+      {
+        bb::Error("%s", "Compiled script string is not terminated");
+        return script_t();
+      }
+    }
+
+    result.Link();
+    result.good = true;
+    return result;
+  }
+
+  script_t::script_t()
+  : good(false)
+  {
+    ;
   }
 
-  std::string StringArg(const listOfRefs_t& refs, uint32_t id)
+  int ExecuteScript(vm_t& vm, const char* script)
   {
-    if (id < refs.size())
+    auto compiled = script_t::Compile(script);
+    if (!compiled.IsGood())
     {
-      auto item = refs.begin();
-      std::advance(item, id);
-      return item->AsString();
+      return -1;
     }
-    return std::string("");
+    return compiled.Execute(vm);
   }
 
   char* ReadWholeFile(FILE* input, size_t* pSize)
@@ -9,6 +9,7 @@
 #ifndef __BB_CORE_UTIL_SHAPES_INDEX_BUFFER_HEADER__
 #define __BB_CORE_UTIL_SHAPES_INDEX_BUFFER_HEADER__
 
+#include <algorithm>
 #include <cassert>
 #include <deque>
 #include <memory>
@@ -16,6 +17,7 @@
 
 #include <camera.hpp>
 #include <common.hpp>
+#include <mappedFile.hpp>
 
 namespace bb
 {
@@ -29,8 +31,25 @@ namespace bb
     virtual const void *Data() const = 0;
     virtual ~basicIndexBuffer_t() = 0;
     virtual basicIndexBuffer_t *Copy() const = 0;
+
+    /**
+     * Maximum index, breaking indecies are skipped.
+     *
+     * Buffers track it on append, so call is cheap.
+     *
+     * Not thread safe: indexBuffer_t and mappedIndexBuffer_t update cached
+     * value from this const call, so one buffer must not be queried from
+     * several threads at once without external lock.
+     */
     virtual size_t MaximumIndex() const = 0;
 
+    /**
+     * Reserve memory for given total number of indecies.
+     *
+     * @return zero on success
+     */
+    virtual int Reserve(size_t size) = 0;
+
     size_t TypeSize() const;
     size_t ByteSize() const;
   };
@@ -39,6 +58,8 @@ namespace bb
   {
     std::unique_ptr<uint8_t[]> data;
     size_t size;
+    size_t capacity;
+    size_t maxIndex;
     GLenum type;
 
     int Assign(const basicIndexBuffer_t &src);
@@ -50,6 +71,7 @@ namespace bb
     const void *Data() const override;
     basicIndexBuffer_t *Copy() const override;
     size_t MaximumIndex() const override;
+    int Reserve(size_t size) override;
 
     defaultIndexBuffer_t();
     defaultIndexBuffer_t(const void *data, size_t size, GLenum type);
@@ -60,12 +82,48 @@ namespace bb
     ~defaultIndexBuffer_t() override;
   };
 
+  /**
+   * Index buffer, which points into memory mapped file.
+   *
+   * Keeps file mapped while alive. Copy() makes defaultIndexBuffer_t.
+   * First Append or Reserve copies data to heap and releases the file.
+   */
+  class mappedIndexBuffer_t final : public basicIndexBuffer_t
+  {
+    std::shared_ptr<const mappedFile_t> file;
+    const void *data;
+    size_t size;
+    GLenum type;
+    mutable size_t maxIndex;
+    mutable bool hasMaxIndex; // computed on first use, not to touch payload on load
+    std::unique_ptr<defaultIndexBuffer_t> owned;
+
+    mappedIndexBuffer_t(const mappedIndexBuffer_t &) = delete;
+    mappedIndexBuffer_t &operator=(const mappedIndexBuffer_t &) = delete;
+
+    defaultIndexBuffer_t &Own();
+
+  public:
+    int Append(const basicIndexBuffer_t &src, size_t offset) override;
+    size_t Size() const override;
+    GLenum Type() const override;
+    const void *Data() const override;
+    basicIndexBuffer_t *Copy() const override;
+    size_t MaximumIndex() const override;
+    int Reserve(size_t size) override;
+
+    mappedIndexBuffer_t(const std::shared_ptr<const mappedFile_t> &file, const void *data, size_t size, GLenum type);
+    ~mappedIndexBuffer_t() override;
+  };
+
   template <typename data_t>
   class indexBuffer_t final : public basicIndexBuffer_t
   {
     using array_t = std::vector<data_t>;
 
     array_t self;
+    mutable size_t maxIndex;
+    mutable size_t maxIndexSize; // number of items maxIndex is known for
 
   public:
     indexBuffer_t(const array_t &copy);
@@ -91,6 +149,8 @@ namespace bb
 
     size_t MaximumIndex() const override;
 
+    int Reserve(size_t size) override;
+
     ~indexBuffer_t() override;
   };
 
@@ -100,6 +160,40 @@ namespace bb
     return std::unique_ptr<basicIndexBuffer_t>(new indexBuffer_t<data_t>(std::move(src)));
   }
 
+  /**
+   * Make index buffer of narrowest type, which can hold all indecies.
+   *
+   * GL_UNSIGNED_SHORT is the smallest type used: byte indecies are slow on
+   * most hardware. Breaking indecies (bb::breakingIndex<uint32_t>()) are
+   * converted to breaking index of selected type.
+   */
+  std::unique_ptr<basicIndexBuffer_t> MakeCompactIndexBuffer(std::vector<uint32_t> &&src);
+
+  /**
+   * Copy indecies adding offset to all, except breaking ones.
+   *
+   * Loop has no branches, so compiler vectorizes it. Caller must check,
+   * that rebased indecies fit data_t.
+   *
+   * @return maximum rebased index or zero when all indecies are breaking
+   */
+  template <typename data_t>
+  data_t RebaseIndecies(data_t *dst, const data_t *src, size_t size, data_t offset)
+  {
+    const data_t breakIndex = bb::breakingIndex<data_t>();
+    data_t result = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+      data_t item = src[i];
+      bool isBreak = (item == breakIndex);
+      data_t rebased = static_cast<data_t>(item + offset);
+      dst[i] = isBreak ? item : rebased;
+      data_t candidate = isBreak ? static_cast<data_t>(0) : rebased;
+      result = (result < candidate) ? candidate : result;
+    }
+    return result;
+  }
+
   template <typename data_t, size_t size>
   std::unique_ptr<basicIndexBuffer_t> MakeIndexBuffer(const data_t(&data)[size])
   {
@@ -112,20 +206,26 @@ namespace bb
 
   template <typename data_t>
   indexBuffer_t<data_t>::indexBuffer_t()
+      : maxIndex(0),
+        maxIndexSize(0)
   {
     ;
   }
 
   template <typename data_t>
   indexBuffer_t<data_t>::indexBuffer_t(const array_t &copy)
-      : self(copy)
+      : self(copy),
+        maxIndex(0),
+        maxIndexSize(0)
   {
     ;
   }
 
   template <typename data_t>
   indexBuffer_t<data_t>::indexBuffer_t(array_t &&src)
-      : self(std::move(src))
+      : self(std::move(src)),
+        maxIndex(0),
+        maxIndexSize(0)
   {
     ;
   }
@@ -139,6 +239,9 @@ namespace bb
   template <typename data_t>
   inline typename indexBuffer_t<data_t>::array_t &indexBuffer_t<data_t>::Self()
   {
+    // array can be changed anywhere
+    this->maxIndex = 0;
+    this->maxIndexSize = 0;
     return this->self;
   }
 
@@ -175,28 +278,31 @@ namespace bb
 
     auto itemsToAppend = reinterpret_cast<const data_t *>(src.Data());
     size_t itemSize = src.Size();
+    if (itemSize == 0)
+    {
+      return 0;
+    }
 
-    this->self.reserve(this->self.size() + itemSize);
     auto breakIndex = bb::breakingIndex<data_t>();
-    for (auto cursor = itemsToAppend, end = itemsToAppend + itemSize; cursor != end; ++cursor)
+    if (src.MaximumIndex() + offset >= static_cast<size_t>(breakIndex))
+    {
+      bb::Error("Too many indecies for buffer!");
+      assert(0);
+      return -1;
+    }
+
+    size_t oldSize = this->self.size();
+    if (this->self.capacity() < oldSize + itemSize)
+    { // grow geometrically, when caller has not reserved
+      this->self.reserve(std::max(oldSize + itemSize, oldSize*2));
+    }
+    this->self.resize(oldSize + itemSize);
+
+    auto appendMax = RebaseIndecies(this->self.data() + oldSize, itemsToAppend, itemSize, static_cast<data_t>(offset));
+    if (this->maxIndexSize == oldSize)
     {
-      if (cursor[0] == breakIndex)
-      {
-        this->self.emplace_back(
-          breakIndex);
-        continue;
-      }
-
-      size_t newIndex = cursor[0] + offset;
-      if (newIndex >= breakIndex)
-      {
-        bb::Error("Too many indecies for buffer!");
-        assert(0);
-        return -1;
-      }
-      this->self.emplace_back(
-        static_cast<data_t>(newIndex & std::numeric_limits<data_t>::max())
-      );
+      this->maxIndex = std::max(this->maxIndex, static_cast<size_t>(appendMax));
+      this->maxIndexSize = this->self.size();
     }
     return 0;
   }
@@ -229,13 +335,22 @@ namespace bb
   template <typename data_t>
   size_t indexBuffer_t<data_t>::MaximumIndex() const
   {
-    size_t result = 0;
+    // only items added after last call are scanned
     auto breakIndex = bb::breakingIndex<data_t>();
-    for (auto item : this->self)
+    for (size_t i = this->maxIndexSize, last = this->self.size(); i < last; ++i)
     {
-      result = ((result < item) && (item != breakIndex)) ? (item) : (result);
+      size_t item = static_cast<size_t>(this->self[i]);
+      this->maxIndex = ((this->maxIndex < item) && (this->self[i] != breakIndex)) ? (item) : (this->maxIndex);
     }
-    return result;
+    this->maxIndexSize = this->self.size();
+    return this->maxIndex;
+  }
+
+  template <typename data_t>
+  int indexBuffer_t<data_t>::Reserve(size_t size)
+  {
+    this->self.reserve(size);
+    return 0;
   }
 
 } // namespace bb
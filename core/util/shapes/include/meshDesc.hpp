@@ -11,31 +11,78 @@
 
 #include <vertexBuffer.hpp>
 #include <indexBuffer.hpp>
+#include <packedVertecies.hpp>
+
+#include <string>
 
 namespace bb
 {
 
   using arrayOfIndecies_t = std::unique_ptr<basicIndexBuffer_t>;
-  using arrayOfVertexBuffers_t = std::deque<std::unique_ptr<basicVertexBuffer_t>>;
   using linePoints_t = std::deque<glm::vec2>;
 
   class meshDesc_t final
   {
     arrayOfVertexBuffers_t buffers;
     arrayOfIndecies_t indecies;
+    std::unique_ptr<packedVertecies_t> packed;
     GLenum drawMode;
 
     meshDesc_t(const meshDesc_t&) = delete;
     meshDesc_t& operator=(const meshDesc_t&) = delete;
 
+    static meshDesc_t LoadPacked(FILE* input);
+
   public:
 
+    /**
+     * Load mesh description from .msh file of version 1 or 2.
+     *
+     * Version 1 files fill Buffers(), version 2 files fill Packed().
+     */
     static meshDesc_t Load(FILE* input);
 
     static bool CheckFile(FILE* input);
 
+    /**
+     * Make mesh description, which points into memory mapped .msh file
+     * of version 1 or 2.
+     *
+     * Only headers are read and checked against file size, payload is
+     * left untouched until used, e.g. by GenerateMesh upload. Buffers
+     * keep file mapped, until first Append copies them to heap.
+     *
+     * @return mesh description, not IsGood() on errors
+     */
+    static meshDesc_t Map(const std::shared_ptr<const mappedFile_t>& file);
+
+    static meshDesc_t Map(const char* filename);
+
+    /**
+     * Save mesh description as version 2 .msh file.
+     *
+     * Vertex buffers are interleaved without quantization.
+     */
     int Save(FILE* output) const;
 
+    /**
+     * Save mesh description as version 2 .msh file with quantized
+     * attributes, see bb::PackVertecies.
+     */
+    int Save(FILE* output, const vertexFormat_t& format) const;
+
+    /**
+     * Replace vertex buffers with interleaved vertecies.
+     *
+     * @return zero on success
+     */
+    int Pack(const vertexFormat_t& format);
+
+    /**
+     * Interleaved vertecies, nullptr when mesh uses separate buffers.
+     */
+    const packedVertecies_t* Packed() const;
+
     arrayOfVertexBuffers_t& Buffers();
     const arrayOfVertexBuffers_t& Buffers() const;
 
@@ -48,6 +95,11 @@ namespace bb
 
     size_t MaxIndex() const;
 
+    /**
+     * Bytes used by one vertex in all vertex buffers.
+     */
+    size_t VertexSize() const;
+
     bool IsGood() const;
 
     meshDesc_t();
@@ -56,8 +108,30 @@ namespace bb
     meshDesc_t(meshDesc_t&&) = default;
     meshDesc_t& operator=(meshDesc_t&&) = default;
 
+    /**
+     * Append mesh, its indecies are rebased after MaxIndex().
+     *
+     * Buffers grow geometrically, so appending N meshes is O(N).
+     * Meshes without index buffer only append vertecies, indexed and
+     * non-indexed meshes can't be mixed.
+     *
+     * @return zero on success
+     */
     int Append(const meshDesc_t& mesh);
 
+    /**
+     * Append all meshes, buffers are reserved for exact total size once.
+     *
+     * @return zero on success
+     */
+    int AppendAll(const meshDesc_t* const* meshes, size_t count);
+
+    /**
+     * Append range of meshDesc_t.
+     */
+    template<typename iterator_t>
+    int AppendAll(iterator_t first, iterator_t last);
+
   };
 
   inline arrayOfVertexBuffers_t& meshDesc_t::Buffers()
@@ -80,6 +154,22 @@ namespace bb
     return this->indecies;
   }
 
+  template<typename iterator_t>
+  int meshDesc_t::AppendAll(iterator_t first, iterator_t last)
+  {
+    std::vector<const meshDesc_t*> meshes;
+    for (; first != last; ++first)
+    {
+      meshes.push_back(&*first);
+    }
+    return this->AppendAll(meshes.data(), meshes.size());
+  }
+
+  inline const packedVertecies_t* meshDesc_t::Packed() const
+  {
+    return this->packed.get();
+  }
+
   inline GLenum meshDesc_t::DrawMode() const
   {
     return this->drawMode;
@@ -90,6 +180,16 @@ namespace bb
     this->drawMode = drawMode;
   }
 
+  /**
+   * Map many .msh files concurrently on worker actors.
+   *
+   * OS is asked to read files ahead, so payload is likely in page cache
+   * when meshes are generated. Failed files give not IsGood() result.
+   *
+   * @warning must not be called from actor, see bb::ParallelFor
+   */
+  std::vector<meshDesc_t> MapMeshes(const std::vector<std::string>& filenames);
+
   meshDesc_t DefineCircle(glm::vec3 center, uint32_t sides, float radius, float width);
   meshDesc_t DefineLine(glm::vec3 offset, float width, const linePoints_t& linePoints);
   meshDesc_t DefineNumber(glm::vec3 offset, float width, glm::vec2 scale, const char* utf8Text);
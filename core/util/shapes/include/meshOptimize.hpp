@@ -0,0 +1,60 @@
+/**
+ * @file meshOptimize.hpp
+ *
+ * Mesh description optimization passes.
+ *
+ */
+
+#pragma once
+#ifndef __BB_CORE_UTIL_SHAPES_MESH_OPTIMIZE_HEADER__
+#define __BB_CORE_UTIL_SHAPES_MESH_OPTIMIZE_HEADER__
+
+#include <meshDesc.hpp>
+
+namespace bb
+{
+
+  /**
+   * Average cache miss ratio: vertex shader invocations per triangle for
+   * FIFO post-transform cache of given size.
+   *
+   * 3.0 is the worst value, ~0.5 is the best for regular grids.
+   *
+   * @return ACMR or 0.0f for non GL_TRIANGLES meshes
+   */
+  float ACMR(const meshDesc_t& desc, size_t cacheSize = 16);
+
+  /**
+   * Merge vertecies, which have bitwise equal data in all vertex buffers.
+   *
+   * @return number of removed vertecies or -1 on error
+   */
+  int WeldVertecies(meshDesc_t& desc);
+
+  /**
+   * Reorder triangles for post-transform vertex cache (Forsyth).
+   *
+   * Works only with GL_TRIANGLES meshes.
+   *
+   * @return 0 on success
+   */
+  int OptimizeVertexCache(meshDesc_t& desc);
+
+  /**
+   * Reorder vertecies in order of first use by index buffer, so vertex
+   * fetch goes forward through memory. Unused vertecies are removed.
+   *
+   * @return 0 on success
+   */
+  int OptimizeVertexFetch(meshDesc_t& desc);
+
+  /**
+   * Weld, vertex cache and vertex fetch passes in one call.
+   *
+   * @return 0 on success
+   */
+  int OptimizeMesh(meshDesc_t& desc);
+
+} // namespace bb
+
+#endif /* __BB_CORE_UTIL_SHAPES_MESH_OPTIMIZE_HEADER__ */
@@ -0,0 +1,163 @@
+/**
+ * @file packedVertecies.hpp
+ *
+ * Interleaved vertex data with per-attribute storage formats.
+ *
+ */
+
+#pragma once
+#ifndef __BB_CORE_UTIL_SHAPES_PACKED_VERTECIES_HEADER__
+#define __BB_CORE_UTIL_SHAPES_PACKED_VERTECIES_HEADER__
+
+#include <vertexBuffer.hpp>
+
+namespace bb
+{
+
+  /**
+   * Storage format of vertex attribute.
+   */
+  enum class attribFormat_t: uint32_t
+  {
+    native = 0, // as in source buffer
+    position16, // normalized int16 inside bounding box, see packedVertecies_t::Dequantize
+    normal16,   // unit vector, octahedral mapping in two normalized int16
+    color8      // normalized uint8, for values in [0, 1]
+  };
+
+  /**
+   * Storage format for every vertex buffer of mesh description.
+   */
+  using vertexFormat_t = std::vector<attribFormat_t>;
+
+  struct packedAttrib_t
+  {
+    GLuint location;
+    GLint dim;
+    GLenum type;
+    GLboolean normalized;
+    GLsizei offset;
+    attribFormat_t format;
+  };
+
+  using packedAttribs_t = std::vector<packedAttrib_t>;
+
+  /**
+   * Immutable interleaved vertecies.
+   *
+   * Data can be owned or point into memory mapped file, copies share it.
+   */
+  class packedVertecies_t final
+  {
+    std::shared_ptr<const uint8_t> data;
+    size_t count;
+    GLsizei stride;
+    packedAttribs_t attribs;
+    glm::vec3 posOffset;
+    glm::vec3 posScale;
+
+    packedVertecies_t(const packedVertecies_t&) = delete;
+    packedVertecies_t& operator=(const packedVertecies_t&) = delete;
+
+  public:
+
+    const uint8_t* Data() const;
+
+    /**
+     * Number of vertecies.
+     */
+    size_t Size() const;
+
+    /**
+     * Vertex size in bytes, always multiple of 4.
+     */
+    GLsizei Stride() const;
+
+    size_t ByteSize() const;
+
+    const packedAttribs_t& Attribs() const;
+
+    const glm::vec3& PositionOffset() const;
+    const glm::vec3& PositionScale() const;
+
+    /**
+     * Matrix, which transforms position16 positions back to mesh space.
+     *
+     * Identity, when positions are not quantized.
+     */
+    glm::mat4 Dequantize() const;
+
+    packedVertecies_t* Copy() const;
+
+    packedVertecies_t(
+      std::unique_ptr<uint8_t[]>&& data,
+      size_t count,
+      GLsizei stride,
+      packedAttribs_t&& attribs,
+      const glm::vec3& posOffset,
+      const glm::vec3& posScale
+    );
+
+    packedVertecies_t(
+      const std::shared_ptr<const uint8_t>& data,
+      size_t count,
+      GLsizei stride,
+      packedAttribs_t&& attribs,
+      const glm::vec3& posOffset,
+      const glm::vec3& posScale
+    );
+
+    packedVertecies_t(packedVertecies_t&&) = default;
+    packedVertecies_t& operator=(packedVertecies_t&&) = default;
+    ~packedVertecies_t() = default;
+  };
+
+  /**
+   * Interleave vertex buffers into one block.
+   *
+   * Attribute i gets location i and format[i], missing formats are native.
+   * Quantized formats need GL_FLOAT sources, normal16 needs 3 dimensions.
+   * Only one attribute can be position16.
+   *
+   * @return packed vertecies or nullptr on errors
+   */
+  std::unique_ptr<packedVertecies_t> PackVertecies(const arrayOfVertexBuffers_t& buffers, const vertexFormat_t& format);
+
+  inline const uint8_t* packedVertecies_t::Data() const
+  {
+    return this->data.get();
+  }
+
+  inline size_t packedVertecies_t::Size() const
+  {
+    return this->count;
+  }
+
+  inline GLsizei packedVertecies_t::Stride() const
+  {
+    return this->stride;
+  }
+
+  inline size_t packedVertecies_t::ByteSize() const
+  {
+    return this->count*static_cast<size_t>(this->stride);
+  }
+
+  inline const packedAttribs_t& packedVertecies_t::Attribs() const
+  {
+    return this->attribs;
+  }
+
+  inline const glm::vec3& packedVertecies_t::PositionOffset() const
+  {
+    return this->posOffset;
+  }
+
+  inline const glm::vec3& packedVertecies_t::PositionScale() const
+  {
+    return this->posScale;
+  }
+
+} // namespace bb
+
+#endif /* __BB_CORE_UTIL_SHAPES_PACKED_VERTECIES_HEADER__ */
@@ -25,34 +25,64 @@ namespace bb
   class mesh_t final
   {
     vao_t vao;
+    std::vector<vbo_t> buffers;
+    vbo_t indecies;
     size_t totalVerts;
     GLenum drawMode;
+    GLenum indexType;
     GLuint activeBuffers;
 
     struct {
       uint32_t BREAK:1;
     } flags;
     uint32_t breakIndex;
+    glm::mat4 dequantize;
 
     mesh_t(const mesh_t&) = delete;
     mesh_t& operator=(const mesh_t&) = delete;
 
+    friend mesh_t GenerateMesh(const meshDesc_t& meshDesc);
+
   public:
 
     size_t TotalVertecies() const;
 
     void Breaking(bool enable, uint32_t index);
 
+    /**
+     * Index type used by draw calls: GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT
+     * or GL_UNSIGNED_INT. Meshes created from vao_t use GL_UNSIGNED_SHORT.
+     */
+    GLenum IndexType() const;
+
     bool Good() const;
 
+    /**
+     * Model matrix prefix, which restores quantized positions of packed
+     * mesh. Identity for other meshes.
+     */
+    const glm::mat4& Dequantize() const;
+
     void SpecialRender(size_t renderVertecies);
 
     void Render();
 
+    /**
+     * Replace mesh content, reusing existing VAO and buffers.
+     *
+     * Falls back to GenerateMesh, when mesh was not created by it, or
+     * number of vertex buffers differs.
+     *
+     * @return zero on success
+     */
+    int Update(const meshDesc_t& meshDesc);
+
     mesh_t();
 
     mesh_t(vao_t&& vao, size_t totalVerts, GLenum drawMode, GLuint activeBuffers);
 
+    mesh_t(vao_t&& vao, std::vector<vbo_t>&& buffers, vbo_t&& indecies, size_t totalVerts, GLenum drawMode, GLenum indexType);
+
     mesh_t(mesh_t&&) = default;
     mesh_t& operator=(mesh_t&&) = default;
     ~mesh_t() = default;
@@ -63,6 +93,16 @@ namespace bb
     return this->totalVerts;
   }
 
+  inline GLenum mesh_t::IndexType() const
+  {
+    return this->indexType;
+  }
+
+  inline const glm::mat4& mesh_t::Dequantize() const
+  {
+    return this->dequantize;
+  }
+
   inline bool mesh_t::Good() const
   {
     return (this->totalVerts != 0) && (this->vao.Good());
@@ -12,6 +12,8 @@
 #include <font.hpp>
 #include <shapes.hpp>
 
+#include <memory>
+
 namespace bb
 {
 
@@ -39,40 +41,77 @@ namespace bb
   template<typename T>
   using storage_t = std::vector<T>;
 
-  struct textStorage_t
+  /**
+   * Text vertex, attributes are interleaved.
+   */
+  struct glyphVertex_t
   {
-    storage_t<vec3_t>   vPos;
-    storage_t<vec2_t>   vUV;
-    storage_t<vec4_t>   vCol;
-    storage_t<uint16_t> indecies;
+    vec3_t pos;
+    vec2_t uv;
+    vec4_t col;
   };
 
+  /**
+   * Laid out text, four vertecies for each glyph.
+   *
+   * Indecies are not stored, because they are same for every quad.
+   */
+  using glyphQuads_t = storage_t<glyphVertex_t>;
+
+  /**
+   * Make vertecies of single line text, nothing is uploaded to GPU.
+   *
+   * Function does not touch GL state, so it can be called from any thread.
+   * Output is reused between calls and only grows.
+   *
+   * @return number of indecies to draw
+   *
+   * @throw std::runtime_error if text is not valid UTF-8
+   */
+  size_t LayoutText(const font_t& font, const char* text, vec2_t chSize, glyphQuads_t& output);
+
   template<typename T>
   size_t ByteSize(const storage_t<T>& arr)
   {
     return arr.size()*sizeof(T);
   }
 
+  /**
+   * Text, which changes often.
+   *
+   * Layout is made by worker actor, each object has its own. Update only
+   * passes text to worker, Render uploads latest finished layout with one
+   * buffer update and draws it. So new text is shown in one of the next
+   * frames, not right after Update.
+   *
+   * All buffers are reused between updates, so no memory is allocated,
+   * while text does not grow.
+   *
+   * Font must outlive text object.
+   */
   class textDynamic_t final
   {
+    struct layout_t;
+
     vao_t vao;
     const font_t* font;
     vec2_t chSize;
 
-    vbo_t vPosVBO;
-    vbo_t vUVVBO;
-    vbo_t vColVBO;
+    vbo_t vertexVBO;
     vbo_t indeciesVBO;
-    size_t totalV;  /**< total allocated vertecies */ 
-    size_t totalI;  /**< total allocated indecies  */
-    size_t renderI; /**< total indecies to render  */
+    size_t totalI;  /**< total allocated indecies */
+    size_t renderI; /**< total indecies to render */
 
-    textStorage_t vertecies;
+    glyphQuads_t quads;              /**< last uploaded layout */
+    std::vector<char> text;          /**< formatting buffer */
+    std::shared_ptr<layout_t> layout;
 
     textDynamic_t(const textDynamic_t&) = delete;
     textDynamic_t& operator=(const textDynamic_t&) = delete;
 
-    void UpdateText(const char* text);
+    void PostText();
+    void Upload();
+    void Release();
 
   public:
 
@@ -87,15 +126,10 @@ namespace bb
     textDynamic_t(const font_t& font, const vec2_t& chSize);
 
     textDynamic_t(textDynamic_t&&) = default;
-    textDynamic_t& operator=(textDynamic_t&&) = default;
-    ~textDynamic_t() = default;
+    textDynamic_t& operator=(textDynamic_t&& move);
+    ~textDynamic_t();
   };
 
-
-
-
-
-
 } // namespace bb
 
 #endif /* __BB_CORE_RENDER_TEXT_HEADER__ */
\ No newline at end of file
@@ -0,0 +1,108 @@
+/**
+ * @file uploadQueue.hpp
+ *
+ * Deferred mesh uploads with per-frame byte budget.
+ *
+ * Workers build meshDesc_t and pass them to render thread by mail, render
+ * thread pushes them here. Flush is called once per frame and uploads
+ * commands in order, until budget is spent. Newer command for the same mesh
+ * replaces pending one, so stale geometry is never uploaded.
+ *
+ * Meshes are updated in place (see mesh_t::Update), so no VAO is recreated.
+ *
+ * Queue must be used only from render thread. Target mesh must outlive
+ * queued commands, or be removed with Cancel.
+ *
+ */
+
+#pragma once
+#ifndef __BB_CORE_UTIL_SHAPES_UPLOAD_QUEUE_HEADER__
+#define __BB_CORE_UTIL_SHAPES_UPLOAD_QUEUE_HEADER__
+
+#include <deque>
+
+#include <shapes.hpp>
+
+namespace bb
+{
+
+  class uploadQueue_t final
+  {
+    struct command_t
+    {
+      mesh_t* target;
+      meshDesc_t desc;
+      size_t bytes;
+    };
+
+    std::deque<command_t> pending;
+    size_t budget;
+    size_t frameBytes;
+    size_t totalBytes;
+
+    uploadQueue_t(const uploadQueue_t&) = delete;
+    uploadQueue_t& operator=(const uploadQueue_t&) = delete;
+
+  public:
+
+    static size_t ByteSize(const meshDesc_t& desc);
+
+    /**
+     * Queue mesh update.
+     */
+    void Push(mesh_t* target, meshDesc_t&& desc);
+
+    /**
+     * Drop pending updates of target.
+     */
+    void Cancel(const mesh_t* target);
+
+    /**
+     * Upload pending commands within budget. At least one command is
+     * uploaded each call, so big meshes are never stuck.
+     *
+     * @return bytes uploaded
+     */
+    size_t Flush();
+
+    size_t Pending() const;
+
+    size_t Budget() const;
+    void SetBudget(size_t budget);
+
+    /**
+     * Bytes uploaded since creation.
+     */
+    size_t TotalBytes() const;
+
+    explicit uploadQueue_t(size_t budget);
+    ~uploadQueue_t();
+
+    uploadQueue_t(uploadQueue_t&&) = default;
+    uploadQueue_t& operator=(uploadQueue_t&&) = default;
+
+  };
+
+  inline size_t uploadQueue_t::Pending() const
+  {
+    return this->pending.size();
+  }
+
+  inline size_t uploadQueue_t::Budget() const
+  {
+    return this->budget;
+  }
+
+  inline void uploadQueue_t::SetBudget(size_t budget)
+  {
+    this->budget = budget;
+  }
+
+  inline size_t uploadQueue_t::TotalBytes() const
+  {
+    return this->totalBytes;
+  }
+
+} // namespace bb
+
+#endif /* __BB_CORE_UTIL_SHAPES_UPLOAD_QUEUE_HEADER__ */
@@ -16,6 +16,7 @@
 
 #include <common.hpp>
 #include <camera.hpp>
+#include <mappedFile.hpp>
 
 namespace bb
 {
@@ -33,6 +34,13 @@ namespace bb
     virtual ~basicVertexBuffer_t() = 0;
     virtual basicVertexBuffer_t* Copy() const = 0;
 
+    /**
+     * Reserve memory for given total number of vertecies.
+     *
+     * @return zero on success
+     */
+    virtual int Reserve(size_t size) = 0;
+
     size_t TypeSize() const;
     size_t ByteSize() const;
 
@@ -42,6 +50,7 @@ namespace bb
   {
     std::unique_ptr<uint8_t[]> data;
     size_t                     size;
+    size_t                     capacity;
     GLint                      dim;
     GLenum                     type;
     GLboolean                  normalized;
@@ -57,6 +66,7 @@ namespace bb
     GLboolean Normalized() const override;
     const void* Data() const override;
     basicVertexBuffer_t* Copy() const override;
+    int Reserve(size_t size) override;
 
     defaultVertexBuffer_t();
     defaultVertexBuffer_t(const void* data, size_t size, GLint dim, GLenum type, GLboolean normalized);
@@ -67,6 +77,44 @@ namespace bb
     ~defaultVertexBuffer_t() override;
   };
 
+  /**
+   * Vertex buffer, which points into memory mapped file.
+   *
+   * Keeps file mapped while alive. Copy() makes defaultVertexBuffer_t.
+   * First Append or Reserve copies data to heap and releases the file.
+   */
+  class mappedVertexBuffer_t final: public basicVertexBuffer_t
+  {
+    std::shared_ptr<const mappedFile_t>    file;
+    const void*                            data;
+    size_t                                 size;
+    GLint                                  dim;
+    GLenum                                 type;
+    GLboolean                              normalized;
+    std::unique_ptr<defaultVertexBuffer_t> owned;
+
+    mappedVertexBuffer_t(const mappedVertexBuffer_t&) = delete;
+    mappedVertexBuffer_t& operator=(const mappedVertexBuffer_t&) = delete;
+
+    defaultVertexBuffer_t& Own();
+
+  public:
+
+    int Append(const basicVertexBuffer_t& src) override;
+    size_t Size() const override;
+    GLint Dimensions() const override;
+    GLenum Type() const override;
+    GLboolean Normalized() const override;
+    const void* Data() const override;
+    basicVertexBuffer_t* Copy() const override;
+    int Reserve(size_t size) override;
+
+    mappedVertexBuffer_t(const std::shared_ptr<const mappedFile_t>& file, const void* data, size_t size, GLint dim, GLenum type, GLboolean normalized);
+    ~mappedVertexBuffer_t() override;
+  };
+
+  using arrayOfVertexBuffers_t = std::deque<std::unique_ptr<basicVertexBuffer_t>>;
+
   template<typename data_t>
   class vertexBuffer_t final: public basicVertexBuffer_t
   {
@@ -100,6 +148,7 @@ namespace bb
     GLboolean Normalized() const override;
     const void* Data() const override;
     basicVertexBuffer_t* Copy() const override;
+    int Reserve(size_t size) override;
 
     ~vertexBuffer_t() override;
   };
@@ -201,6 +250,13 @@ namespace bb
     this->isNormalized = value;
   }
 
+  template<typename data_t>
+  int vertexBuffer_t<data_t>::Reserve(size_t size)
+  {
+    this->self.reserve(size);
+    return 0;
+  }
+
   template<typename data_t>
   const void* vertexBuffer_t<data_t>::Data() const
   {
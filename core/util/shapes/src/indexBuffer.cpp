@@ -41,8 +41,106 @@ namespace bb
     return new defaultIndexBuffer_t(*this);
   }
 
+  template<typename data_t>
+  size_t MaximumIndexArray(const data_t* data, size_t dataSize)
+  {
+    data_t result = 0;
+    auto breakIndex = bb::breakingIndex<data_t>();
+
+    for (auto end = data + dataSize; data != end; ++data)
+    {
+      result = ((result < *data) && (*data != breakIndex))?(*data):(result);
+    }
+    return static_cast<size_t>(result);
+  }
+
+  namespace
+  {
+
+    size_t RawMaximumIndex(const void* data, size_t size, GLenum type)
+    {
+      switch(type)
+      {
+        case GL_BYTE:
+          return MaximumIndexArray(reinterpret_cast<const int8_t*>(data), size);
+        case GL_UNSIGNED_BYTE:
+          return MaximumIndexArray(reinterpret_cast<const uint8_t*>(data), size);
+        case GL_SHORT:
+          return MaximumIndexArray(reinterpret_cast<const int16_t*>(data), size);
+        case GL_UNSIGNED_SHORT:
+          return MaximumIndexArray(reinterpret_cast<const uint16_t*>(data), size);
+        case GL_INT:
+          return MaximumIndexArray(reinterpret_cast<const int32_t*>(data), size);
+        case GL_UNSIGNED_INT:
+          return MaximumIndexArray(reinterpret_cast<const uint32_t*>(data), size);
+        default:
+          assert(0);
+          bb::Error("Unknown index array type (0x%x)", type);
+          return 0;
+      }
+    }
+
+    template<typename data_t>
+    size_t RebaseTyped(void* dst, const void* src, size_t size, size_t offset)
+    {
+      return static_cast<size_t>(
+        RebaseIndecies(
+          reinterpret_cast<data_t*>(dst),
+          reinterpret_cast<const data_t*>(src),
+          size,
+          static_cast<data_t>(offset)
+        )
+      );
+    }
+
+    size_t RebaseRaw(GLenum type, void* dst, const void* src, size_t size, size_t offset)
+    {
+      switch(type)
+      {
+        case GL_BYTE:
+          return RebaseTyped<int8_t>(dst, src, size, offset);
+        case GL_UNSIGNED_BYTE:
+          return RebaseTyped<uint8_t>(dst, src, size, offset);
+        case GL_SHORT:
+          return RebaseTyped<int16_t>(dst, src, size, offset);
+        case GL_UNSIGNED_SHORT:
+          return RebaseTyped<uint16_t>(dst, src, size, offset);
+        case GL_INT:
+          return RebaseTyped<int32_t>(dst, src, size, offset);
+        case GL_UNSIGNED_INT:
+          return RebaseTyped<uint32_t>(dst, src, size, offset);
+        default:
+          assert(0);
+          bb::Error("Unknown index array type (0x%x)", type);
+          return 0;
+      }
+    }
+
+    size_t BreakingIndex(GLenum type)
+    {
+      switch(type)
+      {
+        case GL_BYTE:
+          return static_cast<size_t>(bb::breakingIndex<int8_t>());
+        case GL_UNSIGNED_BYTE:
+          return bb::breakingIndex<uint8_t>();
+        case GL_SHORT:
+          return static_cast<size_t>(bb::breakingIndex<int16_t>());
+        case GL_UNSIGNED_SHORT:
+          return bb::breakingIndex<uint16_t>();
+        case GL_INT:
+          return static_cast<size_t>(bb::breakingIndex<int32_t>());
+        default:
+          return bb::breakingIndex<uint32_t>();
+      }
+    }
+
+  } // namespace
+
   defaultIndexBuffer_t::defaultIndexBuffer_t()
   : size(0),
+    capacity(0),
+    maxIndex(0),
     type(GL_UNSIGNED_SHORT)
   {
     ;
@@ -50,6 +148,8 @@ namespace bb
 
   defaultIndexBuffer_t::defaultIndexBuffer_t(const void* data, size_t size, GLenum type)
   : size(size),
+    capacity(size),
+    maxIndex(RawMaximumIndex(data, size, type)),
     type(type)
   {
     this->data.reset(new uint8_t[this->ByteSize()]);
@@ -58,6 +158,8 @@ namespace bb
 
   defaultIndexBuffer_t::defaultIndexBuffer_t(const defaultIndexBuffer_t& src)
   : size(src.size),
+    capacity(src.size),
+    maxIndex(src.maxIndex),
     type(src.type)
   {
     if (this->ByteSize() > 0)
@@ -70,9 +172,13 @@ namespace bb
   defaultIndexBuffer_t::defaultIndexBuffer_t(defaultIndexBuffer_t&& src)
   : data(std::move(src.data)),
     size(src.size),
+    capacity(src.capacity),
+    maxIndex(src.maxIndex),
     type(src.type)
   {
     src.size = 0;
+    src.capacity = 0;
+    src.maxIndex = 0;
     src.type = GL_UNSIGNED_SHORT;
   }
   
@@ -96,9 +202,13 @@ namespace bb
 
     this->data = std::move(src.data);
     this->size = src.size;
+    this->capacity = src.capacity;
+    this->maxIndex = src.maxIndex;
     this->type = src.type;
 
     src.size = 0;
+    src.capacity = 0;
+    src.maxIndex = 0;
     src.type = GL_UNSIGNED_SHORT;
     return *this;
   }
@@ -123,149 +233,173 @@ namespace bb
 
     this->data = std::move(newData);
     this->size = src.Size();
+    this->capacity = src.Size();
+    this->maxIndex = src.MaximumIndex();
     this->type = src.Type();
     return 0;
   }
 
-  template<typename data_t>
-  size_t MaximumIndexArray(const data_t* data, size_t dataSize)
+  size_t defaultIndexBuffer_t::MaximumIndex() const
   {
-    data_t result = 0;
-    auto breakIndex = bb::breakingIndex<data_t>();
-
-    while(dataSize-->0)
-    {
-      result = ((result < *data) && (*data != breakIndex))?(*data):(result);
-    }
-    return static_cast<size_t>(result);
+    return this->maxIndex;
   }
 
-  size_t defaultIndexBuffer_t::MaximumIndex() const
+  int defaultIndexBuffer_t::Reserve(size_t size)
   {
-    switch(this->Type())
+    if ((!this->data) || (size <= this->capacity))
+    { // type of empty buffer is defined by first Append
+      return 0;
+    }
+
+    std::unique_ptr<uint8_t[]> newData(new uint8_t[size*this->TypeSize()]);
+    if (this->data)
     {
-      case GL_BYTE:
-        return MaximumIndexArray(reinterpret_cast<const int8_t*>(this->Data()), this->Size());
-      case GL_UNSIGNED_BYTE:
-        return MaximumIndexArray(reinterpret_cast<const uint8_t*>(this->Data()), this->Size());
-      case GL_SHORT:
-        return MaximumIndexArray(reinterpret_cast<const int16_t*>(this->Data()), this->Size());
-      case GL_UNSIGNED_SHORT:
-        return MaximumIndexArray(reinterpret_cast<const uint16_t*>(this->Data()), this->Size());
-      case GL_INT:
-        return MaximumIndexArray(reinterpret_cast<const int32_t*>(this->Data()), this->Size());
-      case GL_UNSIGNED_INT:
-        return MaximumIndexArray(reinterpret_cast<const uint32_t*>(this->Data()), this->Size());
-      default:
-        assert(0);
-        bb::Error("Unknown index array type (0x%x)", this->Type());
-        return 0;
+      memcpy(newData.get(), this->data.get(), this->ByteSize());
     }
+
+    this->data = std::move(newData);
+    this->capacity = size;
+    return 0;
   }
 
-  template<typename data_t>
-  int CopyPlusOffset(data_t* dst, const data_t* src, size_t size, size_t offset)
+  int defaultIndexBuffer_t::Append(const basicIndexBuffer_t& src, size_t offset)
   {
-    auto breakIndex = bb::breakingIndex<data_t>();
-    auto realOffset = static_cast<data_t>(offset);
+    if (!this->data)
+    { // if no data, just assing
+      return this->Assign(src);
+    }
 
-    if (static_cast<size_t>(realOffset) != offset)
+    if (this->Type() != src.Type())
     { // some programmer's mistake
+      bb::Error("%s", "Trying to append buffers of different types");
       assert(0);
       return -1;
     }
-    if ((dst == nullptr) || (src == nullptr))
+
+    if ((src.Size() != 0) && (src.MaximumIndex() + offset >= BreakingIndex(this->Type())))
     {
+      bb::Error("%s", "Too many indecies for buffer!");
+      assert(0);
       return -1;
     }
-    while(size-->0)
-    {
-      auto srcVal = *src++;
-      *dst++ = (srcVal == breakIndex)?(srcVal):(srcVal + realOffset);
+
+    if (this->size + src.Size() > this->capacity)
+    { // grow geometrically, when caller has not reserved
+      this->Reserve(std::max(this->size + src.Size(), this->capacity*2));
     }
+
+    auto appendMax = RebaseRaw(this->Type(), this->data.get() + this->ByteSize(), src.Data(), src.Size(), offset);
+
+    this->size += src.Size();
+    this->maxIndex = std::max(this->maxIndex, appendMax);
     return 0;
   }
 
-  int defaultIndexBuffer_t::Append(const basicIndexBuffer_t& src, size_t offset)
+  mappedIndexBuffer_t::mappedIndexBuffer_t(const std::shared_ptr<const mappedFile_t>& file, const void* data, size_t size, GLenum type)
+  : file(file),
+    data(data),
+    size(size),
+    type(type),
+    maxIndex(0),
+    hasMaxIndex(false)
   {
-    if (!this->data)
-    { // if no data, just assing
-      return this->Assign(src);
+    ;
+  }
+
+  mappedIndexBuffer_t::~mappedIndexBuffer_t()
+  {
+    ;
+  }
+
+  defaultIndexBuffer_t& mappedIndexBuffer_t::Own()
+  {
+    if (!this->owned)
+    { // copy on first write, mapping is not needed anymore
+      this->owned.reset(new defaultIndexBuffer_t(this->data, this->size, this->type));
+      this->data = nullptr;
+      this->file.reset();
     }
+    return *this->owned;
+  }
 
-    if (this->Type() != src.Type())
-    { // some programmer's mistake
-      bb::Error("%s", "Trying to append buffers of different types");
+  int mappedIndexBuffer_t::Append(const basicIndexBuffer_t& src, size_t offset)
+  {
+    if (this == &src)
+    {
+      // programmer's mistake
+      bb::Error("%s", "Can't append buffer to itself");
       assert(0);
       return -1;
     }
+    return this->Own().Append(src, offset);
+  }
 
-    size_t fullByteSize = src.ByteSize() + this->ByteSize();
-    std::unique_ptr<uint8_t[]> fullNewData(new uint8_t[fullByteSize]);
+  int mappedIndexBuffer_t::Reserve(size_t size)
+  {
+    return this->Own().Reserve(size);
+  }
 
-    memcpy(fullNewData.get(), this->Data(), this->ByteSize());
+  size_t mappedIndexBuffer_t::Size() const
+  {
+    return (this->owned)?(this->owned->Size()):(this->size);
+  }
+
+  GLenum mappedIndexBuffer_t::Type() const
+  {
+    return this->type;
+  }
+
+  const void* mappedIndexBuffer_t::Data() const
+  {
+    return (this->owned)?(this->owned->Data()):(this->data);
+  }
+
+  basicIndexBuffer_t* mappedIndexBuffer_t::Copy() const
+  {
+    if (this->owned)
+    {
+      return this->owned->Copy();
+    }
+    return new defaultIndexBuffer_t(this->data, this->size, this->type);
+  }
 
-    switch(this->Type())
+  size_t mappedIndexBuffer_t::MaximumIndex() const
+  {
+    if (this->owned)
     {
-      case GL_BYTE:
-        CopyPlusOffset(
-          reinterpret_cast<int8_t*>(fullNewData.get() + this->ByteSize()),
-          reinterpret_cast<const int8_t*>(src.Data()),
-          src.Size(),
-          offset
-        );
-        break;
-      case GL_UNSIGNED_BYTE:
-        CopyPlusOffset(
-          reinterpret_cast<uint8_t*>(fullNewData.get() + this->ByteSize()),
-          reinterpret_cast<const uint8_t*>(src.Data()),
-          src.Size(),
-          offset
-        );
-        break;
-      case GL_SHORT:
-        CopyPlusOffset(
-          reinterpret_cast<int16_t*>(fullNewData.get() + this->ByteSize()),
-          reinterpret_cast<const int16_t*>(src.Data()),
-          src.Size(),
-          offset
-        );
-        break;
-      case GL_UNSIGNED_SHORT:
-        CopyPlusOffset(
-          reinterpret_cast<uint16_t*>(fullNewData.get() + this->ByteSize()),
-          reinterpret_cast<const uint16_t*>(src.Data()),
-          src.Size(),
-          offset
-        );
-        break;
-      case GL_INT:
-        CopyPlusOffset(
-          reinterpret_cast<int32_t*>(fullNewData.get() + this->ByteSize()),
-          reinterpret_cast<const int32_t*>(src.Data()),
-          src.Size(),
-          offset
-        );
-        break;
-      case GL_UNSIGNED_INT:
-        CopyPlusOffset(
-          reinterpret_cast<uint32_t*>(fullNewData.get() + this->ByteSize()),
-          reinterpret_cast<const uint32_t*>(src.Data()),
-          src.Size(),
-          offset
-        );
-        break;
-      default:
-        assert(0);
-        bb::Error("Unknown index array type (0x%x)", this->Type());
-        return -1;
+      return this->owned->MaximumIndex();
     }
 
-    memcpy(fullNewData.get() + this->ByteSize(), src.Data(), src.ByteSize());
+    if (!this->hasMaxIndex)
+    {
+      this->maxIndex = RawMaximumIndex(this->data, this->size, this->type);
+      this->hasMaxIndex = true;
+    }
+    return this->maxIndex;
+  }
 
-    this->data = std::move(fullNewData);
-    this->size = fullByteSize;
-    return 0;
+  std::unique_ptr<basicIndexBuffer_t> MakeCompactIndexBuffer(std::vector<uint32_t>&& src)
+  {
+    const auto srcBreak = bb::breakingIndex<uint32_t>();
+    const auto dstBreak = bb::breakingIndex<uint16_t>();
+
+    for (auto item: src)
+    {
+      if ((item != srcBreak) && (item >= dstBreak))
+      { // does not fit in short
+        return MakeIndexBuffer(std::move(src));
+      }
+    }
+
+    std::vector<uint16_t> compact;
+    compact.reserve(src.size());
+    for (auto item: src)
+    {
+      compact.emplace_back(
+        (item == srcBreak)?(dstBreak):(static_cast<uint16_t>(item))
+      );
+    }
+    return MakeIndexBuffer(std::move(compact));
   }
 
   template<> GLenum indexBuffer_t<uint8_t>::Type() const
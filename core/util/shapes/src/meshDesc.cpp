@@ -1,5 +1,9 @@
 #include <meshDesc.hpp>
+#include <context.hpp>
+#include <parallel.hpp>
+
 #include <cstring>
+#include <thread>
 
 namespace bb
 {
@@ -20,6 +24,21 @@ namespace bb
     return this->indecies->MaximumIndex();
   }
 
+  size_t meshDesc_t::VertexSize() const
+  {
+    if (this->packed)
+    {
+      return static_cast<size_t>(this->packed->Stride());
+    }
+
+    size_t result = 0;
+    for (auto& buffer: this->buffers)
+    {
+      result += buffer->TypeSize()*static_cast<size_t>(buffer->Dimensions());
+    }
+    return result;
+  }
+
   int meshDesc_t::Append(const meshDesc_t& mesh)
   {
     if (this == &mesh)
@@ -29,22 +48,35 @@ namespace bb
       return -1;
     }
 
-    if (this->buffers.empty())
+    if (this->buffers.empty() && (!this->packed))
     { // destination is empty, just copy
       this->drawMode = mesh.drawMode;
-      this->indecies.reset(mesh.Indecies()->Copy());
+      this->indecies.reset((mesh.indecies)?(mesh.indecies->Copy()):(nullptr));
       for (auto& buffer: mesh.Buffers())
       {
         this->buffers.emplace_back(buffer->Copy());
       }
+      if (mesh.packed)
+      {
+        this->packed.reset(mesh.packed->Copy());
+      }
       return 0;
     }
 
     // otherwise buffers expected to be merged
 
+    if (this->packed || mesh.packed)
+    {
+      // Programmer's error!
+      bb::Error("%s", "Can't append packed mesh");
+      assert(0);
+      return -1;
+    }
+
     if (
          (this->drawMode != mesh.drawMode)
       || (this->buffers.size() != mesh.buffers.size())
+      || ((!this->indecies) != (!mesh.indecies))
       )
     {
       // Programmer's error!
@@ -63,18 +95,117 @@ namespace bb
       }
     }
 
+    if (!this->indecies)
+    { // both meshes are not indexed
+      return 0;
+    }
+
     return this->indecies->Append(*mesh.indecies, this->MaxIndex() + 1);
   }
 
+  int meshDesc_t::AppendAll(const meshDesc_t* const* meshes, size_t count)
+  {
+    if (count == 0)
+    {
+      return 0;
+    }
+
+    size_t first = 0;
+    if (this->buffers.empty() && (!this->packed))
+    { // destination is empty, first mesh defines layout
+      if (this->Append(*meshes[0]) != 0)
+      {
+        return -1;
+      }
+      first = 1;
+    }
+
+    std::vector<size_t> totalVertecies;
+    totalVertecies.reserve(this->buffers.size());
+    for (auto& buffer: this->buffers)
+    {
+      totalVertecies.push_back(buffer->Size());
+    }
+    size_t totalIndecies = (this->indecies)?(this->indecies->Size()):(0);
+
+    for (size_t meshID = first; meshID < count; ++meshID)
+    {
+      const meshDesc_t& mesh = *meshes[meshID];
+      if (
+           (&mesh == this)
+        || (mesh.packed)
+        || (this->drawMode != mesh.drawMode)
+        || (this->buffers.size() != mesh.buffers.size())
+        || ((!this->indecies) != (!mesh.indecies))
+      )
+      {
+        // Programmer's error!
+        bb::Error("%s", "Can't append mesh of different type");
+        assert(0);
+        return -1;
+      }
+
+      for (size_t bufID = 0; bufID < mesh.buffers.size(); ++bufID)
+      {
+        totalVertecies[bufID] += mesh.buffers[bufID]->Size();
+      }
+      totalIndecies += (mesh.indecies)?(mesh.indecies->Size()):(0);
+    }
+
+    for (size_t bufID = 0; bufID < this->buffers.size(); ++bufID)
+    {
+      if (this->buffers[bufID]->Reserve(totalVertecies[bufID]) != 0)
+      {
+        return -1;
+      }
+    }
+    if ((this->indecies) && (this->indecies->Reserve(totalIndecies) != 0))
+    {
+      return -1;
+    }
+
+    for (size_t meshID = first; meshID < count; ++meshID)
+    {
+      if (this->Append(*meshes[meshID]) != 0)
+      {
+        return -1;
+      }
+    }
+    return 0;
+  }
+
   bool meshDesc_t::IsGood() const
   {
-    return (!this->buffers.empty()) && (this->indecies->Size() != 0);
+    return ((!this->buffers.empty()) || (this->packed))
+      && (this->indecies)
+      && (this->indecies->Size() != 0);
+  }
+
+  int meshDesc_t::Pack(const vertexFormat_t& format)
+  {
+    if (this->packed)
+    {
+      bb::Error("%s", "Mesh is already packed");
+      assert(0);
+      return -1;
+    }
+
+    auto result = PackVertecies(this->buffers, format);
+    if (!result)
+    {
+      return -1;
+    }
+
+    this->packed = std::move(result);
+    this->buffers.clear();
+    return 0;
   }
 
 #pragma pack(push, 1)
 
   const uint32_t MESH_DESC_MAGIC         = 0x736d6462;
-  const uint32_t MESH_DESC_VERSION       = 0x01;
+  const uint32_t MESH_DESC_VERSION       = 0x01; // separate arrays
+  const uint32_t MESH_DESC_VERSION_2     = 0x02; // interleaved vertecies
   const uint32_t MESH_DESC_ARRAY_MAGIC   = 0x72616462;
   const uint32_t MESH_DESC_ELEMENT_MAGIC = 0x72656462;
 
@@ -97,69 +228,141 @@ namespace bb
     uint32_t byteSize;
   };
 
-#pragma pack(pop)
+  struct meshDescHeaderV2_t
+  {
+    uint32_t magic;       // 0x736d6462 // "bdms"
+    uint32_t version;     // always 2
+    uint32_t dataOffset;  // where vertex data starts, index data follows it
+    uint32_t drawMode;    // draw mode
+    uint32_t vertexCount; // total vertex count
+    uint32_t stride;      // vertex size in bytes
+    uint32_t attribCount; // attribute headers after file header
+    uint32_t indexType;   // index type
+    uint32_t indexCount;  // total index count
+    float posOffset[3];   // position16 dequantization
+    float posScale[3];
+  };
 
-  int meshDesc_t::Save(FILE* output) const
+  struct meshDescAttribHeader_t
   {
-    assert((this->Buffers().size() + 1) < std::numeric_limits<uint32_t>::max());
+    uint32_t location;
+    uint32_t dim;
+    uint32_t type;
+    uint32_t normalized;
+    uint32_t offset;
+    uint32_t format;      // bb::attribFormat_t
+  };
 
-    meshDescHeader_t header;
-    header.magic = MESH_DESC_MAGIC;
-    header.version = MESH_DESC_VERSION;
-    header.dataOffset = sizeof(meshDescHeader_t);
-    header.bufferCount = static_cast<uint32_t>(this->Buffers().size() + 1); // arrays + element array
-    header.drawMode = this->DrawMode();
+#pragma pack(pop)
 
-    if (fwrite(&header, sizeof(meshDescHeader_t), 1, output) != 1)
-    {
-      return -1;
-    }
+  namespace
+  {
 
-    for (auto& arrayBuffer: this->Buffers())
+    int SavePacked(FILE* output, GLenum drawMode, const packedVertecies_t& packed, const basicIndexBuffer_t& indecies)
     {
-      assert(arrayBuffer->Size() < std::numeric_limits<uint32_t>::max());
-      assert(arrayBuffer->ByteSize() + sizeof(meshDescArrayHeader_t) < std::numeric_limits<uint32_t>::max());
+      assert(packed.Size() < std::numeric_limits<uint32_t>::max());
+      assert(indecies.Size() < std::numeric_limits<uint32_t>::max());
+
+      const auto& attribs = packed.Attribs();
+
+      meshDescHeaderV2_t header;
+      header.magic = MESH_DESC_MAGIC;
+      header.version = MESH_DESC_VERSION_2;
+      header.dataOffset = static_cast<uint32_t>(
+        sizeof(meshDescHeaderV2_t) + attribs.size()*sizeof(meshDescAttribHeader_t)
+      );
+      header.drawMode = drawMode;
+      header.vertexCount = static_cast<uint32_t>(packed.Size());
+      header.stride = static_cast<uint32_t>(packed.Stride());
+      header.attribCount = static_cast<uint32_t>(attribs.size());
+      header.indexType = indecies.Type();
+      header.indexCount = static_cast<uint32_t>(indecies.Size());
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        header.posOffset[axis] = packed.PositionOffset()[axis];
+        header.posScale[axis] = packed.PositionScale()[axis];
+      }
 
-      meshDescArrayHeader_t arrayHeader;
-      arrayHeader.magic = MESH_DESC_ARRAY_MAGIC;
-      arrayHeader.size = static_cast<uint32_t>(arrayBuffer->Size());
-      arrayHeader.dim = static_cast<uint32_t>(arrayBuffer->Dimensions()); // dimension can't be < 0
-      arrayHeader.type = arrayBuffer->Type();
-      arrayHeader.normalized = arrayBuffer->Normalized();
-      arrayHeader.byteSize = static_cast<uint32_t>(arrayBuffer->ByteSize() + sizeof(meshDescArrayHeader_t));
+      if (fwrite(&header, sizeof(meshDescHeaderV2_t), 1, output) != 1)
+      {
+        return -1;
+      }
 
-      if (fwrite(&arrayHeader, sizeof(meshDescArrayHeader_t), 1, output) != 1)
+      for (auto& attrib: attribs)
+      {
+        meshDescAttribHeader_t attribHeader;
+        attribHeader.location = attrib.location;
+        attribHeader.dim = static_cast<uint32_t>(attrib.dim);
+        attribHeader.type = attrib.type;
+        attribHeader.normalized = attrib.normalized;
+        attribHeader.offset = static_cast<uint32_t>(attrib.offset);
+        attribHeader.format = static_cast<uint32_t>(attrib.format);
+
+        if (fwrite(&attribHeader, sizeof(meshDescAttribHeader_t), 1, output) != 1)
+        {
+          return -1;
+        }
+      }
+
+      if (fwrite(packed.Data(), 1, packed.ByteSize(), output) != packed.ByteSize())
       {
         return -1;
       }
-      if (fwrite(arrayBuffer->Data(), 1, arrayBuffer->ByteSize(), output) != arrayBuffer->ByteSize())
+      if (fwrite(indecies.Data(), 1, indecies.ByteSize(), output) != indecies.ByteSize())
       {
         return -1;
       }
+      return 0;
     }
 
-    assert(this->Indecies()->Size() < std::numeric_limits<uint32_t>::max());
-    assert(this->Indecies()->ByteSize() + sizeof(meshDescArrayHeader_t) < std::numeric_limits<uint32_t>::max());
+    bool CheckAttrib(const meshDescAttribHeader_t& attrib, uint32_t stride)
+    {
+      if ((attrib.dim < 1) || (attrib.dim > 4) || (attrib.format > static_cast<uint32_t>(attribFormat_t::color8)))
+      {
+        return false;
+      }
 
-    meshDescArrayHeader_t arrayHeader;
-    arrayHeader.magic = MESH_DESC_ELEMENT_MAGIC;
-    arrayHeader.size = static_cast<uint32_t>(this->Indecies()->Size());
-    arrayHeader.dim = 1;
-    arrayHeader.type = this->Indecies()->Type();
-    arrayHeader.normalized = GL_FALSE;
-    arrayHeader.byteSize = static_cast<uint32_t>(
-      this->Indecies()->ByteSize() + sizeof(meshDescArrayHeader_t)
-    );
+      size_t typeSize = bb::TypeSize(attrib.type);
+      if (typeSize == 0)
+      {
+        return false;
+      }
+      return attrib.offset + typeSize*attrib.dim <= stride;
+    }
 
-    if (fwrite(&arrayHeader, sizeof(meshDescArrayHeader_t), 1, output) != 1)
+  } // namespace
+
+  int meshDesc_t::Save(FILE* output) const
+  {
+    if (!this->IsGood())
     {
+      bb::Error("%s", "Can't save bad mesh description");
+      assert(0);
       return -1;
     }
-    if (fwrite(this->Indecies()->Data(), this->Indecies()->TypeSize(), this->Indecies()->Size(), output) != this->Indecies()->Size())
+
+    if (this->packed)
     {
+      return SavePacked(output, this->DrawMode(), *this->packed, *this->indecies);
+    }
+    return this->Save(output, vertexFormat_t());
+  }
+
+  int meshDesc_t::Save(FILE* output, const vertexFormat_t& format) const
+  {
+    if ((!this->IsGood()) || (this->packed))
+    {
+      bb::Error("%s", "Only unpacked mesh description can be saved with format");
+      assert(0);
       return -1;
     }
-    return 0;
+
+    auto packedVerts = PackVertecies(this->buffers, format);
+    if (!packedVerts)
+    {
+      return -1;
+    }
+    return SavePacked(output, this->DrawMode(), *packedVerts, *this->indecies);
   }
 
   bool meshDesc_t::CheckFile(FILE* input)
@@ -173,8 +376,118 @@ namespace bb
     fseek(input, fpos, SEEK_SET);
     return (
          (header.magic == MESH_DESC_MAGIC)
-      || (header.version == MESH_DESC_VERSION)
+      && ((header.version == MESH_DESC_VERSION) || (header.version == MESH_DESC_VERSION_2))
+    );
+  }
+
+  namespace
+  {
+
+    bool CheckIndexType(uint32_t indexType)
+    {
+      switch (indexType)
+      {
+        case GL_UNSIGNED_BYTE:
+        case GL_UNSIGNED_SHORT:
+        case GL_UNSIGNED_INT:
+          return true;
+        default:
+          bb::Error("Unsupported index type (0x%x)", indexType);
+          return false;
+      }
+    }
+
+  } // namespace
+
+  meshDesc_t meshDesc_t::LoadPacked(FILE* input)
+  {
+    meshDesc_t result;
+    meshDescHeaderV2_t header;
+
+    auto start = ftell(input);
+    if (fread(&header, sizeof(meshDescHeaderV2_t), 1, input) != 1)
+    {
+      assert(0);
+      return meshDesc_t();
+    }
+
+    if ((header.magic != MESH_DESC_MAGIC) || (header.version != MESH_DESC_VERSION_2))
+    {
+      assert(0);
+      return meshDesc_t();
+    }
+
+    if ((!CheckIndexType(header.indexType)) || (header.stride == 0) || (header.attribCount == 0))
+    {
+      assert(0);
+      return meshDesc_t();
+    }
+
+    packedAttribs_t attribs;
+    attribs.reserve(header.attribCount);
+    for (uint32_t attribID = 0; attribID < header.attribCount; ++attribID)
+    {
+      meshDescAttribHeader_t attribHeader;
+      if (fread(&attribHeader, sizeof(meshDescAttribHeader_t), 1, input) != 1)
+      {
+        assert(0);
+        return meshDesc_t();
+      }
+
+      if (!CheckAttrib(attribHeader, header.stride))
+      {
+        bb::Error("Bad vertex attribute %u", attribID);
+        assert(0);
+        return meshDesc_t();
+      }
+
+      packedAttrib_t attrib;
+      attrib.location = attribHeader.location;
+      attrib.dim = static_cast<GLint>(attribHeader.dim);
+      attrib.type = attribHeader.type;
+      attrib.normalized = static_cast<GLboolean>(attribHeader.normalized);
+      attrib.offset = static_cast<GLsizei>(attribHeader.offset);
+      attrib.format = static_cast<attribFormat_t>(attribHeader.format);
+      attribs.push_back(attrib);
+    }
+
+    if (fseek(input, start + static_cast<long>(header.dataOffset), SEEK_SET) != 0)
+    {
+      assert(0);
+      return meshDesc_t();
+    }
+
+    size_t vertexByteSize = static_cast<size_t>(header.vertexCount)*header.stride;
+    std::unique_ptr<uint8_t[]> vertexData(new uint8_t[vertexByteSize]);
+    if (fread(vertexData.get(), 1, vertexByteSize, input) != vertexByteSize)
+    {
+      assert(0);
+      return meshDesc_t();
+    }
+
+    size_t indexByteSize = header.indexCount*bb::TypeSize(header.indexType);
+    std::unique_ptr<uint8_t[]> indexData(new uint8_t[indexByteSize]);
+    if (fread(indexData.get(), 1, indexByteSize, input) != indexByteSize)
+    {
+      assert(0);
+      return meshDesc_t();
+    }
+
+    result.SetDrawMode(header.drawMode);
+    result.packed.reset(
+      new packedVertecies_t(
+        std::move(vertexData),
+        header.vertexCount,
+        static_cast<GLsizei>(header.stride),
+        std::move(attribs),
+        glm::vec3(header.posOffset[0], header.posOffset[1], header.posOffset[2]),
+        glm::vec3(header.posScale[0], header.posScale[1], header.posScale[2])
+      )
+    );
+    result.indecies.reset(
+      new defaultIndexBuffer_t(indexData.get(), header.indexCount, header.indexType)
     );
+    return result;
   }
 
   meshDesc_t meshDesc_t::Load(FILE* input)
@@ -182,12 +495,19 @@ namespace bb
     meshDesc_t result;
     meshDescHeader_t header;
 
+    auto start = ftell(input);
     if (fread(&header, sizeof(meshDescHeader_t), 1, input) != 1)
     {
       assert(0);
       return meshDesc_t();
     }
 
+    if ((header.magic == MESH_DESC_MAGIC) && (header.version == MESH_DESC_VERSION_2))
+    {
+      fseek(input, start, SEEK_SET);
+      return meshDesc_t::LoadPacked(input);
+    }
+
     if ((header.magic != MESH_DESC_MAGIC) || (header.version != MESH_DESC_VERSION))
     {
       assert(0);
@@ -238,7 +558,19 @@ namespace bb
           break;
         case MESH_DESC_ELEMENT_MAGIC:
           {
+            if (!CheckIndexType(arrHeader.type))
+            {
+              assert(0);
+              return meshDesc_t();
+            }
+
             size_t elemDataByteSize = arrHeader.byteSize - sizeof(meshDescArrayHeader_t);
+            if (elemDataByteSize != arrHeader.size * bb::TypeSize(arrHeader.type))
+            {
+              bb::Error("Index array size mismatch (%u elements in " BBsize_t " bytes)", arrHeader.size, elemDataByteSize);
+              assert(0);
+              return meshDesc_t();
+            }
 
             std::unique_ptr<uint8_t[]> elemData(new uint8_t[elemDataByteSize]);
             if (fread(elemData.get(), 1, elemDataByteSize, input) != elemDataByteSize)
@@ -262,4 +594,259 @@ namespace bb
     return result;
   }
 
+  namespace
+  {
+
+    // Headers in file are not aligned, so they are copied out
+    template<typename header_t>
+    bool ReadHeader(const mappedFile_t& file, size_t offset, header_t* header)
+    {
+      if ((offset > file.Size()) || (file.Size() - offset < sizeof(header_t)))
+      {
+        return false;
+      }
+      memcpy(header, file.Data() + offset, sizeof(header_t));
+      return true;
+    }
+
+    bool InFile(const mappedFile_t& file, size_t offset, size_t size)
+    {
+      return (offset <= file.Size()) && (file.Size() - offset >= size);
+    }
+
+    bool IsAligned(const void* ptr, size_t alignment)
+    {
+      return (reinterpret_cast<uintptr_t>(ptr) % alignment) == 0;
+    }
+
+  } // namespace
+
+  meshDesc_t meshDesc_t::Map(const char* filename)
+  {
+    std::shared_ptr<mappedFile_t> file(new mappedFile_t(mappedFile_t::Open(filename)));
+    if (!file->IsGood())
+    {
+      bb::Error("Can't map mesh \"%s\"", filename);
+      return meshDesc_t();
+    }
+    return meshDesc_t::Map(file);
+  }
+
+  meshDesc_t meshDesc_t::Map(const std::shared_ptr<const mappedFile_t>& file)
+  {
+    meshDesc_t result;
+
+    if ((!file) || (!file->IsGood()))
+    {
+      assert(0);
+      return meshDesc_t();
+    }
+
+    meshDescHeader_t header;
+    if ((!ReadHeader(*file, 0, &header)) || (header.magic != MESH_DESC_MAGIC))
+    {
+      bb::Error("%s", "Not a mesh file");
+      return meshDesc_t();
+    }
+
+    switch (header.version)
+    {
+      case MESH_DESC_VERSION:
+        {
+          size_t offset = header.dataOffset;
+          for (uint32_t bufID = 0; bufID < header.bufferCount; ++bufID)
+          {
+            meshDescArrayHeader_t arrHeader;
+            if (
+                 (!ReadHeader(*file, offset, &arrHeader))
+              || (arrHeader.byteSize < sizeof(meshDescArrayHeader_t))
+              || (!InFile(*file, offset, arrHeader.byteSize))
+            )
+            {
+              bb::Error("Mesh buffer %u is out of file", bufID);
+              return meshDesc_t();
+            }
+
+            const uint8_t* payload = file->Data() + offset + sizeof(meshDescArrayHeader_t);
+            size_t payloadSize = arrHeader.byteSize - sizeof(meshDescArrayHeader_t);
+            size_t typeSize = bb::TypeSize(arrHeader.type);
+
+            switch (arrHeader.magic)
+            {
+              case MESH_DESC_ARRAY_MAGIC:
+                if ((typeSize == 0) || (payloadSize != static_cast<size_t>(arrHeader.size)*arrHeader.dim*typeSize))
+                {
+                  bb::Error("Vertex array size mismatch (%u elements in " BBsize_t " bytes)", arrHeader.size, payloadSize);
+                  return meshDesc_t();
+                }
+
+                if (IsAligned(payload, typeSize))
+                {
+                  result.buffers.emplace_back(
+                    new mappedVertexBuffer_t(
+                      file,
+                      payload,
+                      arrHeader.size,
+                      static_cast<GLint>(arrHeader.dim),
+                      arrHeader.type,
+                      static_cast<GLboolean>(arrHeader.normalized)
+                    )
+                  );
+                }
+                else
+                { // odd files with byte data before are copied
+                  result.buffers.emplace_back(
+                    new defaultVertexBuffer_t(
+                      payload,
+                      arrHeader.size,
+                      static_cast<GLint>(arrHeader.dim),
+                      arrHeader.type,
+                      static_cast<GLboolean>(arrHeader.normalized)
+                    )
+                  );
+                }
+                break;
+              case MESH_DESC_ELEMENT_MAGIC:
+                if (!CheckIndexType(arrHeader.type))
+                {
+                  return meshDesc_t();
+                }
+                if (payloadSize != static_cast<size_t>(arrHeader.size)*typeSize)
+                {
+                  bb::Error("Index array size mismatch (%u elements in " BBsize_t " bytes)", arrHeader.size, payloadSize);
+                  return meshDesc_t();
+                }
+
+                if (IsAligned(payload, typeSize))
+                {
+                  result.indecies.reset(new mappedIndexBuffer_t(file, payload, arrHeader.size, arrHeader.type));
+                }
+                else
+                {
+                  result.indecies.reset(new defaultIndexBuffer_t(payload, arrHeader.size, arrHeader.type));
+                }
+                break;
+              default:
+                bb::Error("Unknown mesh buffer (0x%x)", arrHeader.magic);
+                return meshDesc_t();
+            }
+            offset += arrHeader.byteSize;
+          }
+        }
+        break;
+      case MESH_DESC_VERSION_2:
+        {
+          meshDescHeaderV2_t headerV2;
+          if (
+               (!ReadHeader(*file, 0, &headerV2))
+            || (!CheckIndexType(headerV2.indexType))
+            || (headerV2.stride == 0)
+            || (headerV2.attribCount == 0)
+          )
+          {
+            bb::Error("%s", "Bad mesh header");
+            return meshDesc_t();
+          }
+
+          size_t attribOffset = sizeof(meshDescHeaderV2_t);
+          size_t vertexByteSize = static_cast<size_t>(headerV2.vertexCount)*headerV2.stride;
+          size_t indexByteSize = static_cast<size_t>(headerV2.indexCount)*bb::TypeSize(headerV2.indexType);
+
+          if (
+               (headerV2.dataOffset < attribOffset + headerV2.attribCount*sizeof(meshDescAttribHeader_t))
+            || (!InFile(*file, headerV2.dataOffset, vertexByteSize + indexByteSize))
+          )
+          {
+            bb::Error("%s", "Mesh data is out of file");
+            return meshDesc_t();
+          }
+
+          packedAttribs_t attribs;
+          attribs.reserve(headerV2.attribCount);
+          for (uint32_t attribID = 0; attribID < headerV2.attribCount; ++attribID)
+          {
+            meshDescAttribHeader_t attribHeader;
+            if (
+                 (!ReadHeader(*file, attribOffset + attribID*sizeof(meshDescAttribHeader_t), &attribHeader))
+              || (!CheckAttrib(attribHeader, headerV2.stride))
+            )
+            {
+              bb::Error("Bad vertex attribute %u", attribID);
+              return meshDesc_t();
+            }
+
+            packedAttrib_t attrib;
+            attrib.location = attribHeader.location;
+            attrib.dim = static_cast<GLint>(attribHeader.dim);
+            attrib.type = attribHeader.type;
+            attrib.normalized = static_cast<GLboolean>(attribHeader.normalized);
+            attrib.offset = static_cast<GLsizei>(attribHeader.offset);
+            attrib.format = static_cast<attribFormat_t>(attribHeader.format);
+            attribs.push_back(attrib);
+          }
+
+          const uint8_t* indexData = file->Data() + headerV2.dataOffset + vertexByteSize;
+
+          result.SetDrawMode(headerV2.drawMode);
+          result.packed.reset(
+            new packedVertecies_t(
+              // shares ownership of mapping
+              std::shared_ptr<const uint8_t>(file, file->Data() + headerV2.dataOffset),
+              headerV2.vertexCount,
+              static_cast<GLsizei>(headerV2.stride),
+              std::move(attribs),
+              glm::vec3(headerV2.posOffset[0], headerV2.posOffset[1], headerV2.posOffset[2]),
+              glm::vec3(headerV2.posScale[0], headerV2.posScale[1], headerV2.posScale[2])
+            )
+          );
+
+          if (IsAligned(indexData, bb::TypeSize(headerV2.indexType)))
+          {
+            result.indecies.reset(new mappedIndexBuffer_t(file, indexData, headerV2.indexCount, headerV2.indexType));
+          }
+          else
+          {
+            result.indecies.reset(new defaultIndexBuffer_t(indexData, headerV2.indexCount, headerV2.indexType));
+          }
+        }
+        return result;
+      default:
+        bb::Error("Unsupported mesh version (%u)", header.version);
+        return meshDesc_t();
+    }
+
+    result.SetDrawMode(header.drawMode);
+    return result;
+  }
+
+  std::vector<meshDesc_t> MapMeshes(const std::vector<std::string>& filenames)
+  {
+    std::vector<meshDesc_t> result(filenames.size());
+
+    // message per file is too much for thousands of small meshes
+    size_t batchCount = std::min<size_t>(filenames.size(), std::max(std::thread::hardware_concurrency(), 1u)*4);
+    size_t batchSize = (batchCount != 0)?((filenames.size() + batchCount - 1)/batchCount):(0);
+
+    bb::ParallelFor(
+      batchCount,
+      [&filenames, &result, batchSize](size_t batch)
+      {
+        size_t first = batch*batchSize;
+        size_t last = std::min(first + batchSize, filenames.size());
+        for (size_t i = first; i < last; ++i)
+        {
+          std::shared_ptr<mappedFile_t> file(new mappedFile_t(mappedFile_t::Open(filenames[i].c_str())));
+          if (!file->IsGood())
+          {
+            bb::Error("Can't map mesh \"%s\"", filenames[i].c_str());
+            continue;
+          }
+          file->WillNeed();
+          result[i] = meshDesc_t::Map(file);
+        }
+      }
+    );
+    return result;
+  }
+
 } // namespace bb
@@ -0,0 +1,488 @@
+#include <meshOptimize.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace
+{
+
+  const uint32_t noIndex = bb::breakingIndex<uint32_t>();
+
+  template<typename data_t>
+  void ReadIndexArray(const data_t* data, size_t size, std::vector<uint32_t>& result)
+  {
+    auto breakIndex = bb::breakingIndex<data_t>();
+    result.reserve(size);
+    for (auto cursor = data, end = data + size; cursor != end; ++cursor)
+    {
+      result.emplace_back((*cursor == breakIndex)?(noIndex):(static_cast<uint32_t>(*cursor)));
+    }
+  }
+
+  int ReadIndecies(const bb::basicIndexBuffer_t& src, std::vector<uint32_t>& result)
+  {
+    result.clear();
+    switch (src.Type())
+    {
+      case GL_UNSIGNED_BYTE:
+        ReadIndexArray(reinterpret_cast<const uint8_t*>(src.Data()), src.Size(), result);
+        return 0;
+      case GL_UNSIGNED_SHORT:
+        ReadIndexArray(reinterpret_cast<const uint16_t*>(src.Data()), src.Size(), result);
+        return 0;
+      case GL_UNSIGNED_INT:
+        ReadIndexArray(reinterpret_cast<const uint32_t*>(src.Data()), src.Size(), result);
+        return 0;
+      default:
+        bb::Error("Unsupported index array type (0x%x)", src.Type());
+        assert(0);
+        return -1;
+    }
+  }
+
+  bool CheckDesc(const bb::meshDesc_t& desc)
+  {
+    if ((desc.Buffers().empty()) || (!desc.Indecies()))
+    {
+      bb::Error("%s", "Can't optimize mesh without vertex or index data");
+      assert(0);
+      return false;
+    }
+
+    auto vertexCount = desc.Buffers().front()->Size();
+    for (auto& buffer: desc.Buffers())
+    {
+      if (buffer->Size() != vertexCount)
+      {
+        bb::Error("%s", "Vertex buffers have different sizes");
+        assert(0);
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Rebuild all vertex buffers, so new vertex i is old vertex newToOld[i].
+   */
+  void RemapVertecies(bb::meshDesc_t& desc, const std::vector<uint32_t>& newToOld)
+  {
+    for (auto& buffer: desc.Buffers())
+    {
+      auto stride = buffer->ByteSize()/buffer->Size();
+      auto src = reinterpret_cast<const uint8_t*>(buffer->Data());
+
+      std::unique_ptr<uint8_t[]> data(new uint8_t[stride*newToOld.size()]);
+      auto dst = data.get();
+      for (auto oldIndex: newToOld)
+      {
+        memcpy(dst, src + oldIndex*stride, stride);
+        dst += stride;
+      }
+
+      buffer.reset(
+        new bb::defaultVertexBuffer_t(
+          data.get(),
+          newToOld.size(),
+          buffer->Dimensions(),
+          buffer->Type(),
+          buffer->Normalized()
+        )
+      );
+    }
+  }
+
+  // Forsyth's "Linear-Speed Vertex Cache Optimisation" constants
+  const int forsythCacheSize = 32;
+  const float forsythDecayPower = 1.5f;
+  const float forsythLastTriScore = 0.75f;
+  const float forsythValenceScale = 2.0f;
+  const float forsythValencePower = 0.5f;
+
+  float ForsythScore(int cachePos, uint32_t activeTris)
+  {
+    if (activeTris == 0)
+    { // vertex is not used anymore
+      return -1.0f;
+    }
+
+    float score = 0.0f;
+    if (cachePos >= 0)
+    {
+      if (cachePos < 3)
+      { // vertex of last triangle, fixed score prevents strip-like order
+        score = forsythLastTriScore;
+      }
+      else
+      {
+        auto scaler = 1.0f / static_cast<float>(forsythCacheSize - 3);
+        score = std::pow(1.0f - static_cast<float>(cachePos - 3)*scaler, forsythDecayPower);
+      }
+    }
+
+    // vertecies with few triangles left are finished first
+    score += forsythValenceScale * std::pow(static_cast<float>(activeTris), -forsythValencePower);
+    return score;
+  }
+
+  void ForsythOrder(std::vector<uint32_t>& index, size_t vertexCount)
+  {
+    const size_t triCount = index.size()/3;
+
+    // triangles of every vertex, packed in one array
+    std::vector<uint32_t> triStart(vertexCount + 1, 0);
+    for (auto vertex: index)
+    {
+      ++triStart[vertex + 1];
+    }
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+      triStart[i + 1] += triStart[i];
+    }
+
+    std::vector<uint32_t> activeTris(vertexCount, 0);
+    std::vector<uint32_t> vertexTris(index.size());
+    for (size_t tri = 0; tri < triCount; ++tri)
+    {
+      for (size_t corner = 0; corner < 3; ++corner)
+      {
+        auto vertex = index[tri*3 + corner];
+        vertexTris[triStart[vertex] + activeTris[vertex]++] = static_cast<uint32_t>(tri);
+      }
+    }
+
+    std::vector<int> cachePos(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+    {
+      vertexScore[vertex] = ForsythScore(-1, activeTris[vertex]);
+    }
+
+    std::vector<float> triScore(triCount);
+    std::vector<bool> triEmitted(triCount, false);
+    for (size_t tri = 0; tri < triCount; ++tri)
+    {
+      triScore[tri] = vertexScore[index[tri*3]] + vertexScore[index[tri*3 + 1]] + vertexScore[index[tri*3 + 2]];
+    }
+
+    std::vector<uint32_t> result;
+    result.reserve(index.size());
+
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> newCache;
+    cache.reserve(forsythCacheSize + 3);
+    newCache.reserve(forsythCacheSize + 3);
+
+    size_t bestTri = noIndex;
+    float bestScore = -1.0f;
+    for (size_t tri = 0; tri < triCount; ++tri)
+    {
+      if (triScore[tri] > bestScore)
+      {
+        bestScore = triScore[tri];
+        bestTri = tri;
+      }
+    }
+
+    size_t scanCursor = 0;
+    while (result.size() < index.size())
+    {
+      if (bestTri == noIndex)
+      { // cache has no candidates, take next unused triangle
+        while (triEmitted[scanCursor])
+        {
+          ++scanCursor;
+        }
+        bestTri = scanCursor;
+      }
+
+      triEmitted[bestTri] = true;
+
+      newCache.clear();
+      for (size_t corner = 0; corner < 3; ++corner)
+      {
+        auto vertex = index[bestTri*3 + corner];
+        result.emplace_back(vertex);
+        newCache.emplace_back(vertex);
+
+        // forget emitted triangle
+        auto first = vertexTris.begin() + triStart[vertex];
+        auto last = first + activeTris[vertex];
+        auto found = std::find(first, last, static_cast<uint32_t>(bestTri));
+        assert(found != last);
+        std::iter_swap(found, last - 1);
+        --activeTris[vertex];
+      }
+
+      for (auto vertex: cache)
+      {
+        if (std::find(newCache.begin(), newCache.begin() + 3, vertex) == newCache.begin() + 3)
+        {
+          newCache.emplace_back(vertex);
+        }
+      }
+
+      for (size_t i = forsythCacheSize; i < newCache.size(); ++i)
+      { // evicted
+        cachePos[newCache[i]] = -1;
+        vertexScore[newCache[i]] = ForsythScore(-1, activeTris[newCache[i]]);
+      }
+      if (newCache.size() > static_cast<size_t>(forsythCacheSize))
+      {
+        newCache.resize(forsythCacheSize);
+      }
+      std::swap(cache, newCache);
+
+      for (size_t i = 0; i < cache.size(); ++i)
+      {
+        cachePos[cache[i]] = static_cast<int>(i);
+        vertexScore[cache[i]] = ForsythScore(static_cast<int>(i), activeTris[cache[i]]);
+      }
+
+      bestTri = noIndex;
+      bestScore = -1.0f;
+      for (auto vertex: cache)
+      {
+        for (uint32_t i = 0; i < activeTris[vertex]; ++i)
+        {
+          auto tri = vertexTris[triStart[vertex] + i];
+          triScore[tri] = vertexScore[index[tri*3]] + vertexScore[index[tri*3 + 1]] + vertexScore[index[tri*3 + 2]];
+          if (triScore[tri] > bestScore)
+          {
+            bestScore = triScore[tri];
+            bestTri = tri;
+          }
+        }
+      }
+    }
+
+    index = std::move(result);
+  }
+
+} // namespace
+
+namespace bb
+{
+
+  float ACMR(const meshDesc_t& desc, size_t cacheSize)
+  {
+    if ((desc.DrawMode() != GL_TRIANGLES) || (!desc.Indecies()) || (cacheSize == 0))
+    {
+      return 0.0f;
+    }
+
+    std::vector<uint32_t> index;
+    if ((ReadIndecies(*desc.Indecies(), index) != 0) || (index.size() < 3))
+    {
+      return 0.0f;
+    }
+
+    // ring buffer FIFO
+    std::vector<uint32_t> cache(cacheSize, noIndex);
+    size_t head = 0;
+    size_t misses = 0;
+    for (auto vertex: index)
+    {
+      if (std::find(cache.begin(), cache.end(), vertex) == cache.end())
+      {
+        cache[head] = vertex;
+        head = (head + 1) % cacheSize;
+        ++misses;
+      }
+    }
+
+    return static_cast<float>(misses)/static_cast<float>(index.size()/3);
+  }
+
+  int WeldVertecies(meshDesc_t& desc)
+  {
+    if (!CheckDesc(desc))
+    {
+      return -1;
+    }
+
+    std::vector<uint32_t> index;
+    if (ReadIndecies(*desc.Indecies(), index) != 0)
+    {
+      return -1;
+    }
+
+    auto vertexCount = desc.Buffers().front()->Size();
+    if (vertexCount == 0)
+    { // nothing to optimize, mesh stays as is
+      return 0;
+    }
+
+    // all attributes of one vertex side by side, so it can be hashed
+    size_t stride = 0;
+    for (auto& buffer: desc.Buffers())
+    {
+      stride += buffer->ByteSize()/buffer->Size();
+    }
+
+    std::vector<uint8_t> packed(stride*vertexCount);
+    size_t attribOffset = 0;
+    for (auto& buffer: desc.Buffers())
+    {
+      auto attribSize = buffer->ByteSize()/buffer->Size();
+      auto src = reinterpret_cast<const uint8_t*>(buffer->Data());
+      for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+      {
+        memcpy(packed.data() + vertex*stride + attribOffset, src + vertex*attribSize, attribSize);
+      }
+      attribOffset += attribSize;
+    }
+
+    auto vertexHash = [&packed, stride](uint32_t vertex)
+    { // FNV-1a
+      size_t hash = 14695981039346656037ULL;
+      for (auto cursor = packed.data() + vertex*stride, end = cursor + stride; cursor != end; ++cursor)
+      {
+        hash = (hash ^ *cursor) * 1099511628211ULL;
+      }
+      return hash;
+    };
+
+    auto vertexEqual = [&packed, stride](uint32_t a, uint32_t b)
+    {
+      return memcmp(packed.data() + a*stride, packed.data() + b*stride, stride) == 0;
+    };
+
+    std::unordered_map<uint32_t, uint32_t, decltype(vertexHash), decltype(vertexEqual)> unique(
+      vertexCount, vertexHash, vertexEqual
+    );
+
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<uint32_t> newToOld;
+    newToOld.reserve(vertexCount);
+    for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+    {
+      auto inserted = unique.emplace(vertex, static_cast<uint32_t>(newToOld.size()));
+      if (inserted.second)
+      {
+        newToOld.emplace_back(vertex);
+      }
+      remap[vertex] = inserted.first->second;
+    }
+
+    if (newToOld.size() == vertexCount)
+    {
+      return 0;
+    }
+
+    for (auto& item: index)
+    {
+      if (item != noIndex)
+      {
+        item = remap[item];
+      }
+    }
+
+    RemapVertecies(desc, newToOld);
+    desc.Indecies() = MakeCompactIndexBuffer(std::move(index));
+    return static_cast<int>(vertexCount - newToOld.size());
+  }
+
+  int OptimizeVertexCache(meshDesc_t& desc)
+  {
+    if (!CheckDesc(desc))
+    {
+      return -1;
+    }
+
+    if (desc.DrawMode() != GL_TRIANGLES)
+    {
+      bb::Error("Vertex cache optimization needs GL_TRIANGLES mesh (0x%x)", desc.DrawMode());
+      return -1;
+    }
+
+    std::vector<uint32_t> index;
+    if (ReadIndecies(*desc.Indecies(), index) != 0)
+    {
+      return -1;
+    }
+
+    auto vertexCount = desc.Buffers().front()->Size();
+    if (vertexCount == 0)
+    { // nothing to optimize, mesh stays as is
+      return 0;
+    }
+    if ((index.size() % 3 != 0) || (std::any_of(index.begin(), index.end(), [vertexCount](uint32_t item) { return item >= vertexCount; })))
+    {
+      bb::Error("%s", "Invalid triangle list");
+      assert(0);
+      return -1;
+    }
+
+    ForsythOrder(index, vertexCount);
+    desc.Indecies() = MakeCompactIndexBuffer(std::move(index));
+    return 0;
+  }
+
+  int OptimizeVertexFetch(meshDesc_t& desc)
+  {
+    if (!CheckDesc(desc))
+    {
+      return -1;
+    }
+
+    std::vector<uint32_t> index;
+    if (ReadIndecies(*desc.Indecies(), index) != 0)
+    {
+      return -1;
+    }
+
+    auto vertexCount = desc.Buffers().front()->Size();
+    if (vertexCount == 0)
+    { // nothing to optimize, mesh stays as is
+      return 0;
+    }
+
+    std::vector<uint32_t> remap(vertexCount, noIndex);
+    std::vector<uint32_t> newToOld;
+    newToOld.reserve(vertexCount);
+    for (auto& item: index)
+    {
+      if (item == noIndex)
+      {
+        continue;
+      }
+
+      if (item >= vertexCount)
+      {
+        bb::Error("%s", "Index out of vertex buffer");
+        assert(0);
+        return -1;
+      }
+
+      if (remap[item] == noIndex)
+      {
+        remap[item] = static_cast<uint32_t>(newToOld.size());
+        newToOld.emplace_back(item);
+      }
+      item = remap[item];
+    }
+
+    RemapVertecies(desc, newToOld);
+    desc.Indecies() = MakeCompactIndexBuffer(std::move(index));
+    return 0;
+  }
+
+  int OptimizeMesh(meshDesc_t& desc)
+  {
+    if (WeldVertecies(desc) < 0)
+    {
+      return -1;
+    }
+
+    if ((desc.DrawMode() == GL_TRIANGLES) && (OptimizeVertexCache(desc) != 0))
+    {
+      return -1;
+    }
+
+    return OptimizeVertexFetch(desc);
+  }
+
+} // namespace bb
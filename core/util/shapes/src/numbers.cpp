@@ -68,13 +68,13 @@ namespace bb
       return meshDesc_t();
     }
 
-    auto wideNumber = bb::utf8extract(utf8Text);
-
     meshDesc_t result;
 
     glm::vec2 cursor(0.0f);
 
-    for(auto smb: wideNumber)
+    utf8Decoder_t decoder(utf8Text);
+    uint32_t smb;
+    while (decoder.Next(&smb))
     {
       if (IsSpace(static_cast<wint_t>(smb)))
       {
@@ -105,6 +105,13 @@ namespace bb
       );
       cursor.x += 1.0f;
     }
+
+    if (!decoder.IsGood())
+    {
+      bb::Error("Invalid UTF-8 text: \"%s\"", utf8Text);
+      assert(0);
+      return meshDesc_t();
+    }
     return result;
   }
 
@@ -0,0 +1,348 @@
+#include <packedVertecies.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+
+namespace bb
+{
+
+  packedVertecies_t::packedVertecies_t(
+    std::unique_ptr<uint8_t[]>&& data,
+    size_t count,
+    GLsizei stride,
+    packedAttribs_t&& attribs,
+    const glm::vec3& posOffset,
+    const glm::vec3& posScale
+  )
+  : data(data.release(), std::default_delete<uint8_t[]>()),
+    count(count),
+    stride(stride),
+    attribs(std::move(attribs)),
+    posOffset(posOffset),
+    posScale(posScale)
+  {
+    ;
+  }
+
+  packedVertecies_t::packedVertecies_t(
+    const std::shared_ptr<const uint8_t>& data,
+    size_t count,
+    GLsizei stride,
+    packedAttribs_t&& attribs,
+    const glm::vec3& posOffset,
+    const glm::vec3& posScale
+  )
+  : data(data),
+    count(count),
+    stride(stride),
+    attribs(std::move(attribs)),
+    posOffset(posOffset),
+    posScale(posScale)
+  {
+    ;
+  }
+
+  glm::mat4 packedVertecies_t::Dequantize() const
+  {
+    glm::mat4 result(1.0f);
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      result[axis][axis] = this->posScale[axis];
+      result[3][axis] = this->posOffset[axis];
+    }
+    return result;
+  }
+
+  packedVertecies_t* packedVertecies_t::Copy() const
+  {
+    packedAttribs_t attribsCopy(this->attribs);
+    return new packedVertecies_t(
+      this->data,
+      this->count,
+      this->stride,
+      std::move(attribsCopy),
+      this->posOffset,
+      this->posScale
+    );
+  }
+
+  namespace
+  {
+
+    const float SNORM16_MAX = static_cast<float>(std::numeric_limits<int16_t>::max());
+    const float UNORM8_MAX = static_cast<float>(std::numeric_limits<uint8_t>::max());
+
+    GLsizei Align4(size_t size)
+    {
+      return static_cast<GLsizei>((size + 3) & ~static_cast<size_t>(3));
+    }
+
+    int16_t SNorm16(float value)
+    {
+      value = std::min(std::max(value, -1.0f), 1.0f);
+      return static_cast<int16_t>(std::lround(value*SNORM16_MAX));
+    }
+
+    uint8_t UNorm8(float value)
+    {
+      value = std::min(std::max(value, 0.0f), 1.0f);
+      return static_cast<uint8_t>(std::lround(value*UNORM8_MAX));
+    }
+
+    float SignNotZero(float value)
+    {
+      return (value >= 0.0f)?(1.0f):(-1.0f);
+    }
+
+    // Project unit vector to octahedron and unfold lower half over upper one
+    void Octahedral(const float* norm, int16_t* out)
+    {
+      float len = fabsf(norm[0]) + fabsf(norm[1]) + fabsf(norm[2]);
+      if (len == 0.0f)
+      {
+        out[0] = 0;
+        out[1] = 0;
+        return;
+      }
+
+      float x = norm[0]/len;
+      float y = norm[1]/len;
+      if (norm[2] < 0.0f)
+      {
+        float ox = (1.0f - fabsf(y))*SignNotZero(x);
+        float oy = (1.0f - fabsf(x))*SignNotZero(y);
+        x = ox;
+        y = oy;
+      }
+      out[0] = SNorm16(x);
+      out[1] = SNorm16(y);
+    }
+
+    bool CheckSource(const basicVertexBuffer_t& buffer, attribFormat_t format)
+    {
+      switch (format)
+      {
+        case attribFormat_t::native:
+          return true;
+        case attribFormat_t::position16:
+        case attribFormat_t::color8:
+          if ((buffer.Type() != GL_FLOAT) || (buffer.Dimensions() < 1) || (buffer.Dimensions() > 4))
+          {
+            bb::Error("%s", "Quantized attribute needs float buffer with 1-4 dimensions");
+            return false;
+          }
+          if ((format == attribFormat_t::position16) && (buffer.Dimensions() > 3))
+          {
+            bb::Error("%s", "Quantized position can't have more than 3 dimensions");
+            return false;
+          }
+          return true;
+        case attribFormat_t::normal16:
+          if ((buffer.Type() != GL_FLOAT) || (buffer.Dimensions() != 3))
+          {
+            bb::Error("%s", "Octahedral normal needs float buffer with 3 dimensions");
+            return false;
+          }
+          return true;
+        default:
+          bb::Error("Unknown attribute format (%u)", static_cast<uint32_t>(format));
+          return false;
+      }
+    }
+
+  } // namespace
+
+  std::unique_ptr<packedVertecies_t> PackVertecies(const arrayOfVertexBuffers_t& buffers, const vertexFormat_t& format)
+  {
+    if (buffers.empty() || (format.size() > buffers.size()))
+    {
+      // Programmer's error!
+      bb::Error("%s", "Vertex format doesn't match buffers");
+      assert(0);
+      return nullptr;
+    }
+
+    size_t count = buffers.front()->Size();
+    packedAttribs_t attribs;
+    attribs.reserve(buffers.size());
+
+    glm::vec3 posOffset(0.0f);
+    glm::vec3 posScale(1.0f);
+    size_t posAttrib = buffers.size();
+
+    GLsizei stride = 0;
+    for (size_t bufID = 0; bufID < buffers.size(); ++bufID)
+    {
+      const auto& buffer = *buffers[bufID];
+      attribFormat_t attribFormat = (bufID < format.size())?(format[bufID]):(attribFormat_t::native);
+
+      if (buffer.Size() != count)
+      {
+        bb::Error("Vertex buffers have different sizes (" BBsize_t " != " BBsize_t ")", buffer.Size(), count);
+        assert(0);
+        return nullptr;
+      }
+
+      if (!CheckSource(buffer, attribFormat))
+      {
+        assert(0);
+        return nullptr;
+      }
+
+      packedAttrib_t attrib;
+      attrib.location = static_cast<GLuint>(bufID);
+      attrib.offset = stride;
+      attrib.format = attribFormat;
+      switch (attribFormat)
+      {
+        case attribFormat_t::native:
+          attrib.dim = buffer.Dimensions();
+          attrib.type = buffer.Type();
+          attrib.normalized = buffer.Normalized();
+          stride += Align4(buffer.TypeSize()*static_cast<size_t>(buffer.Dimensions()));
+          break;
+        case attribFormat_t::position16:
+          if (posAttrib != buffers.size())
+          {
+            bb::Error("%s", "Only one attribute can be quantized position");
+            assert(0);
+            return nullptr;
+          }
+          posAttrib = bufID;
+          attrib.dim = buffer.Dimensions();
+          attrib.type = GL_SHORT;
+          attrib.normalized = GL_TRUE;
+          stride += Align4(sizeof(int16_t)*static_cast<size_t>(buffer.Dimensions()));
+          break;
+        case attribFormat_t::normal16:
+          attrib.dim = 2;
+          attrib.type = GL_SHORT;
+          attrib.normalized = GL_TRUE;
+          stride += Align4(sizeof(int16_t)*2);
+          break;
+        case attribFormat_t::color8:
+          attrib.dim = 4;
+          attrib.type = GL_UNSIGNED_BYTE;
+          attrib.normalized = GL_TRUE;
+          stride += Align4(sizeof(uint8_t)*4);
+          break;
+      }
+      attribs.push_back(attrib);
+    }
+
+    if (posAttrib != buffers.size())
+    { // quantized positions are stored relative to bounding box center
+      const auto& buffer = *buffers[posAttrib];
+      auto dim = static_cast<size_t>(buffer.Dimensions());
+      auto axes = static_cast<glm::length_t>(dim);
+      auto src = static_cast<const float*>(buffer.Data());
+
+      glm::vec3 minBox(0.0f);
+      glm::vec3 maxBox(0.0f);
+      if (count != 0)
+      {
+        for (glm::length_t axis = 0; axis < axes; ++axis)
+        {
+          minBox[axis] = maxBox[axis] = src[static_cast<size_t>(axis)];
+        }
+      }
+      for (size_t vertID = 0; vertID < count; ++vertID)
+      {
+        for (glm::length_t axis = 0; axis < axes; ++axis)
+        {
+          minBox[axis] = std::min(minBox[axis], src[vertID*dim + static_cast<size_t>(axis)]);
+          maxBox[axis] = std::max(maxBox[axis], src[vertID*dim + static_cast<size_t>(axis)]);
+        }
+      }
+
+      for (glm::length_t axis = 0; axis < axes; ++axis)
+      {
+        posOffset[axis] = (maxBox[axis] + minBox[axis])*0.5f;
+        posScale[axis] = (maxBox[axis] - minBox[axis])*0.5f;
+        if (posScale[axis] == 0.0f)
+        { // flat mesh, any scale works
+          posScale[axis] = 1.0f;
+        }
+      }
+    }
+
+    std::unique_ptr<uint8_t[]> data(new uint8_t[count*static_cast<size_t>(stride)]);
+    memset(data.get(), 0, count*static_cast<size_t>(stride));
+
+    for (size_t bufID = 0; bufID < buffers.size(); ++bufID)
+    {
+      const auto& buffer = *buffers[bufID];
+      const auto& attrib = attribs[bufID];
+      auto dim = static_cast<size_t>(buffer.Dimensions());
+      uint8_t* dst = data.get() + attrib.offset;
+
+      switch (attrib.format)
+      {
+        case attribFormat_t::native:
+          {
+            auto src = static_cast<const uint8_t*>(buffer.Data());
+            size_t vertSize = buffer.TypeSize()*dim;
+            for (size_t vertID = 0; vertID < count; ++vertID, dst += stride, src += vertSize)
+            {
+              memcpy(dst, src, vertSize);
+            }
+          }
+          break;
+        case attribFormat_t::position16:
+          {
+            auto src = static_cast<const float*>(buffer.Data());
+            auto axes = static_cast<glm::length_t>(dim);
+            for (size_t vertID = 0; vertID < count; ++vertID, dst += stride, src += dim)
+            {
+              int16_t pos[3];
+              for (glm::length_t axis = 0; axis < axes; ++axis)
+              {
+                pos[axis] = SNorm16((src[axis] - posOffset[axis])/posScale[axis]);
+              }
+              memcpy(dst, pos, sizeof(int16_t)*dim);
+            }
+          }
+          break;
+        case attribFormat_t::normal16:
+          {
+            auto src = static_cast<const float*>(buffer.Data());
+            for (size_t vertID = 0; vertID < count; ++vertID, dst += stride, src += dim)
+            {
+              int16_t norm[2];
+              Octahedral(src, norm);
+              memcpy(dst, norm, sizeof(norm));
+            }
+          }
+          break;
+        case attribFormat_t::color8:
+          {
+            auto src = static_cast<const float*>(buffer.Data());
+            for (size_t vertID = 0; vertID < count; ++vertID, dst += stride, src += dim)
+            {
+              uint8_t color[4] = { 0, 0, 0, 255 };
+              for (size_t comp = 0; comp < dim; ++comp)
+              {
+                color[comp] = UNorm8(src[comp]);
+              }
+              memcpy(dst, color, sizeof(color));
+            }
+          }
+          break;
+      }
+    }
+
+    return std::unique_ptr<packedVertecies_t>(
+      new packedVertecies_t(
+        std::move(data),
+        count,
+        stride,
+        std::move(attribs),
+        posOffset,
+        posScale
+      )
+    );
+  }
+
+} // namespace bb
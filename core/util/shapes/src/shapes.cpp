@@ -7,6 +7,7 @@
 #include <memory>
 #include <limits>
 #include <cinttypes>
+#include <algorithm>
 
 namespace bb
 {
@@ -30,7 +31,7 @@ namespace bb
     glDrawElements(
       this->drawMode,
       static_cast<GLsizei>(renderVertecies),
-      GL_UNSIGNED_SHORT,
+      this->indexType,
       nullptr
     );
     for (auto i = 0u; i < this->activeBuffers; ++i)
@@ -53,8 +54,10 @@ namespace bb
   mesh_t::mesh_t()
   : totalVerts(0),
     drawMode(GL_TRIANGLES),
+    indexType(GL_UNSIGNED_SHORT),
     activeBuffers(2),
-    breakIndex(0)
+    breakIndex(0),
+    dequantize(1.0f)
   {
     flags.BREAK = 0;
   }
@@ -63,8 +66,24 @@ namespace bb
   : vao(std::move(vao)),
     totalVerts(totalVerts),
     drawMode(drawMode),
+    indexType(GL_UNSIGNED_SHORT),
     activeBuffers(activeBuffers),
-    breakIndex(0)
+    breakIndex(0),
+    dequantize(1.0f)
+  {
+    this->flags.BREAK = 0;
+  }
+
+  mesh_t::mesh_t(vao_t&& vao, std::vector<vbo_t>&& buffers, vbo_t&& indecies, size_t totalVerts, GLenum drawMode, GLenum indexType)
+  : vao(std::move(vao)),
+    buffers(std::move(buffers)),
+    indecies(std::move(indecies)),
+    totalVerts(totalVerts),
+    drawMode(drawMode),
+    indexType(indexType),
+    activeBuffers(static_cast<GLuint>(this->buffers.size())),
+    breakIndex(0),
+    dequantize(1.0f)
   {
     this->flags.BREAK = 0;
   }
@@ -75,28 +94,183 @@ namespace bb
     this->breakIndex = index;
   }
 
-  mesh_t GenerateMesh(const meshDesc_t& meshDesc)
+  namespace
   {
-    if (!meshDesc.IsGood())
+
+    bool CheckMeshDesc(const meshDesc_t& meshDesc)
     {
-      bb::Error("%s", "GenerateMesh from bad description!");
-      assert(0);
-      return bb::mesh_t();
+      if (!meshDesc.IsGood())
+      {
+        bb::Error("%s", "GenerateMesh from bad description!");
+        assert(0);
+        return false;
+      }
+
+      switch (meshDesc.Indecies()->Type())
+      {
+        case GL_UNSIGNED_BYTE:
+        case GL_UNSIGNED_SHORT:
+        case GL_UNSIGNED_INT:
+          break;
+        default:
+          // OpenGL draws only unsigned indecies
+          bb::Error("Unsupported index type (0x%x)", meshDesc.Indecies()->Type());
+          assert(0);
+          return false;
+      }
+
+      auto maxIndex = meshDesc.Indecies()->MaximumIndex();
+
+      if ((meshDesc.Packed() != nullptr) && (meshDesc.Packed()->Size() < maxIndex))
+      {
+        bb::Error("Packed vertecies less than available indecies (" BBsize_t " < " BBsize_t ")", meshDesc.Packed()->Size(), maxIndex);
+        assert(0);
+        return false;
+      }
+
+      for (auto& dataBuffer: meshDesc.Buffers())
+      {
+        if (dataBuffer->Size() < maxIndex)
+        {
+          bb::Error("Data buffer smaller than available indecies (%lu < " BBsize_t ")", dataBuffer->Size(), maxIndex);
+          assert(0);
+          return false;
+        }
+      }
+      return true;
     }
 
-    auto maxIndex = meshDesc.Indecies()->MaximumIndex();
+    uint32_t BreakingIndex(GLenum indexType)
+    {
+      switch(indexType)
+      {
+        case GL_UNSIGNED_BYTE:
+          return bb::breakingIndex<uint8_t>();
+        case GL_UNSIGNED_INT:
+          return bb::breakingIndex<uint32_t>();
+        default:
+          return bb::breakingIndex<uint16_t>();
+      }
+    }
 
-    for (auto& dataBuffer: meshDesc.Buffers())
+    void SetupBreaking(mesh_t& mesh, GLenum drawMode)
     {
-      if (dataBuffer->Size() < maxIndex)
+      switch(drawMode)
       {
-        bb::Error("Data buffer smaller than available indecies (%lu < " BBsize_t ")", dataBuffer->Size(), maxIndex);
-        assert(0);
-        return bb::mesh_t();
+        case GL_LINE_STRIP:
+        case GL_TRIANGLE_STRIP:
+        case GL_TRIANGLE_FAN:
+          mesh.Breaking(true, BreakingIndex(mesh.IndexType()));
+          break;
+        default:
+          mesh.Breaking(false, 0);
+      }
+    }
+
+    // Bind all packed attributes to one VBO, returns number of used attribute locations
+    GLuint BindPacked(vao_t& vao, const vbo_t& vbo, const packedVertecies_t& packed)
+    {
+      GLuint result = 0;
+      for (auto& attrib: packed.Attribs())
+      {
+        vao.BindVBO(
+          vbo,
+          attrib.location,
+          attrib.dim,
+          attrib.type,
+          attrib.normalized,
+          packed.Stride(),
+          attrib.offset
+        );
+        result = std::max(result, attrib.location + 1);
       }
+      return result;
+    }
+
+    size_t VertexBufferCount(const meshDesc_t& meshDesc)
+    {
+      return (meshDesc.Packed() != nullptr)?(1):(meshDesc.Buffers().size());
+    }
+
+  } // namespace
+
+  int mesh_t::Update(const meshDesc_t& meshDesc)
+  {
+    if ((!this->vao.Good()) || (!this->indecies.Good()) || (this->buffers.size() != VertexBufferCount(meshDesc)))
+    {
+      *this = GenerateMesh(meshDesc);
+      return (this->Good())?(0):(-1);
+    }
+
+    if (!CheckMeshDesc(meshDesc))
+    {
+      return -1;
+    }
+
+    GLuint arrayBufferIndex = 0;
+    if (meshDesc.Packed() != nullptr)
+    {
+      auto& packed = *meshDesc.Packed();
+      this->buffers.front().Upload(packed.Data(), packed.ByteSize());
+      arrayBufferIndex = BindPacked(this->vao, this->buffers.front(), packed);
+      this->dequantize = packed.Dequantize();
+    }
+    else
+    {
+      this->dequantize = glm::mat4(1.0f);
+    }
+
+    for (auto& arrayBuffer: meshDesc.Buffers())
+    {
+      auto& vbo = this->buffers[arrayBufferIndex];
+      vbo.Upload(arrayBuffer->Data(), arrayBuffer->ByteSize());
+      this->vao.BindVBO(
+        vbo,
+        arrayBufferIndex,
+        arrayBuffer->Dimensions(),
+        arrayBuffer->Type(),
+        arrayBuffer->Normalized(),
+        0, 0
+      );
+      ++arrayBufferIndex;
+    }
+
+    this->indecies.Upload(
+      meshDesc.Indecies()->Data(),
+      meshDesc.Indecies()->ByteSize()
+    );
+
+    this->totalVerts = meshDesc.Indecies()->Size();
+    this->drawMode = meshDesc.DrawMode();
+    this->indexType = meshDesc.Indecies()->Type();
+    this->activeBuffers = arrayBufferIndex;
+    SetupBreaking(*this, meshDesc.DrawMode());
+    return 0;
+  }
+
+  mesh_t GenerateMesh(const meshDesc_t& meshDesc)
+  {
+    if (!CheckMeshDesc(meshDesc))
+    {
+      return bb::mesh_t();
     }
 
     auto meshVAO = bb::vao_t::CreateVertexAttribObject();
+    std::vector<vbo_t> meshVBOs;
+    meshVBOs.reserve(VertexBufferCount(meshDesc));
+
+    GLuint activeBuffers = 0;
+    if (meshDesc.Packed() != nullptr)
+    { // one glBufferData for all attributes
+      auto& packed = *meshDesc.Packed();
+      auto meshVBO = bb::vbo_t::CreateArrayBuffer(
+        packed.Data(),
+        packed.ByteSize(),
+        false
+      );
+      activeBuffers = BindPacked(meshVAO, meshVBO, packed);
+      meshVBOs.emplace_back(std::move(meshVBO));
+    }
 
     GLuint arrayBufferIndex = 0;
     for (auto& arrayBuffer: meshDesc.Buffers())
@@ -114,6 +288,7 @@ namespace bb
         arrayBuffer->Normalized(),
         0, 0
       );
+      meshVBOs.emplace_back(std::move(meshVBO));
       ++arrayBufferIndex;
     }
 
@@ -127,22 +302,18 @@ namespace bb
 
     auto mesh = bb::mesh_t(
       std::move(meshVAO),
+      std::move(meshVBOs),
+      std::move(indexVBO),
       meshDesc.Indecies()->Size(),
       meshDesc.DrawMode(),
-      static_cast<GLuint>(meshDesc.Buffers().size())
+      meshDesc.Indecies()->Type()
     );
-
-    switch(meshDesc.DrawMode())
+    if (meshDesc.Packed() != nullptr)
     {
-      case GL_LINE_STRIP:
-      case GL_TRIANGLE_STRIP:
-      case GL_TRIANGLE_FAN:
-        mesh.Breaking(true, bb::breakingIndex<uint16_t>());
-        break;
-      default:
-        mesh.Breaking(false, 0);
+      mesh.activeBuffers = activeBuffers;
+      mesh.dequantize = meshDesc.Packed()->Dequantize();
     }
-
+    SetupBreaking(mesh, meshDesc.DrawMode());
     return mesh;
   }
 
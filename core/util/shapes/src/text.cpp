@@ -1,25 +1,20 @@
 #include <cstdarg>
+#include <cstddef>
 
 #include <text.hpp>
 #include <utf8.hpp>
 #include <common.hpp>
+#include <worker.hpp>
+#include <role.hpp>
+
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
 
 namespace
 {
 
-  template<typename text_t>
-  uint32_t GetTotalSpaceCount(const text_t& text)
-  {
-    uint32_t result = 0;
-    for (auto smb: text)
-    { // standard says, that isspace works for symbols between 0 and 255
-      // otherwise - result implementation dependent
-      // win32 crt raises assert here, so additional check here
-      result += ((smb <= 0xFF) && (std::isspace(static_cast<int>(smb)) != 0));
-    }
-    return result;
-  }
-
   const glm::vec2 uvMatrix[] = {
     { 0.0f, 1.0f },
     { 1.0f, 1.0f },
@@ -37,141 +32,104 @@ namespace
   static_assert(bb::countof(uvMatrix) == bb::countof(uvInvertedMatrix), "Both matricies expected to be same size!");
   static_assert(bb::countof(uvMatrix) == 4, "and size must be equal to 4, not 3, not 5, 4 is the number");
 
-  size_t MakeText(
-    const bb::font_t& font,
-    const char* text,
-    bb::vec2_t chSize,
-    bb::textStorage_t& output)
+  bool IsLayoutSpace(uint32_t smb)
+  { // standard says, that isspace works for symbols between 0 and 255
+    // otherwise - result implementation dependent
+    // win32 crt raises assert here, so additional check here
+    return (smb <= 0xFF) && (std::isspace(static_cast<int>(smb)) != 0);
+  }
+
+  /**
+   * Check, that one more symbol can be indexed with uint16_t.
+   *
+   * In debug we assert this issue, in release tail of text is truncated.
+   */
+  bool HasRoom(size_t symbols)
   {
-    auto symbols = bb::utf8extract(text);
-    auto totalSpaces = GetTotalSpaceCount(symbols);
-
-    auto totalSymbols = symbols.size() - totalSpaces;
-    auto breakIndex = bb::breakingIndex<uint16_t>();
-
-    assert(totalSymbols*4 < breakIndex); // in debug we assert this issue
-    if (totalSymbols*4 >= breakIndex)
-    { // we are using uint16_t for vert indecies
-      // need to check if given text is to long for
-      // in release we truncate tail
-      symbols.resize(breakIndex/4);
-    }
+    bool result = ((symbols + 1)*4 < bb::breakingIndex<uint16_t>());
+    assert(result);
+    return result;
+  }
 
-    if (output.vPos.size() < totalSymbols*4)
+  /**
+   * Storage is reused between layouts and only grows.
+   */
+  void Reserve(bb::glyphQuads_t& output, size_t symbols)
+  {
+    if (output.size() < symbols*4)
     {
-      output.vPos.resize(totalSymbols*4);
-      output.vUV.resize(totalSymbols*4);
-      output.vCol.resize(totalSymbols*4);
-      output.indecies.resize(totalSymbols*6);
+      output.resize(std::max(symbols*4, output.size()*2));
     }
+  }
 
-    assert(totalSymbols*6 <= output.indecies.size());
-
-    uint32_t vID = 0;
-    bb::vec3_t cursor = bb::vec3_t(0.0f);
-
-    auto vPosIt = output.vPos.begin();
-    auto vUVIt = output.vUV.begin();
-    auto vColIt = output.vCol.begin();
-    auto indIt = output.indecies.begin();
-
-    const glm::vec2* pUVMatrix = (chSize.y < 0)?(uvInvertedMatrix):(uvMatrix);
-    chSize.y = fabsf(chSize.y);
-
-    auto ccolt = glm::vec4(1.0f);
-    auto ccolb = glm::vec4(1.0f);
-
-    for (auto it = symbols.begin(), e = symbols.end(); it != e; ++it)
+  void AddQuad(
+    bb::glyphQuads_t& output,
+    size_t symbol,
+    bb::vec3_t cursor,
+    bb::vec2_t chSize,
+    const bb::glyph_t& glyph,
+    const glm::vec2* pUVMatrix,
+    const bb::vec4_t& colTop,
+    const bb::vec4_t& colBottom)
+  {
+    auto vIt = output.begin() + static_cast<ptrdiff_t>(symbol*4);
+    const bb::vec3_t vPos[] = {
+      { cursor.x, cursor.y, cursor.z },
+      { cursor.x + chSize.x, cursor.y, cursor.z },
+      { cursor.x, cursor.y + chSize.y, cursor.z },
+      { cursor.x + chSize.x, cursor.y + chSize.y, cursor.z }
+    };
+    for (size_t i = 0; i < bb::countof(vPos); ++i, ++vIt)
     {
-      auto smb = *it;
+      vIt->pos = vPos[i];
+      vIt->uv = glyph.offset + glyph.size*pUVMatrix[i];
+      vIt->col = (i < 2)?(colTop):(colBottom);
+    }
+  }
 
-      if (((smb <= 0xFF) && (std::isspace(static_cast<int>(smb)) != 0)) || (smb == '\\'))
-      {
-        switch (smb)
-        {
-        case '\n':
-          ccolb = glm::vec4(1.0f);
-          ccolt = glm::vec4(1.0f);
-          cursor.x = 0.0f;
-          cursor.y += chSize.y;
-          break;
-        case '\t':
-          // Move cursor integer part of tab stops in cursor + 1
-          cursor.x = (floorf(cursor.x/(chSize.x*2.0f))+1.0f)*chSize.x*2.0f;
-          break;
-        case '\\':
-          ++it;
-          smb = *it;
-          switch(smb)
-          {
-            case '0':
-              ccolb = glm::vec4(1.0f);
-              ccolt = glm::vec4(0.0f);
-              break;
-            case '1':
-              ccolb = glm::vec4(0.0f);
-              ccolt = glm::vec4(1.0f);
-              break;
-            default:
-              assert(0);
-              bb::Warning("Unknown escape sequence: \\(%02X)", smb);
-          }
-          break;
-        default:
-          bb::Warning("Unknown space char: (%02X)", smb);
-          /* FALLTHROUGH */
-        case ' ':
-          cursor.x += chSize.x;
-        }
-      }
-      else
-      {
-        bb::vec2_t smbOffset = font.SymbolOffset(smb);
-        bb::vec2_t smbSize   = font.SymbolSize(smb);
-
-        *vPosIt++ = { cursor.x, cursor.y, cursor.z };
-        *vPosIt++ = { cursor.x + chSize.x, cursor.y, cursor.z};
-        *vPosIt++ = { cursor.x, cursor.y + chSize.y, cursor.z};
-        *vPosIt++ = { cursor.x + chSize.x, cursor.y + chSize.y, cursor.z};
-
-        *vUVIt++ = { smbOffset.x + smbSize.x * pUVMatrix[0].x, smbOffset.y + smbSize.y * pUVMatrix[0].y };
-        *vUVIt++ = { smbOffset.x + smbSize.x * pUVMatrix[1].x, smbOffset.y + smbSize.y * pUVMatrix[1].y };
-        *vUVIt++ = { smbOffset.x + smbSize.x * pUVMatrix[2].x, smbOffset.y + smbSize.y * pUVMatrix[2].y };
-        *vUVIt++ = { smbOffset.x + smbSize.x * pUVMatrix[3].x, smbOffset.y + smbSize.y * pUVMatrix[3].y };
-
-        *vColIt++ = ccolt;
-        *vColIt++ = ccolt;
-        *vColIt++ = ccolb;
-        *vColIt++ = ccolb;
-
-        *indIt++ = static_cast<uint16_t>(vID+0u);
-        *indIt++ = static_cast<uint16_t>(vID+1u);
-        *indIt++ = static_cast<uint16_t>(vID+2u);
-        *indIt++ = static_cast<uint16_t>(vID+1u);
-        *indIt++ = static_cast<uint16_t>(vID+3u);
-        *indIt++ = static_cast<uint16_t>(vID+2u);
-        vID += 4u;
-        cursor.x += chSize.x;
-      }
+  /**
+   * Indecies for given number of quads, same for every text.
+   */
+  void QuadIndecies(size_t symbols, bb::storage_t<uint16_t>& output)
+  {
+    output.resize(symbols*6);
+    auto indIt = output.begin();
+    for (size_t symbol = 0; symbol < symbols; ++symbol)
+    {
+      auto vID = static_cast<uint32_t>(symbol*4);
+      *indIt++ = static_cast<uint16_t>(vID+0u);
+      *indIt++ = static_cast<uint16_t>(vID+1u);
+      *indIt++ = static_cast<uint16_t>(vID+2u);
+      *indIt++ = static_cast<uint16_t>(vID+1u);
+      *indIt++ = static_cast<uint16_t>(vID+3u);
+      *indIt++ = static_cast<uint16_t>(vID+2u);
     }
-    return totalSymbols*6;
   }
 
-  using range_t = std::tuple<bb::utf8Symbols::iterator, bb::utf8Symbols::iterator>;
+  void BindGlyphVertecies(bb::vao_t& vao, const bb::vbo_t& vbo)
+  {
+    auto stride = static_cast<GLsizei>(sizeof(bb::glyphVertex_t));
+    vao.BindVBO(vbo, 0, 3, GL_FLOAT, GL_FALSE, stride, static_cast<GLsizei>(offsetof(bb::glyphVertex_t, pos)));
+    vao.BindVBO(vbo, 1, 2, GL_FLOAT, GL_FALSE, stride, static_cast<GLsizei>(offsetof(bb::glyphVertex_t, uv)));
+    vao.BindVBO(vbo, 2, 4, GL_FLOAT, GL_FALSE, stride, static_cast<GLsizei>(offsetof(bb::glyphVertex_t, col)));
+  }
+
+  using range_t = std::tuple<const char*, const char*>;
 
   bool ExtractLine(range_t input, size_t maxWidth, range_t* result)
   {
     assert(result != nullptr);
 
-    auto cursor = std::get<0>(input);
+    auto start = std::get<0>(input);
     auto end = std::get<1>(input);
 
-    auto start = cursor;
-
-    bb::utf8Symbols::iterator lastSpace = end;
+    auto cursor = start;
+    const char* lastSpace = end;
     bool newLine = false;
 
-    for (size_t curWidth = 0; cursor != end; ++cursor, ++curWidth)
+    bb::utf8Decoder_t decoder(start, static_cast<size_t>(end - start));
+    uint32_t smb;
+    for (size_t curWidth = 0; decoder.Next(&smb); ++curWidth)
     {
       if (curWidth > maxWidth)
       {
@@ -179,7 +137,7 @@ namespace
         return true;
       }
 
-      switch (*cursor)
+      switch (smb)
       {
       case '\n':
         if (newLine)
@@ -196,6 +154,12 @@ namespace
         newLine = false;
         break;
       }
+      cursor = decoder.Position();
+    }
+
+    if (!decoder.IsGood())
+    {
+      throw std::runtime_error("Non-UTF8 string");
     }
 
     *result = std::make_tuple(cursor, end);
@@ -206,40 +170,16 @@ namespace
     const bb::font_t& font,
     const std::string& text,
     bb::vec2_t chSize,
-    bb::textStorage_t& output,
+    bb::glyphQuads_t& output,
     size_t maxWidth)
   {
-    auto symbols = bb::utf8extract(text.c_str());
-
-    auto breakIndex = bb::breakingIndex<uint16_t>();
-
-    assert(symbols.size()*4 < breakIndex); // in debug we assert this issue
-    if (symbols.size()*4 >= breakIndex)
-    { // we are using uint16_t for vert indecies
-      // need to check if given text is to long for
-      // in release we truncate tail
-      symbols.resize(breakIndex/4);
-    }
-
-    if (output.vPos.size() < symbols.size()*4)
-    {
-      output.vPos.resize(symbols.size()*4);
-      output.vUV.resize(symbols.size()*4);
-      output.indecies.resize(symbols.size()*6);
-    }
-
-    assert(symbols.size()*6 <= output.indecies.size());
-
-    uint32_t vID = 0;
+    size_t symbols = 0;
     bb::vec3_t cursor = bb::vec3_t(0.0f);
 
-    auto vPosIt = output.vPos.begin();
-    auto vUVIt = output.vUV.begin();
-    auto indIt = output.indecies.begin();
-
     bool newLine = true;
 
-    range_t line = std::make_tuple(symbols.begin(), symbols.end());
+    const char* textEnd = text.c_str() + text.size();
+    range_t line = std::make_tuple(text.c_str(), textEnd);
     while(ExtractLine(line, maxWidth - (newLine*2), &line))
     {
       if (newLine)
@@ -248,9 +188,11 @@ namespace
         newLine = false;
       }
 
-      for (auto it = std::get<0>(line), e = std::get<1>(line); it != e; ++it)
+      bb::utf8Decoder_t decoder(std::get<0>(line), static_cast<size_t>(std::get<1>(line) - std::get<0>(line)));
+      uint32_t smb;
+      while (decoder.Next(&smb))
       {
-        switch(*it)
+        switch(smb)
         {
           case '\n':
           case ' ':
@@ -258,38 +200,27 @@ namespace
             break;
           default:
           {
-            bb::vec2_t smbOffset = font.SymbolOffset(*it);
-            bb::vec2_t smbSize   = font.SymbolSize(*it);
-
-            *vPosIt++ = { cursor.x, cursor.y, cursor.z };
-            *vPosIt++ = { cursor.x + chSize.x, cursor.y, cursor.z};
-            *vPosIt++ = { cursor.x, cursor.y + chSize.y, cursor.z};
-            *vPosIt++ = { cursor.x + chSize.x, cursor.y + chSize.y, cursor.z};
-
-            *vUVIt++ = { smbOffset.x, smbOffset.y + smbSize.y };
-            *vUVIt++ = { smbOffset.x + smbSize.x, smbOffset.y + smbSize.y };
-            *vUVIt++ = { smbOffset.x, smbOffset.y };
-            *vUVIt++ = { smbOffset.x + smbSize.x, smbOffset.y };
-
-            *indIt++ = static_cast<uint16_t>(vID+0u);
-            *indIt++ = static_cast<uint16_t>(vID+1u);
-            *indIt++ = static_cast<uint16_t>(vID+2u);
-            *indIt++ = static_cast<uint16_t>(vID+1u);
-            *indIt++ = static_cast<uint16_t>(vID+3u);
-            *indIt++ = static_cast<uint16_t>(vID+2u);
-
-            vID += 4u;
+            if (!HasRoom(symbols))
+            {
+              output.resize(symbols*4);
+              return symbols*6;
+            }
+            Reserve(output, symbols + 1);
+
+            AddQuad(output, symbols, cursor, chSize, font.Glyph(smb), uvMatrix, bb::vec4_t(1.0f), bb::vec4_t(1.0f));
+
+            ++symbols;
             cursor.x += chSize.x;
           }
         }
       }
 
-      if ((std::get<1>(line) != symbols.end()) && (*std::get<1>(line) == '\n'))
+      if ((std::get<1>(line) != textEnd) && (*std::get<1>(line) == '\n'))
       {
         newLine = true;
       }
 
-      if (std::get<1>(line) == symbols.end())
+      if (std::get<1>(line) == textEnd)
       { // this happen when line has no spaces and whole line is processed
         break;
       }
@@ -297,10 +228,11 @@ namespace
       cursor.x = 0.0f;
       cursor.y -= chSize.y;
 
-      line = std::make_tuple(std::get<1>(line)+1, symbols.end());
+      line = std::make_tuple(std::get<1>(line)+1, textEnd);
     }
 
-    return symbols.size()*6;
+    output.resize(symbols*4);
+    return symbols*6;
   }
 
 }
@@ -308,6 +240,90 @@ namespace
 namespace bb
 {
 
+  size_t LayoutText(
+    const font_t& font,
+    const char* text,
+    vec2_t chSize,
+    glyphQuads_t& output)
+  {
+    size_t symbols = 0;
+    bb::vec3_t cursor = bb::vec3_t(0.0f);
+
+    const glm::vec2* pUVMatrix = (chSize.y < 0)?(uvInvertedMatrix):(uvMatrix);
+    chSize.y = fabsf(chSize.y);
+
+    auto ccolt = glm::vec4(1.0f);
+    auto ccolb = glm::vec4(1.0f);
+
+    utf8Decoder_t decoder(text);
+    uint32_t smb;
+    while (decoder.Next(&smb))
+    {
+      if (IsLayoutSpace(smb) || (smb == '\\'))
+      {
+        switch (smb)
+        {
+        case '\n':
+          ccolb = glm::vec4(1.0f);
+          ccolt = glm::vec4(1.0f);
+          cursor.x = 0.0f;
+          cursor.y += chSize.y;
+          break;
+        case '\t':
+          // Move cursor integer part of tab stops in cursor + 1
+          cursor.x = (floorf(cursor.x/(chSize.x*2.0f))+1.0f)*chSize.x*2.0f;
+          break;
+        case '\\':
+          if (!decoder.Next(&smb))
+          {
+            break;
+          }
+          switch(smb)
+          {
+            case '0':
+              ccolb = glm::vec4(1.0f);
+              ccolt = glm::vec4(0.0f);
+              break;
+            case '1':
+              ccolb = glm::vec4(0.0f);
+              ccolt = glm::vec4(1.0f);
+              break;
+            default:
+              assert(0);
+              bb::Warning("Unknown escape sequence: \\(%02X)", smb);
+          }
+          break;
+        default:
+          bb::Warning("Unknown space char: (%02X)", smb);
+          /* FALLTHROUGH */
+        case ' ':
+          cursor.x += chSize.x;
+        }
+      }
+      else
+      {
+        if (!HasRoom(symbols))
+        {
+          break;
+        }
+        Reserve(output, symbols + 1);
+
+        AddQuad(output, symbols, cursor, chSize, font.Glyph(smb), pUVMatrix, ccolt, ccolb);
+
+        ++symbols;
+        cursor.x += chSize.x;
+      }
+    }
+
+    if (!decoder.IsGood())
+    {
+      throw std::runtime_error("Non-UTF8 string");
+    }
+
+    output.resize(symbols*4);
+    return symbols*6;
+  }
+
   void textStatic_t::Render()
   {
     assert(this->tex);
@@ -323,134 +339,258 @@ namespace bb
   textStatic_t::textStatic_t(const font_t& font, const std::string& text, vec2_t chSize, size_t maxWidth)
   :tex(font.Texture())
   {
-    textStorage_t textV;
+    glyphQuads_t quads;
 
+    size_t textI = 0;
     if (maxWidth == 0)
     {
-      MakeText(font, text.c_str(), chSize, textV);
+      textI = LayoutText(font, text.c_str(), chSize, quads);
     }
     else
     {
-      MakeTextMultiline(font, text, chSize, textV, maxWidth);
+      textI = MakeTextMultiline(font, text, chSize, quads, maxWidth);
     }
 
-    vbo_t vPosVBO = vbo_t::CreateArrayBuffer(textV.vPos.data(), ByteSize(textV.vPos), false);
-    vbo_t vUVVBO = vbo_t::CreateArrayBuffer(textV.vUV.data(), ByteSize(textV.vUV), false);
-    vbo_t vColVBO = vbo_t::CreateArrayBuffer(textV.vCol.data(), ByteSize(textV.vCol), false);
-    vbo_t indeciesVBO = vbo_t::CreateElementArrayBuffer(textV.indecies.data(), ByteSize(textV.indecies), false);
+    storage_t<uint16_t> indecies;
+    QuadIndecies(textI/6, indecies);
 
-    vao_t vao = vao_t::CreateVertexAttribObject();
+    vbo_t vertexVBO = vbo_t::CreateArrayBuffer(quads, false);
+    vbo_t indeciesVBO = vbo_t::CreateElementArrayBuffer(indecies, false);
 
-    vao.BindVBO(vPosVBO, 0, 3, GL_FLOAT, GL_FALSE, 0, 0);
-    vao.BindVBO(vUVVBO, 1, 2, GL_FLOAT, GL_FALSE, 0, 0);
-    vao.BindVBO(vColVBO, 2, 4, GL_FLOAT, GL_FALSE, 0, 0);
+    vao_t vao = vao_t::CreateVertexAttribObject();
+    BindGlyphVertecies(vao, vertexVBO);
     vao.BindIndecies(indeciesVBO);
 
-    this->mesh = mesh_t(std::move(vao), textV.indecies.size(), GL_TRIANGLES, 2);
+    this->mesh = mesh_t(std::move(vao), indecies.size(), GL_TRIANGLES, 2);
   }
 
-  void textDynamic_t::UpdateText(const char* text)
+  struct textDynamic_t::layout_t final
   {
-    assert(this->font != nullptr);
-    size_t textI = MakeText(*this->font, text, this->chSize, this->vertecies);
+    std::mutex guard;
+    actorPID_t worker;
+    std::mutex fontGuard;      /**< held by worker, while font is used */
+    const font_t* font;        /**< nullptr after text object is released */
+    vec2_t chSize;
+
+    std::vector<char> pending; /**< text to lay out next */
+    glyphQuads_t ready;        /**< finished layout, not uploaded yet */
+    size_t readyI;
+    bool hasPending;
+    bool hasReady;
+    bool busy;                 /**< layout task is posted to worker */
+
+    // used only by worker, while busy
+    std::vector<char> work;
+    glyphQuads_t workQuads;
+
+    /**
+     * Lay out all posted text. Only latest text is laid out, when several
+     * updates arrived, while worker was busy.
+     */
+    void Run();
+
+    layout_t(const font_t& font, vec2_t chSize);
+  };
 
-    if (textI == 0)
+  void textDynamic_t::layout_t::Run()
+  {
+    for(;;)
     {
-      Error("%s", "Empty Dynamic String");
-      assert(0);
-      return;
+      {
+        std::lock_guard<std::mutex> lock(this->guard);
+        if (!this->hasPending)
+        {
+          this->busy = false;
+          return;
+        }
+        this->pending.swap(this->work);
+        this->hasPending = false;
+      }
+
+      size_t textI = 0;
+      {
+        std::lock_guard<std::mutex> fontLock(this->fontGuard);
+        if (this->font == nullptr)
+        { // text object and its font may be already destroyed
+          std::lock_guard<std::mutex> lock(this->guard);
+          this->busy = false;
+          return;
+        }
+
+        try
+        {
+          textI = LayoutText(*this->font, this->work.data(), this->chSize, this->workQuads);
+        }
+        catch (const std::exception& error)
+        { // keep previous text on screen
+          bb::Error("Text layout failed: %s", error.what());
+          continue;
+        }
+      }
+
+      std::lock_guard<std::mutex> lock(this->guard);
+      this->ready.swap(this->workQuads);
+      this->readyI = textI;
+      this->hasReady = true;
     }
+  }
 
-    if (this->totalI < textI)
-    { // new bigger VBO needed
-      Debug("Allocate New VBO (%lu)", textI);
+  textDynamic_t::layout_t::layout_t(const font_t& font, vec2_t chSize)
+  : worker(workerPool_t::Instance().Register<execTask_t>()),
+    font(&font),
+    chSize(chSize),
+    readyI(0),
+    hasPending(false),
+    hasReady(false),
+    busy(false)
+  {
+    ;
+  }
 
-      this->vPosVBO = vbo_t::CreateArrayBuffer(
-        this->vertecies.vPos.data(),
-        ByteSize(this->vertecies.vPos),
-        true
-      );
-      this->vUVVBO = vbo_t::CreateArrayBuffer(
-        this->vertecies.vUV.data(),
-        ByteSize(this->vertecies.vUV),
-        true
-      );
-      this->vColVBO = vbo_t::CreateArrayBuffer(
-        this->vertecies.vCol.data(),
-        ByteSize(this->vertecies.vCol),
-        true
-      );
-      this->indeciesVBO = vbo_t::CreateElementArrayBuffer(
-        this->vertecies.indecies.data(),
-        ByteSize(this->vertecies.indecies),
-        true
+  void textDynamic_t::PostText()
+  {
+    assert(this->layout);
+
+    bool post = false;
+    {
+      std::lock_guard<std::mutex> lock(this->layout->guard);
+      this->layout->pending.swap(this->text);
+      this->layout->hasPending = true;
+      if (!this->layout->busy)
+      {
+        this->layout->busy = true;
+        post = true;
+      }
+    }
+
+    if (post)
+    {
+      auto layout = this->layout;
+      auto task = [layout]() -> msg::result_t
+      {
+        layout->Run();
+        return msg::result_t::complete;
+      };
+
+      workerPool_t::Instance().PostMessage(
+        layout->worker,
+        msg_t(new msg::execTask_t<decltype(task)>(task))
       );
+    }
+  }
 
-      this->totalI = textI;
-      this->totalV = this->vertecies.vPos.size();
+  void textDynamic_t::Upload()
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->layout->guard);
+      if (!this->layout->hasReady)
+      {
+        return;
+      }
+      this->quads.swap(this->layout->ready);
+      this->renderI = this->layout->readyI;
+      this->layout->hasReady = false;
     }
-    else
-    { // old VBO enough
-      size_t textV = textI/6*4;
 
-      this->vPosVBO.Update(0, sizeof(vec3_t)*textV, this->vertecies.vPos.data());
-      this->vUVVBO.Update(0,  sizeof(vec2_t)*textV, this->vertecies.vUV.data());
-      this->vColVBO.Update(0, sizeof(vec4_t)*textV, this->vertecies.vCol.data());
-      this->indeciesVBO.Update(0, sizeof(uint16_t)*textI, this->vertecies.indecies.data());
+    if (this->renderI == 0)
+    {
+      return;
     }
 
-    this->vao.BindVBO(this->vPosVBO, 0, 3, GL_FLOAT, GL_FALSE, 0, 0);
-    this->vao.BindVBO(this->vUVVBO, 1, 2, GL_FLOAT, GL_FALSE, 0, 0);
-    this->vao.BindVBO(this->vColVBO, 2, 4, GL_FLOAT, GL_FALSE, 0, 0);
-    this->vao.BindIndecies(this->indeciesVBO);
+    this->vertexVBO.Upload(this->quads.data(), ByteSize(this->quads));
+
+    if (this->totalI < this->renderI)
+    { // indecies change only when text grows
+      auto maxSymbols = static_cast<size_t>(breakingIndex<uint16_t>())/4;
+      auto symbols = std::min(std::max(this->renderI/6, this->totalI/6*2), maxSymbols);
 
-    this->renderI = textI;
+      storage_t<uint16_t> indecies;
+      QuadIndecies(symbols, indecies);
+      this->indeciesVBO.Upload(indecies.data(), ByteSize(indecies));
+      this->totalI = indecies.size();
+    }
+  }
+
+  void textDynamic_t::Release()
+  {
+    if (this->layout)
+    { // running task keeps layout alive, but font can die right after text
+      {
+        // waits only for layout, which is running now
+        std::lock_guard<std::mutex> fontLock(this->layout->fontGuard);
+        this->layout->font = nullptr;
+      }
+      workerPool_t::Instance().Unregister(this->layout->worker);
+      this->layout.reset();
+    }
   }
 
   void textDynamic_t::Update(const std::string& text)
   {
-    this->UpdateText(text.c_str());
+    assert(this->layout);
+    this->text.assign(text.c_str(), text.c_str() + text.size() + 1);
+    this->PostText();
   }
 
   void textDynamic_t::Update(const char* format, ...)
   {
-    char* text = nullptr;
+    assert(this->layout);
+
     va_list vl;
     va_start(vl, format);
     BB_DEFER(va_end(vl));
 
-    auto len = vasprintf(&text, format, vl);
-    if (len == -1)
+    // use all memory, left from previous texts
+    this->text.resize(std::max<size_t>(this->text.capacity(), 64));
+
+    va_list vlCopy;
+    va_copy(vlCopy, vl);
+    auto len = vsnprintf(this->text.data(), this->text.size(), format, vlCopy);
+    va_end(vlCopy);
+
+    if (len < 0)
     {
-      bb::Error("%s", "vasprintf failed");
+      bb::Error("%s", "vsnprintf failed");
       return;
     }
-    BB_DEFER(free(text));
-    this->UpdateText(text);
+
+    if (static_cast<size_t>(len) >= this->text.size())
+    {
+      this->text.resize(static_cast<size_t>(len) + 1);
+      vsnprintf(this->text.data(), this->text.size(), format, vl);
+    }
+    this->PostText();
   }
 
   void textDynamic_t::Render()
   {
-    if (!this->vertecies.indecies.empty())
+    if (!this->layout)
     {
-      assert(this->font != nullptr);
-
-      texture_t::Bind(*this->font->Texture());
-      vao_t::Bind(this->vao);
-
-      glEnableVertexAttribArray(0);
-      glEnableVertexAttribArray(1);
-      glEnableVertexAttribArray(2);
-      glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(this->renderI), GL_UNSIGNED_SHORT, 0);
-      glDisableVertexAttribArray(2);
-      glDisableVertexAttribArray(1);
-      glDisableVertexAttribArray(0);
+      return;
     }
+
+    this->Upload();
+    if (this->renderI == 0)
+    {
+      return;
+    }
+
+    assert(this->font != nullptr);
+
+    texture_t::Bind(*this->font->Texture());
+    vao_t::Bind(this->vao);
+
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(this->renderI), GL_UNSIGNED_SHORT, 0);
+    glDisableVertexAttribArray(2);
+    glDisableVertexAttribArray(1);
+    glDisableVertexAttribArray(0);
   }
 
   textDynamic_t::textDynamic_t()
   : font(nullptr),
-    totalV(0),
     totalI(0),
     renderI(0)
   {
@@ -461,11 +601,45 @@ namespace bb
   : vao(vao_t::CreateVertexAttribObject()),
     font(&font),
     chSize(chSize),
-    totalV(0),
+    vertexVBO(vbo_t::CreateArrayBuffer(nullptr, 0, true)),
+    indeciesVBO(vbo_t::CreateElementArrayBuffer(nullptr, 0, true)),
     totalI(0),
-    renderI(0)
+    renderI(0),
+    layout(std::make_shared<layout_t>(font, chSize))
   {
-    ;
+    BindGlyphVertecies(this->vao, this->vertexVBO);
+    this->vao.BindIndecies(this->indeciesVBO);
+  }
+
+  textDynamic_t& textDynamic_t::operator=(textDynamic_t&& move)
+  {
+    if (this == &move)
+    {
+      return *this;
+    }
+
+    this->Release();
+
+    this->vao = std::move(move.vao);
+    this->font = move.font;
+    this->chSize = move.chSize;
+    this->vertexVBO = std::move(move.vertexVBO);
+    this->indeciesVBO = std::move(move.indeciesVBO);
+    this->totalI = move.totalI;
+    this->renderI = move.renderI;
+    this->quads = std::move(move.quads);
+    this->text = std::move(move.text);
+    this->layout = std::move(move.layout);
+
+    move.font = nullptr;
+    move.totalI = 0;
+    move.renderI = 0;
+    return *this;
+  }
+
+  textDynamic_t::~textDynamic_t()
+  {
+    this->Release();
   }
 
 } // namespace bb
@@ -0,0 +1,94 @@
+#include <uploadQueue.hpp>
+
+namespace bb
+{
+
+  size_t uploadQueue_t::ByteSize(const meshDesc_t& desc)
+  {
+    size_t result = 0;
+    for (auto& buffer: desc.Buffers())
+    {
+      result += buffer->ByteSize();
+    }
+    if (desc.Packed() != nullptr)
+    {
+      result += desc.Packed()->ByteSize();
+    }
+    if (desc.Indecies())
+    {
+      result += desc.Indecies()->ByteSize();
+    }
+    return result;
+  }
+
+  void uploadQueue_t::Push(mesh_t* target, meshDesc_t&& desc)
+  {
+    assert(target != nullptr);
+
+    auto bytes = uploadQueue_t::ByteSize(desc);
+    for (auto& command: this->pending)
+    {
+      if (command.target == target)
+      { // keep place in queue, but upload latest data
+        command.desc = std::move(desc);
+        command.bytes = bytes;
+        return;
+      }
+    }
+
+    command_t command;
+    command.target = target;
+    command.desc = std::move(desc);
+    command.bytes = bytes;
+    this->pending.emplace_back(std::move(command));
+  }
+
+  void uploadQueue_t::Cancel(const mesh_t* target)
+  {
+    for (auto it = this->pending.begin(); it != this->pending.end();)
+    {
+      if (it->target == target)
+      {
+        it = this->pending.erase(it);
+        continue;
+      }
+      ++it;
+    }
+  }
+
+  size_t uploadQueue_t::Flush()
+  {
+    this->frameBytes = 0;
+    while (!this->pending.empty())
+    {
+      auto& command = this->pending.front();
+      if ((this->frameBytes != 0) && (this->frameBytes + command.bytes > this->budget))
+      {
+        break;
+      }
+
+      if (command.target->Update(command.desc) != 0)
+      {
+        bb::Error("Mesh upload failed (" BBsize_t " bytes)", command.bytes);
+      }
+      this->frameBytes += command.bytes;
+      this->pending.pop_front();
+    }
+    this->totalBytes += this->frameBytes;
+    return this->frameBytes;
+  }
+
+  uploadQueue_t::uploadQueue_t(size_t budget)
+  : budget(budget),
+    frameBytes(0),
+    totalBytes(0)
+  {
+    ;
+  }
+
+  uploadQueue_t::~uploadQueue_t()
+  {
+    ;
+  }
+
+} // namespace bb
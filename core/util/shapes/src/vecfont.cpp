@@ -1,5 +1,9 @@
 #include <vecfont.hpp>
 #include <common.hpp>
+#include <glyphTable.hpp>
+
+#include <unordered_map>
+#include <vector>
 
 namespace
 {
@@ -812,11 +816,15 @@ namespace
     size_t size;
   };
 
-  using vectorFont_t = std::map<wint_t, symbol_t>;
+  struct mapping_t
+  {
+    wint_t smb;
+    symbol_t symbol;
+  };
 
   #define SYMBOL(SMB, ARRAY) { (SMB), { (ARRAY), bb::countof(ARRAY) } }
 
-  vectorFont_t vectorFont = {
+  const mapping_t vectorFontSymbols[] = {
     SYMBOL(U'0', tZero),
     SYMBOL(U'1', tOne),
     SYMBOL(U'2', tTwo),
@@ -980,11 +988,43 @@ namespace
     SYMBOL(U'№', tNumero),
   };
 
-  symbol_t dummy = {
-    tUndef,
-    bb::countof(tUndef)
+  /**
+   * Symbols stored once in flat array, upper and lower case letters share glyphs.
+   */
+  class vectorFont_t final
+  {
+    bb::glyphTable_t table;
+    std::vector<symbol_t> symbols; // symbol 0 is drawn for unknown symbols
+
+  public:
+
+    const symbol_t& Symbol(wint_t smb) const
+    {
+      return this->symbols[this->table.Find(static_cast<uint32_t>(smb))];
+    }
+
+    vectorFont_t()
+    : symbols(1, symbol_t{ tUndef, bb::countof(tUndef) })
+    {
+      std::unordered_map<const glm::vec2*, uint16_t> ids;
+      for (auto& mapping: vectorFontSymbols)
+      {
+        auto inserted = ids.emplace(mapping.symbol.v, static_cast<uint16_t>(this->symbols.size()));
+        if (inserted.second)
+        {
+          this->symbols.push_back(mapping.symbol);
+        }
+        this->table.Insert(static_cast<uint32_t>(mapping.smb), inserted.first->second);
+      }
+    }
   };
 
+  const vectorFont_t& VectorFont()
+  {
+    static const vectorFont_t font;
+    return font;
+  }
+
 } // namespace
 
 namespace bb
@@ -998,15 +1038,9 @@ namespace bb
       return nullptr;
     }
 
-    auto it = vectorFont.find(smb);
-    if (it == vectorFont.end())
-    {
-      *pSize = dummy.size;
-      return dummy.v;
-    }
-
-    *pSize = it->second.size;
-    return it->second.v;
+    auto& symbol = VectorFont().Symbol(smb);
+    *pSize = symbol.size;
+    return symbol.v;
   }
 
 } // namespace bb
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <context.hpp>
 
 #include <cstring>
+#include <algorithm>
 
 namespace bb
 {
@@ -51,6 +52,84 @@ namespace bb
     return new defaultVertexBuffer_t(*this);
   }
 
+  mappedVertexBuffer_t::mappedVertexBuffer_t(const std::shared_ptr<const mappedFile_t>& file, const void* data, size_t size, GLint dim, GLenum type, GLboolean normalized)
+  : file(file),
+    data(data),
+    size(size),
+    dim(dim),
+    type(type),
+    normalized(normalized)
+  {
+    ;
+  }
+
+  mappedVertexBuffer_t::~mappedVertexBuffer_t()
+  {
+    ;
+  }
+
+  defaultVertexBuffer_t& mappedVertexBuffer_t::Own()
+  {
+    if (!this->owned)
+    { // copy on first write, mapping is not needed anymore
+      this->owned.reset(new defaultVertexBuffer_t(this->data, this->size, this->dim, this->type, this->normalized));
+      this->data = nullptr;
+      this->file.reset();
+    }
+    return *this->owned;
+  }
+
+  int mappedVertexBuffer_t::Append(const basicVertexBuffer_t& src)
+  {
+    if (this == &src)
+    {
+      // Programmer's error!
+      bb::Error("%s", "Can't append buffer to itself");
+      assert(0);
+      return -1;
+    }
+    return this->Own().Append(src);
+  }
+
+  int mappedVertexBuffer_t::Reserve(size_t size)
+  {
+    return this->Own().Reserve(size);
+  }
+
+  size_t mappedVertexBuffer_t::Size() const
+  {
+    return (this->owned)?(this->owned->Size()):(this->size);
+  }
+
+  GLint mappedVertexBuffer_t::Dimensions() const
+  {
+    return this->dim;
+  }
+
+  GLenum mappedVertexBuffer_t::Type() const
+  {
+    return this->type;
+  }
+
+  GLboolean mappedVertexBuffer_t::Normalized() const
+  {
+    return this->normalized;
+  }
+
+  const void* mappedVertexBuffer_t::Data() const
+  {
+    return (this->owned)?(this->owned->Data()):(this->data);
+  }
+
+  basicVertexBuffer_t* mappedVertexBuffer_t::Copy() const
+  {
+    if (this->owned)
+    {
+      return this->owned->Copy();
+    }
+    return new defaultVertexBuffer_t(this->data, this->size, this->dim, this->type, this->normalized);
+  }
+
   int defaultVertexBuffer_t::Assign(const basicVertexBuffer_t& src)
   {
     if ((src.ByteSize() == 0) || (src.Data() == nullptr))
@@ -66,6 +145,7 @@ namespace bb
 
     this->data       = std::move(newData);
     this->size       = src.Size();
+    this->capacity   = src.Size();
     this->dim        = src.Dimensions();
     this->type       = src.Type();
     this->normalized = src.Normalized();
@@ -91,21 +171,34 @@ namespace bb
     }
 
     // otherwise append data at end
-    size_t fullByteSize = src.ByteSize() + this->ByteSize();
-    size_t fullItemSize = src.Size() + this->Size();
+    if (this->size + src.Size() > this->capacity)
+    { // grow geometrically, when caller has not reserved
+      this->Reserve(std::max(this->size + src.Size(), this->capacity*2));
+    }
+
+    memcpy(this->data.get() + this->ByteSize(), src.Data(), src.ByteSize());
+    this->size += src.Size();
+    return 0;
+  }
 
-    std::unique_ptr<uint8_t[]> fullNewData(new uint8_t[fullByteSize]);
+  int defaultVertexBuffer_t::Reserve(size_t size)
+  {
+    if ((!this->data) || (size <= this->capacity))
+    { // layout of empty buffer is defined by first Append
+      return 0;
+    }
 
-    memcpy(fullNewData.get(), this->Data(), this->ByteSize());
-    memcpy(fullNewData.get() + this->ByteSize(), src.Data(), src.ByteSize());
+    std::unique_ptr<uint8_t[]> newData(new uint8_t[size*static_cast<size_t>(this->dim)*this->TypeSize()]);
+    memcpy(newData.get(), this->data.get(), this->ByteSize());
 
-    this->data = std::move(fullNewData);
-    this->size = fullItemSize;
+    this->data = std::move(newData);
+    this->capacity = size;
     return 0;
   }
 
   defaultVertexBuffer_t::defaultVertexBuffer_t()
   : size(0),
+    capacity(0),
     dim(0),
     type(GL_FLOAT),
     normalized(GL_FALSE)
@@ -121,6 +214,7 @@ namespace bb
     GLboolean normalized
   )
   : size(size),
+    capacity(size),
     dim(dim),
     type(type),
     normalized(normalized)
@@ -133,6 +227,7 @@ namespace bb
     const defaultVertexBuffer_t& src
   )
   : size(src.size),
+    capacity(src.size),
     dim(src.dim),
     type(src.type),
     normalized(src.normalized)
@@ -149,11 +244,13 @@ namespace bb
   )
   : data(std::move(src.data)),
     size(src.size),
+    capacity(src.capacity),
     dim(src.dim),
     type(src.type),
     normalized(src.normalized)
   {
     src.size = 0;
+    src.capacity = 0;
     src.dim  = 0;
     src.type = GL_FLOAT;
     src.normalized = GL_FALSE;
@@ -179,11 +276,13 @@ namespace bb
 
     this->data       = std::move(src.data);
     this->size       = src.size;
+    this->capacity   = src.capacity;
     this->dim        = src.dim;
     this->type       = src.type;
     this->normalized = src.normalized;
 
     src.size = 0;
+    src.capacity = 0;
     src.dim  = 0;
     src.type = GL_FLOAT;
     src.normalized = GL_FALSE;
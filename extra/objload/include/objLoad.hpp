@@ -0,0 +1,67 @@
+/**
+ * @file objLoad.hpp
+ *
+ * Wavefront OBJ loader
+ *
+ * File is memory mapped and split to line aligned chunks, which are parsed
+ * in parallel on worker actors and merged to one triangle list.
+ *
+ * Supported statements: v, vt, vn, f (polygons are triangulated as fan),
+ * usemtl, mtllib (only Kd color is used). Face corners can be v, v/vt,
+ * v//vn and v/vt/vn, negative indecies are relative to the end of current
+ * vertex list. Other statements are skipped.
+ *
+ */
+
+#pragma once
+#ifndef __BB_EXTRA_OBJLOAD_HEADER__
+#define __BB_EXTRA_OBJLOAD_HEADER__
+
+#include <meshDesc.hpp>
+
+namespace bb
+{
+
+  namespace ext
+  {
+
+    struct objStats_t
+    {
+      size_t positions; // v statements
+      size_t normals;   // vn statements
+      size_t uvs;       // vt statements
+      size_t triangles; // after triangulation
+      size_t skipped;   // unsupported statements
+      size_t chunks;    // parsed in parallel
+      vertexFormat_t format; // quantized storage of result buffers, see meshDesc_t::Save
+    };
+
+    /**
+     * Parse OBJ text.
+     *
+     * Result buffers: positions, colors (when materials are used),
+     * normals (when present), texture coordinates (when present). Every
+     * triangle corner is separate vertex, use bb::WeldVertecies to merge
+     * them.
+     *
+     * @param text OBJ file content, not null terminated
+     * @param size text size in bytes
+     * @param mtlDir directory to search mtllib files in, can be nullptr
+     * @param stats optional parsing statistics
+     *
+     * @return mesh description, not IsGood() on errors
+     */
+    meshDesc_t ParseOBJ(const char* text, size_t size, const char* mtlDir, objStats_t* stats = nullptr);
+
+    /**
+     * Map OBJ file to memory and parse it.
+     *
+     * Material libraries are searched in the directory of OBJ file.
+     */
+    meshDesc_t LoadOBJ(const char* filename, objStats_t* stats = nullptr);
+
+  } // namespace ext
+
+} // namespace bb
+
+#endif /* __BB_EXTRA_OBJLOAD_HEADER__ */
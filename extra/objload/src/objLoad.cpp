@@ -0,0 +1,848 @@
+#include <objLoad.hpp>
+#include <mappedFile.hpp>
+#include <parallel.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+  // smaller chunks are not worth of separate task
+  const size_t minChunkSize = 256*1024;
+
+  const int32_t noAttrib = std::numeric_limits<int32_t>::min();
+
+  enum : uint8_t
+  {
+    REL_POS = 0x01,
+    REL_UV = 0x02,
+    REL_NORM = 0x04
+  };
+
+  /**
+   * Face corner as written in file.
+   *
+   * Relative indecies are stored as chunk-local ones and can be negative,
+   * when they point to previous chunks.
+   */
+  struct corner_t
+  {
+    int32_t pos;
+    int32_t uv;
+    int32_t norm;
+    uint8_t relative;
+  };
+
+  struct material_t
+  {
+    size_t corner;
+    std::string name;
+  };
+
+  struct chunk_t
+  {
+    const char* begin;
+    const char* end;
+
+    std::vector<glm::vec3> pos;
+    std::vector<glm::vec3> norm;
+    std::vector<glm::vec2> uv;
+    std::vector<corner_t> corners;
+    std::vector<material_t> materials;
+    std::vector<std::string> libs;
+
+    size_t lines;
+    size_t skipped;
+    bool hasUV;
+    bool hasNorm;
+
+    size_t errorLine;
+    std::string error;
+
+    chunk_t(const char* begin, const char* end)
+    : begin(begin),
+      end(end),
+      lines(0),
+      skipped(0),
+      hasUV(false),
+      hasNorm(false),
+      errorLine(0)
+    {
+      ;
+    }
+  };
+
+  using mtlLib_t = std::unordered_map<std::string, glm::vec3>;
+
+  inline bool IsBlank(char c)
+  {
+    return (c == ' ') || (c == '\t') || (c == '\r');
+  }
+
+  inline bool IsDigit(char c)
+  {
+    return (c >= '0') && (c <= '9');
+  }
+
+  inline void SkipBlank(const char*& cur, const char* end)
+  {
+    while ((cur != end) && IsBlank(*cur))
+    {
+      ++cur;
+    }
+  }
+
+  inline const char* NextLine(const char* cur, const char* end)
+  {
+    auto eol = static_cast<const char*>(memchr(cur, '\n', static_cast<size_t>(end - cur)));
+    return (eol != nullptr)?(eol + 1):(end);
+  }
+
+  template<size_t N>
+  inline bool IsKeyword(const char* word, size_t size, const char (&keyword)[N])
+  {
+    return (size == N - 1) && (memcmp(word, keyword, N - 1) == 0);
+  }
+
+  inline const char* TrimRight(const char* begin, const char* end)
+  {
+    while ((end != begin) && IsBlank(end[-1]))
+    {
+      --end;
+    }
+    return end;
+  }
+
+  const double powerOfTen[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+    1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+    1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+
+  /**
+   * Locale independent decimal float parser.
+   *
+   * Up to 19 significant digits are used, which is more than float needs.
+   */
+  bool ParseFloat(const char*& cur, const char* end, float* result)
+  {
+    SkipBlank(cur, end);
+
+    auto start = cur;
+    bool negative = false;
+    if ((cur != end) && ((*cur == '-') || (*cur == '+')))
+    {
+      negative = (*cur == '-');
+      ++cur;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool hasDigits = false;
+
+    while ((cur != end) && IsDigit(*cur))
+    {
+      if (digits < 19)
+      {
+        mantissa = mantissa*10 + static_cast<uint64_t>(*cur - '0');
+        digits += (mantissa != 0)?(1):(0);
+      }
+      else
+      {
+        ++exponent;
+      }
+      hasDigits = true;
+      ++cur;
+    }
+
+    if ((cur != end) && (*cur == '.'))
+    {
+      ++cur;
+      while ((cur != end) && IsDigit(*cur))
+      {
+        if (digits < 19)
+        {
+          mantissa = mantissa*10 + static_cast<uint64_t>(*cur - '0');
+          digits += (mantissa != 0)?(1):(0);
+          --exponent;
+        }
+        hasDigits = true;
+        ++cur;
+      }
+    }
+
+    if (!hasDigits)
+    {
+      cur = start;
+      return false;
+    }
+
+    if ((cur != end) && ((*cur == 'e') || (*cur == 'E')))
+    {
+      auto expStart = cur++;
+      bool expNegative = false;
+      if ((cur != end) && ((*cur == '-') || (*cur == '+')))
+      {
+        expNegative = (*cur == '-');
+        ++cur;
+      }
+
+      int value = 0;
+      bool hasExpDigits = false;
+      while ((cur != end) && IsDigit(*cur))
+      {
+        value = (value < 10000)?(value*10 + (*cur - '0')):(value);
+        hasExpDigits = true;
+        ++cur;
+      }
+
+      if (hasExpDigits)
+      {
+        exponent += (expNegative)?(-value):(value);
+      }
+      else
+      { // not an exponent
+        cur = expStart;
+      }
+    }
+
+    auto value = static_cast<double>(mantissa);
+    if (exponent < 0)
+    {
+      for (; exponent < -22; exponent += 22)
+      {
+        value /= powerOfTen[22];
+      }
+      value /= powerOfTen[-exponent];
+    }
+    else
+    {
+      for (; exponent > 22; exponent -= 22)
+      {
+        value *= powerOfTen[22];
+      }
+      value *= powerOfTen[exponent];
+    }
+
+    *result = static_cast<float>((negative)?(-value):(value));
+    return true;
+  }
+
+  bool ParseIndex(const char*& cur, const char* end, int64_t* result)
+  {
+    bool negative = false;
+    if ((cur != end) && (*cur == '-'))
+    {
+      negative = true;
+      ++cur;
+    }
+
+    if ((cur == end) || (!IsDigit(*cur)))
+    {
+      return false;
+    }
+
+    int64_t value = 0;
+    while ((cur != end) && IsDigit(*cur))
+    {
+      value = value*10 + (*cur - '0');
+      if (value > std::numeric_limits<int32_t>::max())
+      {
+        return false;
+      }
+      ++cur;
+    }
+
+    *result = (negative)?(-value):(value);
+    return true;
+  }
+
+  bool ParseVector(const char*& cur, const char* end, float* dst, int required, int total)
+  {
+    for (int i = 0; i < total; ++i)
+    {
+      if (!ParseFloat(cur, end, dst + i))
+      {
+        if (i < required)
+        {
+          return false;
+        }
+        dst[i] = 0.0f;
+      }
+      else if ((cur != end) && (!IsBlank(*cur)))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Convert OBJ index to chunk-local zero-based one.
+   */
+  bool ConvertIndex(int64_t index, size_t localCount, uint8_t relFlag, int32_t* result, uint8_t* relative)
+  {
+    if (index > 0)
+    {
+      *result = static_cast<int32_t>(index - 1);
+      return true;
+    }
+
+    if (index < 0)
+    {
+      *result = static_cast<int32_t>(static_cast<int64_t>(localCount) + index);
+      *relative |= relFlag;
+      return true;
+    }
+
+    return false;
+  }
+
+  const char* ParseCorner(chunk_t& chunk, const char*& cur, const char* end, corner_t* corner)
+  {
+    corner->pos = noAttrib;
+    corner->uv = noAttrib;
+    corner->norm = noAttrib;
+    corner->relative = 0;
+
+    int64_t index;
+    if (!ParseIndex(cur, end, &index) || !ConvertIndex(index, chunk.pos.size(), REL_POS, &corner->pos, &corner->relative))
+    {
+      return "Invalid face vertex index";
+    }
+
+    if ((cur != end) && (*cur == '/'))
+    {
+      ++cur;
+      if ((cur != end) && (*cur != '/'))
+      {
+        if (!ParseIndex(cur, end, &index) || !ConvertIndex(index, chunk.uv.size(), REL_UV, &corner->uv, &corner->relative))
+        {
+          return "Invalid face texture coordinate index";
+        }
+        chunk.hasUV = true;
+      }
+
+      if ((cur != end) && (*cur == '/'))
+      {
+        ++cur;
+        if (!ParseIndex(cur, end, &index) || !ConvertIndex(index, chunk.norm.size(), REL_NORM, &corner->norm, &corner->relative))
+        {
+          return "Invalid face normal index";
+        }
+        chunk.hasNorm = true;
+      }
+    }
+
+    if ((cur != end) && (!IsBlank(*cur)))
+    {
+      return "Invalid face corner format";
+    }
+    return nullptr;
+  }
+
+  const char* ParseLine(chunk_t& chunk, const char* cur, const char* end, std::vector<corner_t>& polygon)
+  {
+    SkipBlank(cur, end);
+    if ((cur == end) || (*cur == '#'))
+    {
+      return nullptr;
+    }
+
+    auto word = cur;
+    while ((cur != end) && (!IsBlank(*cur)))
+    {
+      ++cur;
+    }
+    auto wordSize = static_cast<size_t>(cur - word);
+
+    switch (word[0])
+    {
+      case 'v':
+        if (IsKeyword(word, wordSize, "v"))
+        {
+          glm::vec3 value;
+          // optional w or vertex color are ignored
+          if (!ParseVector(cur, end, &value.x, 3, 3))
+          {
+            return "Bad vertex position";
+          }
+          chunk.pos.emplace_back(value);
+          return nullptr;
+        }
+        if (IsKeyword(word, wordSize, "vn"))
+        {
+          glm::vec3 value;
+          if (!ParseVector(cur, end, &value.x, 3, 3))
+          {
+            return "Bad vertex normal";
+          }
+          chunk.norm.emplace_back(value);
+          return nullptr;
+        }
+        if (IsKeyword(word, wordSize, "vt"))
+        {
+          glm::vec2 value;
+          if (!ParseVector(cur, end, &value.x, 1, 2))
+          {
+            return "Bad texture coordinate";
+          }
+          chunk.uv.emplace_back(value);
+          return nullptr;
+        }
+        break;
+      case 'f':
+        if (IsKeyword(word, wordSize, "f"))
+        {
+          polygon.clear();
+          for (SkipBlank(cur, end); cur != end; SkipBlank(cur, end))
+          {
+            corner_t corner;
+            if (auto error = ParseCorner(chunk, cur, end, &corner))
+            {
+              return error;
+            }
+            polygon.emplace_back(corner);
+          }
+
+          if (polygon.size() < 3)
+          {
+            return "Face has less than 3 vertecies";
+          }
+
+          for (size_t i = 1; i + 1 < polygon.size(); ++i)
+          {
+            chunk.corners.emplace_back(polygon[0]);
+            chunk.corners.emplace_back(polygon[i]);
+            chunk.corners.emplace_back(polygon[i + 1]);
+          }
+          return nullptr;
+        }
+        break;
+      case 'u':
+        if (IsKeyword(word, wordSize, "usemtl"))
+        {
+          SkipBlank(cur, end);
+          auto nameEnd = TrimRight(cur, end);
+          if (cur == nameEnd)
+          {
+            return "Material name is not found";
+          }
+
+          material_t material;
+          material.corner = chunk.corners.size();
+          material.name.assign(cur, nameEnd);
+          chunk.materials.emplace_back(std::move(material));
+          return nullptr;
+        }
+        break;
+      case 'm':
+        if (IsKeyword(word, wordSize, "mtllib"))
+        {
+          for (SkipBlank(cur, end); cur != end; SkipBlank(cur, end))
+          {
+            auto name = cur;
+            while ((cur != end) && (!IsBlank(*cur)))
+            {
+              ++cur;
+            }
+            chunk.libs.emplace_back(name, cur);
+          }
+          return nullptr;
+        }
+        break;
+      case 'o':
+      case 'g':
+      case 's':
+        if (wordSize == 1)
+        { // grouping and smoothing do not change geometry
+          return nullptr;
+        }
+        break;
+      default:
+        break;
+    }
+
+    ++chunk.skipped;
+    return nullptr;
+  }
+
+  void ParseChunk(chunk_t& chunk)
+  {
+    std::vector<corner_t> polygon;
+
+    // rough estimate, most lines in big files are faces and vertecies
+    auto estimate = static_cast<size_t>(chunk.end - chunk.begin)/32;
+    chunk.pos.reserve(estimate);
+    chunk.corners.reserve(estimate*3);
+
+    for (auto cur = chunk.begin; cur != chunk.end;)
+    {
+      auto next = NextLine(cur, chunk.end);
+      ++chunk.lines;
+
+      auto lineEnd = (next[-1] == '\n')?(next - 1):(next);
+      if (auto error = ParseLine(chunk, cur, lineEnd, polygon))
+      {
+        chunk.error = error;
+        chunk.errorLine = chunk.lines;
+        return;
+      }
+      cur = next;
+    }
+  }
+
+  int LoadMaterials(const std::string& filename, mtlLib_t* pMtlLib)
+  {
+    auto file = bb::mappedFile_t::Open(filename.c_str());
+    if (!file.IsGood())
+    {
+      return -1;
+    }
+
+    auto text = reinterpret_cast<const char*>(file.Data());
+    auto textEnd = text + file.Size();
+
+    std::string name;
+    size_t lineNum = 0;
+    for (auto cur = text; cur != textEnd;)
+    {
+      auto next = NextLine(cur, textEnd);
+      auto end = (next[-1] == '\n')?(next - 1):(next);
+      ++lineNum;
+
+      SkipBlank(cur, end);
+      auto word = cur;
+      while ((cur != end) && (!IsBlank(*cur)))
+      {
+        ++cur;
+      }
+      auto wordSize = static_cast<size_t>(cur - word);
+
+      if (IsKeyword(word, wordSize, "newmtl"))
+      {
+        SkipBlank(cur, end);
+        name.assign(cur, TrimRight(cur, end));
+      }
+      else if (IsKeyword(word, wordSize, "Kd"))
+      {
+        glm::vec3 color;
+        if (!ParseVector(cur, end, &color.x, 3, 3))
+        {
+          bb::Error("%s:" BBsize_t ": Bad color format", filename.c_str(), lineNum);
+          return -1;
+        }
+        if (name.empty())
+        {
+          bb::Error("%s:" BBsize_t ": Material name is not found", filename.c_str(), lineNum);
+          return -1;
+        }
+        (*pMtlLib)[name] = color;
+      }
+      cur = next;
+    }
+    return 0;
+  }
+
+  int32_t ResolveIndex(int32_t index, uint8_t relative, uint8_t relFlag, size_t base, size_t total)
+  {
+    if (index == noAttrib)
+    {
+      return noAttrib;
+    }
+
+    auto result = ((relative & relFlag) != 0)?(static_cast<int64_t>(base) + index):(static_cast<int64_t>(index));
+    if ((result < 0) || (result >= static_cast<int64_t>(total)))
+    {
+      return -1;
+    }
+    return static_cast<int32_t>(result);
+  }
+
+} // namespace
+
+namespace bb
+{
+
+  namespace ext
+  {
+
+    meshDesc_t ParseOBJ(const char* text, size_t size, const char* mtlDir, objStats_t* stats)
+    {
+      if ((text == nullptr) || (size == 0))
+      {
+        bb::Error("%s", "Empty OBJ");
+        return meshDesc_t();
+      }
+
+      auto textEnd = text + size;
+
+      auto threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+      auto chunkCount = bb::CheckValueBounds<size_t>(size/minChunkSize, 1, threads*4);
+
+      std::vector<chunk_t> chunks;
+      chunks.reserve(chunkCount);
+      for (size_t i = 0, begin = 0; i < chunkCount; ++i)
+      {
+        auto cur = text + begin;
+        auto end = textEnd;
+        if (i + 1 < chunkCount)
+        { // chunk ends after line break
+          end = std::max(cur, text + size/chunkCount*(i + 1));
+          end = (end != textEnd)?(NextLine(end, textEnd)):(end);
+        }
+        chunks.emplace_back(cur, end);
+        begin = static_cast<size_t>(end - text);
+      }
+
+      bb::ParallelFor(
+        chunks.size(),
+        [&chunks](size_t i)
+        {
+          ParseChunk(chunks[i]);
+        }
+      );
+
+      size_t lineBase = 0;
+      for (auto& chunk: chunks)
+      {
+        if (!chunk.error.empty())
+        {
+          bb::Error(BBsize_t ": %s", lineBase + chunk.errorLine, chunk.error.c_str());
+          return meshDesc_t();
+        }
+        lineBase += chunk.lines;
+      }
+
+      // prefix sums, to convert chunk-local indecies to global
+      std::vector<size_t> posBase;
+      std::vector<size_t> normBase;
+      std::vector<size_t> uvBase;
+      std::vector<size_t> cornerBase;
+
+      size_t totalPos = 0;
+      size_t totalNorm = 0;
+      size_t totalUV = 0;
+      size_t totalCorners = 0;
+      size_t totalSkipped = 0;
+      bool hasUV = false;
+      bool hasNorm = false;
+      bool hasColor = false;
+      for (auto& chunk: chunks)
+      {
+        posBase.emplace_back(totalPos);
+        normBase.emplace_back(totalNorm);
+        uvBase.emplace_back(totalUV);
+        cornerBase.emplace_back(totalCorners);
+
+        totalPos += chunk.pos.size();
+        totalNorm += chunk.norm.size();
+        totalUV += chunk.uv.size();
+        totalCorners += chunk.corners.size();
+        totalSkipped += chunk.skipped;
+        hasUV = hasUV || chunk.hasUV;
+        hasNorm = hasNorm || chunk.hasNorm;
+        hasColor = hasColor || (!chunk.materials.empty());
+      }
+
+      if (totalCorners == 0)
+      {
+        bb::Error("%s", "No faces found");
+        return meshDesc_t();
+      }
+
+      if (totalCorners >= bb::breakingIndex<uint32_t>())
+      {
+        bb::Error("%s", "Too many faces");
+        return meshDesc_t();
+      }
+
+      mtlLib_t mtlLib;
+      for (auto& chunk: chunks)
+      {
+        for (auto& lib: chunk.libs)
+        {
+          auto path = ((mtlDir != nullptr) && (lib[0] != '/'))?(std::string(mtlDir) + "/" + lib):(lib);
+          if (LoadMaterials(path, &mtlLib) != 0)
+          {
+            bb::Error("Can't load material library \"%s\"", path.c_str());
+            return meshDesc_t();
+          }
+        }
+      }
+
+      // material ranges in corners, material lasts across chunk borders
+      std::vector<std::vector<std::pair<size_t, glm::vec3>>> colors(chunks.size());
+      glm::vec3 color(1.0f);
+      for (size_t i = 0; i < chunks.size(); ++i)
+      {
+        colors[i].emplace_back(0, color);
+        for (auto& material: chunks[i].materials)
+        {
+          auto found = mtlLib.find(material.name);
+          if (found == mtlLib.end())
+          {
+            bb::Error("No material \"%s\" in library", material.name.c_str());
+            return meshDesc_t();
+          }
+          color = found->second;
+          colors[i].emplace_back(material.corner, color);
+        }
+      }
+
+      std::vector<glm::vec3> allPos(totalPos);
+      std::vector<glm::vec3> allNorm(totalNorm);
+      std::vector<glm::vec2> allUV(totalUV);
+
+      bb::ParallelFor(
+        chunks.size(),
+        [&](size_t i)
+        {
+          std::copy(chunks[i].pos.begin(), chunks[i].pos.end(), allPos.begin() + static_cast<ptrdiff_t>(posBase[i]));
+          std::copy(chunks[i].norm.begin(), chunks[i].norm.end(), allNorm.begin() + static_cast<ptrdiff_t>(normBase[i]));
+          std::copy(chunks[i].uv.begin(), chunks[i].uv.end(), allUV.begin() + static_cast<ptrdiff_t>(uvBase[i]));
+        }
+      );
+
+      std::vector<glm::vec3> outPos(totalCorners);
+      std::vector<glm::vec3> outCol((hasColor)?(totalCorners):(0));
+      std::vector<glm::vec3> outNorm((hasNorm)?(totalCorners):(0));
+      std::vector<glm::vec2> outUV((hasUV)?(totalCorners):(0));
+
+      bb::ParallelFor(
+        chunks.size(),
+        [&](size_t i)
+        {
+          auto& chunk = chunks[i];
+          auto colorRange = colors[i].begin();
+          auto out = cornerBase[i];
+
+          for (size_t c = 0; c < chunk.corners.size(); ++c, ++out)
+          {
+            auto& corner = chunk.corners[c];
+
+            auto pos = ResolveIndex(corner.pos, corner.relative, REL_POS, posBase[i], totalPos);
+            auto norm = ResolveIndex(corner.norm, corner.relative, REL_NORM, normBase[i], totalNorm);
+            auto uv = ResolveIndex(corner.uv, corner.relative, REL_UV, uvBase[i], totalUV);
+            if ((pos < 0) || (norm == -1) || (uv == -1))
+            {
+              chunk.error = "Face references missing vertex data";
+              return;
+            }
+
+            outPos[out] = allPos[static_cast<size_t>(pos)];
+            if (hasNorm)
+            {
+              outNorm[out] = (norm >= 0)?(allNorm[static_cast<size_t>(norm)]):(glm::vec3(0.0f));
+            }
+            if (hasUV)
+            {
+              outUV[out] = (uv >= 0)?(allUV[static_cast<size_t>(uv)]):(glm::vec2(0.0f));
+            }
+            if (hasColor)
+            {
+              while ((colorRange + 1 != colors[i].end()) && ((colorRange + 1)->first <= c))
+              {
+                ++colorRange;
+              }
+              outCol[out] = colorRange->second;
+            }
+          }
+        }
+      );
+
+      for (auto& chunk: chunks)
+      {
+        if (!chunk.error.empty())
+        {
+          bb::Error("%s", chunk.error.c_str());
+          return meshDesc_t();
+        }
+      }
+
+      if (stats != nullptr)
+      {
+        stats->positions = totalPos;
+        stats->normals = totalNorm;
+        stats->uvs = totalUV;
+        stats->triangles = totalCorners/3;
+        stats->skipped = totalSkipped;
+        stats->chunks = chunks.size();
+
+        // same order, as result buffers below
+        stats->format.assign(1, bb::attribFormat_t::position16);
+        if (hasColor)
+        {
+          stats->format.emplace_back(bb::attribFormat_t::color8);
+        }
+        if (hasNorm)
+        {
+          stats->format.emplace_back(bb::attribFormat_t::normal16);
+        }
+        if (hasUV)
+        { // can be outside of [0, 1]
+          stats->format.emplace_back(bb::attribFormat_t::native);
+        }
+      }
+
+      std::vector<uint32_t> index(totalCorners);
+      for (size_t i = 0; i < totalCorners; ++i)
+      {
+        index[i] = static_cast<uint32_t>(i);
+      }
+
+      meshDesc_t result;
+      result.SetDrawMode(GL_TRIANGLES);
+      result.Buffers().emplace_back(bb::MakeVertexBuffer(std::move(outPos)));
+      if (hasColor)
+      {
+        result.Buffers().emplace_back(bb::MakeVertexBuffer(std::move(outCol)));
+      }
+      if (hasNorm)
+      {
+        result.Buffers().emplace_back(bb::MakeVertexBuffer(std::move(outNorm)));
+      }
+      if (hasUV)
+      {
+        result.Buffers().emplace_back(bb::MakeVertexBuffer(std::move(outUV)));
+      }
+      result.Indecies() = bb::MakeCompactIndexBuffer(std::move(index));
+      return result;
+    }
+
+    meshDesc_t LoadOBJ(const char* filename, objStats_t* stats)
+    {
+      auto file = bb::mappedFile_t::Open(filename);
+      if (!file.IsGood())
+      {
+        return meshDesc_t();
+      }
+      file.Sequential();
+
+      std::string dir(filename);
+      auto slash = dir.find_last_of("/\\");
+      dir = (slash != std::string::npos)?(dir.substr(0, slash)):(std::string("."));
+
+      auto result = ParseOBJ(
+        reinterpret_cast<const char*>(file.Data()),
+        file.Size(),
+        dir.c_str(),
+        stats
+      );
+      if (!result.IsGood())
+      {
+        bb::Error("Can't load \"%s\"", filename);
+      }
+      return result;
+    }
+
+  } // namespace ext
+
+} // namespace bb
@@ -0,0 +1,100 @@
+/**
+ * @file terrain.hpp
+ *
+ * Chunked terrain with geometric LOD (geomipmapping).
+ *
+ * Height map is stored in GL_R32F texture and sampled in vertex shader.
+ * All chunks share one vertex grid and one index buffer, which holds index
+ * ranges for every LOD level. Chunk edges have skirts to hide cracks
+ * between neighbours of different LOD.
+ *
+ * LOD is selected per frame, so projected quad size stays near given
+ * number of pixels. Triangle count depends on screen resolution, not on
+ * map size.
+ *
+ */
+
+#pragma once
+#ifndef __ORTHOFIGHT_TERRAIN_HEADER__
+#define __ORTHOFIGHT_TERRAIN_HEADER__
+
+#include <vector>
+
+#include <vao.hpp>
+#include <shader.hpp>
+#include <camera.hpp>
+#include <texture.hpp>
+#include <heightMap.hpp>
+
+class terrain_t final
+{
+  struct chunk_t
+  {
+    glm::ivec2 origin;
+    glm::vec3 boxMin;
+    glm::vec3 boxMax;
+  };
+
+  struct lod_t
+  {
+    size_t offset; // in bytes
+    GLsizei count;
+  };
+
+  bb::shader_t shader;
+  bb::texture_t heightMap;
+  bb::vao_t vao;
+  bb::vbo_t grid;
+  bb::vbo_t indecies;
+  std::vector<lod_t> lods;
+  std::vector<chunk_t> chunks;
+  glm::ivec2 chunkCount;
+  int chunkSize;
+  float pixelsPerQuad;
+
+  GLint chunkOriginLoc;
+
+  size_t drawnChunks;
+  size_t drawnTriangles;
+
+  void BuildGeometry();
+  void BuildChunkRow(const bb::ext::heightMap_t& hmap, int row);
+  void BuildChunks(const bb::ext::heightMap_t& hmap);
+
+  terrain_t(const terrain_t&) = delete;
+  terrain_t& operator=(const terrain_t&) = delete;
+  terrain_t(terrain_t&&) = delete;
+  terrain_t& operator=(terrain_t&&) = delete;
+
+public:
+
+  /**
+   * Vertex scale used by terrain shader.
+   */
+  static glm::vec3 WorldPos(int x, int y, float height);
+
+  void Render(const bb::camera_t& camera, float viewportHeight);
+
+  size_t DrawnChunks() const;
+  size_t DrawnTriangles() const;
+
+  /**
+   * @param hmap height map
+   * @param chunkSize chunk side in quads, must be power of two
+   * @param pixelsPerQuad target projected quad size in pixels
+   */
+  terrain_t(const bb::ext::heightMap_t& hmap, int chunkSize, float pixelsPerQuad);
+  ~terrain_t();
+};
+
+inline size_t terrain_t::DrawnChunks() const
+{
+  return this->drawnChunks;
+}
+
+inline size_t terrain_t::DrawnTriangles() const
+{
+  return this->drawnTriangles;
+}
+
+#endif /* __ORTHOFIGHT_TERRAIN_HEADER__ */
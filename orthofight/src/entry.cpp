@@ -8,76 +8,9 @@
 #include <camera.hpp>
 #include <shader.hpp>
 #include <mapGen.hpp>
+#include <config.hpp>
 
-bb::mesh_t Plane(const bb::ext::heightMap_t& hmap)
-{
-  bb::meshDesc_t desc;
-
-  desc.SetDrawMode(GL_TRIANGLES);
-
-  std::vector<glm::vec3> vpos;
-  std::vector<glm::vec3> vcol;
-  std::vector<glm::vec3> vnorm;
-  std::vector<uint16_t> indecies;
-
-  vpos.reserve(hmap.DataSize());
-  vcol.reserve(hmap.DataSize());
-  vnorm.reserve(hmap.DataSize());
-  indecies.reserve(hmap.DataSize()*6);
-
-  uint16_t index = 0;
-  for (size_t y = 0; y < hmap.Height(); ++y)
-  {
-    for (size_t x = 0; x < hmap.Width(); ++x)
-    {
-      vpos.emplace_back(
-        glm::vec3{
-          static_cast<float>(x)/10.0f,
-          static_cast<float>(y)/10.0f, 
-          roundf(hmap.Data(x, y)*4.0f)/4.0f*2.0f
-        }
-      );
-      vcol.emplace_back(
-        glm::vec3(
-          hmap.Data(x, y)
-        )
-      );
-      vnorm.emplace_back(
-        hmap.NormalAtPoint(glm::vec2(x, y), 2.0f)
-      );
-
-      if ((y + 1 < hmap.Height()) && (x + 1 < hmap.Width()))
-      {
-        indecies.emplace_back(index);
-        indecies.emplace_back(index + 1);
-        indecies.emplace_back(index + hmap.Width());
-
-        indecies.emplace_back(index + hmap.Width());
-        indecies.emplace_back(index + 1);
-        indecies.emplace_back(index + hmap.Width()+1);
-        ++index;
-      }
-    }
-    ++index;
-    printf("\n");
-  }
-
-  desc.Buffers().emplace_back(
-    bb::MakeVertexBuffer(std::move(vpos))
-  );
-
-  desc.Buffers().emplace_back(
-    bb::MakeVertexBuffer(std::move(vcol))
-  );
-
-  desc.Buffers().emplace_back(
-    bb::MakeVertexBuffer(std::move(vnorm))
-  );
-
-  desc.Indecies() = bb::MakeIndexBuffer(std::move(indecies));
-
-  return bb::GenerateMesh(desc);
-}
+#include <terrain.hpp>
 
 int main(int argc, char* argv[])
 {
@@ -122,27 +55,27 @@ int main(int argc, char* argv[])
 
   bb::mesh_t unit;
 
-  if(FILE* unitMesh = fopen("green.obj.msh", "rb"))
+  auto unitDesc = bb::meshDesc_t::Map("green.obj.msh");
+  if (unitDesc.IsGood())
   {
-    BB_DEFER(fclose(unitMesh));
-    unit = bb::GenerateMesh(bb::meshDesc_t::Load(unitMesh));
+    unit = bb::GenerateMesh(unitDesc);
   }
 
-  auto worldShader = bb::shader_t::LoadProgramFromFiles(
-    "world.vp.glsl",
-    "world.fp.glsl"
-  );
-
   auto unitShader = bb::shader_t::LoadProgramFromFiles(
     "obj2mesh.vp.glsl",
     "obj2mesh.fp.glsl"
   );
 
+  bb::config_t config("default.config");
+  auto mapSize = static_cast<size_t>(
+    bb::CheckValueBounds(config.Value("map.size", 255.0), 2.0, 4096.0)
+  );
+
   auto world = bb::ext::MakeHMapUsingOctaves(
     bb::ext::generate_t(
       -1,
-      255,
-      255,
+      mapSize,
+      mapSize,
       0.5f,
       20.0f,
       0,
@@ -152,7 +85,11 @@ int main(int argc, char* argv[])
     )
   );
 
-  auto plane = Plane(world);
+  terrain_t terrain(
+    world,
+    static_cast<int>(config.Value("terrain.chunk", 64.0)),
+    static_cast<float>(config.Value("terrain.pixels", 4.0))
+  );
 
   bb::frameTimer_t frameTimer;
 
@@ -166,12 +103,7 @@ int main(int argc, char* argv[])
     glEnable(GL_DEPTH_TEST);
     glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
 
-    bb::shader_t::Bind(worldShader);
-    worldShader.SetBlock(
-      "camera",
-      camera.UniformBlock()
-    );
-    plane.Render();
+    terrain.Render(camera, static_cast<float>(context.Height()));
 
     if (context.IsCursorInside())
     {
@@ -191,7 +123,8 @@ int main(int argc, char* argv[])
 
       context.Title(
         bb::Print(
-          '[', worldPos.x, ',', worldPos.y, ',', worldPos.z, ']'
+          '[', worldPos.x, ',', worldPos.y, ',', worldPos.z, "] ",
+          terrain.DrawnChunks(), " chunks, ", terrain.DrawnTriangles(), " triangles"
         )
       );
 
@@ -221,8 +154,8 @@ int main(int argc, char* argv[])
           glm::radians(135.0f),
           glm::vec3(0.0f, 1.0f, 0.0f)
         ),
-        glm::vec3(0.5f)
-      )
+        glm::vec3(0.25f)
+      )*unit.Dequantize()
     );
 
     unit.Render();
@@ -0,0 +1,300 @@
+#include <terrain.hpp>
+
+#include <common.hpp>
+#include <parallel.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+namespace
+{
+
+  // skirt vertices are lowered by this value
+  const float skirtDepth = 0.5f;
+
+  int LevelCount(int chunkSize)
+  {
+    int result = 0;
+    while ((1 << result) <= chunkSize)
+    {
+      ++result;
+    }
+    return result;
+  }
+
+} // namespace
+
+glm::vec3 terrain_t::WorldPos(int x, int y, float height)
+{
+  // same scale as old full-resolution world mesh
+  return glm::vec3(
+    static_cast<float>(x)/20.0f,
+    static_cast<float>(y)/20.0f,
+    std::round(height*4.0f)/4.0f + height/5.0f
+  );
+}
+
+void terrain_t::BuildGeometry()
+{
+  const int side = this->chunkSize + 1;
+
+  // local grid (x, y, skirt)
+  std::vector<glm::vec3> vertecies;
+  vertecies.reserve(static_cast<size_t>(side*side + 4*side));
+
+  for (int y = 0; y < side; ++y)
+  {
+    for (int x = 0; x < side; ++x)
+    {
+      vertecies.emplace_back(static_cast<float>(x), static_cast<float>(y), 0.0f);
+    }
+  }
+
+  const int skirtBase = side*side;
+  for (int i = 0; i < side; ++i)
+  { // bottom
+    vertecies.emplace_back(static_cast<float>(i), 0.0f, 1.0f);
+  }
+  for (int i = 0; i < side; ++i)
+  { // top
+    vertecies.emplace_back(static_cast<float>(i), static_cast<float>(this->chunkSize), 1.0f);
+  }
+  for (int i = 0; i < side; ++i)
+  { // left
+    vertecies.emplace_back(0.0f, static_cast<float>(i), 1.0f);
+  }
+  for (int i = 0; i < side; ++i)
+  { // right
+    vertecies.emplace_back(static_cast<float>(this->chunkSize), static_cast<float>(i), 1.0f);
+  }
+
+  assert(vertecies.size() < bb::breakingIndex<uint16_t>());
+
+  auto gridIndex = [side](int x, int y)
+  {
+    return static_cast<uint16_t>(y*side + x);
+  };
+
+  auto skirtIndex = [side, skirtBase](int edge, int i)
+  {
+    return static_cast<uint16_t>(skirtBase + edge*side + i);
+  };
+
+  std::vector<uint16_t> index;
+  for (int level = 0, levels = LevelCount(this->chunkSize); level < levels; ++level)
+  {
+    const int step = 1 << level;
+
+    lod_t lod;
+    lod.offset = index.size()*sizeof(uint16_t);
+
+    for (int y = 0; y < this->chunkSize; y += step)
+    {
+      for (int x = 0; x < this->chunkSize; x += step)
+      {
+        index.emplace_back(gridIndex(x, y));
+        index.emplace_back(gridIndex(x + step, y));
+        index.emplace_back(gridIndex(x, y + step));
+
+        index.emplace_back(gridIndex(x, y + step));
+        index.emplace_back(gridIndex(x + step, y));
+        index.emplace_back(gridIndex(x + step, y + step));
+      }
+    }
+
+    for (int i = 0; i < this->chunkSize; i += step)
+    {
+      const int edgeA[4][2] = {{i, 0}, {i, this->chunkSize}, {0, i}, {this->chunkSize, i}};
+      const int edgeB[4][2] = {{i + step, 0}, {i + step, this->chunkSize}, {0, i + step}, {this->chunkSize, i + step}};
+
+      for (int edge = 0; edge < 4; ++edge)
+      {
+        auto a = gridIndex(edgeA[edge][0], edgeA[edge][1]);
+        auto b = gridIndex(edgeB[edge][0], edgeB[edge][1]);
+        auto sa = skirtIndex(edge, i);
+        auto sb = skirtIndex(edge, i + step);
+
+        index.emplace_back(a);
+        index.emplace_back(sa);
+        index.emplace_back(b);
+
+        index.emplace_back(b);
+        index.emplace_back(sa);
+        index.emplace_back(sb);
+      }
+    }
+
+    lod.count = static_cast<GLsizei>(index.size() - lod.offset/sizeof(uint16_t));
+    this->lods.emplace_back(lod);
+  }
+
+  this->grid = bb::vbo_t::CreateArrayBuffer(vertecies, false);
+  this->indecies = bb::vbo_t::CreateElementArrayBuffer(index, false);
+
+  this->vao = bb::vao_t::CreateVertexAttribObject();
+  this->vao.BindVBO(this->grid, 0, 3, GL_FLOAT, GL_FALSE, 0, 0);
+  this->vao.BindIndecies(this->indecies);
+}
+
+void terrain_t::BuildChunkRow(const bb::ext::heightMap_t& hmap, int row)
+{
+  for (int col = 0; col < this->chunkCount.x; ++col)
+  {
+    auto& chunk = this->chunks[static_cast<size_t>(row*this->chunkCount.x + col)];
+    chunk.origin = glm::ivec2(col, row)*this->chunkSize;
+
+    auto lastX = std::min(chunk.origin.x + this->chunkSize, hmap.Width() - 1);
+    auto lastY = std::min(chunk.origin.y + this->chunkSize, hmap.Height() - 1);
+
+    float minZ = std::numeric_limits<float>::max();
+    float maxZ = -std::numeric_limits<float>::max();
+    for (int y = chunk.origin.y; y <= lastY; ++y)
+    {
+      for (int x = chunk.origin.x; x <= lastX; ++x)
+      {
+        auto z = terrain_t::WorldPos(x, y, hmap.Data(static_cast<size_t>(x), static_cast<size_t>(y))).z;
+        minZ = std::min(minZ, z);
+        maxZ = std::max(maxZ, z);
+      }
+    }
+
+    chunk.boxMin = terrain_t::WorldPos(chunk.origin.x, chunk.origin.y, 0.0f);
+    chunk.boxMax = terrain_t::WorldPos(lastX, lastY, 0.0f);
+    chunk.boxMin.z = minZ - skirtDepth;
+    chunk.boxMax.z = maxZ;
+  }
+}
+
+void terrain_t::BuildChunks(const bb::ext::heightMap_t& hmap)
+{
+  this->chunks.resize(static_cast<size_t>(this->chunkCount.x*this->chunkCount.y));
+
+  bb::ParallelFor(
+    static_cast<size_t>(this->chunkCount.y),
+    [this, &hmap](size_t row)
+    {
+      this->BuildChunkRow(hmap, static_cast<int>(row));
+    }
+  );
+}
+
+void terrain_t::Render(const bb::camera_t& camera, float viewportHeight)
+{
+  this->drawnChunks = 0;
+  this->drawnTriangles = 0;
+
+  const auto projView = camera.Projection() * camera.View();
+  const auto eye = glm::vec3(glm::inverse(camera.View())[3]);
+
+  // world size of one pixel at unit distance
+  const auto pixelAngle = 2.0f / (camera.Projection()[1][1] * viewportHeight);
+  const auto quadSize = terrain_t::WorldPos(1, 0, 0.0f).x;
+  const auto maxLevel = static_cast<int>(this->lods.size()) - 1;
+
+  bb::shader_t::Bind(this->shader);
+  this->shader.SetBlock("camera", camera.UniformBlock());
+  bb::texture_t::Bind(this->heightMap);
+
+  bb::vao_t::Bind(this->vao);
+  glEnableVertexAttribArray(0);
+
+  for (auto& chunk: this->chunks)
+  {
+    bool outside = false;
+    for (int axis = 0; (axis < 3) && (!outside); ++axis)
+    {
+      for (float side: {-1.0f, 1.0f})
+      {
+        int cornersOutside = 0;
+        for (int corner = 0; corner < 8; ++corner)
+        {
+          auto clip = projView * glm::vec4(
+            (corner & 1)?(chunk.boxMax.x):(chunk.boxMin.x),
+            (corner & 2)?(chunk.boxMax.y):(chunk.boxMin.y),
+            (corner & 4)?(chunk.boxMax.z):(chunk.boxMin.z),
+            1.0f
+          );
+          cornersOutside += (side*clip[axis] > clip.w)?(1):(0);
+        }
+        if (cornersOutside == 8)
+        {
+          outside = true;
+          break;
+        }
+      }
+    }
+
+    if (outside)
+    {
+      continue;
+    }
+
+    auto nearest = glm::clamp(eye, chunk.boxMin, chunk.boxMax);
+    auto distance = std::max(glm::length(eye - nearest), quadSize);
+
+    // biggest quad, which still projects to less than pixelsPerQuad
+    auto level = static_cast<int>(
+      std::floor(std::log2(this->pixelsPerQuad * pixelAngle * distance / quadSize))
+    );
+    level = bb::CheckValueBounds(level, 0, maxLevel);
+
+    auto& lod = this->lods[static_cast<size_t>(level)];
+    this->shader.SetVector2f(this->chunkOriginLoc, glm::vec2(chunk.origin));
+    glDrawElements(
+      GL_TRIANGLES,
+      lod.count,
+      GL_UNSIGNED_SHORT,
+      reinterpret_cast<void*>(static_cast<uintptr_t>(lod.offset))
+    );
+
+    ++this->drawnChunks;
+    this->drawnTriangles += static_cast<size_t>(lod.count/3);
+  }
+
+  glDisableVertexAttribArray(0);
+}
+
+terrain_t::terrain_t(const bb::ext::heightMap_t& hmap, int chunkSize, float pixelsPerQuad)
+: shader(bb::shader_t::LoadProgramFromFiles("terrain.vp.glsl", "world.fp.glsl")),
+  heightMap(hmap.Width(), hmap.Height(), hmap.Data()),
+  chunkCount(0),
+  chunkSize(chunkSize),
+  pixelsPerQuad(pixelsPerQuad),
+  chunkOriginLoc(-1),
+  drawnChunks(0),
+  drawnTriangles(0)
+{
+  if ((chunkSize <= 0) || ((chunkSize & (chunkSize - 1)) != 0))
+  {
+    throw std::runtime_error("Terrain chunk size must be power of two");
+  }
+
+  if (!hmap.IsGood())
+  {
+    throw std::runtime_error("Terrain from empty height map");
+  }
+
+  // last vertex of chunk is first of next one
+  this->chunkCount = glm::ivec2(
+    (hmap.Width() - 2) / chunkSize + 1,
+    (hmap.Height() - 2) / chunkSize + 1
+  );
+
+  this->BuildGeometry();
+  this->BuildChunks(hmap);
+
+  bb::shader_t::Bind(this->shader);
+  this->shader.SetTexture("heightMap", 0);
+  this->shader.SetFloat("skirtDepth", skirtDepth);
+  this->chunkOriginLoc = this->shader.UniformLocation("chunkOrigin");
+
+  bb::Info("Terrain: %dx%d chunks of %d quads, %d levels",
+    this->chunkCount.x, this->chunkCount.y, chunkSize, static_cast<int>(this->lods.size())
+  );
+}
+
+terrain_t::~terrain_t()
+{
+  ;
+}
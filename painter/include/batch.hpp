@@ -0,0 +1,42 @@
+/**
+ * @file batch.hpp
+ *
+ * Batch PVF compiler.
+ *
+ * Scripts are compiled to SCRIPT.msh in parallel on worker actors. Each
+ * directory keeps painter.cache with content hashes of compiled scripts,
+ * unchanged scripts with existing meshes are skipped.
+ */
+
+#pragma once
+#ifndef __BB_PAINTER_BATCH_HEADER__
+#define __BB_PAINTER_BATCH_HEADER__
+
+#include <string>
+#include <vector>
+
+namespace paint
+{
+
+  struct batchStats_t
+  {
+    size_t compiled;
+    size_t skipped;
+    size_t failed;
+    double seconds;
+  };
+
+  /**
+   * Compile scripts and .pvf files of directories.
+   *
+   * @param paths scripts or directories, directories are not scanned recursively
+   * @param force compile unchanged scripts too
+   * @param stats if != nullptr, filled with batch results
+   *
+   * @return 0 if all scripts compiled or skipped, -1 otherwise
+   */
+  int CompileBatch(const std::vector<std::string>& paths, bool force, batchStats_t* stats);
+
+} // namespace paint
+
+#endif /* __BB_PAINTER_BATCH_HEADER__ */
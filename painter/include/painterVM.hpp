@@ -0,0 +1,71 @@
+/**
+ * @file painterVM.hpp
+ *
+ * PVF script interpreter.
+ */
+
+#pragma once
+#ifndef __BB_PAINTER_VM_HEADER__
+#define __BB_PAINTER_VM_HEADER__
+
+#include <script.hpp>
+#include <tessellator.hpp>
+
+#include <glm/vec4.hpp>
+
+namespace paint
+{
+
+  class painterVM_t final: public bb::vm_t
+  {
+    float brushWidth;
+    glm::vec3 cursor;
+    uint32_t sides;
+    glm::vec2 textScale;
+    glm::vec4 frame;
+    bool hasFrame;
+    tessellator_t tessellator;
+
+    int OnCommand(int cmd, const bb::scriptArgs_t& args) override;
+
+    painterVM_t(const painterVM_t&) = delete;
+    painterVM_t& operator=(const painterVM_t&) = delete;
+    painterVM_t(painterVM_t&&) = delete;
+    painterVM_t& operator=(painterVM_t&&) = delete;
+
+  public:
+
+    /**
+     * Canvas arguments of f command.
+     */
+    const glm::vec4& Frame() const;
+
+    bool HasFrame() const;
+
+    /**
+     * Make mesh description of all drawn strokes.
+     */
+    bb::meshDesc_t MeshDescription() const;
+
+    painterVM_t();
+    ~painterVM_t() override = default;
+  };
+
+  inline const glm::vec4& painterVM_t::Frame() const
+  {
+    return this->frame;
+  }
+
+  inline bool painterVM_t::HasFrame() const
+  {
+    return this->hasFrame;
+  }
+
+  inline bb::meshDesc_t painterVM_t::MeshDescription() const
+  {
+    return this->tessellator.Build();
+  }
+
+} // namespace paint
+
+#endif /* __BB_PAINTER_VM_HEADER__ */
@@ -0,0 +1,84 @@
+/**
+ * @file tessellator.hpp
+ *
+ * Painter stroke tessellation.
+ *
+ * Builds same vertecies, as DefineLine, DefineCircle and DefineNumber
+ * appended one by one, but writes them straight to shared arrays, so
+ * no temporary mesh is made per stroke. Unit circles are computed once
+ * for each side count.
+ */
+
+#pragma once
+#ifndef __BB_PAINTER_TESSELLATOR_HEADER__
+#define __BB_PAINTER_TESSELLATOR_HEADER__
+
+#include <meshDesc.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+namespace paint
+{
+
+  class tessellator_t final
+  {
+    using circle_t = std::vector<glm::vec2>;
+    using circleCache_t = std::unordered_map<uint32_t, circle_t>;
+
+    std::vector<glm::vec2> points;
+    std::vector<glm::vec2> distance;
+    std::vector<uint32_t> indecies;
+    circleCache_t circles;
+
+    const circle_t& UnitCircle(uint32_t sides);
+    void Segment(glm::vec2 start, glm::vec2 finish, glm::vec2 offset, float width);
+    void Polyline(const glm::vec2* linePoints, size_t count, glm::vec2 offset, float width);
+
+    tessellator_t(const tessellator_t&) = delete;
+    tessellator_t& operator=(const tessellator_t&) = delete;
+
+  public:
+
+    /**
+     * Same as DefineLine with two points.
+     */
+    void Line(glm::vec2 start, glm::vec2 finish, float width);
+
+    /**
+     * Same as DefineCircle.
+     */
+    void Circle(glm::vec3 center, uint32_t sides, float radius, float width);
+
+    /**
+     * Same as DefineNumber.
+     *
+     * @return 0 on success, -1 if text has unknown symbols, nothing is added then
+     */
+    int Text(glm::vec3 offset, float width, glm::vec2 scale, const char* utf8Text);
+
+    size_t Vertecies() const;
+
+    /**
+     * Make mesh description of all strokes.
+     *
+     * Indecies are 16-bit, when they fit.
+     */
+    bb::meshDesc_t Build() const;
+
+    tessellator_t();
+    ~tessellator_t() = default;
+  };
+
+  inline size_t tessellator_t::Vertecies() const
+  {
+    return this->points.size();
+  }
+
+} // namespace paint
+
+#endif /* __BB_PAINTER_TESSELLATOR_HEADER__ */
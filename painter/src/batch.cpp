@@ -0,0 +1,344 @@
+#include <batch.hpp>
+#include <painterVM.hpp>
+#include <common.hpp>
+#include <parallel.hpp>
+#include <script.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <unordered_map>
+
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+namespace paint
+{
+
+  namespace
+  {
+
+    // bump, when tessellation changes, so cached scripts are compiled again
+    const uint64_t PAINTER_CACHE_VERSION = 1;
+    const char* const PAINTER_CACHE_NAME = "painter.cache";
+
+    using hashes_t = std::unordered_map<std::string, uint64_t>;
+
+    enum class jobResult_t
+    {
+      compiled,
+      skipped,
+      failed
+    };
+
+    struct job_t
+    {
+      std::string dir;
+      std::string name;
+      uint64_t hash;
+      jobResult_t result;
+    };
+
+    uint64_t ContentHash(const char* data, size_t size)
+    { // FNV-1a
+      uint64_t result = 0xcbf29ce484222325ull ^ PAINTER_CACHE_VERSION;
+      for (size_t i = 0; i < size; ++i)
+      {
+        result ^= static_cast<uint8_t>(data[i]);
+        result *= 0x100000001b3ull;
+      }
+      return result;
+    }
+
+    bool IsDirectory(const std::string& path)
+    {
+      struct stat info;
+      return (stat(path.c_str(), &info) == 0) && ((info.st_mode & S_IFMT) == S_IFDIR);
+    }
+
+    bool FileExists(const std::string& path)
+    {
+      struct stat info;
+      return (stat(path.c_str(), &info) == 0) && ((info.st_mode & S_IFMT) == S_IFREG);
+    }
+
+    bool HasExtension(const std::string& filename, const char* ext)
+    {
+      size_t extLen = strlen(ext);
+      return (filename.size() > extLen)
+        && (filename.compare(filename.size() - extLen, extLen, ext) == 0);
+    }
+
+    std::string JoinPath(const std::string& dir, const std::string& name)
+    {
+      return dir + "/" + name;
+    }
+
+    int ListScripts(const std::string& dir, std::vector<std::string>* names)
+    {
+#ifdef _WIN32
+      WIN32_FIND_DATAA data;
+      HANDLE find = FindFirstFileA((dir + "\\*.pvf").c_str(), &data);
+      if (find == INVALID_HANDLE_VALUE)
+      {
+        return (GetLastError() == ERROR_FILE_NOT_FOUND)?(0):(-1);
+      }
+      do
+      {
+        if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+        {
+          names->emplace_back(data.cFileName);
+        }
+      } while (FindNextFileA(find, &data) != 0);
+      FindClose(find);
+#else
+      DIR* input = opendir(dir.c_str());
+      if (input == nullptr)
+      {
+        return -1;
+      }
+      BB_DEFER(closedir(input));
+
+      while (auto entry = readdir(input))
+      {
+        std::string name(entry->d_name);
+        if (HasExtension(name, ".pvf") && FileExists(JoinPath(dir, name)))
+        {
+          names->emplace_back(std::move(name));
+        }
+      }
+#endif
+      return 0;
+    }
+
+    hashes_t LoadCache(const std::string& dir)
+    {
+      hashes_t result;
+
+      FILE* input = fopen(JoinPath(dir, PAINTER_CACHE_NAME).c_str(), "rt");
+      if (input == nullptr)
+      { // nothing compiled yet
+        return result;
+      }
+      BB_DEFER(fclose(input));
+
+      char line[1024];
+      while (fgets(line, sizeof(line), input) != nullptr)
+      {
+        char* name = nullptr;
+        unsigned long long hash = strtoull(line, &name, 16);
+        if ((name == line) || (*name != ' '))
+        {
+          bb::Error("Invalid line in \"%s\" cache ignored", dir.c_str());
+          continue;
+        }
+        ++name;
+        name[strcspn(name, "\r\n")] = 0;
+        result[name] = static_cast<uint64_t>(hash);
+      }
+      return result;
+    }
+
+    int SaveCache(const std::string& dir, const hashes_t& hashes)
+    {
+      FILE* output = fopen(JoinPath(dir, PAINTER_CACHE_NAME).c_str(), "wt");
+      if (output == nullptr)
+      {
+        bb::Error("Can't write \"%s\" cache", dir.c_str());
+        return -1;
+      }
+      BB_DEFER(fclose(output));
+
+      // sorted, so cache file does not change without reason
+      std::map<std::string, uint64_t> sorted(hashes.begin(), hashes.end());
+      for (auto& item: sorted)
+      {
+        fprintf(output, "%016llx %s\n", static_cast<unsigned long long>(item.second), item.first.c_str());
+      }
+      return 0;
+    }
+
+    jobResult_t Compile(const std::string& dir, const std::string& name, const hashes_t& cache, bool force, uint64_t* hash)
+    {
+      std::string scriptName = JoinPath(dir, name);
+
+      size_t size = 0;
+      char* script = bb::ReadWholeFile(scriptName.c_str(), "rb", &size);
+      if (script == nullptr)
+      {
+        bb::Error("Can't read \"%s\"", scriptName.c_str());
+        return jobResult_t::failed;
+      }
+      BB_DEFER(free(script));
+
+      // terminating zero is not a content
+      *hash = ContentHash(script, size - 1);
+
+      std::string meshName = scriptName + ".msh";
+      auto cached = cache.find(name);
+      if (!force && (cached != cache.end()) && (cached->second == *hash) && FileExists(meshName))
+      {
+        return jobResult_t::skipped;
+      }
+
+      painterVM_t painterVM;
+      if (bb::ExecuteScript(painterVM, script) != 0)
+      {
+        bb::Error("Invalid PVF \"%s\"", scriptName.c_str());
+        return jobResult_t::failed;
+      }
+
+      auto meshDesc = painterVM.MeshDescription();
+      if (!meshDesc.IsGood())
+      {
+        bb::Error("Nothing is drawn in \"%s\"", scriptName.c_str());
+        return jobResult_t::failed;
+      }
+
+      FILE* output = fopen(meshName.c_str(), "wb");
+      if (output == nullptr)
+      {
+        bb::Error("Can't write \"%s\"", meshName.c_str());
+        return jobResult_t::failed;
+      }
+      BB_DEFER(fclose(output));
+
+      if (meshDesc.Save(output) != 0)
+      {
+        bb::Error("Can't save \"%s\"", meshName.c_str());
+        return jobResult_t::failed;
+      }
+      return jobResult_t::compiled;
+    }
+
+  } // namespace
+
+  int CompileBatch(const std::vector<std::string>& paths, bool force, batchStats_t* stats)
+  {
+    auto start = std::chrono::steady_clock::now();
+    int result = 0;
+
+    std::vector<job_t> jobs;
+    for (auto path: paths)
+    {
+      while ((path.size() > 1) && (path.back() == '/'))
+      {
+        path.pop_back();
+      }
+
+      if (IsDirectory(path))
+      {
+        std::vector<std::string> names;
+        if (ListScripts(path, &names) != 0)
+        {
+          bb::Error("Can't list \"%s\"", path.c_str());
+          result = -1;
+          continue;
+        }
+        for (auto& name: names)
+        {
+          jobs.push_back(job_t{ path, name, 0, jobResult_t::failed });
+        }
+        continue;
+      }
+
+      if (!FileExists(path))
+      {
+        bb::Error("Script \"%s\" not found", path.c_str());
+        result = -1;
+        continue;
+      }
+
+      auto slash = path.find_last_of('/');
+      if (slash == std::string::npos)
+      {
+        jobs.push_back(job_t{ ".", path, 0, jobResult_t::failed });
+      }
+      else
+      {
+        jobs.push_back(job_t{ path.substr(0, slash), path.substr(slash + 1), 0, jobResult_t::failed });
+      }
+    }
+
+    // same script may be given twice, as file and in directory
+    std::sort(jobs.begin(), jobs.end(),
+      [](const job_t& a, const job_t& b)
+      {
+        return (a.dir < b.dir) || ((a.dir == b.dir) && (a.name < b.name));
+      }
+    );
+    jobs.erase(
+      std::unique(jobs.begin(), jobs.end(),
+        [](const job_t& a, const job_t& b)
+        {
+          return (a.dir == b.dir) && (a.name == b.name);
+        }
+      ),
+      jobs.end()
+    );
+
+    // caches are read only, while jobs run
+    std::map<std::string, hashes_t> caches;
+    for (auto& job: jobs)
+    {
+      if (caches.find(job.dir) == caches.end())
+      {
+        caches.emplace(job.dir, LoadCache(job.dir));
+      }
+    }
+
+    bb::ParallelFor(jobs.size(),
+      [&jobs, &caches, force](size_t index)
+      {
+        auto& job = jobs[index];
+        job.result = Compile(job.dir, job.name, caches.at(job.dir), force, &job.hash);
+      }
+    );
+
+    batchStats_t total = { 0, 0, 0, 0.0 };
+    for (auto& job: jobs)
+    {
+      auto& cache = caches.at(job.dir);
+      switch (job.result)
+      {
+        case jobResult_t::compiled:
+          bb::Info("Compiled \"%s\"", JoinPath(job.dir, job.name).c_str());
+          cache[job.name] = job.hash;
+          ++total.compiled;
+          break;
+        case jobResult_t::skipped:
+          ++total.skipped;
+          break;
+        case jobResult_t::failed:
+          cache.erase(job.name);
+          ++total.failed;
+          result = -1;
+          break;
+      }
+    }
+
+    for (auto& cache: caches)
+    {
+      if (SaveCache(cache.first, cache.second) != 0)
+      {
+        result = -1;
+      }
+    }
+
+    total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (stats != nullptr)
+    {
+      *stats = total;
+    }
+    return result;
+  }
+
+} // namespace paint
@@ -1,6 +1,11 @@
 #include <string>
+#include <chrono>
+#include <cstring>
+#include <vector>
 
 #include <painter.hpp>
+#include <painterVM.hpp>
+#include <batch.hpp>
 #include <camera.hpp>
 #include <common.hpp>
 #include <mailbox.hpp>
@@ -101,126 +106,6 @@ bb::mesh_t mesh;
 bb::shader_t lineShader;
 bb::camera_t camera;
 
-class painterVM_t: public bb::vm_t
-{
-  float brushWidth;
-  glm::vec3 cursor;
-  uint32_t sides;
-  bb::meshDesc_t meshDesc;
-  glm::vec2 textScale;
-
-  int OnCommand(int cmd, const bb::listOfRefs_t& refs) override
-  {
-    switch(cmd)
-    {
-    case 'f':
-    {
-      camera = bb::camera_t::Orthogonal(
-        static_cast<float>(bb::Argument(refs, 2)),
-        static_cast<float>(bb::Argument(refs, 0)),
-        static_cast<float>(bb::Argument(refs, 1)),
-        static_cast<float>(bb::Argument(refs, 3))
-      );
-      break;
-    }
-    case 'm':
-      this->cursor = glm::vec3(0.0f);
-      /* FALLTHROUGH */
-    case 'r':
-      this->cursor.x += static_cast<float>(bb::Argument(refs, 0));
-      this->cursor.y += static_cast<float>(bb::Argument(refs, 1));
-      break;
-    case 'l':
-      {
-        bb::linePoints_t linePoints;
-
-        linePoints.emplace_back(this->cursor);
-        this->cursor.x = static_cast<float>(bb::Argument(refs, 0));
-        this->cursor.y = static_cast<float>(bb::Argument(refs, 1));
-
-        linePoints.emplace_back(this->cursor);
-
-        this->meshDesc.Append(
-          bb::DefineLine(
-            glm::vec3(0.0f),
-            this->brushWidth,
-            linePoints
-          )
-        );
-      }
-      break;
-    case 'b':
-      this->brushWidth = static_cast<float>(bb::Argument(refs, 0));
-      break;
-    case 'c':
-      this->meshDesc.Append(
-        bb::DefineCircle(
-          this->cursor,
-          this->sides,
-          static_cast<float>(bb::Argument(refs, 0)),
-          this->brushWidth
-        )
-      );
-      break;
-    case 's':
-      this->sides = static_cast<uint32_t>(bb::Argument(refs, 0));
-      if (this->sides == 0)
-      {
-        this->sides = 32;
-      }
-      break;
-    case 't':
-      this->textScale.x = static_cast<float>(bb::Argument(refs, 0));
-      this->textScale.y = static_cast<float>(bb::Argument(refs, 1));
-      break;
-    case 'd':
-      this->meshDesc.Append(
-        bb::DefineNumber(
-          this->cursor,
-          this->brushWidth,
-          this->textScale,
-          bb::StringArg(refs, 0).c_str()
-        )
-      );
-      break;
-    default:
-      bb::Debug("Command %c (%d)\n", cmd, cmd);
-      for (auto& item: refs)
-      {
-        bb::Debug("\t%f\n", item.Number());
-      }
-    }
-    return 0;
-  }
-
-public:
-
-  const bb::meshDesc_t& GetMeshDescription() const
-  {
-    return this->meshDesc;
-  }
-
-  bb::mesh_t GetMesh() const
-  {
-    return bb::GenerateMesh(this->meshDesc);
-  }
-
-  painterVM_t()
-  : brushWidth(0.0f),
-    cursor(0.0f),
-    sides(32),
-    textScale(1.0f)
-  {
-    this->meshDesc.SetDrawMode(GL_TRIANGLE_STRIP);
-  }
-
-  painterVM_t(const painterVM_t&) = delete;
-  painterVM_t& operator=(const painterVM_t&) = delete;
-  painterVM_t(painterVM_t&&) = delete;
-  painterVM_t& operator=(painterVM_t&&) = delete;
-
-};
-
 void Render()
 {
   auto& context = bb::context_t::Instance();
@@ -253,7 +138,17 @@ int UpdateScene(const char* scriptName)
 
   if (bb::meshDesc_t::CheckFile(input))
   {
+    auto loadStart = std::chrono::steady_clock::now();
     auto meshDesc = bb::meshDesc_t::Load(input);
+    if (!meshDesc.IsGood())
+    {
+      return -1;
+    }
+    bb::Info(
+      "Mesh loaded in %.3f ms (" BBsize_t " bytes per vertex)",
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count(),
+      meshDesc.VertexSize()
+    );
     mesh = bb::GenerateMesh(meshDesc);
 
     camera = bb::camera_t::Orthogonal(
@@ -270,21 +165,36 @@ int UpdateScene(const char* scriptName)
     }
     BB_DEFER(free(script));
 
-    painterVM_t painterVM;
+    paint::painterVM_t painterVM;
     if (bb::ExecuteScript(painterVM, script) != 0)
     {
       return -1;
     }
-    mesh = painterVM.GetMesh();
+
+    if (painterVM.HasFrame())
+    {
+      auto& frame = painterVM.Frame();
+      camera = bb::camera_t::Orthogonal(frame.z, frame.x, frame.y, frame.w);
+    }
+
+    auto meshDesc = painterVM.MeshDescription();
+    if (!meshDesc.IsGood())
+    {
+      return -1;
+    }
+    mesh = bb::GenerateMesh(meshDesc);
 
     FILE* output = fopen((std::string(scriptName) + ".msh").c_str(), "wb");
     if (output != nullptr)
     {
       BB_DEFER(fclose(output));
-      bb::Info("Saving mesh description...");
+      bb::Info(
+        "Saving mesh description (" BBsize_t " bytes per vertex)...",
+        meshDesc.VertexSize()
+      );
       bb::Info(
         "Save mesh result: %d",
-        painterVM.GetMeshDescription().Save(output)
+        meshDesc.Save(output)
       );
     }
   }
@@ -298,10 +208,29 @@ int main(int argc, char* argv[])
     return -1;
   }
 
+  if ((argc > 2) && ((strcmp(argv[1], "batch") == 0) || (strcmp(argv[1], "rebuild") == 0)))
+  { // no window needed
+    paint::batchStats_t stats;
+    int result = paint::CompileBatch(
+      std::vector<std::string>(argv + 2, argv + argc),
+      strcmp(argv[1], "rebuild") == 0,
+      &stats
+    );
+    bb::Info(
+      "Batch: " BBsize_t " compiled, " BBsize_t " unchanged, " BBsize_t " failed in %.3f ms",
+      stats.compiled,
+      stats.skipped,
+      stats.failed,
+      stats.seconds*1000.0
+    );
+    return result;
+  }
+
   if (argc != 2)
   {
     fprintf(stderr, "Error: No script provided!\n");
     fprintf(stderr, "Usage: painter SCRIPT\n");
+    fprintf(stderr, "       painter batch|rebuild SCRIPT|DIR...\n");
     return -1;
   }
 
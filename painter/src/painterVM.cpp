@@ -0,0 +1,91 @@
+#include <painterVM.hpp>
+#include <common.hpp>
+
+namespace paint
+{
+
+  int painterVM_t::OnCommand(int cmd, const bb::scriptArgs_t& args)
+  {
+    switch(cmd)
+    {
+    case 'f':
+      this->frame = glm::vec4(
+        static_cast<float>(bb::Argument(args, 0)),
+        static_cast<float>(bb::Argument(args, 1)),
+        static_cast<float>(bb::Argument(args, 2)),
+        static_cast<float>(bb::Argument(args, 3))
+      );
+      this->hasFrame = true;
+      break;
+    case 'm':
+      this->cursor = glm::vec3(0.0f);
+      /* FALLTHROUGH */
+    case 'r':
+      this->cursor.x += static_cast<float>(bb::Argument(args, 0));
+      this->cursor.y += static_cast<float>(bb::Argument(args, 1));
+      break;
+    case 'l':
+      {
+        glm::vec2 start(this->cursor.x, this->cursor.y);
+        this->cursor.x = static_cast<float>(bb::Argument(args, 0));
+        this->cursor.y = static_cast<float>(bb::Argument(args, 1));
+
+        this->tessellator.Line(
+          start,
+          glm::vec2(this->cursor.x, this->cursor.y),
+          this->brushWidth
+        );
+      }
+      break;
+    case 'b':
+      this->brushWidth = static_cast<float>(bb::Argument(args, 0));
+      break;
+    case 'c':
+      this->tessellator.Circle(
+        this->cursor,
+        this->sides,
+        static_cast<float>(bb::Argument(args, 0)),
+        this->brushWidth
+      );
+      break;
+    case 's':
+      this->sides = static_cast<uint32_t>(bb::Argument(args, 0));
+      if (this->sides == 0)
+      {
+        this->sides = 32;
+      }
+      break;
+    case 't':
+      this->textScale.x = static_cast<float>(bb::Argument(args, 0));
+      this->textScale.y = static_cast<float>(bb::Argument(args, 1));
+      break;
+    case 'd':
+      this->tessellator.Text(
+        this->cursor,
+        this->brushWidth,
+        this->textScale,
+        bb::TextArg(args, 0)
+      );
+      break;
+    default:
+      bb::Debug("Command %c (%d)\n", cmd, cmd);
+      for (auto& item: args)
+      {
+        bb::Debug("\t%f\n", item.Number());
+      }
+    }
+    return 0;
+  }
+
+  painterVM_t::painterVM_t()
+  : brushWidth(0.0f),
+    cursor(0.0f),
+    sides(32),
+    textScale(1.0f),
+    frame(0.0f),
+    hasFrame(false)
+  {
+    ;
+  }
+
+} // namespace paint
@@ -0,0 +1,225 @@
+#include <tessellator.hpp>
+#include <algebra.hpp>
+#include <common.hpp>
+#include <utf8.hpp>
+#include <vecfont.hpp>
+
+#include <cmath>
+#include <limits>
+
+namespace paint
+{
+
+  namespace
+  {
+
+    const glm::vec2 topleft(0.0f, 0.0f);
+    const glm::vec2 topright(0.0f, 1.0f);
+    const glm::vec2 left(0.5f, 0.0f);
+    const glm::vec2 right(0.5f, 1.0f);
+    const glm::vec2 bottomleft(1.0f, 0.0f);
+    const glm::vec2 bottomright(1.0f, 1.0f);
+
+    // line segment is two quads with round caps in fragment shader
+    const glm::vec2 segmentDistance[8] = {
+      topleft, topright, left, right, left, right, bottomleft, bottomright
+    };
+
+    const glm::vec2 innerDist(1.0f, 1.0f);
+    const glm::vec2 outerDist(0.0f, 0.0f);
+
+  } // namespace
+
+  const tessellator_t::circle_t& tessellator_t::UnitCircle(uint32_t sides)
+  {
+    auto cached = this->circles.find(sides);
+    if (cached != this->circles.end())
+    {
+      return cached->second;
+    }
+
+    circle_t result;
+    result.reserve(sides);
+
+    // angle is accumulated, as DefineCircle does
+    float angle = 0.0f;
+    const float angleStep = static_cast<float>(M_PI*2.0/sides);
+    for (uint32_t i = 0; i < sides; ++i)
+    {
+      result.push_back(bb::Dir(angle));
+      angle += angleStep;
+    }
+    return this->circles.emplace(sides, std::move(result)).first->second;
+  }
+
+  void tessellator_t::Segment(glm::vec2 start, glm::vec2 finish, glm::vec2 offset, float width)
+  {
+    auto index = static_cast<uint32_t>(this->points.size());
+
+    auto dir = glm::normalize(finish - start);
+    auto tangent = glm::vec2(dir.y, -dir.x)*width/2.0f;
+
+    this->points.emplace_back(start + tangent + offset - dir*width/2.0f);
+    this->points.emplace_back(start - tangent + offset - dir*width/2.0f);
+    this->points.emplace_back(start + tangent + offset + dir*width/2.0f);
+    this->points.emplace_back(start - tangent + offset + dir*width/2.0f);
+    this->points.emplace_back(finish + tangent + offset - dir*width/2.0f);
+    this->points.emplace_back(finish - tangent + offset - dir*width/2.0f);
+    this->points.emplace_back(finish + tangent + offset + dir*width/2.0f);
+    this->points.emplace_back(finish - tangent + offset + dir*width/2.0f);
+
+    this->distance.insert(this->distance.end(), segmentDistance, segmentDistance + bb::countof(segmentDistance));
+
+    for (uint32_t cnt = 0; cnt < 8; ++cnt)
+    {
+      this->indecies.push_back(index + cnt);
+    }
+    this->indecies.push_back(bb::breakingIndex<uint32_t>());
+  }
+
+  void tessellator_t::Polyline(const glm::vec2* linePoints, size_t count, glm::vec2 offset, float width)
+  {
+    if (count < 2)
+    { // DefineLine rejects it too
+      return;
+    }
+
+    width = bb::CheckValueBounds(width, 0.01f, 100.0f);
+    for (size_t i = 0; i + 1 < count; ++i)
+    {
+      this->Segment(linePoints[i], linePoints[i + 1], offset, width);
+    }
+  }
+
+  void tessellator_t::Line(glm::vec2 start, glm::vec2 finish, float width)
+  {
+    const glm::vec2 linePoints[2] = { start, finish };
+    this->Polyline(linePoints, bb::countof(linePoints), glm::vec2(0.0f), width);
+  }
+
+  void tessellator_t::Circle(glm::vec3 center, uint32_t sides, float radius, float width)
+  {
+    sides = bb::CheckValueBounds(sides, static_cast<uint32_t>(3), static_cast<uint32_t>(std::numeric_limits<uint16_t>::max()/4));
+    radius = bb::CheckValueBounds(radius, 0.0f, 1000.0f);
+    width = bb::CheckValueBounds(width, 0.01f, radius/2.0f);
+
+    const float outerRing = radius + width/2.0f;
+    const float innerRing = radius - width/2.0f;
+    auto index = static_cast<uint32_t>(this->points.size());
+
+    for (auto dir: this->UnitCircle(sides))
+    {
+      glm::vec2 point = dir;
+      point.x += center.x;
+      point.y += center.y;
+
+      this->points.push_back(point * outerRing);
+      this->points.push_back(point * innerRing);
+
+      this->distance.push_back(outerDist);
+      this->distance.push_back(innerDist);
+
+      this->indecies.push_back(static_cast<uint32_t>(this->points.size() - 2));
+      this->indecies.push_back(static_cast<uint32_t>(this->points.size() - 1));
+    }
+    this->indecies.push_back(index);
+    this->indecies.push_back(index + 1);
+    this->indecies.push_back(bb::breakingIndex<uint32_t>());
+  }
+
+  int tessellator_t::Text(glm::vec3 offset, float width, glm::vec2 scale, const char* utf8Text)
+  {
+    if (utf8Text == nullptr)
+    {
+      return 0;
+    }
+
+    const size_t pointsMark = this->points.size();
+    const size_t indeciesMark = this->indecies.size();
+    const glm::vec2 off2d(offset.x, offset.y);
+
+    std::vector<glm::vec2> linePoints;
+    glm::vec2 cursor(0.0f);
+
+    bb::utf8Decoder_t decoder(utf8Text);
+    uint32_t smb;
+    while (decoder.Next(&smb))
+    {
+      if (bb::IsSpace(static_cast<wint_t>(smb)))
+      {
+        cursor.x += 1.0f;
+        continue;
+      }
+
+      auto smbScale = scale;
+      auto smbCursor = cursor;
+
+      if (bb::IsLower(static_cast<wint_t>(smb)))
+      {
+        smbCursor.y += 0.6f;
+        smbScale.y *= 0.6f;
+      }
+
+      size_t smbSize;
+      auto smbVerts = bb::VectorFontSymbol(static_cast<wint_t>(smb), &smbSize);
+      if (smbVerts == nullptr)
+      { // DefineNumber drops whole text
+        bb::Error("Unknown symbol: %08x (%c)", smb, (smb & 0xFF));
+        this->points.resize(pointsMark);
+        this->distance.resize(pointsMark);
+        this->indecies.resize(indeciesMark);
+        return -1;
+      }
+
+      linePoints.clear();
+      for (size_t i = 0; i < smbSize; ++i)
+      {
+        if (smbVerts[i].x > 1.0f)
+        { // breaking vertex starts new line, short lines continue
+          if (linePoints.size() < 2)
+          {
+            continue;
+          }
+          this->Polyline(linePoints.data(), linePoints.size(), off2d, width);
+          linePoints.clear();
+          continue;
+        }
+        linePoints.emplace_back((smbVerts[i] + smbCursor)*smbScale);
+      }
+      this->Polyline(linePoints.data(), linePoints.size(), off2d, width);
+
+      cursor.x += 1.0f;
+    }
+
+    if (!decoder.IsGood())
+    { // same as unknown symbol
+      bb::Error("Invalid UTF-8 text: \"%s\"", utf8Text);
+      this->points.resize(pointsMark);
+      this->distance.resize(pointsMark);
+      this->indecies.resize(indeciesMark);
+      return -1;
+    }
+    return 0;
+  }
+
+  bb::meshDesc_t tessellator_t::Build() const
+  {
+    if (this->points.empty())
+    {
+      return bb::meshDesc_t();
+    }
+
+    bb::meshDesc_t result;
+    result.Buffers().emplace_back(bb::MakeVertexBuffer(std::vector<glm::vec2>(this->points)));
+    result.Buffers().emplace_back(bb::MakeVertexBuffer(std::vector<glm::vec2>(this->distance)));
+    result.Indecies() = bb::MakeCompactIndexBuffer(std::vector<uint32_t>(this->indecies));
+    result.SetDrawMode(GL_TRIANGLE_STRIP);
+    return result;
+  }
+
+  tessellator_t::tessellator_t()
+  {
+    ;
+  }
+
+} // namespace paint
@@ -3,7 +3,7 @@
 
 layout(location = 0) in vec3 vPos;
 layout(location = 1) in vec3 vCol;
-layout(location = 2) in vec3 vNorm;
+layout(location = 2) in vec2 vNorm; // octahedral
 
 uniform camera
 {
@@ -11,12 +11,25 @@ uniform camera
   mat4 view;
 };
 
+uniform mat4 model;
+
 out vec3 fragCol;
 out vec3 fragNormal;
 
+vec3 OctahedralDecode(vec2 e)
+{
+  vec3 v = vec3(e, 1.0f - abs(e.x) - abs(e.y));
+  if (v.z < 0.0f)
+  {
+    vec2 s = vec2((v.x >= 0.0f)?1.0f:-1.0f, (v.y >= 0.0f)?1.0f:-1.0f);
+    v.xy = (1.0f - abs(v.yx))*s;
+  }
+  return normalize(v);
+}
+
 void main()
 {
   fragCol = vCol;
-  fragNormal = vec3(view * vec4(vNorm, 0.0f));
-  gl_Position = proj * view * vec4(vPos, 1.0f);
+  fragNormal = vec3(view * vec4(OctahedralDecode(vNorm), 0.0f));
+  gl_Position = proj * view * model * vec4(vPos, 1.0f);
 }
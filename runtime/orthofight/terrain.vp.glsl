@@ -0,0 +1,61 @@
+
+// Vertex Shader
+#version 330 core
+
+layout(location = 0) in vec3 vGrid;
+
+uniform camera
+{
+  mat4 proj;
+  mat4 view;
+};
+
+uniform sampler2D heightMap;
+uniform vec2 chunkOrigin;
+uniform float skirtDepth;
+
+out vec3 fragCol;
+out vec3 fragNormal;
+
+float Height(ivec2 pos)
+{
+  ivec2 size = textureSize(heightMap, 0);
+  return texelFetch(heightMap, clamp(pos, ivec2(0), size - 1), 0).r;
+}
+
+float WrapHeight(ivec2 pos)
+{
+  ivec2 size = textureSize(heightMap, 0);
+  return texelFetch(heightMap, (pos + size) % size, 0).r;
+}
+
+vec3 Normal(ivec2 pos)
+{
+  // same as heightMap_t::NormalAtPoint with zScale = 2
+  float h = WrapHeight(pos)*2.0f;
+  vec3 right = vec3( 1.0f,  0.0f, WrapHeight(pos + ivec2( 1,  0))*2.0f - h);
+  vec3 up    = vec3( 0.0f,  1.0f, WrapHeight(pos + ivec2( 0,  1))*2.0f - h);
+  vec3 left  = vec3(-1.0f,  0.0f, WrapHeight(pos + ivec2(-1,  0))*2.0f - h);
+  vec3 down  = vec3( 0.0f, -1.0f, WrapHeight(pos + ivec2( 0, -1))*2.0f - h);
+  return normalize(cross(right, up) + cross(up, left) + cross(left, down) + cross(down, right));
+}
+
+void main()
+{
+  ivec2 pos = ivec2(chunkOrigin + vGrid.xy);
+  ivec2 size = textureSize(heightMap, 0);
+
+  // chunks on map border are partially outside
+  pos = min(pos, size - 1);
+
+  float h = Height(pos);
+
+  fragCol = vec3(h);
+  fragNormal = vec3(view * vec4(Normal(pos), 0.0f));
+  gl_Position = proj * view * vec4(
+    float(pos.x)/20.0f,
+    float(pos.y)/20.0f,
+    round(h*4.0f)/4.0f + h/5.0f - vGrid.z*skirtDepth,
+    1.0f
+  );
+}
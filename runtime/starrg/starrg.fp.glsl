@@ -5,13 +5,28 @@ layout(location = 0) out vec4 pixColor;
 
 in vec2 fragUV;
 in vec3 fragCol;
+in vec2 fragMapPos;
 
 uniform sampler2D tileset;
+uniform sampler2D fog;
 uniform float minAlpha;
+uniform float useFog;
+
+const vec2 tileSize = vec2(16.0f, 16.0f);
 
 void main()
 {
+  float light = 1.0f;
+  if (useFog != 0.0f)
+  {
+    light = texelFetch(fog, ivec2(floor(fragMapPos / tileSize)), 0).r;
+    if (light == 0.0f)
+    {
+      discard;
+    }
+  }
+
   vec4 fragm = texture(tileset, fragUV);
-  vec3 color = fragm.rgb * fragCol;
+  vec3 color = fragm.rgb * fragCol * light;
   pixColor = vec4(color, max(minAlpha, fragm.a));
-}
\ No newline at end of file
+}
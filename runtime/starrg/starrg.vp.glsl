@@ -14,6 +14,7 @@ uniform camera
 
 out vec2 fragUV;
 out vec3 fragCol;
+out vec2 fragMapPos;
 
 uniform float time;
 
@@ -21,5 +22,6 @@ void main()
 {
   fragUV = vUV;
   fragCol = vCol;
+  fragMapPos = vPos.xy;
   gl_Position = proj * view * vec4(vPos.xy + vShim*sin(time), vPos.z, 1.0f);
 }
@@ -1,9 +1,16 @@
 /**
  * @file ecs.hpp
  * @author masscry
- * 
+ *
  * Simple ECS
- * 
+ *
+ * Each component type is stored in sparse set: dense arrays of entity IDs
+ * and component data, plus sparse array from entity ID to dense index.
+ * Add, remove and lookup are O(1), iteration walks dense arrays.
+ *
+ * Entities and components are not guarded by mutex, they must be used
+ * from one thread at a time (star.rg world actor).
+ *
  */
 
 #pragma once
@@ -11,13 +18,11 @@
 #define STARRG_ECS_HEADER
 
 #include <glm/vec2.hpp>
+#include <algorithm>
 #include <cstdint>
 #include <vector>
-#include <list>
-#include <deque>
 #include <type_traits>
-#include <algorithm>
-#include <mutex>
+#include <stdexcept>
 
 namespace sr
 {
@@ -34,16 +39,13 @@ namespace sr
 
   class entityFactory_t final
   {
-    mutable std::mutex mutex;
     std::vector<bool> entity;
-    std::list<entityID_t> released;
-    std::list<basicComponentFactory_t*> factories;
+    std::vector<entityID_t> released; // free list, last released ID is reused first
+    std::vector<basicComponentFactory_t*> factories;
 
     entityFactory_t();
     ~entityFactory_t();
 
-    void ReleaseNoLock(entityID_t id);
-
   public:
 
     static entityFactory_t& Instance();
@@ -55,6 +57,11 @@ namespace sr
     entityID_t GetNew();
     void Release(entityID_t id);
 
+    /**
+     * Number of alive entities.
+     */
+    size_t Size() const;
+
     void Clear();
 
     entityFactory_t(const entityFactory_t&) = delete;
@@ -63,66 +70,29 @@ namespace sr
     entityFactory_t& operator=(entityFactory_t&&) = delete;
   };
 
-  template<class ForwardIt, class T, class Compare>
-  ForwardIt BinarySearch(ForwardIt first, ForwardIt last, const T& value, Compare comp)
-  {
-    first = std::lower_bound(first, last, value, comp);
-    if (!(first == last) && !(comp(value, *first)))
-    {
-      return first;
-    }
-    return last;
-  }
-
+  /**
+   * Component type tag, data_t components are kept in factory_t.
+   */
   template<typename data_t>
   class component_t final
   {
-    using self_t = component_t<data_t>;
-    friend class std::deque<self_t>;
-
     static_assert(std::is_trivial<data_t>::value == true, "Data Must Be Trivial");
 
-    entityID_t id;
-    data_t data;
+    component_t() = delete;
 
   public:
 
-    bool operator < (const component_t<data_t>& rhs) const
-    {
-      return this->id < rhs.id;
-    }
+    using value_t = data_t;
 
     class factory_t: public basicComponentFactory_t
     {
-      using storage_t = std::deque<self_t>;
-
-      struct compareSelfItems_t
-      {
-        bool operator()(entityID_t a, const self_t& b)
-        {
-          return a < b.ID();
-        }
-        bool operator()(const self_t& a, entityID_t b)
-        {
-          return a.ID() < b;
-        }
-        bool operator()(const self_t& a, const self_t& b)
-        {
-          return a.ID() < b.ID();
-        }
-      };
-
-      mutable std::mutex mutex;
-      storage_t storage;
+      std::vector<uint32_t> sparse; // entity ID to dense index or npos
+      std::vector<entityID_t> ids;  // dense, entity of each item
+      std::vector<data_t> items;    // dense, parallel to ids
 
       void OnEntityDelete(entityID_t id) override
       {
-        std::unique_lock<std::mutex> lock(this->mutex);
-        auto it = BinarySearch(this->storage.begin(), this->storage.end(), id, compareSelfItems_t());
-        if (it != this->storage.end())
-        {
-          this->storage.erase(it);
-        }
+        this->Remove(id);
       }
 
       factory_t()
@@ -135,165 +105,248 @@ namespace sr
         entityFactory_t::Instance().RemoveFactory(this);
       }
 
-      self_t& ItemNoLock(entityID_t id)
+    public:
+
+      enum : uint32_t
       {
-        auto it = BinarySearch(this->storage.begin(), this->storage.end(), id, compareSelfItems_t());
-        if (it != this->storage.end())
-        {
-          return *it;
-        }
-        throw std::runtime_error("Item not found!");
-      }
+        npos = UINT32_MAX
+      };
 
-    public:
+      static factory_t& Instance()
+      {
+        static factory_t factory;
+        return factory;
+      }
 
+      /**
+       * Call func(entityID_t, data_t&) for each component.
+       *
+       * Components are walked from the end, so components added during
+       * iteration are skipped and current component can be removed.
+       *
+       * Other components must not be removed during iteration: last
+       * component, which is already visited, is moved to the place of
+       * removed one and visited again. Iteration only stops early, when
+       * storage shrinks below current index.
+       */
       template<typename func_t>
       void Each(func_t func)
       {
-        for (auto it: storage)
+        for (size_t index = this->items.size(); index-- > 0;)
         {
-          func(it);
+          func(this->ids[index], this->items[index]);
+          if (index > this->items.size())
+          { // more, than current component was removed
+            break;
+          }
         }
       }
 
-      static factory_t& Instance()
+      /**
+       * Add component, or return existing one.
+       *
+       * References to components are invalidated, when component is added
+       * or removed.
+       */
+      data_t& NewComponent(entityID_t id, data_t data)
       {
-        static self_t::factory_t factory;
-        return factory;
-      }
+        if (id < 0)
+        {
+          throw std::runtime_error("Invalid entity ID");
+        }
 
-      self_t& NewComponent(entityID_t id, data_t data)
-      {
-        std::unique_lock<std::mutex> lock(this->mutex);
-        auto it = BinarySearch(this->storage.begin(), this->storage.end(), id, compareSelfItems_t());
-        if (it != this->storage.end())
+        auto entity = static_cast<size_t>(id);
+        if (entity >= this->sparse.size())
         {
-          return *it;
+          this->sparse.resize(entity + 1, npos);
         }
 
-        this->storage.emplace_back(
-          id, data
-        );
-        std::sort(this->storage.begin(), this->storage.end(), compareSelfItems_t());
+        if (this->sparse[entity] != npos)
+        {
+          return this->items[this->sparse[entity]];
+        }
 
-        return this->ItemNoLock(id);
+        this->sparse[entity] = static_cast<uint32_t>(this->items.size());
+        this->ids.push_back(id);
+        this->items.push_back(data);
+        return this->items.back();
       }
 
-      self_t& NewComponent(entityID_t id)
+      data_t& NewComponent(entityID_t id)
       {
         return this->NewComponent(id, data_t());
       }
 
-      const self_t& Item(entityID_t id) const
+      /**
+       * Remove component, last component takes its place.
+       */
+      void Remove(entityID_t id)
       {
-        return const_cast<self_t::factory_t*>(this)->Item(id);
+        auto index = this->Index(id);
+        if (index == npos)
+        {
+          return;
+        }
+
+        auto last = static_cast<uint32_t>(this->items.size() - 1);
+        // keep arrays dense
+        if (index != last)
+        {
+          this->ids[index] = this->ids[last];
+          this->items[index] = this->items[last];
+          this->sparse[static_cast<size_t>(this->ids[index])] = index;
+        }
+        this->ids.pop_back();
+        this->items.pop_back();
+        this->sparse[static_cast<size_t>(id)] = npos;
+      }
+
+      /**
+       * @return dense index of entity component or npos
+       */
+      uint32_t Index(entityID_t id) const
+      {
+        auto entity = static_cast<size_t>(id);
+        if ((id < 0) || (entity >= this->sparse.size()))
+        {
+          return npos;
+        }
+        return this->sparse[entity];
       }
 
-      self_t& Item(entityID_t id)
+      bool Has(entityID_t id) const
       {
-        std::unique_lock<std::mutex> lock(this->mutex);
-        return this->ItemNoLock(id);
+        return this->Index(id) != npos;
       }
 
-      const self_t* OptionalItem(entityID_t id) const
+      const data_t& Item(entityID_t id) const
       {
-        return const_cast<self_t::factory_t*>(this)->OptionalItem(id);
+        return const_cast<factory_t*>(this)->Item(id);
       }
 
-      self_t* OptionalItem(entityID_t id)
+      data_t& Item(entityID_t id)
       {
-        std::unique_lock<std::mutex> lock(this->mutex);
-        auto it = BinarySearch(this->storage.begin(), this->storage.end(), id, compareSelfItems_t());
-        if (it != this->storage.end())
+        auto index = this->Index(id);
+        if (index == npos)
         {
-          return &(*it);
+          throw std::runtime_error("Item not found!");
         }
-        return nullptr;
+        return this->items[index];
       }
 
-    };
-
-    data_t* operator->()
-    {
-      return &this->data;
-    }
+      const data_t* OptionalItem(entityID_t id) const
+      {
+        return const_cast<factory_t*>(this)->OptionalItem(id);
+      }
 
-    data_t& operator*()
-    {
-      return this->data;
-    }
+      data_t* OptionalItem(entityID_t id)
+      {
+        auto index = this->Index(id);
+        return (index != npos)?(&this->items[index]):(nullptr);
+      }
 
-    const data_t* operator->() const
-    {
-      return &this->data;
-    }
+      size_t Size() const
+      {
+        return this->items.size();
+      }
 
-    const data_t& operator*() const
-    {
-      return this->data;
-    }
+      /**
+       * Dense array of entity IDs, same order as Data.
+       */
+      const entityID_t* IDs() const
+      {
+        return this->ids.data();
+      }
 
-    entityID_t ID() const
-    {
-      return this->id;
-    }
+      data_t* Data()
+      {
+        return this->items.data();
+      }
 
-    data_t& Data() 
-    {
-      return this->data;
-    }
+      const data_t* Data() const
+      {
+        return this->items.data();
+      }
 
-    const data_t& Data() const
-    {
-      return this->data;
-    }
+    };
 
-    component_t(entityID_t id, data_t data)
-    : id(id),
-      data(data)
-    {
-      ;
-    }
+  };
 
-    component_t(const component_t& comp)
-    : id(comp.id),
-      data(comp.data)
-    {
-      ;
-    }
+  namespace detail
+  {
 
-    component_t(component_t&& comp)
-    : id(comp.id),
-      data(std::move(comp.data))
-    {
-      ;
-    }
+    template<typename... comps_t>
+    struct view_t;
 
-    ~component_t()
+    template<>
+    struct view_t<>
     {
-      ;
-    }
+      template<typename func_t, typename... data_t>
+      static void Call(entityID_t id, func_t& func, data_t&... data)
+      {
+        func(id, data...);
+      }
+    };
 
-    component_t& operator=(const component_t& comp)
+    template<typename head_t, typename... tail_t>
+    struct view_t<head_t, tail_t...>
     {
-      if (this != &comp)
+      template<typename func_t, typename... data_t>
+      static void Call(entityID_t id, func_t& func, data_t&... data)
       {
-        this->data = comp.data;
+        auto& factory = head_t::factory_t::Instance();
+        auto index = factory.Index(id);
+        if (index != head_t::factory_t::npos)
+        {
+          view_t<tail_t...>::Call(id, func, data..., factory.Data()[index]);
+        }
       }
-      return *this;
-    }
+    };
 
-    component_t& operator=(component_t&& comp)
+  } // namespace detail
+
+  /**
+   * Call func(entityID_t, first data&, rest data&...) for each entity,
+   * which has all listed components.
+   *
+   * Dense array of first component is walked, other components are taken
+   * by index from sparse arrays, so rarest component should be first.
+   *
+   * Same rules, as in factory_t::Each, apply to removing components:
+   * first_t components of other entities must not be removed.
+   */
+  template<typename first_t, typename... rest_t, typename func_t>
+  void Each(func_t func)
+  {
+    auto& first = first_t::factory_t::Instance();
+    for (size_t index = first.Size(); index-- > 0;)
     {
-      if (this != &comp)
-      {
-        this->data = std::move(comp.data);
+      detail::view_t<rest_t...>::Call(first.IDs()[index], func, first.Data()[index]);
+      if (index > first.Size())
+      { // more, than current component was removed
+        break;
       }
-      return *this;
     }
+  }
 
-  };
+  /**
+   * Same as Each, but only components of first type with dense indecies
+   * in [begin, end) are walked.
+   *
+   * Components must not be added or removed, so different ranges can be
+   * walked from different threads at the same time.
+   */
+  template<typename first_t, typename... rest_t, typename func_t>
+  void EachInRange(size_t begin, size_t end, func_t func)
+  {
+    auto& first = first_t::factory_t::Instance();
+    end = std::min(end, first.Size());
+    for (size_t index = begin; index < end; ++index)
+    {
+      detail::view_t<rest_t...>::Call(first.IDs()[index], func, first.Data()[index]);
+    }
+  }
 
 } // namespace sr
 
-#endif /* STARRG_ECS_HEADER */
\ No newline at end of file
+#endif /* STARRG_ECS_HEADER */
@@ -13,10 +13,14 @@
 #include <font.hpp>
 #include <text.hpp>
 #include <role.hpp>
+#include <profilerOverlay.hpp>
+#include <uploadQueue.hpp>
 
 #include <random>
 
 #include <components.hpp>
+#include <systems.hpp>
+#include <unitGrid.hpp>
 
 std::mt19937& RandomEngine();
 
@@ -75,19 +79,6 @@ const uint16_t vConstInd[6] = {
 
 using unit_t = sr::entityID_t;
 
-struct ivecKey_t
-{
-  size_t operator()(const glm::ivec2& k) const
-  {
-    return std::hash<int>()(k.x) ^ std::hash<int>()(k.y);
-  }
-  
-  bool operator()(const glm::ivec2& a, const glm::ivec2& b)const
-  {
-    return a.x == b.x && a.y == b.y;
-  }
-};
-
 struct action_t
 {
   int key;
@@ -109,11 +100,14 @@ class starrg_t
   bb::shader_t mapShader;
   bb::shader_t fontShader;
   bb::texture_t tileset;
+  bb::texture_t fog;
   bb::font_t font;
   bb::textDynamic_t text;
   bb::textDynamic_t log;
   bb::mesh_t map;
   bb::mesh_t unit;
+  bb::profilerOverlay_t overlay;
+  bb::uploadQueue_t uploads;
   bb::mailbox_t::shared_t box;
   bb::actorPID_t world;
   std::deque<std::string> logLines;
@@ -0,0 +1,173 @@
+/**
+ * @file systems.hpp
+ *
+ * ECS systems scheduler
+ *
+ * Each system declares components and world resources it reads and
+ * writes. Systems are split in stages: system goes to the stage right
+ * after the last earlier system it conflicts with. Systems of one stage
+ * run at the same time, per-entity work of each system is split in
+ * chunks, chunks are run by worker actors and by calling thread.
+ *
+ * Systems must not add or remove entities and components, they queue
+ * such changes in commands_t, which are applied between stages.
+ *
+ */
+
+#pragma once
+#ifndef STARRG_SYSTEMS_HEADER
+#define STARRG_SYSTEMS_HEADER
+
+#include <ecs.hpp>
+#include <msg.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sr
+{
+
+  using accessMask_t = uint64_t;
+
+  /**
+   * Unique bit for new resource type, at most 64 types.
+   */
+  accessMask_t NewAccessBit();
+
+  /**
+   * Bit of component or world resource. Any type can be used as resource
+   * tag, even incomplete one.
+   */
+  template<typename resource_t>
+  accessMask_t AccessBit()
+  {
+    static const accessMask_t bit = NewAccessBit();
+    return bit;
+  }
+
+  template<typename... resources_t>
+  accessMask_t Access()
+  {
+    accessMask_t result = 0;
+    using expand_t = int[];
+    (void) expand_t{ 0, ((result |= AccessBit<resources_t>()), 0)... };
+    return result;
+  }
+
+  /**
+   * Deferred structural changes.
+   *
+   * Can be filled from several threads, changes are applied in order of
+   * arrival.
+   */
+  class commands_t final
+  {
+    using change_t = std::function<void(entityID_t)>;
+
+    struct command_t
+    {
+      entityID_t id;   // entity to change or release, -1 to spawn
+      change_t change; // applied to spawned or changed entity, empty to release
+    };
+
+    std::mutex guard;
+    std::vector<command_t> queue;
+
+  public:
+
+    void Spawn(change_t&& spawn);
+    void Despawn(entityID_t id);
+
+    /**
+     * Call change(id) between stages, e.g. to update world resources,
+     * which other chunks read. Skipped, when entity is released before.
+     */
+    void Change(entityID_t id, change_t&& change);
+
+    /**
+     * Apply all queued changes.
+     *
+     * @return number of applied changes
+     */
+    size_t Apply();
+
+    commands_t() = default;
+    commands_t(const commands_t&) = delete;
+    commands_t& operator=(const commands_t&) = delete;
+  };
+
+  struct system_t
+  {
+    std::string name;
+    accessMask_t reads;
+    accessMask_t writes;
+
+    /**
+     * Called on scheduling thread, before stage starts.
+     *
+     * @return number of items to split in chunks, if not set - system is
+     * run as one chunk [0, 1)
+     */
+    std::function<size_t()> prepare;
+
+    /**
+     * Process items [begin, end). Can be called from several threads at
+     * the same time for different ranges.
+     */
+    std::function<void(size_t begin, size_t end, commands_t& commands)> run;
+  };
+
+  class scheduler_t final
+  {
+    std::vector<system_t> systems;
+    std::vector<std::vector<size_t>> stages;
+    std::vector<bb::actorPID_t> helpers;
+    commands_t commands;
+    size_t chunkSize;
+
+    void RunStage(const std::vector<size_t>& stage);
+
+  public:
+
+    /**
+     * Systems are run in order of addition, unless they do not conflict.
+     */
+    void Add(system_t&& system);
+
+    /**
+     * Run all systems, wait until they finish.
+     *
+     * Calling thread runs chunks too, so Run can be called from actor.
+     */
+    void Run();
+
+    size_t Stages() const;
+
+    commands_t& Commands();
+
+    /**
+     * @param chunkSize items in one chunk of work
+     */
+    explicit scheduler_t(size_t chunkSize);
+    ~scheduler_t();
+
+    scheduler_t(const scheduler_t&) = delete;
+    scheduler_t& operator=(const scheduler_t&) = delete;
+  };
+
+  inline size_t scheduler_t::Stages() const
+  {
+    return this->stages.size();
+  }
+
+  inline commands_t& scheduler_t::Commands()
+  {
+    return this->commands;
+  }
+
+} // namespace sr
+
+#endif /* STARRG_SYSTEMS_HEADER */
@@ -0,0 +1,171 @@
+/**
+ * @file unitGrid.hpp
+ *
+ * Units on map
+ *
+ * Map is bounded, so each cell has own list of units. Lists are
+ * intrusive: links are kept in array indexed by entity ID, cell stores
+ * only first unit. Placing and removing unit is O(1), queries walk only
+ * cells they touch.
+ *
+ */
+
+#pragma once
+#ifndef STARRG_UNIT_GRID_HEADER
+#define STARRG_UNIT_GRID_HEADER
+
+#include <ecs.hpp>
+
+#include <glm/vec2.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace sr
+{
+
+  class unitGrid_t final
+  {
+    struct link_t
+    {
+      entityID_t prev;
+      entityID_t next;
+      int32_t cell; // -1, when unit is not on grid
+    };
+
+    glm::ivec2 size;
+    std::vector<entityID_t> cells; // first unit in cell or -1
+    std::vector<link_t> links;     // indexed by entity ID
+
+    int32_t CellIndex(glm::ivec2 pos) const;
+    void Unlink(entityID_t id);
+
+  public:
+
+    /**
+     * Remove all units and set grid size.
+     */
+    void Reset(glm::ivec2 size);
+
+    glm::ivec2 Size() const;
+
+    bool Inside(glm::ivec2 pos) const;
+
+    /**
+     * Put unit in cell, or move it there, if it is already on grid.
+     */
+    void Place(entityID_t id, glm::ivec2 pos);
+
+    /**
+     * Must be called, when placed entity is released.
+     */
+    void Remove(entityID_t id);
+
+    bool Has(entityID_t id) const;
+
+    /**
+     * First unit in cell or -1.
+     */
+    entityID_t First(glm::ivec2 pos) const;
+
+    /**
+     * Next unit in same cell or -1.
+     */
+    entityID_t Next(entityID_t id) const;
+
+    /**
+     * Call func(entityID_t, glm::ivec2 cell) for units in cell.
+     *
+     * Grid must not be changed from func.
+     */
+    template<typename func_t>
+    void EachAt(glm::ivec2 pos, func_t func) const
+    {
+      for (auto id = this->First(pos); id >= 0; id = this->Next(id))
+      {
+        func(id, pos);
+      }
+    }
+
+    /**
+     * Call func(entityID_t, glm::ivec2 cell) for units in rectangle with
+     * corners from and to (inclusive), clamped to grid.
+     */
+    template<typename func_t>
+    void EachInRect(glm::ivec2 from, glm::ivec2 to, func_t func) const
+    {
+      auto lo = glm::ivec2(std::max(std::min(from.x, to.x), 0), std::max(std::min(from.y, to.y), 0));
+      auto hi = glm::ivec2(std::min(std::max(from.x, to.x), this->size.x - 1), std::min(std::max(from.y, to.y), this->size.y - 1));
+
+      for (auto y = lo.y; y <= hi.y; ++y)
+      {
+        for (auto x = lo.x; x <= hi.x; ++x)
+        {
+          for (auto id = this->cells[static_cast<size_t>(y * this->size.x + x)]; id >= 0; id = this->links[static_cast<size_t>(id)].next)
+          {
+            func(id, glm::ivec2(x, y));
+          }
+        }
+      }
+    }
+
+    /**
+     * Call func(entityID_t, glm::ivec2 cell) for units in cells, which
+     * are not farther than radius from center.
+     */
+    template<typename func_t>
+    void EachInRadius(glm::ivec2 center, int radius, func_t func) const
+    {
+      auto radius2 = radius * radius;
+      this->EachInRect(center - radius, center + radius,
+        [&func, center, radius2](entityID_t id, glm::ivec2 cell)
+        {
+          auto delta = cell - center;
+          if (delta.x * delta.x + delta.y * delta.y <= radius2)
+          {
+            func(id, cell);
+          }
+        }
+      );
+    }
+
+    unitGrid_t();
+  };
+
+  inline glm::ivec2 unitGrid_t::Size() const
+  {
+    return this->size;
+  }
+
+  inline bool unitGrid_t::Inside(glm::ivec2 pos) const
+  {
+    return (pos.x >= 0) && (pos.y >= 0) && (pos.x < this->size.x) && (pos.y < this->size.y);
+  }
+
+  inline int32_t unitGrid_t::CellIndex(glm::ivec2 pos) const
+  {
+    return this->Inside(pos)?(pos.y * this->size.x + pos.x):(-1);
+  }
+
+  inline bool unitGrid_t::Has(entityID_t id) const
+  {
+    return (id >= 0)
+      && (static_cast<size_t>(id) < this->links.size())
+      && (this->links[static_cast<size_t>(id)].cell >= 0);
+  }
+
+  inline entityID_t unitGrid_t::First(glm::ivec2 pos) const
+  {
+    auto cell = this->CellIndex(pos);
+    return (cell >= 0)?(this->cells[static_cast<size_t>(cell)]):(-1);
+  }
+
+  inline entityID_t unitGrid_t::Next(entityID_t id) const
+  {
+    return this->links[static_cast<size_t>(id)].next;
+  }
+
+} // namespace sr
+
+#endif /* STARRG_UNIT_GRID_HEADER */
@@ -27,13 +27,61 @@ public:
   meshData_t& operator=(meshData_t&&) = default;
 };
 
+/**
+ * Map is split in square chunks, visibility changes are tracked
+ * and sent to renderer chunk by chunk.
+ */
+const int chunkSize = 16;
+
+/**
+ * Player sees cells not farther than this.
+ */
+const int fovRadius = 10;
+
+/**
+ * Cell brightness stored in fog texture.
+ */
+enum fogLevel_t: uint8_t
+{
+  FOG_HIDDEN = 0,
+  FOG_SHADOW = 77,  // 0.3
+  FOG_VISIBLE = 153 // 0.6
+};
+
+/**
+ * Rectangle of fog cells to upload into fog texture.
+ */
+struct fogChunk_t
+{
+  glm::ivec2 origin;
+  glm::ivec2 size;
+  std::vector<uint8_t> cells;
+};
+
+using fogData_t = bb::msg::dataMsg_t<fogChunk_t>;
+
+/**
+ * World resources, which turn systems access besides components.
+ */
+struct mapTiles_t;
+struct mapUnits_t;
+
 class world_t: public bb::role_t
 {
   glm::ivec2 mapSize;
+  glm::ivec2 chunkCount;
   std::vector<cell_t> tiles;
+  std::vector<uint8_t> fog;
+  std::vector<glm::ivec2> visibleCells;
+  std::vector<glm::ivec2> lastVisibleCells;
+  std::vector<bool> chunkDirty;
+  std::vector<size_t> dirtyChunks;
   std::deque<unit_t> units;
-  std::unordered_multimap<glm::ivec2, unit_t, ivecKey_t, ivecKey_t> unitsOnMap;
+  sr::unitGrid_t unitsOnMap;
   uint32_t timePassed;
+  uint32_t aiTime;
+  uint32_t aiSeed;
+  sr::scheduler_t turn;
 
   cell_t& Tiles(glm::ivec2 v)
   {
@@ -45,9 +93,20 @@ class world_t: public bb::role_t
     return this->tiles[static_cast<size_t>(v.y * mapSize.x + v.x)];
   }
 
-  void UpdateMapUnits();
+  uint8_t& Fog(glm::ivec2 v)
+  {
+    return this->fog[static_cast<size_t>(v.y * mapSize.x + v.x)];
+  }
+
+  unit_t LivingUnitAt(glm::ivec2 pos) const;
   void GenerateMap();
 
+  void Reveal(glm::ivec2 pos);
+  void UpdateFog(glm::ivec2 pos);
+  void MarkDirty(glm::ivec2 pos);
+  void MarkAllDirty();
+  void PostDirtyChunks();
+
   void CastLight(
     glm::ivec2 pos,
     int radius,
@@ -61,10 +120,12 @@ class world_t: public bb::role_t
   );
 
   void UpdateFOV(glm::ivec2 pos, int radius);
+  void UpdateVisibility();
   bb::meshDesc_t BuildTileMap();
   bb::meshDesc_t BuildUnits();
 
-  void ProcessAI();
+  void ProcessAI(size_t begin, size_t end, sr::commands_t& commands);
+  void SetupTurn();
 
   bb::msg::result_t OnProcessMessage(const bb::actor_t&, const bb::msg::basic_t& msg) override;
 
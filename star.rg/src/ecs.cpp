@@ -1,6 +1,9 @@
-#include<ecs.hpp>
+#include <ecs.hpp>
 #include <components.hpp>
 
+#include <algorithm>
+#include <cassert>
+
 namespace sr
 {
 
@@ -22,7 +25,6 @@ namespace sr
 
   bool entityFactory_t::Valid(entityID_t entityID) const
   {
-    std::unique_lock<std::mutex> lock(this->mutex);
     if (entityID < 0)
     {
       return false;
@@ -36,15 +38,14 @@ namespace sr
 
   entityID_t entityFactory_t::GetNew()
   {
-    std::unique_lock<std::mutex> lock(this->mutex);
     if (this->released.empty())
     {
       this->entity.push_back(true);
       return static_cast<entityID_t>(this->entity.size()-1);
     }
 
-    auto resultID = this->released.front();
-    this->released.pop_front();
+    auto resultID = this->released.back();
+    this->released.pop_back();
 
     this->entity[resultID] = true;
     return resultID;
@@ -52,13 +53,7 @@ namespace sr
 
   void entityFactory_t::Release(entityID_t id)
   {
-    std::unique_lock<std::mutex> lock(this->mutex);
-    this->ReleaseNoLock(id);
-  }
-
-  void entityFactory_t::ReleaseNoLock(entityID_t id)
-  {
-    if ((id < 0) || (this->entity.size() < static_cast<size_t>(id)))
+    if (!this->Valid(id))
     {
       assert(0);
       throw std::runtime_error("Try to release invalid ID");
@@ -73,35 +68,41 @@ namespace sr
     this->released.push_back(id);
   }
 
+  size_t entityFactory_t::Size() const
+  {
+    return this->entity.size() - this->released.size();
+  }
+
   void entityFactory_t::Clear()
   {
-    std::unique_lock<std::mutex> lock(this->mutex);
     entityID_t index = 0;
     for (auto it = this->entity.begin(), e = this->entity.end(); it != e; ++it, ++index)
     {
       if (*it)
       {
-        this->ReleaseNoLock(index);
+        for (auto factory: this->factories)
+        {
+          factory->OnEntityDelete(index);
+        }
       }
     }
+
+    // nothing is alive, so IDs start from zero again
+    this->entity.clear();
+    this->released.clear();
   }
 
   void entityFactory_t::RegisterFactory(basicComponentFactory_t* factory)
   {
-    std::unique_lock<std::mutex> lock(this->mutex);
     this->factories.push_back(factory);
   }
 
   void entityFactory_t::RemoveFactory(basicComponentFactory_t* factory)
   {
-    std::unique_lock<std::mutex> lock(this->mutex);
-    for (auto it = this->factories.begin(), e = this->factories.end(); it != e; ++it)
+    auto it = std::find(this->factories.begin(), this->factories.end(), factory);
+    if (it != this->factories.end())
     {
-      if (factory == *it)
-      {
-        this->factories.erase(it);
-        return;
-      }
+      this->factories.erase(it);
     }
   }
 
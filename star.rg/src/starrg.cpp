@@ -21,6 +21,9 @@ std::mt19937& RandomEngine()
 
 const size_t maxLines = 44;
 
+// geometry bytes uploaded per frame
+const size_t uploadBudget = 1024*1024;
+
 void starrg_t::Update(double dt)
 {
   bb::msg_t msg;
@@ -31,19 +34,29 @@ void starrg_t::Update(double dt)
       switch(tileDesc->type)
       {
         case meshData_t::M_MAP:
-          this->map = bb::GenerateMesh(
-            tileDesc->Data()
-          );
+          this->uploads.Push(&this->map, std::move(tileDesc->Data()));
           break;
         case meshData_t::M_UNIT:
-          this->unit = bb::GenerateMesh(
-            tileDesc->Data()
-          );
+          this->uploads.Push(&this->unit, std::move(tileDesc->Data()));
           this->time = 0.5;
           break;
       }
       continue;
     }
+    if (auto fogChunk = bb::As<fogData_t>(msg))
+    {
+      auto& chunk = fogChunk->Data();
+      this->fog.Update(
+        chunk.origin.x,
+        chunk.origin.y,
+        chunk.size.x,
+        chunk.size.y,
+        GL_RED,
+        GL_UNSIGNED_BYTE,
+        chunk.cells.data()
+      );
+      continue;
+    }
     if (auto log = bb::As<bb::msg::dataMsg_t<std::string>>(msg))
     {
       logLines.emplace_back(std::move(log->Data()));
@@ -76,11 +89,14 @@ void starrg_t::Update(double dt)
     assert(0);
   }
 
+  this->uploads.Flush();
+
   if (!this->logText.empty())
   {
     this->log.Update("%s", this->logText.c_str());
   }
   this->text.Update("%5.1f", 1.0/dt);
+  this->overlay.Update(dt);
   if (this->time > 0.0)
   {
     this->time -= dt;
@@ -108,21 +124,33 @@ void starrg_t::Render()
   );
 
   bb::texture_t::Bind(tileset);
+  bb::texture_t::Bind(fog, 1);
+  this->mapShader.SetTexture("fog", 1);
   if (this->map.Good())
   {
+    BB_GPU_SCOPE("map");
     this->mapShader.SetFloat(
       "minAlpha",
       1.0f
     );
+    this->mapShader.SetFloat(
+      "useFog",
+      1.0f
+    );
     this->map.Render();
   }
 
   if (this->unit.Good())
   {
+    BB_GPU_SCOPE("units");
     this->mapShader.SetFloat(
       "minAlpha",
       0.0f
     );
+    this->mapShader.SetFloat(
+      "useFog",
+      0.0f
+    );
     this->unit.Render();
   }
 
@@ -144,6 +172,8 @@ void starrg_t::Render()
   {
     this->log.Render();
   }
+
+  this->overlay.Render();
   bb::framebuffer_t::RenderToScreen();
 }
 
@@ -158,10 +188,15 @@ starrg_t::starrg_t(bb::context_t& context)
   mapShader(bb::shader_t::LoadProgramFromFiles("starrg.vp.glsl", "starrg.fp.glsl")),
   fontShader(bb::shader_t::LoadProgramFromFiles("font.vp.glsl", "font.fp.glsl")),
   tileset(bb::texture_t::LoadConfig("tiles.config")),
+  overlay(context.AspectRatio()),
+  uploads(uploadBudget),
   box(bb::postOffice_t::Instance().New("StarView"))
 {
   auto len = static_cast<int>(context.Height()/tileSize.y);
 
+  std::vector<uint8_t> hidden(static_cast<size_t>(len * len), FOG_HIDDEN);
+  this->fog = bb::texture_t(len, len, hidden.data());
+
   this->world = bb::workerPool_t::Instance().Register<world_t>(glm::ivec2(len));
   this->context.RegisterActorCallback(
     this->world,
@@ -0,0 +1,256 @@
+#include <systems.hpp>
+#include <worker.hpp>
+#include <role.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace sr
+{
+
+  namespace
+  {
+
+    struct chunk_t
+    {
+      const system_t* system;
+      size_t begin;
+      size_t end;
+    };
+
+    /**
+     * Chunks of one stage, taken one by one by all participating threads.
+     */
+    struct job_t
+    {
+      std::vector<chunk_t> chunks;
+      std::atomic<size_t> next;
+      std::atomic<size_t> done;
+      commands_t* commands;
+      std::mutex errorGuard;
+      std::exception_ptr error;  /**< first failure, rethrown by RunStage */
+
+      void Work()
+      {
+        for (;;)
+        {
+          auto id = this->next.fetch_add(1);
+          if (id >= this->chunks.size())
+          {
+            return;
+          }
+          auto& chunk = this->chunks[id];
+          try
+          {
+            chunk.system->run(chunk.begin, chunk.end, *this->commands);
+          }
+          catch (...)
+          { // failed chunk is done too, or RunStage waits forever
+            std::lock_guard<std::mutex> lock(this->errorGuard);
+            if (!this->error)
+            {
+              this->error = std::current_exception();
+            }
+          }
+          this->done.fetch_add(1);
+        }
+      }
+
+      job_t()
+      : next(0),
+        done(0),
+        commands(nullptr)
+      {
+        ;
+      }
+    };
+
+    bool Conflict(const system_t& a, const system_t& b)
+    {
+      return ((a.writes & (b.reads | b.writes)) != 0)
+        || ((b.writes & a.reads) != 0);
+    }
+
+  } // namespace
+
+  accessMask_t NewAccessBit()
+  {
+    static std::atomic<uint32_t> counter(0);
+    auto id = counter.fetch_add(1);
+    if (id >= 64)
+    {
+      assert(0);
+      throw std::runtime_error("Too many resource types");
+    }
+    return accessMask_t(1) << id;
+  }
+
+  void commands_t::Spawn(change_t&& spawn)
+  {
+    std::lock_guard<std::mutex> lock(this->guard);
+    this->queue.emplace_back(command_t{ -1, std::move(spawn) });
+  }
+
+  void commands_t::Despawn(entityID_t id)
+  {
+    std::lock_guard<std::mutex> lock(this->guard);
+    this->queue.emplace_back(command_t{ id, change_t() });
+  }
+
+  void commands_t::Change(entityID_t id, change_t&& change)
+  {
+    assert(change);
+    std::lock_guard<std::mutex> lock(this->guard);
+    this->queue.emplace_back(command_t{ id, std::move(change) });
+  }
+
+  size_t commands_t::Apply()
+  {
+    std::vector<command_t> applied;
+    {
+      std::lock_guard<std::mutex> lock(this->guard);
+      applied.swap(this->queue);
+    }
+
+    auto& entities = entityFactory_t::Instance();
+    for (auto& command: applied)
+    {
+      if (command.id < 0)
+      {
+        command.change(entities.GetNew());
+        continue;
+      }
+
+      if (!entities.Valid(command.id))
+      { // entity could be despawned twice in one stage
+        continue;
+      }
+
+      if (command.change)
+      {
+        command.change(command.id);
+      }
+      else
+      {
+        entities.Release(command.id);
+      }
+    }
+    return applied.size();
+  }
+
+  void scheduler_t::Add(system_t&& system)
+  {
+    size_t stage = 0;
+    for (size_t id = 0; id < this->systems.size(); ++id)
+    {
+      if (Conflict(this->systems[id], system))
+      {
+        for (size_t prev = stage; prev < this->stages.size(); ++prev)
+        {
+          auto& prevStage = this->stages[prev];
+          if (std::find(prevStage.begin(), prevStage.end(), id) != prevStage.end())
+          {
+            stage = prev + 1;
+          }
+        }
+      }
+    }
+
+    if (stage == this->stages.size())
+    {
+      this->stages.emplace_back();
+    }
+    this->stages[stage].push_back(this->systems.size());
+    this->systems.emplace_back(std::move(system));
+  }
+
+  void scheduler_t::RunStage(const std::vector<size_t>& stage)
+  {
+    auto job = std::make_shared<job_t>();
+    job->commands = &this->commands;
+
+    for (auto id: stage)
+    {
+      auto& system = this->systems[id];
+      size_t items = (system.prepare)?(system.prepare()):(1);
+      for (size_t begin = 0; begin < items; begin += this->chunkSize)
+      {
+        job->chunks.push_back(chunk_t{ &system, begin, std::min(begin + this->chunkSize, items) });
+      }
+    }
+
+    if (job->chunks.empty())
+    {
+      return;
+    }
+
+    // helpers, which come late, find no work and finish at once
+    auto& pool = bb::workerPool_t::Instance();
+    auto helperCount = std::min(this->helpers.size(), job->chunks.size() - 1);
+    for (size_t i = 0; i < helperCount; ++i)
+    {
+      auto task = [job]()
+      {
+        job->Work();
+        return bb::msg::result_t::complete;
+      };
+
+      pool.PostMessage(
+        this->helpers[i],
+        bb::msg_t(new bb::msg::execTask_t<decltype(task)>(task))
+      );
+    }
+
+    job->Work();
+
+    // all chunks are taken, only running ones are left
+    while (job->done.load() != job->chunks.size())
+    {
+      std::this_thread::yield();
+    }
+
+    if (job->error)
+    { // helpers never throw, failure is reported on calling thread
+      std::rethrow_exception(job->error);
+    }
+  }
+
+  void scheduler_t::Run()
+  {
+    for (auto& stage: this->stages)
+    {
+      this->RunStage(stage);
+      this->commands.Apply();
+    }
+  }
+
+  scheduler_t::scheduler_t(size_t chunkSize)
+  : chunkSize(std::max<size_t>(chunkSize, 1))
+  {
+    // calling thread is busy with chunks too
+    auto helperCount = std::max<size_t>(std::thread::hardware_concurrency(), 2) - 1;
+
+    auto& pool = bb::workerPool_t::Instance();
+    this->helpers.reserve(helperCount);
+    for (size_t i = 0; i < helperCount; ++i)
+    {
+      this->helpers.emplace_back(pool.Register<bb::execTask_t>());
+    }
+  }
+
+  scheduler_t::~scheduler_t()
+  {
+    auto& pool = bb::workerPool_t::Instance();
+    for (auto helper: this->helpers)
+    {
+      pool.Unregister(helper);
+    }
+  }
+
+} // namespace sr
@@ -0,0 +1,94 @@
+#include <unitGrid.hpp>
+
+#include <cassert>
+#include <stdexcept>
+
+namespace sr
+{
+
+  unitGrid_t::unitGrid_t()
+  : size(0)
+  {
+    ;
+  }
+
+  void unitGrid_t::Reset(glm::ivec2 size)
+  {
+    if ((size.x < 0) || (size.y < 0))
+    {
+      assert(0);
+      throw std::runtime_error("Invalid grid size");
+    }
+
+    this->size = size;
+    this->cells.assign(static_cast<size_t>(size.x * size.y), -1);
+    this->links.clear();
+  }
+
+  void unitGrid_t::Unlink(entityID_t id)
+  {
+    auto& link = this->links[static_cast<size_t>(id)];
+    if (link.prev >= 0)
+    {
+      this->links[static_cast<size_t>(link.prev)].next = link.next;
+    }
+    else
+    {
+      this->cells[static_cast<size_t>(link.cell)] = link.next;
+    }
+
+    if (link.next >= 0)
+    {
+      this->links[static_cast<size_t>(link.next)].prev = link.prev;
+    }
+
+    link.prev = -1;
+    link.next = -1;
+    link.cell = -1;
+  }
+
+  void unitGrid_t::Place(entityID_t id, glm::ivec2 pos)
+  {
+    auto cell = this->CellIndex(pos);
+    if ((id < 0) || (cell < 0))
+    {
+      assert(0);
+      throw std::runtime_error("Unit is out of grid");
+    }
+
+    if (static_cast<size_t>(id) >= this->links.size())
+    {
+      this->links.resize(static_cast<size_t>(id) + 1, link_t{ -1, -1, -1 });
+    }
+
+    auto& link = this->links[static_cast<size_t>(id)];
+    if (link.cell == cell)
+    {
+      return;
+    }
+
+    if (link.cell >= 0)
+    {
+      this->Unlink(id);
+    }
+
+    auto& first = this->cells[static_cast<size_t>(cell)];
+    link.prev = -1;
+    link.next = first;
+    link.cell = cell;
+    if (first >= 0)
+    {
+      this->links[static_cast<size_t>(first)].prev = id;
+    }
+    first = id;
+  }
+
+  void unitGrid_t::Remove(entityID_t id)
+  {
+    if (this->Has(id))
+    {
+      this->Unlink(id);
+    }
+  }
+
+} // namespace sr
@@ -12,23 +12,16 @@
 
 #include <sstream>
 
-void world_t::UpdateMapUnits()
+unit_t world_t::LivingUnitAt(glm::ivec2 pos) const
 {
-  this->unitsOnMap.clear();
-  for (auto it = this->units.begin(), e = this->units.end(); it != e; ++it)
+  for (auto unit = this->unitsOnMap.First(pos); unit >= 0; unit = this->unitsOnMap.Next(unit))
   {
-    std::unordered_multimap<glm::ivec2, unit_t, ivecKey_t, ivecKey_t> newMapUnits;
-    sr::pos_t::factory_t::Instance().Each(
-      [&newMapUnits](sr::pos_t& pos)
-      {
-        newMapUnits.emplace(
-          pos.Data().v,
-          pos.ID()
-        );
-      }
-    );
-    this->unitsOnMap = std::move(newMapUnits);
+    if (sr::status_t::factory_t::Instance().Item(unit).status != sr::US_DEAD)
+    {
+      return unit;
+    }
   }
+  return -1;
 }
 
 const sr::spriteData_t pikeManSprite = { {26, 0} };
@@ -75,6 +68,15 @@ void world_t::GenerateMap()
     cell_t{T_EMPTY, false, false}
   );
 
+  this->chunkCount = (this->mapSize + chunkSize - 1) / chunkSize;
+  this->fog.assign(this->tiles.size(), FOG_HIDDEN);
+  this->visibleCells.clear();
+  this->lastVisibleCells.clear();
+  this->chunkDirty.assign(static_cast<size_t>(this->chunkCount.x * this->chunkCount.y), false);
+  this->dirtyChunks.clear();
+  this->MarkAllDirty();
+  this->unitsOnMap.Reset(this->mapSize);
+
   std::discrete_distribution<int> dist{
     15, // T_EMPTY
     5,  // T_GRASS
@@ -174,6 +176,7 @@ void world_t::GenerateMap()
   );
 
   this->units.emplace_back(playerEntity);
+  this->unitsOnMap.Place(playerEntity, plPos);
 
   for (int i = 0; i < 10; ++i)
   {
@@ -229,7 +232,7 @@ void world_t::GenerateMap()
     );
 
     this->units.emplace_back(orkEntity);
-    this->UpdateMapUnits();
+    this->unitsOnMap.Place(orkEntity, pos);
   }
 
   this->timePassed = 0.0;
@@ -295,7 +298,7 @@ void world_t::CastLight(
             )
           );
         }
-        this->Tiles(glm::ivec2{ax, ay}).visible = true;
+        this->Reveal(glm::ivec2{ax, ay});
       }
 
       if (blocked)
@@ -348,6 +351,128 @@ void world_t::UpdateFOV(glm::ivec2 pos, int radius)
   }
 }
 
+void world_t::Reveal(glm::ivec2 pos)
+{
+  auto& cell = this->Tiles(pos);
+  if (!cell.visible)
+  {
+    cell.visible = true;
+    this->visibleCells.push_back(pos);
+  }
+  cell.shadow = false;
+}
+
+void world_t::MarkDirty(glm::ivec2 pos)
+{
+  auto chunk = pos / chunkSize;
+  auto index = static_cast<size_t>(chunk.y * this->chunkCount.x + chunk.x);
+  if (!this->chunkDirty[index])
+  {
+    this->chunkDirty[index] = true;
+    this->dirtyChunks.push_back(index);
+  }
+}
+
+void world_t::MarkAllDirty()
+{
+  for (auto y = 0; y < this->chunkCount.y; ++y)
+  {
+    for (auto x = 0; x < this->chunkCount.x; ++x)
+    {
+      this->MarkDirty(glm::ivec2{x, y} * chunkSize);
+    }
+  }
+}
+
+void world_t::UpdateFog(glm::ivec2 pos)
+{
+  const auto& cell = this->Tiles(pos);
+
+  uint8_t level = FOG_HIDDEN;
+  if (cell.visible)
+  {
+    level = FOG_VISIBLE;
+  }
+  else if (cell.shadow)
+  {
+    level = FOG_SHADOW;
+  }
+
+  auto& fogCell = this->Fog(pos);
+  if (fogCell != level)
+  {
+    fogCell = level;
+    this->MarkDirty(pos);
+  }
+}
+
+void world_t::UpdateVisibility()
+{
+  glm::ivec2 playerPos(0);
+
+  if (!this->units.empty())
+  {
+    playerPos = sr::pos_t::factory_t::Instance().Item(this->units[0]).v;
+  }
+
+  // Only cells lit on previous turn can change, so whole map is never scanned
+  std::swap(this->lastVisibleCells, this->visibleCells);
+  this->visibleCells.clear();
+
+  for (auto v: this->lastVisibleCells)
+  {
+    auto& cell = this->Tiles(v);
+    cell.visible = false;
+    cell.shadow = true;
+  }
+
+  this->Reveal(playerPos);
+  this->UpdateFOV(playerPos, fovRadius);
+
+  for (auto v: this->lastVisibleCells)
+  {
+    this->UpdateFog(v);
+  }
+
+  for (auto v: this->visibleCells)
+  {
+    this->UpdateFog(v);
+  }
+}
+
+void world_t::PostDirtyChunks()
+{
+  for (auto index: this->dirtyChunks)
+  {
+    this->chunkDirty[index] = false;
+
+    glm::ivec2 chunk{
+      static_cast<int>(index) % this->chunkCount.x,
+      static_cast<int>(index) / this->chunkCount.x
+    };
+
+    fogChunk_t data;
+    data.origin = chunk * chunkSize;
+    data.size = glm::min(glm::ivec2(chunkSize), this->mapSize - data.origin);
+    data.cells.reserve(static_cast<size_t>(data.size.x * data.size.y));
+
+    for (auto y = data.origin.y, ey = data.origin.y + data.size.y; y < ey; ++y)
+    {
+      auto row = this->fog.begin() + y * this->mapSize.x + data.origin.x;
+      data.cells.insert(data.cells.end(), row, row + data.size.x);
+    }
+
+    bb::postOffice_t::Instance().Post(
+      "StarView",
+      bb::Issue<fogData_t>(
+        std::move(data),
+        -1
+      )
+    );
+  }
+  this->dirtyChunks.clear();
+}
+
 struct quadData_t
 {
   glm::vec3 vPos[4];
@@ -471,22 +596,30 @@ bb::meshDesc_t world_t::BuildUnits()
     return bb::meshDesc_t();
   }
 
-  vec.pos.reserve(this->units.size() * 4);
-  vec.uv.reserve(this->units.size() * 4);
-  vec.col.reserve(this->units.size() * 4);
-  vec.shim.reserve(this->units.size() * 4);
-  vec.ind.reserve(this->units.size() * 6);
+  // Only units in player's field of view can be visible
+  std::vector<unit_t> nearUnits;
+  this->unitsOnMap.EachInRadius(
+    sr::pos_t::factory_t::Instance().Item(this->units[0]).v,
+    fovRadius,
+    [&nearUnits](unit_t unit, glm::ivec2)
+    {
+      nearUnits.push_back(unit);
+    }
+  );
+
+  vec.pos.reserve(nearUnits.size() * 4);
+  vec.uv.reserve(nearUnits.size() * 4);
+  vec.col.reserve(nearUnits.size() * 4);
+  vec.shim.reserve(nearUnits.size() * 4);
+  vec.ind.reserve(nearUnits.size() * 6);
 
   int indOffset = 0;
 
-  for (auto& unit : this->units)
+  for (auto unit : nearUnits)
   {
-    auto& unitPosComponent = sr::pos_t::factory_t::Instance().Item(unit);
-    auto& unitSpriteComponent = sr::sprite_t::factory_t::Instance().Item(unit);
-    auto& unitStatusComponent = sr::status_t::factory_t::Instance().Item(unit);
-
-    auto unitPos = unitPosComponent.Data().v;
-    auto& unitStatus = unitStatusComponent.Data();
+    auto unitPos = sr::pos_t::factory_t::Instance().Item(unit).v;
+    auto& unitSprite = sr::sprite_t::factory_t::Instance().Item(unit);
+    auto& unitStatus = sr::status_t::factory_t::Instance().Item(unit);
 
     auto info = this->Tiles(unitPos);
 
@@ -503,7 +636,7 @@ bb::meshDesc_t world_t::BuildUnits()
       continue;
     }
 
-    quadData_t q = CreateQuad(unitSpriteComponent.Data().id, pos, glm::vec3(1.0f), static_cast<uint16_t>(indOffset), false);
+    quadData_t q = CreateQuad(unitSprite.id, pos, glm::vec3(1.0f), static_cast<uint16_t>(indOffset), false);
     for (auto& v: q.vPos)
     {
       v.z = 1.0f;
@@ -592,9 +725,6 @@ bb::meshDesc_t world_t::BuildUnits()
 bb::meshDesc_t world_t::BuildTileMap()
 {
   triData_t vec;
-  bb::meshDesc_t result;
-
-  glm::ivec2 playerPos;
 
   if (mapSize.y * mapSize.x < 0)
   { // Invalid map dimensions!
@@ -602,11 +732,6 @@ bb::meshDesc_t world_t::BuildTileMap()
     return bb::meshDesc_t();
   }
 
-  if (!this->units.empty())
-  {
-    playerPos = sr::pos_t::factory_t::Instance().Item(this->units[0]).Data().v;
-  }
-
   vec.pos.reserve(static_cast<size_t>(mapSize.y * mapSize.x * 4));
   vec.uv.reserve(static_cast<size_t>(mapSize.y * mapSize.x * 4));
   vec.col.reserve(static_cast<size_t>(mapSize.y * mapSize.x * 4));
@@ -615,31 +740,14 @@ bb::meshDesc_t world_t::BuildTileMap()
 
   int indOffset = 0;
 
-  for (auto &cell : this->tiles)
-  {
-    cell.shadow = cell.visible || cell.shadow;
-    cell.visible = false;
-  }
-
-  this->Tiles(playerPos).visible = true;
-
-  this->UpdateFOV(playerPos, 10);
-  for (auto &cell : this->tiles)
-  {
-    cell.shadow = cell.shadow && (!cell.visible);
-  }
-
+  // Geometry does not depend on visibility, it is built once per map.
+  // Visibility and shadows are applied in shader from fog texture.
   for (auto y = 0; y < mapSize.y; ++y)
   {
     for (auto x = 0; x < mapSize.x; ++x)
     {
       auto &cell = this->Tiles(glm::ivec2{x, y});
-      if ((cell.visible == false) && (cell.shadow == false))
-      {
-        continue;
-      }
 
-      auto color = cell.shadow ? glm::vec3(0.3f) : glm::vec3(0.6f);
       auto tile = tileID[cell.tile];
       glm::vec2 pos = {x * tileSize.x, y * tileSize.y};
 
@@ -649,7 +757,7 @@ bb::meshDesc_t world_t::BuildTileMap()
         continue;
       }
 
-      quadData_t q = CreateQuad(tile.pos, pos, color, static_cast<uint16_t>(indOffset), tile.flip);
+      quadData_t q = CreateQuad(tile.pos, pos, glm::vec3(1.0f), static_cast<uint16_t>(indOffset), tile.flip);
 
       vec.Add(q);
       indOffset += 4;
@@ -659,54 +767,117 @@ bb::meshDesc_t world_t::BuildTileMap()
   return vec.Create();
 }
 
-void world_t::ProcessAI()
+void world_t::ProcessAI(size_t begin, size_t end, sr::commands_t& commands)
 {
   // Обработка ответа мира на действия игрока
-  auto &engine = RandomEngine();
+  // Chunks are run in parallel, each one has own engine
+  std::mt19937 engine(static_cast<uint32_t>(this->aiSeed + begin));
   std::uniform_int_distribution<int> modeSide(sr::SIDE_UP, sr::SIDE_UP_LEFT);
-  for (auto unit: this->units)
-  {
-    auto& unitStatus = sr::status_t::factory_t::Instance().Item(unit);
-    if (unitStatus->status == sr::US_DEAD)
+  auto timePassed = this->aiTime;
+  sr::EachInRange<sr::ai_t, sr::status_t, sr::update_t, sr::pos_t>(begin, end,
+    [this, &engine, &modeSide, &commands, timePassed](sr::entityID_t id, const sr::aiData_t& unitAI, const sr::statusData_t& unitStatus, sr::updateData_t& unitUpdate, sr::posData_t& unitPos)
     {
-      continue;
-    }
-
-    auto& unitUpdate = sr::update_t::factory_t::Instance().Item(unit);
-
-    unitUpdate->curTime += this->timePassed;
-    while (unitUpdate->curTime > unitUpdate->moveTime)
-    {
-      unitUpdate->curTime -= unitUpdate->moveTime;
-      auto* unitAI = sr::ai_t::factory_t::Instance().OptionalItem(unit);
-      if (unitAI == nullptr)
+      if (unitStatus.status == sr::US_DEAD)
       {
-        continue;
+        return;
       }
 
-      switch(unitAI->Data().ai)
+      auto from = unitPos.v;
+      unitUpdate.curTime += timePassed;
+      while (unitUpdate.curTime > unitUpdate.moveTime)
       {
-        case sr::AI_STALKER:
+        unitUpdate.curTime -= unitUpdate.moveTime;
+        switch(unitAI.ai)
         {
-          // Каждые два хода игрока, все орки двигаются в случайном направлении
-          auto& unitPos = sr::pos_t::factory_t::Instance().Item(unit);
-          auto side = (sr::unitSide_t) modeSide(engine);
-          if (this->CanWalk(unitPos->v, side))
+          case sr::AI_STALKER:
           {
-            unitPos->v += sr::iSideVec[side];
+            // Каждые два хода игрока, все орки двигаются в случайном направлении
+            auto side = (sr::unitSide_t) modeSide(engine);
+            if (this->CanWalk(unitPos.v, side))
+            {
+              unitPos.v += sr::iSideVec[side];
+            }
+            break;
           }
-          break;
+          case sr::AI_SCARED:
+            break;
+          case sr::AI_ANGRY:
+            break;
+          default:
+            assert(0);
         }
-        case sr::AI_SCARED:
-          break;
-        case sr::AI_ANGRY:
-          break;
-        default:
-          assert(0);
+      }
+
+      if (unitPos.v != from)
+      { // other chunks read unit map, so only moved units are placed after stage
+        auto to = unitPos.v;
+        commands.Change(id,
+          [this, to](sr::entityID_t moved)
+          {
+            this->unitsOnMap.Place(moved, to);
+          }
+        );
       }
     }
-  }
-  this->timePassed = 0;
+  );
+}
+
+void world_t::SetupTurn()
+{
+  this->turn.Add(
+    sr::system_t{
+      "ai",
+      sr::Access<sr::ai_t, sr::status_t, mapTiles_t, mapUnits_t>(),
+      sr::Access<sr::update_t, sr::pos_t>(),
+      [this]()
+      {
+        this->aiTime = this->timePassed;
+        this->aiSeed = static_cast<uint32_t>(RandomEngine()());
+        this->timePassed = 0;
+        return sr::ai_t::factory_t::Instance().Size();
+      },
+      [this](size_t begin, size_t end, sr::commands_t& commands)
+      {
+        this->ProcessAI(begin, end, commands);
+      }
+    }
+  );
+
+  // Units block light, so visibility waits for them
+  this->turn.Add(
+    sr::system_t{
+      "visibility",
+      sr::Access<sr::pos_t, mapUnits_t>(),
+      sr::Access<mapTiles_t>(),
+      nullptr,
+      [this](size_t, size_t, sr::commands_t&)
+      {
+        // Отправляем изменившиеся куски тумана
+        this->UpdateVisibility();
+        this->PostDirtyChunks();
+      }
+    }
+  );
+
+  this->turn.Add(
+    sr::system_t{
+      "unitMesh",
+      sr::Access<sr::pos_t, sr::sprite_t, mapTiles_t, mapUnits_t>(),
+      sr::Access<sr::status_t>(),
+      nullptr,
+      [this](size_t, size_t, sr::commands_t&)
+      {
+        // Отправляем новые положения и состояния юнитов
+        bb::postOffice_t::Instance().Post(
+          "StarView",
+          bb::Issue<meshData_t>(
+            this->BuildUnits(),
+            meshData_t::M_UNIT
+          )
+        );
+      }
+    }
+  );
 }
 
 bb::msg::result_t world_t::OnKeyPress(const bb::msg::keyEvent_t& key)
@@ -797,174 +968,159 @@ bb::msg::result_t world_t::OnProcessMessage(const bb::actor_t &, const bb::msg::
     uint32_t totalTimePassed = 0;
 
     sr::userInput_t::factory_t::Instance().Each(
-      [this,action,&totalTimePassed](sr::userInput_t& input)
+      [this,action,&totalTimePassed](sr::entityID_t id, sr::userInputData_t& input)
       {
         // обработка ввода игрока
         switch (action->Data().key)
         {
           case GLFW_KEY_KP_1:
-            input->side = sr::SIDE_DOWN_LEFT;
+            input.side = sr::SIDE_DOWN_LEFT;
             totalTimePassed += SQ2;
-            ++input->steps;
+            ++input.steps;
             break;
           case GLFW_KEY_KP_2:
-            input->side = sr::SIDE_DOWN;
+            input.side = sr::SIDE_DOWN;
             totalTimePassed += SQ1;
-            ++input->steps;
+            ++input.steps;
             break;
           case GLFW_KEY_KP_3:
-            input->side = sr::SIDE_DOWN_RIGHT;
+            input.side = sr::SIDE_DOWN_RIGHT;
             totalTimePassed += SQ2;
-            ++input->steps;
+            ++input.steps;
             break;
           case GLFW_KEY_KP_4:
-            input->side = sr::SIDE_LEFT;
+            input.side = sr::SIDE_LEFT;
             totalTimePassed += SQ1;
-            ++input->steps;
+            ++input.steps;
             break;
           case GLFW_KEY_KP_6:
-            input->side = sr::SIDE_RIGHT;
+            input.side = sr::SIDE_RIGHT;
             totalTimePassed += SQ1;
-            ++input->steps;
+            ++input.steps;
             break;
           case GLFW_KEY_KP_7:
-            input->side = sr::SIDE_UP_LEFT;
+            input.side = sr::SIDE_UP_LEFT;
             totalTimePassed += SQ2;
-            ++input->steps;
+            ++input.steps;
             break;
           case GLFW_KEY_KP_8:
-            input->side = sr::SIDE_UP;
+            input.side = sr::SIDE_UP;
             totalTimePassed += SQ1;
-            ++input->steps;
+            ++input.steps;
             break;
           case GLFW_KEY_KP_9:
-            input->side = sr::SIDE_UP_RIGHT;
+            input.side = sr::SIDE_UP_RIGHT;
             totalTimePassed += SQ2;
-            ++input->steps;
+            ++input.steps;
             break;
           default:
-            input->side = sr::SIDE_TOTAL;
+            input.side = sr::SIDE_TOTAL;
         }
 
-        if (input->side != sr::SIDE_TOTAL)
+        if (input.side != sr::SIDE_TOTAL)
         {
-          auto& playerPos = sr::pos_t::factory_t::Instance().Item(input.ID());
+          auto& playerPos = sr::pos_t::factory_t::Instance().Item(id);
 
           // Если можно сделать ход
-          if (this->CanWalk(playerPos->v, input->side))
+          if (this->CanWalk(playerPos.v, input.side))
           {
-            playerPos->v += sr::iSideVec[input->side];
+            playerPos.v += sr::iSideVec[input.side];
+            this->unitsOnMap.Place(id, playerPos.v);
 
-            auto tileInfo = this->TileInfo(playerPos->v);
+            auto tileInfo = this->TileInfo(playerPos.v);
             if (tileInfo.ladder)
             { // Специальная клетка - лестница
               this->GenerateMap();
-            }
-            else
-            { // Двигаем остальных и обновляем карту
-              this->ProcessAI();
-              this->UpdateMapUnits();
-            }
 
-            // Отправляем новую карту
-            bb::postOffice_t::Instance().Post(
-              "StarView",
-              bb::Issue<meshData_t>(
-                this->BuildTileMap(),
-                meshData_t::M_MAP
-              )
-            );
-
-            // Отправляем новых юнитов
-            bb::postOffice_t::Instance().Post(
-              "StarView",
-              bb::Issue<meshData_t>(
-                this->BuildUnits(),
-                meshData_t::M_UNIT
-              )
-            );
-            // Больше делать нечего - заканчиваем
+              // Отправляем новую карту
+              bb::postOffice_t::Instance().Post(
+                "StarView",
+                bb::Issue<meshData_t>(
+                  this->BuildTileMap(),
+                  meshData_t::M_MAP
+                )
+              );
+            }
+            // Остальных двигает ход
             return;
           }
 
           // Пройти не получилось, пробуем драться!
-          auto targetPos = playerPos->v + sr::iSideVec[input->side];
+          auto targetPos = playerPos.v + sr::iSideVec[input.side];
 
           // Если в клетке есть враг - пытаемся драться
-          auto target = this->unitsOnMap.find(targetPos);
-          if (target != this->unitsOnMap.end())
+          auto target = this->LivingUnitAt(targetPos);
+          if (target >= 0)
           {
             auto& playerStatus = sr::status_t::factory_t::Instance().Item(this->units[0]);
-            auto& targetStatus = sr::status_t::factory_t::Instance().Item(target->second);
-            if (targetStatus->status != sr::US_DEAD)
+            auto& targetStatus = sr::status_t::factory_t::Instance().Item(target);
+
+            std::stringstream logst;
+            auto &engine = RandomEngine();
+            std::uniform_int_distribution<int> dice(0, 100);
+
+            auto& playerMelee = sr::melee_t::factory_t::Instance().Item(this->units[0]);
+            auto& targetMelee = sr::melee_t::factory_t::Instance().Item(target);
+            targetStatus.side = sr::sideVec[input.side];
+
+            logst << "[" << input.steps << "]" << "Конан бьёт! ";
+
+            // Как хорошо попадаем
+            int hitRoll = dice(engine);
+            if (hitRoll <= playerMelee.skill)
             {
-              std::stringstream logst;
-              auto &engine = RandomEngine();
-              std::uniform_int_distribution<int> dice(0, 100);
-
-              auto& playerMelee = sr::melee_t::factory_t::Instance().Item(this->units[0]);
-              auto& targetMelee = sr::melee_t::factory_t::Instance().Item(target->second);
-              targetStatus->side = sr::sideVec[input->side];
-
-              logst << "[" << input->steps << "]" << "Конан бьёт! ";
-
-              // Как хорошо попадаем
-              int hitRoll = dice(engine);
-              if (hitRoll <= playerMelee->skill)
-              {
-                // Чтобы ранить - надо пробить броню своей силой
-                int woundDifficulty = 50; // Если равны - то вероятность 50/50
-
-                woundDifficulty += (playerMelee->stren > targetMelee->tough)*20; // Если сила выше, то +20%
-                woundDifficulty += (playerMelee->stren > targetMelee->tough*2)*20; // Если в два раза выше +40%
-                woundDifficulty -= (playerMelee->stren < targetMelee->tough)*20; // Если сила меньше, то -20%
-                woundDifficulty -= (playerMelee->stren*2 < targetMelee->tough)*20; // Если в два раза меньше -40%
-
-                int woundRoll = dice(engine);
-
-                if (woundRoll <= woundDifficulty)
-                { // Рана попала
-                  
-                  // Воин способен минимизировать вред от раны
-                  int armorSave = dice(engine);
-                  if (armorSave > targetMelee->armor)
-                  { // Не вышло!
-                    logst << "Убил!";
-                    targetStatus->status = sr::US_DEAD;
-                  }
-                  else
-                  { // Рана не прошла
-                    logst << "Не задел! (S" << armorSave << "<" << targetMelee->armor << ')';
-                    playerStatus->status = sr::US_SAVE;
-                    playerStatus->side = -sr::sideVec[input->side];
-                    targetStatus->status = sr::US_SAVE;
-                  }
+              // Чтобы ранить - надо пробить броню своей силой
+              int woundDifficulty = 50; // Если равны - то вероятность 50/50
+
+              woundDifficulty += (playerMelee.stren > targetMelee.tough)*20; // Если сила выше, то +20%
+              woundDifficulty += (playerMelee.stren > targetMelee.tough*2)*20; // Если в два раза выше +40%
+              woundDifficulty -= (playerMelee.stren < targetMelee.tough)*20; // Если сила меньше, то -20%
+              woundDifficulty -= (playerMelee.stren*2 < targetMelee.tough)*20; // Если в два раза меньше -40%
+
+              int woundRoll = dice(engine);
+
+              if (woundRoll <= woundDifficulty)
+              { // Рана попала
+                
+                // Воин способен минимизировать вред от раны
+                int armorSave = dice(engine);
+                if (armorSave > targetMelee.armor)
+                { // Не вышло!
+                  logst << "Убил!";
+                  targetStatus.status = sr::US_DEAD;
                 }
                 else
-                { // Спасла броня
-                  logst << "Мечь отскочил от брони! (W" << woundRoll << ">" << woundDifficulty << ')';
-                  playerStatus->status = sr::US_MISS;
-                  playerStatus->side = -sr::sideVec[input->side];
-                  targetStatus->status = sr::US_ARMOR;
+                { // Рана не прошла
+                  logst << "Не задел! (S" << armorSave << "<" << targetMelee.armor << ')';
+                  playerStatus.status = sr::US_SAVE;
+                  playerStatus.side = -sr::sideVec[input.side];
+                  targetStatus.status = sr::US_SAVE;
                 }
               }
               else
-              { // Вообще не попал
-                logst << "Промазал! (H" << hitRoll << ">" << playerMelee->skill << ')';
-                playerStatus->status = sr::US_MISS;
-                playerStatus->side = -sr::sideVec[input->side];
-                targetStatus->status = sr::US_MISS;
+              { // Спасла броня
+                logst << "Мечь отскочил от брони! (W" << woundRoll << ">" << woundDifficulty << ')';
+                playerStatus.status = sr::US_MISS;
+                playerStatus.side = -sr::sideVec[input.side];
+                targetStatus.status = sr::US_ARMOR;
               }
-
-              // Отправка сообщения в лог
-              bb::postOffice_t::Instance().Post(
-                "StarView",
-                bb::Issue<bb::msg::dataMsg_t<std::string>>(
-                  logst.str(),
-                  -1
-                )
-              );
             }
+            else
+            { // Вообще не попал
+              logst << "Промазал! (H" << hitRoll << ">" << playerMelee.skill << ')';
+              playerStatus.status = sr::US_MISS;
+              playerStatus.side = -sr::sideVec[input.side];
+              targetStatus.status = sr::US_MISS;
+            }
+
+            // Отправка сообщения в лог
+            bb::postOffice_t::Instance().Post(
+              "StarView",
+              bb::Issue<bb::msg::dataMsg_t<std::string>>(
+                logst.str(),
+                -1
+              )
+            );
           }
         }
       }
@@ -972,18 +1128,8 @@ bb::msg::result_t world_t::OnProcessMessage(const bb::actor_t &, const bb::msg::
 
     this->timePassed += totalTimePassed;
 
-    // Двигаем кого можем и обновляем карту
-    this->ProcessAI();
-    this->UpdateMapUnits();
-
-    // Отправляем новые положения и состояния юнитов
-    bb::postOffice_t::Instance().Post(
-      "StarView",
-      bb::Issue<meshData_t>(
-        this->BuildUnits(),
-        meshData_t::M_UNIT
-      )
-    );
+    // Двигаем кого можем, обновляем карту и отправляем юнитов
+    this->turn.Run();
 
     return bb::msg::result_t::complete;
   }
@@ -1012,8 +1158,7 @@ bool world_t::CanStand(glm::ivec2 pos) const
   if ((pos.x < this->mapSize.x) && (pos.y < this->mapSize.y) && (pos.x >= 0) && (pos.y >= 0))
   {
     auto tile = tileID[this->Tiles(pos).tile];
-    auto unit = this->unitsOnMap.find(pos) ;
-    if ((unit == this->unitsOnMap.end()) ||  (sr::status_t::factory_t::Instance().Item(unit->second)->status == sr::US_DEAD))
+    if (this->LivingUnitAt(pos) < 0)
     {
       return tile.canWalk;
     }
@@ -1045,8 +1190,13 @@ bool world_t::CanWalk(glm::ivec2 pos, sr::unitSide_t side) const
 }
 
 world_t::world_t(glm::ivec2 mapSize)
-: mapSize(mapSize)
+: mapSize(mapSize),
+  timePassed(0),
+  aiTime(0),
+  aiSeed(0),
+  turn(256)
 {
+  this->SetupTurn();
   this->GenerateMap();
 
   bb::postOffice_t::Instance().Post(
@@ -1056,6 +1206,10 @@ world_t::world_t(glm::ivec2 mapSize)
       meshData_t::M_MAP
     )
   );
+
+  this->UpdateVisibility();
+  this->PostDirtyChunks();
+
   bb::postOffice_t::Instance().Post(
     "StarView",
     bb::Issue<meshData_t>(
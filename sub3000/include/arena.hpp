@@ -31,7 +31,7 @@ namespace sub3000
     radar::status_t radarStatus;
     bb::mesh_t radarStatusPlane;
 
-    bb::shader_t shader;
+    bb::shaderAsset_t shader;
     bb::camera_t camera;
 
     bb::mailbox_t::shared_t box;
@@ -40,8 +40,6 @@ namespace sub3000
     bb::sound_t::sample_t engine;
     bb::sound_t::sample_t button;
 
-    int configWatch;
-
     void OnPrepare() override;
     void OnUpdate(double delta) override;
     void OnRender() override;
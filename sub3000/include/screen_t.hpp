@@ -39,6 +39,7 @@ namespace sub3000
       bb::mesh_t radarLine;
       bb::mailbox_t::shared_t box;
       bb::actorPID_t spaceActorID;
+      bb::configAsset_t arenaConfig;
 
       bb::linePoints_t unitPoints;
       std::deque<float> unitLife;
@@ -59,6 +59,11 @@ namespace sub3000
 
     bb::msg::result_t OnProcessMessage(const bb::actor_t&, const bb::msg::basic_t& msg) override;
 
+    /**
+     * Apply ship parameters, which can be tuned while arena runs.
+     */
+    void Configure(const bb::config_t& config);
+
   public:
 
     void Step(double dt);
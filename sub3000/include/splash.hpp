@@ -11,6 +11,7 @@
 #include <string>
 
 #include <context.hpp>
+#include <assets.hpp>
 
 namespace sub3000
 {
@@ -22,10 +23,10 @@ namespace sub3000
     std::string shader_fp;
     std::string logo;
 
-    bb::shader_t  shader;
-    bb::vao_t     object;
-    bb::texture_t texture;
-    int           timePassedUniform;
+    bb::shaderAsset_t  shader;
+    bb::vao_t          object;
+    bb::textureAsset_t texture;
+    int                timePassedUniform;
 
     double currentTimePassed;
 
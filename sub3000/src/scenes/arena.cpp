@@ -4,7 +4,6 @@
 #include <shapes.hpp>
 #include <worker.hpp>
 #include <space.hpp>
-#include <monfs.hpp>
 #include <mapGen.hpp>
 
 #include <vector>
@@ -12,16 +11,6 @@
 namespace sub3000
 {
 
-  class monitorConfig_t: public bb::fs::processor_t
-  {
-  public:
-    int OnChange(const char*, bb::fs::event_t)
-    {
-      sub3000::PostChangeScene(sub3000::sceneID_t::arena);
-      return 0;
-    }
-  };
-
   glm::vec2 OffsetFromCenterOfScreen(glm::vec2 offset)
   {
     auto screenDim = bb::context_t::Instance().Dimensions();
@@ -119,22 +108,12 @@ namespace sub3000
       0.0f
     );
 
-    this->shader = bb::shader_t::LoadProgramFromFiles(
-      menuConfig.Value("arena.shader.vp", "desktop.vp.glsl").c_str(),
-      menuConfig.Value("arena.shader.fp", "desktop.fp.glsl").c_str()
+    this->shader = Assets().Shader(
+      menuConfig.Value("arena.shader.vp", "desktop.vp.glsl"),
+      menuConfig.Value("arena.shader.fp", "desktop.fp.glsl")
     );
 
     this->box = bb::postOffice_t::Instance().New("arenaBox");
-    this->configWatch = -1;
-
-    sub3000::PostToMain(
-      bb::Issue<sub3000::fs::watch_t>(
-        this->box->Address(),
-        "./arena.config",
-        std::unique_ptr<bb::fs::processor_t>(new monitorConfig_t)
-      )
-    );
-
   }
 
   void arenaScene_t::OnUpdate(double dt)
@@ -142,11 +121,6 @@ namespace sub3000
     bb::msg_t msg;
     while (this->box->Poll(&msg))
     {
-      if (auto status = bb::As<sub3000::fs::status_t>(msg))
-      {
-        this->configWatch = status->Status();
-      }
-
       if (auto sound = bb::As<bb::msg::dataMsg_t<sounds_t>>(msg))
       {
         switch (sound->Data())
@@ -179,11 +153,17 @@ namespace sub3000
     bb::framebuffer_t::Bind(bb::context_t::Instance().Canvas());
 
     glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
-    bb::shader_t::Bind(this->shader);
+    if (!this->shader->IsReady())
+    {
+      return;
+    }
+
+    auto& shader = this->shader->Get();
+    bb::shader_t::Bind(shader);
     camera.Update();
 
-    this->shader.SetBlock(
-      this->shader.UniformBlockIndex("camera"),
+    shader.SetBlock(
+      shader.UniformBlockIndex("camera"),
       this->camera.UniformBlock()
     );
 
@@ -199,13 +179,8 @@ namespace sub3000
     this->radarStatus.Cleanup();
     this->radarScreen.Cleanup();
 
-    if (this->configWatch != -1)
-    {
-      sub3000::PostToMain(
-        bb::Issue<sub3000::fs::rmWatch_t>(this->configWatch)
-      );
-    }
     this->box.reset();
+    this->shader.reset();
 
     bb::sound_t::Instance().Stop(
       this->button
@@ -219,8 +194,7 @@ namespace sub3000
   }
 
   arenaScene_t::arenaScene_t()
-  : scene_t(sceneID_t::arena, "Arena"),
-    configWatch(-1)
+  : scene_t(sceneID_t::arena, "Arena")
   {
 
   }
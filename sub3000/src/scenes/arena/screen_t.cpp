@@ -22,18 +22,15 @@ namespace sub3000
 
       this->warningText = screenConfig.Value("radar.warning", "warning").c_str();
 
-      FILE* input = fopen(screenConfig.Value("radar.mesh", "radar.msh").c_str(), "rb");
-      if (input == nullptr)
+      auto radarDesc = bb::meshDesc_t::Map(screenConfig.Value("radar.mesh", "radar.msh").c_str());
+      if (!radarDesc.IsGood())
       { // resource not found!
         assert(0);
       }
-      BB_DEFER(fclose(input));
 
       this->pointSize = static_cast<float>(screenConfig.Value("radar.pointSize", 0.2f));
 
-      this->radar = bb::GenerateMesh(
-        bb::meshDesc_t::Load(input)
-      );
+      this->radar = bb::GenerateMesh(radarDesc);
 
       this->radarCamera = bb::camera_t::Orthogonal(
         -1.0f, 1.0f, 1.0f, -1.0f
@@ -54,6 +51,10 @@ namespace sub3000
 
       this->spaceActorID = bb::workerPool_t::Instance().Register<sub3000::space_t>();
 
+      // space actor retunes ship, when arena.config changes
+      this->arenaConfig = sub3000::Assets().Config("./arena.config");
+      sub3000::Assets().Subscribe(this->spaceActorID);
+
       bb::context_t::Instance().RegisterActorCallback(
         this->spaceActorID,
         bb::context_t::keyboard
@@ -136,7 +137,7 @@ namespace sub3000
       defLine.Buffers().emplace_back(
         bb::MakeVertexBuffer(FillBuffer(8, 4.0f))
       );
-      this->radarLine = bb::GenerateMesh(
+      this->radarLine.Update(
         defLine
       );
 
@@ -180,7 +181,7 @@ namespace sub3000
         mesh.Buffers().emplace_back(
           bb::MakeVertexBuffer(Linearize(this->unitLife))
         );
-        this->units = bb::GenerateMesh(mesh);
+        this->units.Update(mesh);
       }
     }
 
@@ -245,7 +246,7 @@ namespace sub3000
         );
       }
 
-      this->depthZ = bb::GenerateMesh(
+      this->depthZ.Update(
         zpoints
       );
     }
@@ -353,7 +354,7 @@ namespace sub3000
         );
       }
 
-      this->rudder = bb::GenerateMesh(
+      this->rudder.Update(
         actualRudderTri
       );
     }
@@ -372,7 +373,7 @@ namespace sub3000
         );
       }
 
-      this->engine = bb::GenerateMesh(
+      this->engine.Update(
         actualOutputTri
       );
     }
@@ -391,7 +392,7 @@ namespace sub3000
         );
       }
 
-      this->ballast = bb::GenerateMesh(
+      this->ballast.Update(
         actualOutputTri
       );
     }
@@ -409,7 +410,7 @@ namespace sub3000
         this->speedMult = state->simSpeed;
         if (this->speedMult != 1)
         {
-          this->speedMultMesh = bb::GenerateMesh(
+          this->speedMultMesh.Update(
             bb::DefineNumber(
               glm::vec3(-0.95f, -0.7f, 0.0f),
               0.01f, 
@@ -524,6 +525,8 @@ namespace sub3000
 
     void screen_t::OnCleanup()
     {
+      sub3000::Assets().Unsubscribe(this->spaceActorID);
+      this->arenaConfig.reset();
       bb::workerPool_t::Instance().Unregister(this->spaceActorID);
       this->box.reset();
     }
@@ -15,10 +15,18 @@
 #include <scene.hpp>
 
 #include <mapGen.hpp>
+#include <assets.hpp>
 
 namespace sub3000
 {
 
+  namespace
+  {
+
+    const char* const ARENA_CONFIG = "./arena.config";
+
+  } // namespace
+
   namespace engine 
   {
   
@@ -207,19 +215,23 @@ namespace sub3000
       return bb::msg::result_t::complete;
     }
 
+    if (auto changed = bb::msg::As<bb::msg::assetChanged_t>(msg))
+    {
+      if ((changed->Filename() == ARENA_CONFIG) && (changed->Config() != nullptr))
+      {
+        this->Configure(*changed->Config());
+        bb::Info("%s", "Arena config reloaded");
+      }
+      return bb::msg::result_t::complete;
+    }
+
     bb::Error("Unknown message: %s", typeid(msg).name());
     assert(0);
     return bb::msg::result_t::error;
   }
 
-  space_t::space_t()
-  : cumDT(0.0),
-    newPointCount(0),
-    renderDepth(false)
+  void space_t::Configure(const bb::config_t& config)
   {
-    bb::config_t config;
-    config.Load("./arena.config");
-
     this->player.mass = static_cast<float>(config.Value("player.mass", 1.0f));
     this->player.rotMoment = static_cast<float>(config.Value("player.moment", 1.0f));
     this->player.engineModeList = engine::modeList_t(config);
@@ -228,11 +240,21 @@ namespace sub3000
     this->player.maxBallastChange = static_cast<float>(config.Value("player.max.change.ballast", 0.6f));
     this->player.width = static_cast<float>(config.Value("player.width", 1.0f));
     this->player.length =  static_cast<float>(config.Value("player.length", 1.0f));
+    this->player.clip = (config.Value("clip", 1.0f) != 0.0f);
+  }
+
+  space_t::space_t()
+  : cumDT(0.0),
+    newPointCount(0),
+    renderDepth(false)
+  {
+    bb::config_t config;
+    config.Load(ARENA_CONFIG);
+    this->Configure(config);
 
     this->player.pos.x = static_cast<float>(config.Value("player.pos.x", 240.0f));
     this->player.pos.y = static_cast<float>(config.Value("player.pos.y", 117.0f));
     this->player.angle = 0.0f;
-    this->player.clip = (config.Value("clip", 1.0f) != 0.0f);
 
     this->radarZ.resize(20, 0.0f);
 
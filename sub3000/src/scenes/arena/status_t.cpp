@@ -108,7 +108,7 @@ namespace sub3000
             glm::vec3(-newMapPos, 0.0f)
           );
 
-          this->mapShip = bb::GenerateMesh(ShipTriangle(10.0f, status->Data().pos, status->Data().angle));
+          this->mapShip.Update(ShipTriangle(10.0f, status->Data().pos, status->Data().angle));
 
           if ((this->coursePoints.empty()) || (glm::length(this->coursePoints.back() - status->Data().pos) >= 0.4f))
           {
@@ -121,7 +121,7 @@ namespace sub3000
               this->coursePoints.pop_front();
             }
 
-            this->mapPoints = bb::GenerateMesh(
+            this->mapPoints.Update(
               bb::DefinePoints(0.2f, this->coursePoints)
             );
           }
@@ -1,4 +1,5 @@
 #include <splash.hpp>
+#include <sub3000.hpp>
 
 #include <config.hpp>
 
@@ -31,13 +32,9 @@ namespace sub3000
   void splashScene_t::OnPrepare()
   {
     this->pContext = &bb::context_t::Instance();
-    this->shader = bb::shader_t::LoadProgramFromFiles(
-      this->shader_vp.c_str(),
-      this->shader_fp.c_str()
-    );
-    this->timePassedUniform = this->shader.UniformLocation("time");
-
-    this->texture = bb::texture_t::LoadTGA(this->logo);
+    this->shader = Assets().Shader(this->shader_vp, this->shader_fp);
+    this->texture = Assets().Texture(this->logo);
+    this->timePassedUniform = -1;
 
     auto vboPos  = bb::vbo_t::CreateArrayBuffer(vPos, sizeof(vPos), false);
     auto vboUV   = bb::vbo_t::CreateArrayBuffer(vUV,  sizeof(vUV),  false);
@@ -53,6 +50,22 @@ namespace sub3000
 
   void splashScene_t::OnUpdate(double delta)
   {
+    if (this->shader->IsFailed() || this->texture->IsFailed())
+    { // nothing to show
+      PostChangeScene(sceneID_t::mainMenu);
+      return;
+    }
+
+    if (!this->shader->IsReady() || !this->texture->IsReady())
+    { // splash starts, when logo is loaded
+      return;
+    }
+
+    if (this->timePassedUniform == -1)
+    {
+      this->timePassedUniform = this->shader->Get().UniformLocation("time");
+    }
+
     this->currentTimePassed += delta;
     if (this->currentTimePassed > this->duration)
     {
@@ -65,17 +78,23 @@ namespace sub3000
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glDisable(GL_DEPTH_TEST);
 
-    bb::shader_t::Bind(this->shader);
-    this->shader.SetFloat(
+    bb::framebuffer_t::Bind(this->pContext->Canvas());
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    if (!this->shader->IsReady() || !this->texture->IsReady())
+    {
+      return;
+    }
+
+    auto& shader = this->shader->Get();
+    bb::shader_t::Bind(shader);
+    shader.SetFloat(
       this->timePassedUniform,
       static_cast<float>(this->currentTimePassed)
     );
 
-    bb::framebuffer_t::Bind(this->pContext->Canvas());
     bb::vao_t::Bind(this->object);
-    bb::texture_t::Bind(this->texture);
-
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    bb::texture_t::Bind(this->texture->Get());
 
     glEnableVertexAttribArray(0);
     glEnableVertexAttribArray(1);
@@ -86,13 +105,14 @@ namespace sub3000
 
   void splashScene_t::OnCleanup()
   {
-    ;
+    this->shader.reset();
+    this->texture.reset();
   }
 
   splashScene_t::splashScene_t()
   : scene_t(sceneID_t::splash, "Splash Screen"),
     duration(0.0),
-    timePassedUniform(0),
+    timePassedUniform(-1),
     currentTimePassed(0.0),
     pContext(nullptr)
   {
@@ -7,7 +7,7 @@
 #include <msg.hpp>
 #include <mapGen.hpp>
 #include <worker.hpp>
-#include <monfs.hpp>
+#include <profilerOverlay.hpp>
 
 namespace 
 {
@@ -21,6 +21,9 @@ namespace
   std::mutex g_mapGenLock;
   bb::actorPID_t g_mapGenActorID = -1;
 
+  // bytes uploaded to GPU each frame, when assets arrive together
+  const size_t assetUploadBudget = 8*1024*1024;
+
 }
 
 namespace sub3000
@@ -31,6 +34,12 @@ namespace sub3000
     Mailbox()->Put(std::move(msg));
   }
 
+  bb::assets_t& Assets()
+  {
+    static bb::assets_t assets(assetUploadBudget);
+    return assets;
+  }
+
   bool RequestGenerateMap(bb::actorPID_t sendResultToID)
   {
     std::unique_lock<std::mutex> lock(g_mapGenLock);
@@ -98,9 +107,6 @@ void ProcessGameAction(bb::actorPID_t src, sub3000::gameAction_t action)
   }
 }
 
-int fsMonitorIDCounter = 0;
-std::unordered_map<int, bb::fs::monitor_t> fsMonitors;
-
 int main(int argc, char* argv[])
 {
   if (bb::ProcessStartupArguments(argc, argv) != 0)
@@ -126,16 +132,32 @@ int main(int argc, char* argv[])
     return -1;
   }
 
+  auto hotReload = defaultConfig.Value("assets.hotReload", 0.0);
+  if (hotReload > 0.0)
+  { // development builds tune assets, while game runs
+    sub3000::Assets().EnableHotReload(std::chrono::milliseconds(static_cast<int64_t>(hotReload)));
+  }
+
   sub3000::PushScene(sub3000::GetScene(sceneID));
   sub3000::deltaTime_t dt;
   bb::msg_t msgToMain;
+  bb::profilerOverlay_t overlay(context.AspectRatio());
 
   bool loop = true;
   while(loop)
   {
     auto topScene = sub3000::TopScene(0);
-    topScene->Update(dt.Mark());
-    topScene->Render();
+    auto delta = dt.Mark();
+    sub3000::Assets().Update();
+    topScene->Update(delta);
+    {
+      BB_GPU_SCOPE("scene");
+      topScene->Render();
+    }
+
+    overlay.Update(delta);
+    bb::framebuffer_t::Bind(context.Canvas());
+    overlay.Render();
 
     if (!context.Update())
     {
@@ -153,6 +175,8 @@ int main(int argc, char* argv[])
       if (auto changeScene = bb::As<sub3000::changeScene_t>(msgToMain))
       {
         sub3000::PopScene();
+        // scene reload must read changed files again
+        sub3000::Assets().Purge();
         sub3000::PushScene(
           sub3000::GetScene(
             changeScene->SceneID()
@@ -179,43 +203,6 @@ int main(int argc, char* argv[])
         continue;
       }
 
-      if (auto watch = bb::As<sub3000::fs::watch_t>(msgToMain))
-      {
-        auto newMon = bb::fs::monitor_t::Create(std::move(watch->Processor()));
-        auto result = newMon.Watch(watch->Filename().c_str());
-
-        if (result == -1)
-        { // add watch failed, so just return
-          if (watch->Source() != bb::INVALID_ACTOR)
-          {
-            bb::workerPool_t::Instance().PostMessage(
-              watch->Source(), 
-              bb::Issue<sub3000::fs::status_t>(-1)
-            );
-          }
-          continue;
-        }
-
-        // otherwise, store monitor and return it's id
-        fsMonitors[fsMonitorIDCounter] = std::move(newMon);
-
-        if (watch->Source() != bb::INVALID_ACTOR)
-        {
-          bb::workerPool_t::Instance().PostMessage(
-            watch->Source(), 
-            bb::Issue<sub3000::fs::status_t>(fsMonitorIDCounter)
-          );
-        }
-        ++fsMonitorIDCounter;
-        continue;
-      }
-
-      if (auto rmWatch = bb::As<sub3000::fs::rmWatch_t>(msgToMain))
-      {
-        fsMonitors.erase(rmWatch->Watch());
-        continue;
-      }
-
       if (auto* defMsg = msgToMain.get())
       {
         bb::Error("Unknown action type: %s", typeid(*defMsg).name());
@@ -227,11 +214,6 @@ int main(int argc, char* argv[])
       assert(0);
     }
 
-    for (auto& monitor: fsMonitors)
-    {
-      monitor.second.Check();
-    }
-
   }
 
   {
@@ -0,0 +1,59 @@
+/**
+ * @file bench.hpp
+ *
+ * Timing and checking helpers shared by benchmark tests
+ *
+ */
+
+#pragma once
+#ifndef __BB_TESTS_BENCH_HEADER__
+#define __BB_TESTS_BENCH_HEADER__
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+
+namespace bench
+{
+
+  using benchClock_t = std::chrono::steady_clock;
+
+  /**
+   * Seconds passed since start.
+   */
+  inline double Seconds(benchClock_t::time_point start)
+  {
+    return std::chrono::duration<double>(benchClock_t::now() - start).count();
+  }
+
+  /**
+   * Best time of func in given number of rounds.
+   */
+  template<typename func_t>
+  double Measure(int rounds, func_t func)
+  {
+    double best = std::numeric_limits<double>::max();
+    for (int round = 0; round < rounds; ++round)
+    {
+      auto start = benchClock_t::now();
+      func();
+      best = std::min(best, Seconds(start));
+    }
+    return best;
+  }
+
+  /**
+   * @throw std::runtime_error with what, when condition is false
+   */
+  inline void Check(bool condition, const char* what)
+  {
+    if (!condition)
+    {
+      throw std::runtime_error(what);
+    }
+  }
+
+} // namespace bench
+
+#endif /* __BB_TESTS_BENCH_HEADER__ */
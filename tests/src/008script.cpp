@@ -5,10 +5,10 @@
 
 class printVM_t final: public bb::vm_t
 {
-  int OnCommand(int cmd, const bb::listOfRefs_t& refs)
+  int OnCommand(int cmd, const bb::scriptArgs_t& args)
   {
     printf("\t%c", cmd);
-    for (auto& item: refs)
+    for (auto& item: args)
     {
       printf(":%f", item.Number());
     }
@@ -0,0 +1,159 @@
+#include <common.hpp>
+#include <objLoad.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace
+{
+
+  const char* benchFile = "013objload.obj";
+  const char* convertFile = "013objload.small.obj";
+  const char* meshFile = "013objload.small.obj.msh";
+
+  /**
+   * Grid of side x side quads, two triangles each.
+   *
+   * Odd rows use negative indecies.
+   */
+  void WriteGrid(FILE* output, int side)
+  {
+    const int width = side + 1;
+
+    fprintf(output, "# %d triangles\n", side*side*2);
+    for (int y = 0; y < width; ++y)
+    {
+      for (int x = 0; x < width; ++x)
+      {
+        fprintf(output, "v %f %f %f\n", x*0.1, y*0.1, (rand() % 1000)/1000.0);
+        fprintf(output, "vt %f %f\n", x/static_cast<double>(side), y/static_cast<double>(side));
+        fprintf(output, "vn 0.0 0.0 1.0\n");
+      }
+    }
+
+    const int total = width*width;
+    for (int y = 0; y < side; ++y)
+    {
+      for (int x = 0; x < side; ++x)
+      {
+        int a = y*width + x + 1;
+        int b = a + 1;
+        int c = a + width;
+        int d = c + 1;
+        if ((y & 1) != 0)
+        { // relative to last vertex
+          a -= total + 1;
+          b -= total + 1;
+          c -= total + 1;
+          d -= total + 1;
+        }
+        fprintf(output, "f %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, b, b, b, c, c, c);
+        fprintf(output, "f %d/%d/%d %d/%d/%d %d/%d/%d\n", c, c, c, b, b, b, d, d, d);
+      }
+    }
+  }
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  if (bb::ProcessStartupArguments(argc, argv) != 0)
+  {
+    return -1;
+  }
+
+  // ~1M triangles by default
+  const int side = (argc > 1)?(atoi(argv[1])):(708);
+  const int rounds = 5;
+
+  if (FILE* output = fopen(benchFile, "wt"))
+  {
+    BB_DEFER(fclose(output));
+    WriteGrid(output, side);
+  }
+  else
+  {
+    throw std::runtime_error("Can't write benchmark OBJ");
+  }
+  BB_DEFER(remove(benchFile));
+
+  double best = std::numeric_limits<double>::max();
+  double total = 0.0;
+  bb::ext::objStats_t stats;
+  for (int i = 0; i < rounds; ++i)
+  {
+    auto start = std::chrono::steady_clock::now();
+    auto mesh = bb::ext::LoadOBJ(benchFile, &stats);
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (!mesh.IsGood() || (stats.triangles != static_cast<size_t>(side*side*2)))
+    {
+      throw std::runtime_error("OBJ parsing failed");
+    }
+
+    best = std::min(best, elapsed);
+    total += elapsed;
+  }
+
+  bb::Info("OBJ: " BBsize_t " triangles, " BBsize_t " chunks", stats.triangles, stats.chunks);
+  bb::Info("Best: %.3f s, average: %.3f s, %.1f Mtri/s",
+    best,
+    total/rounds,
+    static_cast<double>(stats.triangles)/best/1.0e6
+  );
+
+  // grid has no materials: as obj2mesh does, save only buffers, which are present
+  if (FILE* output = fopen(convertFile, "wt"))
+  {
+    BB_DEFER(fclose(output));
+    WriteGrid(output, 16);
+  }
+  else
+  {
+    throw std::runtime_error("Can't write OBJ to convert");
+  }
+  BB_DEFER(remove(convertFile));
+
+  auto mesh = bb::ext::LoadOBJ(convertFile, &stats);
+  if ((!mesh.IsGood()) || (mesh.Buffers().size() != stats.format.size()))
+  {
+    throw std::runtime_error("Format does not match parsed buffers");
+  }
+
+  if (FILE* output = fopen(meshFile, "wb"))
+  {
+    BB_DEFER(fclose(output));
+    if (mesh.Save(output, stats.format) != 0)
+    {
+      throw std::runtime_error("Can't save converted mesh");
+    }
+  }
+  BB_DEFER(remove(meshFile));
+
+  bb::meshDesc_t converted;
+  if (FILE* input = fopen(meshFile, "rb"))
+  {
+    BB_DEFER(fclose(input));
+    converted = bb::meshDesc_t::Load(input);
+  }
+  if ((!converted.IsGood()) || (converted.Packed() == nullptr))
+  {
+    throw std::runtime_error("Can't load converted mesh");
+  }
+
+  // positions, normals, texture coordinates
+  const auto& attribs = converted.Packed()->Attribs();
+  if ((attribs.size() != 3)
+    || (attribs[0].format != bb::attribFormat_t::position16)
+    || (attribs[1].format != bb::attribFormat_t::normal16)
+    || (attribs[2].format != bb::attribFormat_t::native)
+    || (attribs[2].dim != 2) || (attribs[2].type != GL_FLOAT)
+    || (converted.Packed()->Size() != mesh.Buffers().front()->Size()))
+  {
+    throw std::runtime_error("Converted mesh has wrong attributes");
+  }
+  return 0;
+}
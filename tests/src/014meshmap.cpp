@@ -0,0 +1,204 @@
+#include <bench.hpp>
+#include <common.hpp>
+#include <meshDesc.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+  const char* sourceMeshes[] = {
+    "../painter/alphabet.pvf.msh",
+    "../painter/test.pvf.msh"
+  };
+
+  /**
+   * Read every payload byte, as GenerateMesh upload does.
+   */
+  uint32_t Touch(const std::vector<bb::meshDesc_t>& meshes)
+  {
+    uint32_t result = 0;
+    auto sum = [&result](const void* data, size_t size)
+    {
+      auto bytes = static_cast<const uint8_t*>(data);
+      for (size_t i = 0; i < size; ++i)
+      {
+        result += bytes[i];
+      }
+    };
+
+    for (auto& mesh: meshes)
+    {
+      if (mesh.Packed() != nullptr)
+      {
+        sum(mesh.Packed()->Data(), mesh.Packed()->ByteSize());
+      }
+      for (auto& buffer: mesh.Buffers())
+      {
+        sum(buffer->Data(), buffer->ByteSize());
+      }
+      sum(mesh.Indecies()->Data(), mesh.Indecies()->ByteSize());
+    }
+    return result;
+  }
+
+  void Check(const std::vector<bb::meshDesc_t>& meshes)
+  {
+    for (auto& mesh: meshes)
+    {
+      if (!mesh.IsGood())
+      {
+        throw std::runtime_error("Mesh loading failed");
+      }
+    }
+  }
+
+  struct result_t
+  {
+    double load;
+    double touch;
+    uint32_t checksum;
+  };
+
+  template<typename loader_t>
+  result_t Measure(const std::vector<std::string>& files, int rounds, loader_t loader)
+  {
+    result_t best = { std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), 0 };
+    for (int i = 0; i < rounds; ++i)
+    {
+      auto start = bench::benchClock_t::now();
+      auto meshes = loader(files);
+      auto load = bench::Seconds(start);
+      Check(meshes);
+
+      start = bench::benchClock_t::now();
+      best.checksum = Touch(meshes);
+      auto touch = bench::Seconds(start);
+
+      best.load = std::min(best.load, load);
+      best.touch = std::min(best.touch, touch);
+    }
+    return best;
+  }
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  if (bb::ProcessStartupArguments(argc, argv) != 0)
+  {
+    return -1;
+  }
+
+  const size_t copies = (argc > 1)?(static_cast<size_t>(atoi(argv[1]))):(4096);
+  const int rounds = 5;
+
+  // even copies keep original version 1 files, odd are saved as version 2
+  std::vector<std::string> files;
+  files.reserve(copies);
+  for (size_t i = 0; i < copies; ++i)
+  {
+    const char* source = sourceMeshes[(i/2) % (sizeof(sourceMeshes)/sizeof(sourceMeshes[0]))];
+
+    FILE* input = fopen(source, "rb");
+    if (input == nullptr)
+    {
+      throw std::runtime_error("Can't open painter mesh");
+    }
+    BB_DEFER(fclose(input));
+
+    files.emplace_back("014meshmap." + std::to_string(i) + ".msh");
+    FILE* output = fopen(files.back().c_str(), "wb");
+    if (output == nullptr)
+    {
+      throw std::runtime_error("Can't write benchmark mesh");
+    }
+    BB_DEFER(fclose(output));
+
+    if ((i & 1) != 0)
+    {
+      if (bb::meshDesc_t::Load(input).Save(output) != 0)
+      {
+        throw std::runtime_error("Can't write benchmark mesh");
+      }
+    }
+    else
+    {
+      char buffer[4096];
+      size_t size;
+      while ((size = fread(buffer, 1, sizeof(buffer), input)) != 0)
+      {
+        fwrite(buffer, 1, size, output);
+      }
+    }
+  }
+  BB_DEFER(
+    for (auto& file: files)
+    {
+      remove(file.c_str());
+    }
+  );
+
+  auto readLoad = Measure(files, rounds,
+    [](const std::vector<std::string>& files) -> std::vector<bb::meshDesc_t>
+    {
+      std::vector<bb::meshDesc_t> result;
+      result.reserve(files.size());
+      for (auto& file: files)
+      {
+        FILE* input = fopen(file.c_str(), "rb");
+        if (input == nullptr)
+        {
+          throw std::runtime_error("Can't open benchmark mesh");
+        }
+        BB_DEFER(fclose(input));
+        result.emplace_back(bb::meshDesc_t::Load(input));
+      }
+      return result;
+    }
+  );
+
+  auto mapLoad = Measure(files, rounds,
+    [](const std::vector<std::string>& files) -> std::vector<bb::meshDesc_t>
+    {
+      std::vector<bb::meshDesc_t> result;
+      result.reserve(files.size());
+      for (auto& file: files)
+      {
+        result.emplace_back(bb::meshDesc_t::Map(file.c_str()));
+      }
+      return result;
+    }
+  );
+
+  auto bulkLoad = Measure(files, rounds, bb::MapMeshes);
+
+  if ((readLoad.checksum != mapLoad.checksum) || (readLoad.checksum != bulkLoad.checksum))
+  {
+    throw std::runtime_error("Mapped meshes differ from read ones");
+  }
+
+  { // mapped mesh copies its data on first write
+    auto merged = bb::meshDesc_t::Map(files.front().c_str());
+    auto tail = bb::meshDesc_t::Map(files.front().c_str());
+    const bb::meshDesc_t* tails[] = { &tail, &tail };
+    if ((merged.AppendAll(tails, bb::countof(tails)) != 0)
+      || (merged.Buffers().front()->Size() != tail.Buffers().front()->Size()*3)
+      || (merged.Indecies()->Size() != tail.Indecies()->Size()*3))
+    {
+      throw std::runtime_error("Can't append to mapped mesh");
+    }
+  }
+
+  bb::Info("Meshes: " BBsize_t ", best of %d rounds", copies, rounds);
+  bb::Info("fread: %.3f ms load, %.3f ms payload", readLoad.load*1000.0, readLoad.touch*1000.0);
+  bb::Info("mmap:  %.3f ms load, %.3f ms payload", mapLoad.load*1000.0, mapLoad.touch*1000.0);
+  bb::Info("bulk:  %.3f ms load, %.3f ms payload", bulkLoad.load*1000.0, bulkLoad.touch*1000.0);
+  return 0;
+}
@@ -0,0 +1,150 @@
+#include <bench.hpp>
+#include <common.hpp>
+#include <meshDesc.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+
+  const uint32_t quadIndecies[] = { 0, 1, 2, 2, 1, 3 };
+
+  /**
+   * Quad at (x, y), as painter strokes or star.rg tiles are made.
+   *
+   * @param useDefault use defaultVertexBuffer_t/defaultIndexBuffer_t as loaded meshes do
+   */
+  bb::meshDesc_t Quad(float x, float y, bool useDefault)
+  {
+    const glm::vec2 points[] = {
+      glm::vec2(x, y),
+      glm::vec2(x + 1.0f, y),
+      glm::vec2(x, y + 1.0f),
+      glm::vec2(x + 1.0f, y + 1.0f)
+    };
+
+    bb::meshDesc_t result;
+    if (useDefault)
+    {
+      result.Buffers().emplace_back(
+        new bb::defaultVertexBuffer_t(points, bb::countof(points), 2, GL_FLOAT, GL_FALSE)
+      );
+      result.Indecies().reset(
+        new bb::defaultIndexBuffer_t(quadIndecies, bb::countof(quadIndecies), GL_UNSIGNED_INT)
+      );
+    }
+    else
+    {
+      result.Buffers().emplace_back(bb::MakeVertexBuffer(points));
+      result.Indecies() = bb::MakeIndexBuffer(quadIndecies);
+    }
+    return result;
+  }
+
+  void Check(const bb::meshDesc_t& mesh, size_t count)
+  {
+    if (
+         (mesh.Buffers().front()->Size() != count*4)
+      || (mesh.Indecies()->Size() != count*6)
+      || (mesh.MaxIndex() != count*4 - 1)
+    )
+    {
+      throw std::runtime_error("Appended mesh is broken");
+    }
+  }
+
+  bool Same(const bb::meshDesc_t& a, const bb::meshDesc_t& b)
+  {
+    return (a.Indecies()->ByteSize() == b.Indecies()->ByteSize())
+      && (memcmp(a.Indecies()->Data(), b.Indecies()->Data(), a.Indecies()->ByteSize()) == 0)
+      && (a.Buffers().front()->ByteSize() == b.Buffers().front()->ByteSize())
+      && (memcmp(a.Buffers().front()->Data(), b.Buffers().front()->Data(), a.Buffers().front()->ByteSize()) == 0);
+  }
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  if (bb::ProcessStartupArguments(argc, argv) != 0)
+  {
+    return -1;
+  }
+
+  const size_t count = (argc > 1)?(static_cast<size_t>(atoi(argv[1]))):(100000);
+  const int rounds = 5;
+
+  if (count == 0)
+  {
+    throw std::runtime_error("Nothing to append");
+  }
+
+  for (int useDefault = 0; useDefault < 2; ++useDefault)
+  {
+    std::vector<bb::meshDesc_t> quads;
+    quads.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+      quads.emplace_back(Quad(static_cast<float>(i % 1000), static_cast<float>(i / 1000), useDefault != 0));
+    }
+
+    double bestAppend = std::numeric_limits<double>::max();
+    double bestAppendAll = std::numeric_limits<double>::max();
+    for (int round = 0; round < rounds; ++round)
+    {
+      auto start = bench::benchClock_t::now();
+      bb::meshDesc_t appended;
+      for (auto& quad: quads)
+      {
+        if (appended.Append(quad) != 0)
+        {
+          throw std::runtime_error("Append failed");
+        }
+      }
+      bestAppend = std::min(bestAppend, bench::Seconds(start));
+
+      start = bench::benchClock_t::now();
+      bb::meshDesc_t appendedAll;
+      if (appendedAll.AppendAll(quads.begin(), quads.end()) != 0)
+      {
+        throw std::runtime_error("AppendAll failed");
+      }
+      bestAppendAll = std::min(bestAppendAll, bench::Seconds(start));
+
+      Check(appended, count);
+      Check(appendedAll, count);
+      if (!Same(appended, appendedAll))
+      {
+        throw std::runtime_error("Append and AppendAll results differ");
+      }
+    }
+
+    bb::Info("%s buffers, " BBsize_t " quads, best of %d rounds",
+      (useDefault != 0)?("Default"):("Typed"),
+      count,
+      rounds
+    );
+    bb::Info("Append:    %.3f ms", bestAppend*1000.0);
+    bb::Info("AppendAll: %.3f ms", bestAppendAll*1000.0);
+  }
+
+  { // meshes without index buffer append only vertecies
+    auto unindexed = Quad(0.0f, 0.0f, true);
+    unindexed.Indecies().reset();
+    bb::meshDesc_t appended = Quad(0.0f, 0.0f, true);
+    appended.Indecies().reset();
+
+    const bb::meshDesc_t* tails[] = { &unindexed, &unindexed };
+    if ((appended.AppendAll(tails, bb::countof(tails)) != 0)
+      || (appended.Indecies())
+      || (appended.Buffers().front()->Size() != 12))
+    {
+      throw std::runtime_error("Can't append meshes without indecies");
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,173 @@
+#include <bench.hpp>
+#include <common.hpp>
+#include <image.hpp>
+#include <textureFile.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+  const char* sourceImages[] = {
+    "grid.tga",
+    "mono.tga",
+    "mono.sdf.tga",
+    "splash.tga",
+    "../starrg/tiles.tga",
+    "../starrg/font.tga",
+    "../tacwar/basic.tga"
+  };
+
+  /**
+   * Read every byte, as texture upload does.
+   */
+  uint32_t Touch(const uint8_t* data, size_t size)
+  {
+    uint64_t result = 0;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+    {
+      uint64_t word;
+      memcpy(&word, data + i, sizeof(word));
+      result ^= word;
+    }
+    for (; i < size; ++i)
+    {
+      result ^= data[i];
+    }
+    return static_cast<uint32_t>(result ^ (result >> 32));
+  }
+
+  template<typename loader_t>
+  double Measure(int rounds, int repeat, loader_t loader)
+  {
+    return bench::Measure(rounds,
+      [repeat, &loader]()
+      {
+        for (int i = 0; i < repeat; ++i)
+        {
+          loader();
+        }
+      }
+    );
+  }
+
+  std::string TexName(size_t index, bb::textureFormat_t format)
+  {
+    return "016texload." + std::to_string(index) + "." + std::to_string(static_cast<uint32_t>(format)) + ".tex";
+  }
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  if (bb::ProcessStartupArguments(argc, argv) != 0)
+  {
+    return -1;
+  }
+
+  const int repeat = (argc > 1)?(atoi(argv[1])):(20);
+  const int rounds = 5;
+  const bb::textureFormat_t formats[] = {
+    bb::textureFormat_t::rgba8,
+    bb::textureFormat_t::bc1,
+    bb::textureFormat_t::bc3
+  };
+
+  std::vector<std::string> files;
+  for (size_t i = 0; i < bb::countof(sourceImages); ++i)
+  {
+    auto image = bb::LoadTGA(sourceImages[i]);
+    for (auto format: formats)
+    {
+      files.emplace_back(TexName(i, format));
+      FILE* output = fopen(files.back().c_str(), "wb");
+      if (output == nullptr)
+      {
+        throw std::runtime_error("Can't write benchmark texture");
+      }
+      BB_DEFER(fclose(output));
+      if (bb::SaveTexture(output, image, format, true) != 0)
+      {
+        throw std::runtime_error("Can't write benchmark texture");
+      }
+    }
+  }
+  BB_DEFER(
+    for (auto& file: files)
+    {
+      remove(file.c_str());
+    }
+  );
+
+  uint32_t checksum = 0;
+
+  // runtime path: decode and upload, mip chain is built by GPU afterwards
+  auto decode = Measure(rounds, repeat,
+    [&checksum]()
+    {
+      for (auto name: sourceImages)
+      {
+        auto image = bb::LoadTGA(name);
+        checksum += Touch(image.Data(), static_cast<size_t>(image.Width()*image.Height()*4));
+      }
+    }
+  );
+
+  // same levels, as baked in containers, but built on load
+  auto mipmaps = Measure(rounds, repeat,
+    [&checksum]()
+    {
+      for (auto name: sourceImages)
+      {
+        auto image = bb::LoadTGA(name);
+        checksum += Touch(image.Data(), static_cast<size_t>(image.Width()*image.Height()*4));
+        while ((image.Width() > 1) || (image.Height() > 1))
+        {
+          image = bb::Downsample(image);
+          checksum += Touch(image.Data(), static_cast<size_t>(image.Width()*image.Height()*4));
+        }
+      }
+    }
+  );
+
+  bb::Info("Images: " BBsize_t ", %d loads, best of %d rounds", bb::countof(sourceImages), repeat, rounds);
+  bb::Info("tga decode:          %.3f ms", decode*1000.0);
+  bb::Info("tga decode + mips:   %.3f ms", mipmaps*1000.0);
+
+  for (size_t f = 0; f < bb::countof(formats); ++f)
+  {
+    size_t totalSize = 0;
+    auto mapped = Measure(rounds, repeat,
+      [&checksum, &totalSize, &formats, f]()
+      {
+        totalSize = 0;
+        for (size_t i = 0; i < bb::countof(sourceImages); ++i)
+        {
+          auto file = bb::textureFile_t::Map(TexName(i, formats[f]).c_str());
+          if (!file.IsGood())
+          {
+            throw std::runtime_error("Texture mapping failed");
+          }
+          for (auto& level: file.Levels())
+          {
+            checksum += Touch(level.data, level.size);
+            totalSize += level.size;
+          }
+        }
+      }
+    );
+
+    const char* formatNames[] = { "rgba8", "bc1", "bc3" };
+    bb::Info("tex %-5s mapped:    %.3f ms (" BBsize_t " bytes with mips)", formatNames[f], mapped*1000.0, totalSize);
+  }
+
+  bb::Debug("Checksum: %08x", checksum);
+  return 0;
+}
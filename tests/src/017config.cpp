@@ -0,0 +1,169 @@
+#include <bench.hpp>
+#include <common.hpp>
+#include <config.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+  const char* const sampleName = "017config.config";
+  const char* const savedName = "017config.saved.config";
+
+  std::string SectionName(int section)
+  {
+    return "section" + std::to_string(section);
+  }
+
+  std::string KeyName(int key)
+  {
+    return "key" + std::to_string(key);
+  }
+
+  /**
+   * Sections with nested blocks, numbers in all supported forms and strings.
+   */
+  void WriteSample(int sections, int keysPerSection)
+  {
+    FILE* output = fopen(sampleName, "wt");
+    if (output == nullptr)
+    {
+      throw std::runtime_error("Can't write benchmark config");
+    }
+    BB_DEFER(fclose(output));
+
+    for (int section = 0; section < sections; ++section)
+    {
+      fprintf(output, "\"%s\" {\n", SectionName(section).c_str());
+      fprintf(output, "  \"nested\" {\n");
+      fprintf(output, "    \"scale\": %d.5e-1\n", section);
+      fprintf(output, "  }\n");
+      for (int key = 1; key < keysPerSection; ++key)
+      {
+        if ((key % 2) == 0)
+        {
+          fprintf(output, "  \"%s\": -%d.25\n", KeyName(key).c_str(), key);
+        }
+        else
+        {
+          fprintf(output, "  \"%s\": \"value %d/%d\"\n", KeyName(key).c_str(), section, key);
+        }
+      }
+      fprintf(output, "}\n");
+    }
+  }
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  if (bb::ProcessStartupArguments(argc, argv) != 0)
+  {
+    return -1;
+  }
+
+  const int totalKeys = (argc > 1)?(atoi(argv[1])):(100000);
+  const int keysPerSection = 100;
+  const int sections = std::max(totalKeys/keysPerSection, 1);
+  const int rounds = 5;
+
+  WriteSample(sections, keysPerSection);
+  BB_DEFER(remove(sampleName));
+  BB_DEFER(remove(savedName));
+
+  bb::config_t sample;
+  auto load = bench::Measure(rounds,
+    [&sample]()
+    {
+      bb::config_t config(sampleName);
+      sample = std::move(config);
+    }
+  );
+
+  bench::Check(std::fabs(sample.Value(SectionName(sections - 1) + ".nested.scale", 0.0) - (sections - 1 + 0.5)*0.1) < 1e-9, "Nested number mismatch");
+  bench::Check(sample.Value(SectionName(0) + "." + KeyName(2), 0.0) == -2.25, "Number mismatch");
+  bench::Check(sample.Value(SectionName(1) + "." + KeyName(3), "") == "value 1/3", "String mismatch");
+
+  auto save = bench::Measure(rounds,
+    [&sample]()
+    {
+      sample.Save(savedName);
+    }
+  );
+
+  bb::config_t saved;
+  auto reload = bench::Measure(rounds,
+    [&saved]()
+    {
+      bb::config_t config(savedName);
+      saved = std::move(config);
+    }
+  );
+
+  std::vector<std::string> names;
+  for (int section = 0; section < sections; ++section)
+  {
+    auto prefix = SectionName(section) + ".";
+    for (int key = 1; key < keysPerSection; ++key)
+    {
+      names.emplace_back(prefix + KeyName(key));
+    }
+  }
+
+  const bb::config_t& loaded = sample;
+  const bb::config_t& reloaded = saved;
+  bench::Check(loaded.Size() == reloaded.Size(), "Saved key count mismatch");
+
+  auto lookup = bench::Measure(rounds,
+    [&loaded, &reloaded, &names]()
+    {
+      for (auto& name: names)
+      {
+        bench::Check(loaded[name] == reloaded[name], "Saved value mismatch");
+      }
+    }
+  );
+
+  const auto copy = loaded.Copy();
+  bench::Check(copy.Size() == loaded.Size(), "Copied key count mismatch");
+  for (auto& name: names)
+  {
+    bench::Check(copy[name] == loaded[name], "Copied value mismatch");
+  }
+
+  std::vector<bb::configKey_t> keys;
+  auto resolve = bench::Measure(1,
+    [&keys, &names]()
+    {
+      for (auto& name: names)
+      {
+        keys.emplace_back(name);
+      }
+    }
+  );
+
+  auto handles = bench::Measure(rounds,
+    [&loaded, &reloaded, &keys]()
+    {
+      for (auto& key: keys)
+      {
+        bench::Check(loaded[key] == reloaded[key], "Saved value mismatch");
+      }
+    }
+  );
+
+  bb::Info("Keys: " BBsize_t ", best of %d rounds", loaded.Size(), rounds);
+  bb::Info("load:           %.3f ms", load*1000.0);
+  bb::Info("save:           %.3f ms", save*1000.0);
+  bb::Info("reload:         %.3f ms", reload*1000.0);
+  bb::Info("string lookup:  %.3f ms (" BBsize_t " keys, 2 per key)", lookup*1000.0, names.size());
+  bb::Info("resolve keys:   %.3f ms", resolve*1000.0);
+  bb::Info("handle lookup:  %.3f ms", handles*1000.0);
+  return 0;
+}
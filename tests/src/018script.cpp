@@ -0,0 +1,156 @@
+#include <bench.hpp>
+#include <common.hpp>
+#include <script.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+
+  const char* const compiledName = "018script.bbsc";
+
+  std::atomic<size_t> allocations(0);
+
+  /**
+   * Sums everything, so runs can be compared.
+   */
+  class sumVM_t final: public bb::vm_t
+  {
+    int OnCommand(int cmd, const bb::scriptArgs_t& args) override
+    {
+      this->sum += cmd;
+      for (auto& arg: args)
+      {
+        if (arg.Type() == bb::type_t::number)
+        {
+          this->sum += arg.Number();
+        }
+        else
+        {
+          this->sum += arg.Size() + static_cast<unsigned char>(arg.String()[0]);
+        }
+      }
+      ++this->commands;
+      return 0;
+    }
+
+  public:
+    double sum;
+    size_t commands;
+
+    sumVM_t()
+    : sum(0.0),
+      commands(0)
+    {
+      ;
+    }
+  };
+
+} // namespace
+
+void* operator new(size_t size)
+{
+  ++allocations;
+  if (void* result = malloc((size != 0)?(size):(1)))
+  {
+    return result;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+  free(ptr);
+}
+
+int main(int argc, char* argv[])
+{
+  if (bb::ProcessStartupArguments(argc, argv) != 0)
+  {
+    return -1;
+  }
+
+  const char* scriptName = (argc > 1)?(argv[1]):("../painter/alphabet.pvf");
+  const int runs = (argc > 2)?(atoi(argv[2])):(10000);
+  const int rounds = 5;
+
+  char* text = bb::ReadWholeFile(scriptName, "rb", nullptr);
+  if (text == nullptr)
+  {
+    bb::Error("Can't read \"%s\"", scriptName);
+    return -1;
+  }
+  BB_DEFER(free(text));
+
+  sumVM_t reference;
+  bench::Check(bb::ExecuteScript(reference, text) == 0, "Script failed");
+
+  sumVM_t interpreted;
+  auto parse = bench::Measure(rounds,
+    [&interpreted, text, runs]()
+    {
+      for (int run = 0; run < runs; ++run)
+      {
+        bench::Check(bb::ExecuteScript(interpreted, text) == 0, "Script failed");
+      }
+    }
+  );
+
+  bb::script_t script;
+  auto compile = bench::Measure(rounds,
+    [&script, text]()
+    {
+      script = bb::script_t::Compile(text);
+    }
+  );
+  bench::Check(script.IsGood(), "Compile failed");
+
+  sumVM_t compiled;
+  size_t executeAllocs = allocations;
+  auto execute = bench::Measure(rounds,
+    [&compiled, &script, runs]()
+    {
+      for (int run = 0; run < runs; ++run)
+      {
+        bench::Check(script.Execute(compiled) == 0, "Script failed");
+      }
+    }
+  );
+  executeAllocs = allocations - executeAllocs;
+
+  {
+    FILE* output = fopen(compiledName, "wb");
+    bench::Check(output != nullptr, "Can't write compiled script");
+    BB_DEFER(fclose(output));
+    bench::Check(script.Save(output) == 0, "Save failed");
+  }
+  BB_DEFER(remove(compiledName));
+
+  bb::script_t loaded;
+  {
+    FILE* input = fopen(compiledName, "rb");
+    bench::Check(input != nullptr, "Can't read compiled script");
+    BB_DEFER(fclose(input));
+    loaded = bb::script_t::Load(input);
+  }
+  bench::Check(loaded.IsGood(), "Load failed");
+
+  sumVM_t reloaded;
+  bench::Check(loaded.Execute(reloaded) == 0, "Loaded script failed");
+
+  bench::Check(reloaded.commands == reference.commands, "Loaded command count mismatch");
+  bench::Check(reloaded.sum == reference.sum, "Loaded arguments mismatch");
+  bench::Check(compiled.commands == reference.commands*runs*rounds, "Compiled command count mismatch");
+  bench::Check(interpreted.commands == compiled.commands, "Interpreted command count mismatch");
+  bench::Check(executeAllocs == 0, "Compiled script allocated");
+
+  bb::Info("\"%s\": " BBsize_t " commands, %d runs, best of %d rounds", scriptName, script.Size(), runs, rounds);
+  bb::Info("parse and execute: %.3f ms", parse*1000.0);
+  bb::Info("compile once:      %.3f ms", compile*1000.0);
+  bb::Info("execute compiled:  %.3f ms (" BBsize_t " allocations)", execute*1000.0, executeAllocs);
+  return 0;
+}
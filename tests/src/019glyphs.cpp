@@ -0,0 +1,197 @@
+#include <bench.hpp>
+#include <common.hpp>
+#include <config.hpp>
+#include <context.hpp>
+#include <font.hpp>
+#include <text.hpp>
+#include <utf8.hpp>
+#include <vecfont.hpp>
+
+#include <iconv.h>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+
+  const char* const sentences[] = {
+    "The quick brown fox jumps over the lazy dog. ",
+    "Съешь же ещё этих мягких французских булок, да выпей чаю. ",
+    "Sphinx of black quartz, judge my vow! ",
+    "Широкая электрификация южных губерний даст мощный толчок подъёму сельского хозяйства. "
+  };
+
+  /**
+   * Mixed Latin and Cyrillic text with given number of symbols.
+   */
+  std::string MakeParagraph(size_t symbols)
+  {
+    std::string result;
+    size_t total = 0;
+    for (size_t sentence = 0; total < symbols; ++sentence)
+    {
+      const char* cursor = sentences[sentence % bb::countof(sentences)];
+      while ((*cursor != 0) && (total < symbols))
+      {
+        int octets = bb::utf8SymbolLength(*cursor);
+        result.append(cursor, static_cast<size_t>(octets));
+        cursor += octets;
+        ++total;
+      }
+    }
+    return result;
+  }
+
+  /**
+   * Glyph metrics per symbol, recomputed from font config, the way font
+   * stored them in trees before glyph table was introduced.
+   */
+  void LoadTree(const char* filename, std::map<uint32_t, bb::vec2_t>& offsets, std::map<uint32_t, bb::vec2_t>& sizes)
+  {
+    bb::config_t config;
+    config.Load(filename);
+
+    double fontWidth = config.Value("font.width", 1.0);
+    double fontHeight = config.Value("font.height", 1.0);
+    double xstride = config.Value("font.xstride", 0.0);
+    double ystride = config.Value("font.ystride", 0.0);
+    const auto size = bb::vec2_t(1.0/fontWidth - xstride, 1.0/fontHeight - ystride);
+    const auto width = static_cast<int>(fontWidth);
+
+    iconv_t code = iconv_open("WCHAR_T", config.Value("font.encoding", "ASCII").c_str());
+    if (code == (iconv_t) -1)
+    {
+      throw std::runtime_error("Unsupported font encoding");
+    }
+    BB_DEFER(iconv_close(code));
+
+    for (uint8_t smb = 0; smb < std::numeric_limits<uint8_t>::max(); ++smb)
+    {
+      char input[1] = { static_cast<char>(smb) };
+      char* inputCursor = input;
+      size_t inputLeft = 1;
+
+      wchar_t output[1];
+      char* outputCursor = reinterpret_cast<char*>(output);
+      size_t outputLeft = sizeof(wchar_t);
+
+      if (iconv(code, &inputCursor, &inputLeft, &outputCursor, &outputLeft) == ((size_t)-1))
+      {
+        continue;
+      }
+
+      auto smbPos = bb::vec2_t(smb%width, smb/width);
+      offsets[static_cast<uint32_t>(output[0])] = bb::vec2_t { smbPos.x * (size.x + xstride), smbPos.y * (size.y + ystride) };
+      sizes[static_cast<uint32_t>(output[0])] = size;
+    }
+  }
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  if (bb::ProcessStartupArguments(argc, argv) != 0)
+  {
+    return -1;
+  }
+
+  const size_t symbols = 10000;
+  const int repeats = 100;
+  const int rounds = 5;
+
+  bb::context_t::Instance();
+
+  bb::font_t font;
+  font.Load("mono.config");
+
+  auto paragraph = MakeParagraph(symbols);
+  auto codepoints = bb::utf8extract(paragraph.c_str());
+  bench::Check(codepoints.size() == symbols, "Paragraph size mismatch");
+
+  std::map<uint32_t, bb::vec2_t> offsets;
+  std::map<uint32_t, bb::vec2_t> sizes;
+  LoadTree("mono.config", offsets, sizes);
+  for (auto smb: codepoints)
+  {
+    auto offset = offsets.find(smb);
+    auto size = sizes.find(smb);
+    bench::Check((offset != offsets.end()) && (size != sizes.end()), "Symbol is not in font");
+    bench::Check(font.Glyph(smb).offset == offset->second, "Glyph offset mismatch");
+    bench::Check(font.Glyph(smb).size == size->second, "Glyph size mismatch");
+  }
+
+  // mono.config: 16x16 CP866 symbols, 0.015625 between columns
+  bench::Check(font.Glyph('A').offset == bb::vec2_t(0.0625f, 0.25f), "Glyph 'A' offset mismatch");
+  bench::Check(font.Glyph(0x416).offset == bb::vec2_t(0.375f, 0.5f), "Glyph U+0416 offset mismatch");
+  bench::Check(font.Glyph('A').size == bb::vec2_t(0.046875f, 0.0625f), "Glyph size mismatch");
+
+  float treeSum = 0.0f;
+  auto tree = bench::Measure(rounds,
+    [&codepoints, &offsets, &sizes, &treeSum, repeats]()
+    {
+      for (int repeat = 0; repeat < repeats; ++repeat)
+      {
+        for (auto smb: codepoints)
+        {
+          treeSum += offsets.find(smb)->second.x + sizes.find(smb)->second.y;
+        }
+      }
+    }
+  );
+
+  float tableSum = 0.0f;
+  auto table = bench::Measure(rounds,
+    [&codepoints, &font, &tableSum, repeats]()
+    {
+      for (int repeat = 0; repeat < repeats; ++repeat)
+      {
+        for (auto smb: codepoints)
+        {
+          auto& glyph = font.Glyph(smb);
+          tableSum += glyph.offset.x + glyph.size.y;
+        }
+      }
+    }
+  );
+  bench::Check(treeSum == tableSum, "Glyph metrics mismatch");
+
+  size_t vectorPoints = 0;
+  auto vector = bench::Measure(rounds,
+    [&codepoints, &vectorPoints, repeats]()
+    {
+      for (int repeat = 0; repeat < repeats; ++repeat)
+      {
+        for (auto smb: codepoints)
+        {
+          size_t smbSize = 0;
+          bb::VectorFontSymbol(static_cast<wint_t>(smb), &smbSize);
+          vectorPoints += smbSize;
+        }
+      }
+    }
+  );
+
+  bb::glyphQuads_t quads;
+  size_t indecies = 0;
+  auto layout = bench::Measure(rounds,
+    [&paragraph, &font, &quads, &indecies, repeats]()
+    {
+      for (int repeat = 0; repeat < repeats; ++repeat)
+      {
+        indecies = bb::LayoutText(font, paragraph.c_str(), bb::vec2_t(0.01f, 0.02f), quads);
+      }
+    }
+  );
+  bench::Check(indecies > 0, "Nothing laid out");
+
+  bb::Info("Paragraph: " BBsize_t " symbols, " BBsize_t " bytes, %d repeats, best of %d rounds", codepoints.size(), paragraph.size(), repeats, rounds);
+  bb::Info("tree lookups:   %.3f ms", tree*1000.0);
+  bb::Info("table lookups:  %.3f ms", table*1000.0);
+  bb::Info("vector symbols: %.3f ms (" BBsize_t " points)", vector*1000.0, vectorPoints);
+  bb::Info("layout:         %.3f ms (" BBsize_t " indecies)", layout*1000.0, indecies);
+  return 0;
+}
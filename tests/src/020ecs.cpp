@@ -0,0 +1,494 @@
+#include <bench.hpp>
+#include <common.hpp>
+#include <components.hpp>
+#include <systems.hpp>
+#include <unitGrid.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+  const glm::ivec2 mapSize = { 1024, 1024 };
+  const int queryRadius = 10;
+
+  /**
+   * Same set of components, as star.rg gives to orks, every tenth unit
+   * has no AI, like player.
+   */
+  void AddComponents(std::mt19937& engine, sr::entityID_t entity, int index)
+  {
+    std::uniform_int_distribution<int> posX(1, mapSize.x - 2);
+    std::uniform_int_distribution<int> posY(1, mapSize.y - 2);
+
+    sr::pos_t::factory_t::Instance().NewComponent(entity, { glm::ivec2(posX(engine), posY(engine)) });
+    sr::sprite_t::factory_t::Instance().NewComponent(entity, { glm::ivec2(26, 2) });
+    sr::melee_t::factory_t::Instance().NewComponent(entity, { 20, 90, 50, 5 });
+    sr::update_t::factory_t::Instance().NewComponent(entity, { 2000, 0 });
+    sr::status_t::factory_t::Instance().NewComponent(entity, { sr::US_NONE, glm::vec2(0.0f) });
+    if ((index % 10) != 0)
+    {
+      sr::ai_t::factory_t::Instance().NewComponent(entity, { sr::AI_STALKER });
+    }
+  }
+
+  sr::entityID_t Spawn(std::mt19937& engine, int index)
+  {
+    auto entity = sr::entityFactory_t::Instance().GetNew();
+    AddComponents(engine, entity, index);
+    return entity;
+  }
+
+  bool InsideMap(glm::ivec2 pos)
+  {
+    return (pos.x > 0) && (pos.y > 0) && (pos.x < mapSize.x - 1) && (pos.y < mapSize.y - 1);
+  }
+
+  template<typename dist_t>
+  size_t Stalk(std::mt19937& engine, dist_t& modeSide, const sr::aiData_t& unitAI, const sr::statusData_t& unitStatus, sr::updateData_t& unitUpdate, sr::posData_t& unitPos)
+  {
+    if ((unitStatus.status == sr::US_DEAD) || (unitAI.ai != sr::AI_STALKER))
+    {
+      return 0;
+    }
+
+    size_t moves = 0;
+    unitUpdate.curTime += 1000;
+    while (unitUpdate.curTime > unitUpdate.moveTime)
+    {
+      unitUpdate.curTime -= unitUpdate.moveTime;
+      auto newPos = unitPos.v + sr::iSideVec[modeSide(engine)];
+      if (InsideMap(newPos))
+      {
+        unitPos.v = newPos;
+        ++moves;
+      }
+    }
+    return moves;
+  }
+
+  /**
+   * Key, which star.rg used for units on map, all cells on diagonal get
+   * same hash.
+   */
+  struct diagonalKey_t
+  {
+    size_t operator()(const glm::ivec2& k) const
+    {
+      return std::hash<int>()(k.x) ^ std::hash<int>()(k.y);
+    }
+
+    bool operator()(const glm::ivec2& a, const glm::ivec2& b) const
+    {
+      return a.x == b.x && a.y == b.y;
+    }
+  };
+
+  using unitMap_t = std::unordered_multimap<glm::ivec2, sr::entityID_t, diagonalKey_t, diagonalKey_t>;
+  using unitPos_t = std::pair<sr::entityID_t, glm::ivec2>;
+
+  std::vector<unitPos_t> UnitPositions()
+  {
+    std::vector<unitPos_t> result;
+    sr::pos_t::factory_t::Instance().Each(
+      [&result](sr::entityID_t id, sr::posData_t& pos)
+      {
+        result.emplace_back(id, pos.v);
+      }
+    );
+    return result;
+  }
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  if (bb::ProcessStartupArguments(argc, argv) != 0)
+  {
+    return -1;
+  }
+
+  const int total = (argc > 1)?(atoi(argv[1])):(100000);
+  const int passes = 10;
+  const int rounds = 5;
+
+  std::mt19937 engine(42);
+  auto& entities = sr::entityFactory_t::Instance();
+
+  std::vector<sr::entityID_t> units;
+  auto spawn = bench::Measure(rounds,
+    [&engine, &entities, &units, total]()
+    {
+      entities.Clear();
+      units.clear();
+      for (int i = 0; i < total; ++i)
+      {
+        units.push_back(Spawn(engine, i));
+      }
+    }
+  );
+  bench::Check(entities.Size() == static_cast<size_t>(total), "Entity count mismatch");
+  bench::Check(sr::ai_t::factory_t::Instance().Size() == static_cast<size_t>(total - (total + 9)/10), "AI count mismatch");
+
+  // ProcessAI pass: every unit with AI moves, when its time comes
+  size_t moves = 0;
+  auto ai = bench::Measure(rounds,
+    [&engine, &moves, passes]()
+    {
+      std::uniform_int_distribution<int> modeSide(sr::SIDE_UP, sr::SIDE_UP_LEFT);
+      for (int pass = 0; pass < passes; ++pass)
+      {
+        sr::Each<sr::ai_t, sr::status_t, sr::update_t, sr::pos_t>(
+          [&engine, &moves, &modeSide](sr::entityID_t, const sr::aiData_t& unitAI, const sr::statusData_t& unitStatus, sr::updateData_t& unitUpdate, sr::posData_t& unitPos)
+          {
+            moves += Stalk(engine, modeSide, unitAI, unitStatus, unitUpdate, unitPos);
+          }
+        );
+      }
+    }
+  );
+  bench::Check(moves > 0, "Nobody moved");
+
+  // same pass split in chunks by scheduler
+  std::atomic<size_t> scheduledMoves(0);
+  sr::scheduler_t turn(1024);
+  turn.Add(
+    sr::system_t{
+      "ai",
+      sr::Access<sr::ai_t, sr::status_t>(),
+      sr::Access<sr::update_t, sr::pos_t>(),
+      []()
+      {
+        return sr::ai_t::factory_t::Instance().Size();
+      },
+      [&scheduledMoves](size_t begin, size_t end, sr::commands_t&)
+      {
+        std::mt19937 chunkEngine(static_cast<uint32_t>(begin));
+        std::uniform_int_distribution<int> modeSide(sr::SIDE_UP, sr::SIDE_UP_LEFT);
+        size_t chunkMoves = 0;
+        sr::EachInRange<sr::ai_t, sr::status_t, sr::update_t, sr::pos_t>(begin, end,
+          [&chunkEngine, &modeSide, &chunkMoves](sr::entityID_t, const sr::aiData_t& unitAI, const sr::statusData_t& unitStatus, sr::updateData_t& unitUpdate, sr::posData_t& unitPos)
+          {
+            chunkMoves += Stalk(chunkEngine, modeSide, unitAI, unitStatus, unitUpdate, unitPos);
+          }
+        );
+        scheduledMoves += chunkMoves;
+      }
+    }
+  );
+
+  auto scheduled = bench::Measure(rounds,
+    [&turn, passes]()
+    {
+      for (int pass = 0; pass < passes; ++pass)
+      {
+        turn.Run();
+      }
+    }
+  );
+  bench::Check(scheduledMoves.load() > 0, "Nobody moved in scheduled pass");
+
+  // BuildUnits pass: per-entity lookups by ID
+  size_t visible = 0;
+  auto lookup = bench::Measure(rounds,
+    [&units, &visible]()
+    {
+      visible = 0;
+      for (auto unit: units)
+      {
+        auto& unitPos = sr::pos_t::factory_t::Instance().Item(unit);
+        auto& unitSprite = sr::sprite_t::factory_t::Instance().Item(unit);
+        auto& unitStatus = sr::status_t::factory_t::Instance().Item(unit);
+        visible += ((unitPos.v.x < mapSize.x/2) && (unitSprite.id.x != 0) && (unitStatus.status != sr::US_DEAD));
+      }
+    }
+  );
+
+  // same pass with view
+  size_t viewVisible = 0;
+  auto view = bench::Measure(rounds,
+    [&viewVisible]()
+    {
+      viewVisible = 0;
+      sr::Each<sr::sprite_t, sr::pos_t, sr::status_t>(
+        [&viewVisible](sr::entityID_t, const sr::spriteData_t& unitSprite, const sr::posData_t& unitPos, const sr::statusData_t& unitStatus)
+        {
+          viewVisible += ((unitPos.v.x < mapSize.x/2) && (unitSprite.id.x != 0) && (unitStatus.status != sr::US_DEAD));
+        }
+      );
+    }
+  );
+  bench::Check(visible == viewVisible, "View mismatch");
+
+  // third of units die and are replaced, IDs are reused from free list
+  auto respawn = bench::Measure(1,
+    [&engine, &entities, &units]()
+    {
+      for (size_t i = 0; i < units.size(); i += 3)
+      {
+        entities.Release(units[i]);
+      }
+      for (size_t i = 0; i < units.size(); i += 3)
+      {
+        units[i] = Spawn(engine, static_cast<int>(i));
+      }
+    }
+  );
+  bench::Check(entities.Size() == static_cast<size_t>(total), "Entity count mismatch after respawn");
+  bench::Check(*std::max_element(units.begin(), units.end()) == total - 1, "Entity IDs are not reused");
+  bench::Check(sr::pos_t::factory_t::Instance().Size() == static_cast<size_t>(total), "Component count mismatch after respawn");
+
+  // dead units are replaced through commands, applied after stage ends
+  for (size_t i = 0; i < units.size(); i += 7)
+  {
+    sr::status_t::factory_t::Instance().Item(units[i]).status = sr::US_DEAD;
+  }
+
+  size_t dead = 0;
+  sr::status_t::factory_t::Instance().Each(
+    [&dead](sr::entityID_t, sr::statusData_t& unitStatus)
+    {
+      dead += (unitStatus.status == sr::US_DEAD);
+    }
+  );
+
+  sr::scheduler_t reaper(1024);
+  reaper.Add(
+    sr::system_t{
+      "reaper",
+      sr::Access<sr::status_t>(),
+      0,
+      []()
+      {
+        return sr::status_t::factory_t::Instance().Size();
+      },
+      [&engine](size_t begin, size_t end, sr::commands_t& commands)
+      {
+        sr::EachInRange<sr::status_t>(begin, end,
+          [&engine, &commands](sr::entityID_t id, const sr::statusData_t& unitStatus)
+          {
+            if (unitStatus.status != sr::US_DEAD)
+            {
+              return;
+            }
+            commands.Despawn(id);
+            commands.Spawn(
+              [&engine](sr::entityID_t entity)
+              {
+                AddComponents(engine, entity, 1);
+              }
+            );
+          }
+        );
+      }
+    }
+  );
+
+  auto reap = bench::Measure(1,
+    [&reaper]()
+    {
+      reaper.Run();
+    }
+  );
+  bench::Check(entities.Size() == static_cast<size_t>(total), "Entity count mismatch after reaping");
+  bench::Check(sr::pos_t::factory_t::Instance().Size() == static_cast<size_t>(total), "Component count mismatch after reaping");
+  sr::status_t::factory_t::Instance().Each(
+    [](sr::entityID_t, sr::statusData_t& unitStatus)
+    {
+      bench::Check(unitStatus.status != sr::US_DEAD, "Dead unit is not reaped");
+    }
+  );
+
+  // units on map: hash map rebuilt every turn, as world_t did, against
+  // grid, where only moved units change cells
+  std::vector<unitPos_t> turns[2];
+  turns[0] = UnitPositions();
+  {
+    std::uniform_int_distribution<int> modeSide(sr::SIDE_UP, sr::SIDE_UP_LEFT);
+    sr::Each<sr::ai_t, sr::status_t, sr::update_t, sr::pos_t>(
+      [&engine, &modeSide](sr::entityID_t, const sr::aiData_t& unitAI, const sr::statusData_t& unitStatus, sr::updateData_t& unitUpdate, sr::posData_t& unitPos)
+      {
+        Stalk(engine, modeSide, unitAI, unitStatus, unitUpdate, unitPos);
+      }
+    );
+  }
+  turns[1] = UnitPositions();
+
+  unitMap_t unitMap;
+  int turnIndex = 0;
+  auto rebuild = bench::Measure(rounds,
+    [&unitMap, &turns, &turnIndex]()
+    {
+      unitMap.clear();
+      for (auto& unit: turns[turnIndex++ % 2])
+      {
+        unitMap.emplace(unit.second, unit.first);
+      }
+    }
+  );
+
+  sr::unitGrid_t grid;
+  grid.Reset(mapSize);
+  turnIndex = 0;
+  auto place = bench::Measure(rounds,
+    [&grid, &turns, &turnIndex]()
+    {
+      for (auto& unit: turns[turnIndex++ % 2])
+      {
+        grid.Place(unit.first, unit.second);
+      }
+    }
+  );
+
+  std::vector<glm::ivec2> centers;
+  {
+    std::uniform_int_distribution<int> posX(0, mapSize.x - 1);
+    std::uniform_int_distribution<int> posY(0, mapSize.y - 1);
+    for (int i = 0; i < 1000; ++i)
+    {
+      centers.emplace_back(posX(engine), posY(engine));
+    }
+  }
+
+  size_t mapFound = 0;
+  auto mapQuery = bench::Measure(rounds,
+    [&unitMap, &centers, &mapFound]()
+    {
+      mapFound = 0;
+      for (auto center: centers)
+      {
+        for (auto dy = -queryRadius; dy <= queryRadius; ++dy)
+        {
+          for (auto dx = -queryRadius; dx <= queryRadius; ++dx)
+          {
+            if (dx * dx + dy * dy <= queryRadius * queryRadius)
+            {
+              auto range = unitMap.equal_range(center + glm::ivec2(dx, dy));
+              mapFound += static_cast<size_t>(std::distance(range.first, range.second));
+            }
+          }
+        }
+      }
+    }
+  );
+
+  size_t gridFound = 0;
+  auto gridQuery = bench::Measure(rounds,
+    [&grid, &centers, &gridFound]()
+    {
+      gridFound = 0;
+      for (auto center: centers)
+      {
+        grid.EachInRadius(center, queryRadius,
+          [&gridFound](sr::entityID_t, glm::ivec2)
+          {
+            ++gridFound;
+          }
+        );
+      }
+    }
+  );
+  bench::Check(mapFound == gridFound, "Radius query mismatch");
+
+  // rectangle against brute force, grid holds positions of the last round
+  const auto& placed = turns[(rounds - 1) % 2];
+  for (size_t i = 0; i < 10; ++i)
+  {
+    auto from = centers[i] - queryRadius;
+    auto to = centers[i] + glm::ivec2(queryRadius * 2, queryRadius);
+    size_t inRect = 0;
+    grid.EachInRect(from, to,
+      [&inRect](sr::entityID_t, glm::ivec2)
+      {
+        ++inRect;
+      }
+    );
+
+    size_t expected = 0;
+    for (auto& unit: placed)
+    {
+      expected += (unit.second.x >= from.x) && (unit.second.y >= from.y) && (unit.second.x <= to.x) && (unit.second.y <= to.y);
+    }
+    bench::Check(inRect == expected, "Rectangle query mismatch");
+  }
+
+  // units leave head, middle and tail of shared cell by moving or removal
+  {
+    sr::unitGrid_t cellGrid;
+    cellGrid.Reset(glm::ivec2(4, 4));
+    const glm::ivec2 shared(1, 1);
+    const glm::ivec2 other(2, 3);
+    for (sr::entityID_t id = 0; id < 6; ++id)
+    {
+      cellGrid.Place(id, shared);
+    }
+
+    auto cellUnits = [&cellGrid](glm::ivec2 pos) -> std::vector<sr::entityID_t>
+    {
+      std::vector<sr::entityID_t> result;
+      cellGrid.EachAt(pos,
+        [&result](sr::entityID_t id, glm::ivec2)
+        {
+          result.push_back(id);
+        }
+      );
+      std::sort(result.begin(), result.end());
+      return result;
+    };
+
+    auto head = cellGrid.First(shared);
+    auto middle = cellGrid.Next(head);
+    auto tail = middle;
+    while (cellGrid.Next(tail) >= 0)
+    {
+      tail = cellGrid.Next(tail);
+    }
+
+    cellGrid.Place(middle, other);
+    cellGrid.Remove(head);
+    cellGrid.Remove(tail);
+    cellGrid.Place(cellGrid.First(shared), shared); // same cell, nothing changes
+
+    std::vector<sr::entityID_t> left;
+    for (sr::entityID_t id = 0; id < 6; ++id)
+    {
+      if ((id != head) && (id != middle) && (id != tail))
+      {
+        left.push_back(id);
+      }
+    }
+    bench::Check(cellUnits(shared) == left, "Shared cell list is broken");
+    bench::Check(cellUnits(other) == std::vector<sr::entityID_t>(1, middle), "Moved unit is not in its cell");
+    bench::Check((!cellGrid.Has(head)) && (!cellGrid.Has(tail)) && cellGrid.Has(middle), "Removed units are still on grid");
+
+    // last unit of cell leaves
+    cellGrid.Remove(middle);
+    bench::Check(cellGrid.First(other) < 0, "Cell is not empty after removal");
+    for (auto id: left)
+    {
+      cellGrid.Place(id, other);
+    }
+    bench::Check(cellGrid.First(shared) < 0, "Cell is not empty after moves");
+    bench::Check(cellUnits(other) == left, "Cell list is broken after moves");
+  }
+
+  bb::Info("Entities: %d, best of %d rounds", total, rounds);
+  bb::Info("spawn:        %.3f ms", spawn*1000.0);
+  bb::Info("ai passes:    %.3f ms (%d passes, " BBsize_t " moves)", ai*1000.0, passes, moves);
+  bb::Info("scheduled:    %.3f ms (%d passes, " BBsize_t " stages)", scheduled*1000.0, passes, turn.Stages());
+  bb::Info("lookup pass:  %.3f ms (" BBsize_t " visible)", lookup*1000.0, visible);
+  bb::Info("view pass:    %.3f ms", view*1000.0);
+  bb::Info("respawn 1/3:  %.3f ms", respawn*1000.0);
+  bb::Info("reap:         %.3f ms (" BBsize_t " dead)", reap*1000.0, dead);
+  bb::Info("map rebuild:  %.3f ms", rebuild*1000.0);
+  bb::Info("grid moves:   %.3f ms", place*1000.0);
+  bb::Info("map radius:   %.3f ms (" BBsize_t " found)", mapQuery*1000.0, mapFound);
+  bb::Info("grid radius:  %.3f ms (" BBsize_t " found)", gridQuery*1000.0, gridFound);
+  return 0;
+}
@@ -0,0 +1,106 @@
+#include <common.hpp>
+#include <image.hpp>
+#include <textureFile.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+
+  void PrintUsage()
+  {
+    fprintf(stderr, "%s\n", "Usage: tga2tex TGA TEX [rgba8|bc1|bc3] [nomips]");
+  }
+
+  bool ParseFormat(const char* name, bb::textureFormat_t* format)
+  {
+    if (strcmp(name, "rgba8") == 0)
+    {
+      *format = bb::textureFormat_t::rgba8;
+      return true;
+    }
+    if (strcmp(name, "bc1") == 0)
+    {
+      *format = bb::textureFormat_t::bc1;
+      return true;
+    }
+    if (strcmp(name, "bc3") == 0)
+    {
+      *format = bb::textureFormat_t::bc3;
+      return true;
+    }
+    return false;
+  }
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  if (bb::ProcessStartupArguments(argc, argv) != 0)
+  {
+    return -1;
+  }
+
+  if ((argc < 3) || (argc > 5))
+  {
+    fprintf(stderr, "%s\n", "Error: No input or output provided!");
+    PrintUsage();
+    return -1;
+  }
+
+  auto format = bb::textureFormat_t::rgba8;
+  if ((argc > 3) && !ParseFormat(argv[3], &format))
+  {
+    fprintf(stderr, "Error: Unknown format \"%s\"\n", argv[3]);
+    PrintUsage();
+    return -1;
+  }
+
+  bool mipmaps = true;
+  if (argc > 4)
+  {
+    if (strcmp(argv[4], "nomips") != 0)
+    {
+      fprintf(stderr, "Error: Unknown option \"%s\"\n", argv[4]);
+      PrintUsage();
+      return -1;
+    }
+    mipmaps = false;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+
+  bb::image_t image;
+  try
+  {
+    image = bb::LoadTGA(argv[1]);
+  }
+  catch (const std::runtime_error& error)
+  {
+    fprintf(stderr, "Error: %s\n", error.what());
+    return -1;
+  }
+
+  FILE* output = fopen(argv[2], "wb");
+  if (output == nullptr)
+  {
+    fprintf(stderr, "Error: Can't open \"%s\"\n", argv[2]);
+    return -1;
+  }
+  BB_DEFER(fclose(output));
+
+  if (bb::SaveTexture(output, image, format, mipmaps) != 0)
+  {
+    fprintf(stderr, "Error: Can't save \"%s\"\n", argv[2]);
+    return -1;
+  }
+  long fileSize = ftell(output);
+
+  auto convert = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  bb::Info("Image: %dx%d", image.Width(), image.Height());
+  bb::Info("Saved: %ld bytes in %.3f ms", fileSize, convert*1000.0);
+  return 0;
+}